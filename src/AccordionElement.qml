@@ -11,8 +11,17 @@ ColumnLayout {
     property alias textFontSize: accordionText.font.pixelSize
     property alias indicatRectColor: indicatRect.color
     default property alias accordionContent: contentPlaceholder.data
+    // content created the first time the section is opened, instead of with the page
+    property Component sectionContent: null
     spacing: 0
 
+    function loadSection() {
+        if(rootElement.isOpen && rootElement.sectionContent)
+            sectionLoader.active = true;
+    }
+    onIsOpenChanged: loadSection()
+    Component.onCompleted: loadSection()
+
     Layout.fillWidth: true;
 
     Rectangle {
@@ -65,4 +74,13 @@ ColumnLayout {
         visible: rootElement.isOpen
         Layout.fillWidth: true;
     }
+
+    // once loaded the section is kept, closing it only hides it
+    Loader {
+        id: sectionLoader
+        active: false
+        visible: rootElement.isOpen
+        sourceComponent: rootElement.sectionContent
+        Layout.fillWidth: true;
+    }
 }
@@ -1,59 +1,65 @@
 import QtQuick 2.4
+import QtCharts 2.2
+import Qt.labs.settings 1.0
 
 ChartsEndWorkoutForm {
-    Timer {
-        id: timer
+    // the series read the session in place from the model, one point every 10 seconds
+    VXYModelMapper { model: rootItem.workout_model; series: powerSeries; xColumn: 0; yColumn: 1 }
+    VXYModelMapper { model: rootItem.workout_model; series: heartSeries; xColumn: 0; yColumn: 2 }
+    VXYModelMapper { model: rootItem.workout_model; series: cadenceSeries; xColumn: 0; yColumn: 3 }
+    VXYModelMapper { model: rootItem.workout_model; series: resistanceSeries; xColumn: 0; yColumn: 4 }
+    VXYModelMapper { model: rootItem.workout_model; series: pelotonResistanceSeries; xColumn: 0; yColumn: 5 }
 
-        // Start the timer and execute the provided callback on every X milliseconds
-        function startTimer(callback, milliseconds) {
-            timer.interval = milliseconds;
-            timer.repeat = false;
-            timer.triggered.connect(callback);
-            timer.start();
-        }
-
-        // Stop the timer and unregister the callback
-        function stopTimer(callback) {
-            timer.stop();
-            timer.triggered.disconnect(callback);
-        }
+    Settings {
+        id: settings
+        property bool miles_unit: false
     }
 
-    function saveScreenshot()
+    // power curve, or the speed one without a power meter, with the heart rate one on the right scale
+    function updateCurves()
     {
-        rootItem.save_screenshot_chart(powerChart, "powerChart");
-        rootItem.save_screenshot_chart(heartChart, "heartChart");
-        rootItem.save_screenshot_chart(cadenceChart, "cadenceChart");
-        timer.stopTimer(saveScreenshot)
-        timer.startTimer(sendMail, 100);
-    }
-
-    function sendMail()
-    {
-        rootItem.sendMail()
-        timer.stopTimer(sendMail)
+        var durations = rootItem.workout_curve_durations;
+        var power = rootItem.workout_power_curve_points;
+        var heart = rootItem.workout_heart_curve_points;
+        var speed = rootItem.workout_speed_curve_points;
+        var left = power;
+        var conversion = 1.0;
+        if(power.length === 0 || power[0] <= 0)
+        {
+            left = speed;
+            conversion = settings.miles_unit ? 0.621371 : 1.0;
+            curveSeries.name = settings.miles_unit ? "Speed (mi/h)" : "Speed (km/h)";
+            curveSeries.color = "steelblue";
+        }
+        var top = 1;
+        var last = 1;
+        for(var i = 0; i < durations.length; i++)
+        {
+            if(left[i] > 0)
+            {
+                curveSeries.append(durations[i], left[i] * conversion);
+                top = Math.max(top, left[i] * conversion);
+                last = durations[i];
+            }
+            if(heart[i] > 0)
+            {
+                heartCurveSeries.append(durations[i], heart[i]);
+                last = Math.max(last, durations[i]);
+            }
+        }
+        curveAxisX.max = Math.max(10, last);
+        curveAxisY.max = Math.ceil(top * 1.1);
     }
 
     Component.onCompleted: {
         headerToolbar.visible = true;
 
-        //console.log("ChartsEndWorkoutForm completed " + rootItem.workout_sample_points)
-        for(var i=0;i<rootItem.workout_sample_points;i+=10)
-        {
-            //console.log("ChartsEndWorkoutForm completed " + i + " " + rootItem.workout_watt_points[i])
-            powerSeries.append(i * 1000, rootItem.workout_watt_points[i]);
-            heartSeries.append(i * 1000, rootItem.workout_heart_points[i]);
-            cadenceSeries.append(i * 1000, rootItem.workout_cadence_points[i]);
-            resistanceSeries.append(i * 1000, rootItem.workout_resistance_points[i]);
-            pelotonResistanceSeries.append(i * 1000, rootItem.workout_peloton_resistance_points[i]);
-        }
         rootItem.update_chart_power(powerChart);
         //rootItem.update_axes(valueAxisX, valueAxisY);
         rootItem.update_chart_heart(heartChart);
         //rootItem.update_axes(valueAxisXHR, valueAxisYHR);
         //rootItem.update_chart(cadenceChart);
         //rootItem.update_axes(valueAxisXCadence, valueAxisYCadence);
-
-        timer.startTimer(saveScreenshot, 100);
+        updateCurves();
     }
 }
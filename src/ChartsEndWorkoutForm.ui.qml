@@ -14,6 +14,12 @@ Item {
     property alias resistanceSeries: resistanceSeries
     property alias pelotonResistanceSeries: pelotonResistanceSeries
     property alias cadenceChart: cadenceChart
+    property alias curveChart: curveChart
+    property alias curveAxisX: curveAxisX
+    property alias curveAxisY: curveAxisY
+    property alias curveAxisYHR: curveAxisYHR
+    property alias curveSeries: curveSeries
+    property alias heartCurveSeries: heartCurveSeries
 
     Settings {
         id: settings
@@ -128,7 +134,7 @@ Item {
             anchors.right: parent.right
             anchors.top: instructor.bottom
             anchors.bottom: parent.bottom
-            contentHeight: powerChart.height+heartChart.height+cadenceChart.height
+            contentHeight: powerChart.height+heartChart.height+cadenceChart.height+curveChart.height
 
             ChartView {
                 id: powerChart
@@ -286,6 +292,63 @@ Item {
                     width: 1
                 }
             }
+
+            // best efforts: the mean-maximal curves, filled by ChartsEndWorkout.qml
+            ChartView {
+                id: curveChart
+                height: 400
+                width: parent.width
+                antialiasing: true
+                legend.visible: true
+                anchors.top: cadenceChart.bottom
+                title: "Best Efforts"
+                titleFont.pixelSize: 20
+
+                LogValueAxis {
+                    id: curveAxisX
+                    base: 10
+                    min: 1
+                    max: 3600
+                    labelFormat: "%.0f s"
+                    labelsFont.pixelSize: 10
+                }
+
+                ValueAxis {
+                    id: curveAxisY
+                    min: 0
+                    max: rootItem.wattMaxChart
+                    tickCount: 8
+                    labelFormat: "%.0f"
+                    labelsFont.pixelSize: 10
+                }
+
+                ValueAxis {
+                    id: curveAxisYHR
+                    min: 60
+                    max: 220
+                    tickCount: 6
+                    labelFormat: "%.0f"
+                    labelsFont.pixelSize: 10
+                }
+
+                LineSeries {
+                    name: "Power"
+                    id: curveSeries
+                    axisX: curveAxisX
+                    axisY: curveAxisY
+                    color: "black"
+                    width: 2
+                }
+
+                LineSeries {
+                    name: "Heart Rate"
+                    id: heartCurveSeries
+                    axisX: curveAxisX
+                    axisYRight: curveAxisYHR
+                    color: "red"
+                    width: 2
+                }
+            }
         }
     }
 }
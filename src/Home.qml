@@ -12,6 +12,8 @@ HomeForm{
     signal stop_clicked;
     signal lap_clicked;
     signal peloton_start_workout;
+    signal journal_resume;
+    signal journal_discard;
     signal plus_clicked(string name)
     signal minus_clicked(string name)
 
@@ -30,6 +32,16 @@ HomeForm{
         visible: rootItem.pelotonAskStart
     }
 
+    MessageDialog {
+        id: messageJournalAskResume
+        text: "Unfinished workout found"
+        informativeText: "The last workout wasn't saved. Do you want to resume it?"
+        buttons: (MessageDialog.Yes | MessageDialog.No)
+        onYesClicked: {rootItem.journalAskResume = false; journal_resume();}
+        onNoClicked: {rootItem.journalAskResume = false; journal_discard();}
+        visible: rootItem.journalAskResume
+    }
+
     Popup {
         id: popupLap
          parent: Overlay.overlay
@@ -73,4 +73,80 @@ ColumnLayout {
             onClicked: portRow.doSavePort(textTcpClientPort.text)
         }
     }
+    SwitchDelegate {
+        id: binaryDelegate
+        text: qsTr("Binary telemetry (no template script)")
+        spacing: 0
+        bottomPadding: 0
+        topPadding: 0
+        rightPadding: 0
+        leftPadding: 0
+        clip: false
+        checked: settings.value("template_"+rootElement.templateId+"_binary", false)
+        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+        Layout.fillWidth: true
+        onClicked: settings.setValue("template_"+rootElement.templateId+"_binary", checked)
+    }
+    RowLayout {
+        spacing: 10
+        id: rateRow
+        visible: binaryDelegate.checked
+        Label {
+            id: labelTcpClientRate
+            text: qsTr("Sample interval (ms):")
+            Layout.fillWidth: true
+        }
+        function doSaveRate(text) {
+            let rate = parseInt(text);
+            if (!isNaN(rate) && rate >= 20)
+                settings.setValue("template_"+rootElement.templateId+"_rate_ms", rate);
+        }
+
+        TextField {
+            id: textTcpClientRate
+            text: settings.value("template_"+rootElement.templateId+"_rate_ms",100) + "";
+            horizontalAlignment: Text.AlignRight
+            Layout.fillHeight: false
+            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+            inputMethodHints: Qt.ImhDigitsOnly
+            onAccepted: rateRow.doSaveRate(text)
+        }
+        Button {
+            id: buttonTcpClientRate
+            text: "OK"
+            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+            onClicked: rateRow.doSaveRate(textTcpClientRate.text)
+        }
+    }
+    RowLayout {
+        spacing: 10
+        id: flushRow
+        visible: binaryDelegate.checked
+        Label {
+            id: labelTcpClientFlush
+            text: qsTr("Flush interval (ms):")
+            Layout.fillWidth: true
+        }
+        function doSaveFlush(text) {
+            let flush = parseInt(text);
+            if (!isNaN(flush) && flush >= 0)
+                settings.setValue("template_"+rootElement.templateId+"_flush_ms", flush);
+        }
+
+        TextField {
+            id: textTcpClientFlush
+            text: settings.value("template_"+rootElement.templateId+"_flush_ms",500) + "";
+            horizontalAlignment: Text.AlignRight
+            Layout.fillHeight: false
+            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+            inputMethodHints: Qt.ImhDigitsOnly
+            onAccepted: flushRow.doSaveFlush(text)
+        }
+        Button {
+            id: buttonTcpClientFlush
+            text: "OK"
+            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+            onClicked: flushRow.doSaveFlush(textTcpClientFlush.text)
+        }
+    }
 }
@@ -0,0 +1,97 @@
+#include "actuationmodel.h"
+#include <QDateTime>
+#include <QDebug>
+#include <string.h>
+
+// smallest change that makes a step, in the units of the channel (km/h, %, resistance levels)
+static const double tolerance[actuationmodel::CHANNELS] = {0.2, 0.2, 0.6};
+static const qint64 maxStep = 60000; // ms, a target not reached by then is dropped (limits of the machine, manual change)
+static const double learning = 0.3; // weight of the last step in the estimates
+static const double minRamp = 0.1; // s, a value that jumps to the target between two updates
+static const double maxLag = 20.0; // s
+
+actuationmodel::actuationmodel()
+{
+    clear();
+}
+
+void actuationmodel::clear()
+{
+    memset(m_channels, 0, sizeof(m_channels));
+    for(int c = 0; c < CHANNELS; c++)
+    {
+        m_latency[c] = metric();
+        m_deadTime[c].store(0, std::memory_order_relaxed);
+        m_rate[c].store(0, std::memory_order_release);
+    }
+}
+
+void actuationmodel::request(CHANNEL c, double target, double current)
+{
+    channel& ch = m_channels[c];
+
+    // the same target again doesn't restart the step
+    if(ch.pending && qAbs(ch.target - target) < tolerance[c])
+        return;
+
+    ch.pending = qAbs(target - current) >= tolerance[c];
+    ch.from = current;
+    ch.target = target;
+    ch.requested = QDateTime::currentMSecsSinceEpoch();
+    ch.moved = 0;
+}
+
+void actuationmodel::measure(CHANNEL c, double value)
+{
+    channel& ch = m_channels[c];
+    if(!ch.pending)
+        return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if(now - ch.requested > maxStep)
+    {
+        qDebug() << "actuationmodel: channel" << c << "target" << ch.target << "not reached, last value" << value;
+        ch.pending = false;
+        return;
+    }
+
+    if(!ch.moved && qAbs(value - ch.from) >= tolerance[c])
+        ch.moved = now;
+
+    // on the target or past it
+    if(qAbs(ch.target - value) >= tolerance[c] && (ch.target - value) * (ch.target - ch.from) > 0)
+        return;
+
+    if(!ch.moved)
+        ch.moved = now;
+    ch.pending = false;
+
+    const double dead = (ch.moved - ch.requested) / 1000.0;
+    const double rate = qAbs(ch.target - ch.from) / qMax((now - ch.moved) / 1000.0, minRamp);
+    if(!ch.steps)
+    {
+        ch.deadTime = dead;
+        ch.rate = rate;
+    }
+    else
+    {
+        ch.deadTime += learning * (dead - ch.deadTime);
+        ch.rate += learning * (rate - ch.rate);
+    }
+    if(ch.steps < 0xffff)
+        ch.steps++;
+    m_deadTime[c].store(ch.deadTime, std::memory_order_relaxed);
+    m_rate[c].store(ch.rate, std::memory_order_release);
+    m_latency[c].setValue(now - ch.requested);
+
+    qDebug() << "actuationmodel: channel" << c << "step" << ch.from << "->" << ch.target << "in" << (now - ch.requested) <<
+                "ms, dead time" << ch.deadTime << "s rate" << ch.rate << "/s";
+}
+
+double actuationmodel::lag(CHANNEL c, double from, double to)
+{
+    const double rate = m_rate[c].load(std::memory_order_acquire);
+    if(rate <= 0 || qAbs(to - from) < tolerance[c])
+        return 0;
+    return qMin(m_deadTime[c].load(std::memory_order_relaxed) + qAbs(to - from) / rate, maxLag);
+}
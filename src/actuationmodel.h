@@ -0,0 +1,57 @@
+#ifndef ACTUATIONMODEL_H
+#define ACTUATIONMODEL_H
+
+#include <QtGlobal>
+#include <atomic>
+#include "metric.h"
+
+// step response of a machine to the requested targets, learned from the values it reports:
+// a dead time before the value starts moving and a ramp rate after it. The lag predicted for a step
+// is dead time + step / rate; the train program issues the next segment ahead of its start by it.
+// request() and measure() run on the thread of the device, lag() can be called from any thread.
+class actuationmodel
+{
+public:
+    enum CHANNEL
+    {
+        SPEED = 0,
+        INCLINATION,
+        RESISTANCE,
+        CHANNELS
+    };
+
+    actuationmodel();
+    // a new target requested with the value measured at the request
+    void request(CHANNEL c, double target, double current);
+    // the value measured at an update of the device, closes the step when it reaches the target
+    void measure(CHANNEL c, double value);
+    // seconds from the request of the step to the target, 0 until a step has been measured
+    double lag(CHANNEL c, double from, double to);
+    // ms from the request to the target of the measured steps
+    metric latency(CHANNEL c) {return m_latency[c];}
+    void clear();
+
+private:
+    typedef struct channel
+    {
+        // the step in progress
+        bool pending;
+        double from;
+        double target;
+        qint64 requested; // ms
+        qint64 moved; // ms, 0 while the value is still on from
+
+        // learned
+        uint16_t steps;
+        double deadTime; // s
+        double rate; // units per s
+    }channel;
+
+    channel m_channels[CHANNELS];
+    metric m_latency[CHANNELS];
+    // the learned values as lag() reads them, 0 until a step has been measured
+    std::atomic<double> m_deadTime[CHANNELS];
+    std::atomic<double> m_rate[CHANNELS];
+};
+
+#endif // ACTUATIONMODEL_H
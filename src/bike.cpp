@@ -4,13 +4,31 @@
 
 bike::bike()
 {
-
+    // about 3 bpm for each resistance level, at most a level every 2 seconds
+    heartZone.setModel(3, 40);
+    heartZone.setLimits(1, 32, 0.5, 1);
 }
 
-void bike::changeResistance(int8_t resistance) { if(autoResistanceEnable) {requestResistance = resistance * m_difficult; emit resistanceChanged(requestResistance);} RequestedResistance = resistance * m_difficult; }
+void bike::changeResistance(int8_t resistance, commandarbiter::SOURCE source) { arbiter.submit(actuationmodel::RESISTANCE, resistance * m_difficult, source); }
+double bike::heartZoneOutput() { return currentResistance().value(); }
+// the output is already a resistance of the machine: no difficulty on it, unlike changeResistance
+void bike::changeHeartZoneOutput(double value) { arbiter.submit(actuationmodel::RESISTANCE, (int8_t)value, commandarbiter::HEARTZONE); }
+void bike::applyCommand(actuationmodel::CHANNEL c, double value)
+{
+    if(c != actuationmodel::RESISTANCE)
+        return;
+    if(autoResistanceEnable)
+    {
+        requestResistance = value;
+        actuation.request(c, requestResistance, currentResistance().value());
+        emit resistanceChanged(requestResistance);
+    }
+    RequestedResistance = value;
+}
 void bike::changeRequestedPelotonResistance(int8_t resistance) { RequestedPelotonResistance = resistance; }
 void bike::changeCadence(int16_t cadence) { RequestedCadence = cadence; }
-void bike::changePower(int32_t power)
+void bike::changeGrade(double grade) { physics.setGrade(grade); }
+void bike::changePower(int32_t power, commandarbiter::SOURCE source)
 {
     RequestedPower = power;
     QSettings settings;
@@ -23,7 +41,7 @@ void bike::changePower(int32_t power)
     double deltaUp = ((double)power) - wattsMetric().value();
     qDebug() << "filter  " + QString::number(deltaUp) + " " + QString::number(deltaDown) + " " +QString::number(erg_filter_upper) + " " +QString::number(erg_filter_lower);
     if(force_resistance /*&& erg_mode*/ && (deltaUp > erg_filter_upper || deltaDown > erg_filter_lower))
-        changeResistance((int8_t)resistanceFromPowerRequest(power)); // resistance start from 1
+        changeResistance((int8_t)resistanceFromPowerRequest(power), source); // resistance start from 1
 }
 double bike::currentCrankRevolutions() { return CrankRevs;}
 uint16_t bike::lastCrankEventTime() { return LastCrankEventTime;}
@@ -39,22 +57,40 @@ uint16_t bike::watts() { return 0; }
 metric bike::pelotonResistance() { return m_pelotonResistance; }
 int bike::pelotonToBikeResistance(int pelotonResistance) {return pelotonResistance;}
 uint8_t bike::resistanceFromPowerRequest(uint16_t power) {return power / 10;} // in order to have something
-void bike::cadenceSensor(uint8_t cadence) { Cadence.setValue(cadence); }
+void bike::cadenceSensor(uint8_t cadence) { sensors.publish(sensorbus::CADENCE, sensorbus::EXTERNAL, cadence); }
+void bike::powerSensor(uint16_t power) { sensors.publish(sensorbus::POWER, sensorbus::EXTERNAL, power); }
+
+void bike::fuseSensors()
+{
+    bluetoothdevice::fuseSensors();
+    double cadence;
+    if(sensors.fuse(sensorbus::CADENCE, &cadence))
+        Cadence = cadence;
+    // the machine keeps writing its own power on every packet, so it's the fallback when the accessory is gone
+    double power;
+    if(sensors.active(sensorbus::POWER) && sensors.fuse(sensorbus::POWER, &power))
+        m_watt = power;
+}
+
+void bike::fillSample(bluetoothdevicesample* s)
+{
+    bluetoothdevice::fillSample(s);
+    s->bike.cadence = sampleOf(currentCadence());
+    s->bike.resistance = sampleOf(currentResistance());
+    s->bike.pelotonResistance = sampleOf(pelotonResistance());
+    s->bike.requestedResistance = lastRequestedResistance().value();
+    s->bike.requestedPelotonResistance = lastRequestedPelotonResistance().value();
+    s->bike.requestedCadence = lastRequestedCadence().value();
+    s->bike.requestedPower = lastRequestedPower().value();
+    s->bike.crankRevolutions = currentCrankRevolutions();
+    s->bike.lastCrankEventTime = lastCrankEventTime();
+}
 
 bluetoothdevice::BLUETOOTH_TYPE bike::deviceType() { return bluetoothdevice::BIKE; }
 
 void bike::clearStats()
 {
-    moving.clear(true);
-    elapsed.clear(true);
-    Speed.clear(false);
-    KCal.clear(true);
-    Distance.clear(true);
-    Heart.clear(false);
-    m_jouls.clear(true);
-    elevationAcc = 0;
-    m_watt.clear(false);
-    WeightLoss.clear(false);
+    physics.reset();
 
     RequestedPelotonResistance.clear(false);
     RequestedResistance.clear(false);
@@ -63,20 +99,12 @@ void bike::clearStats()
     m_pelotonResistance.clear(false);
     Cadence.clear(false);
     Resistance.clear(false);
+    bluetoothdevice::clearStats();
 }
 
 void bike::setPaused(bool p)
 {
-    paused = p;
-    moving.setPaused(p);
-    elapsed.setPaused(p);
-    Speed.setPaused(p);
-    KCal.setPaused(p);
-    Distance.setPaused(p);
-    Heart.setPaused(p);
-    m_jouls.setPaused(p);
-    m_watt.setPaused(p);
-    WeightLoss.setPaused(p);
+    bluetoothdevice::setPaused(p);
     m_pelotonResistance.setPaused(p);
     Cadence.setPaused(p);
     Resistance.setPaused(p);
@@ -88,16 +116,7 @@ void bike::setPaused(bool p)
 
 void bike::setLap()
 {
-    moving.setLap(true);
-    elapsed.setLap(true);
-    Speed.setLap(false);
-    KCal.setLap(true);
-    Distance.setLap(true);
-    Heart.setLap(false);
-    m_jouls.setLap(true);
-    m_watt.setLap(false);
-    WeightLoss.setLap(false);
-
+    bluetoothdevice::setLap();
     RequestedPelotonResistance.setLap(false);
     RequestedResistance.setLap(false);
     RequestedCadence.setLap(false);
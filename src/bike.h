@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include "bluetoothdevice.h"
+#include "bikephysics.h"
 
 class bike:public bluetoothdevice
 {
@@ -31,11 +32,14 @@ public:
     uint8_t metrics_override_heartrate();
 
 public slots:
-    virtual void changeResistance(int8_t res);
+    virtual void changeResistance(int8_t res, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
     virtual void changeCadence(int16_t cad);
-    virtual void changePower(int32_t power);
+    virtual void changePower(int32_t power, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
     virtual void changeRequestedPelotonResistance(int8_t resistance);
     virtual void cadenceSensor(uint8_t cadence);
+    virtual void powerSensor(uint16_t power);
+    // percent, grade of the route for the virtual speed
+    void changeGrade(double grade);
 
 signals:
     void bikeStarted();
@@ -43,6 +47,7 @@ signals:
     void resistanceRead(int8_t resistance);
 
 protected:
+    bikephysics physics; // power based virtual speed (speed_power_based)
     metric Cadence;
     metric Resistance;
     metric RequestedResistance;    
@@ -54,6 +59,12 @@ protected:
     double CrankRevs = 0;
 
     metric m_pelotonResistance;
+
+    void fuseSensors();
+    void fillSample(bluetoothdevicesample* s);
+    double heartZoneOutput();
+    void changeHeartZoneOutput(double value);
+    void applyCommand(actuationmodel::CHANNEL c, double value);
 };
 
 #endif // BIKE_H
@@ -0,0 +1,118 @@
+#include "bikephysics.h"
+#include <QSettings>
+#include <QtMath>
+#include <QDebug>
+
+static const double g = 9.8;
+static const double aero = 0.22691607640851885; // 0.5 * air density * CdA
+static const double crr = 0.005;
+static const double tran = 0.95; // drivetrain efficiency
+static const double maxSpeed = 40.0; // m/s
+static const qint64 profileCheck = 10000; // ms between the reads of the rider profile
+static const double maxStep = 5.0; // seconds, longer gaps between the samples don't carry momentum
+static const double substep = 0.1; // seconds, integration step
+static const double minDriveSpeed = 0.5; // m/s, the drive force tran * power / v is taken at least at this speed
+
+bikephysics::bikephysics()
+{
+    profile();
+}
+
+void bikephysics::profile()
+{
+    QSettings settings;
+    const double mass = settings.value("weight", 75.0).toDouble() + settings.value("bike_weight", 0.0).toDouble();
+    m_profileTimer.start();
+    if(mass == m_mass)
+        return;
+
+    m_mass = mass;
+    for(int p = 0; p < POWER_STEPS; p++)
+        for(int gr = 0; gr < GRADE_STEPS; gr++)
+            m_table[p][gr] = solve(p * POWER_STEP, GRADE_MIN + gr * GRADE_STEP);
+    qDebug() << "bikephysics: table built for" << m_mass << "kg";
+}
+
+double bikephysics::solve(double power, double grade)
+{
+    const double angle = qAtan(grade / 100.0);
+    const double resistance = m_mass * g * (crr * qCos(angle) + qSin(angle));
+    const double drive = tran * power;
+
+    // v * (aero * v^2 + resistance) grows with v after its minimum, so there is only one crossing
+    double lo = 0;
+    double hi = maxSpeed;
+    for(int i = 0; i < 40; i++)
+    {
+        const double v = (lo + hi) / 2;
+        if(v * (aero * v * v + resistance) < drive)
+            lo = v;
+        else
+            hi = v;
+    }
+    return lo;
+}
+
+double bikephysics::steadySpeed(double power, double grade)
+{
+    if(m_profileTimer.elapsed() > profileCheck)
+        profile();
+
+    const double pi = qBound(0.0, power / POWER_STEP, (double)(POWER_STEPS - 1));
+    const double gi = qBound(0.0, (grade - GRADE_MIN) / GRADE_STEP, (double)(GRADE_STEPS - 1));
+    const int p0 = qMin((int)pi, POWER_STEPS - 2);
+    const int g0 = qMin((int)gi, GRADE_STEPS - 2);
+    const double fp = pi - p0;
+    const double fg = gi - g0;
+    const double v = m_table[p0][g0] * (1 - fp) * (1 - fg) + m_table[p0 + 1][g0] * fp * (1 - fg) +
+                     m_table[p0][g0 + 1] * (1 - fp) * fg + m_table[p0 + 1][g0 + 1] * fp * fg;
+    return v * 3.6;
+}
+
+double bikephysics::speed(double power)
+{
+    const double target = steadySpeed(power, m_grade) / 3.6;
+
+    double dt = 0;
+    if(m_sampleTimer.isValid())
+        dt = qMin(m_sampleTimer.restart() / 1000.0, maxStep);
+    else
+        m_sampleTimer.start();
+    if(dt <= 0)
+        return m_speed * 3.6;
+
+    // m * dv/dt = tran * power / v - aero * v^2 - resistance, integrated from the current speed, so
+    // without power the rider coasts down with the drag of that speed. The steady speed of the table
+    // is the only zero of the force: a step never goes past it. Below minDriveSpeed the drive force
+    // would be unbounded, it's taken at that speed (or at the steady one, if it's lower)
+    const double angle = qAtan(m_grade / 100.0);
+    const double resistance = m_mass * g * (crr * qCos(angle) + qSin(angle));
+    const double drive = tran * qMax(power, 0.0);
+    const double driveFloor = qMin(minDriveSpeed, qMax(target, 0.1));
+    while(dt > 0)
+    {
+        const double h = qMin(dt, substep);
+        const double force = drive / qMax(m_speed, driveFloor) - aero * m_speed * m_speed - resistance;
+        double v = m_speed + force / m_mass * h;
+        if((v - target) * (m_speed - target) < 0)
+            v = target;
+        m_speed = qBound(0.0, v, maxSpeed);
+        dt -= h;
+    }
+    return m_speed * 3.6;
+}
+
+void bikephysics::setGrade(double grade)
+{
+    if(grade == m_grade)
+        return;
+    qDebug() << "bikephysics: grade" << grade;
+    m_grade = grade;
+}
+
+void bikephysics::reset()
+{
+    m_speed = 0;
+    m_grade = 0;
+    m_sampleTimer.invalidate();
+}
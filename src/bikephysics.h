@@ -0,0 +1,49 @@
+#ifndef BIKEPHYSICS_H
+#define BIKEPHYSICS_H
+
+#include <QElapsedTimer>
+
+// virtual speed of a rider on a road bike, for the bikes without a speed sensor (speed_power_based).
+// The steady speed at every power and grade is solved once per rider profile (weight and bike weight
+// of the settings) into a table, so the target of a sample costs a bilinear lookup. The speed then
+// follows the equation of motion of the rider mass from the current speed toward the steady one:
+// it doesn't jump with the power, it builds up and coasts down like on the road.
+// The grade comes from the simulation parameters of the virtual bridge or from the train program.
+// Every bike owns its own, so the machines of the sessions don't share the state of the rider.
+class bikephysics
+{
+public:
+    bikephysics();
+
+    // km/h, speed reached holding the power on the grade (percent)
+    double steadySpeed(double power, double grade);
+    // km/h, speed after the time elapsed since the previous call, riding at the power on the current grade
+    double speed(double power);
+
+    void setGrade(double grade);
+    double grade() {return m_grade;}
+    // new session: the rider starts still on the flat
+    void reset();
+
+private:
+    // reads the rider profile and builds the table again when it changed
+    void profile();
+    // m/s, solution of tran * power = v * (aero * v^2 + rolling and gravity forces)
+    double solve(double power, double grade);
+
+    static const int POWER_STEPS = 201; // 0..2000 W
+    static const int GRADE_STEPS = 101; // -25..25 %
+    static constexpr double POWER_STEP = 10.0;
+    static constexpr double GRADE_STEP = 0.5;
+    static constexpr double GRADE_MIN = -25.0;
+
+    float m_table[POWER_STEPS][GRADE_STEPS]; // m/s
+    double m_mass = 0; // kg, rider and bike
+    QElapsedTimer m_profileTimer;
+
+    double m_grade = 0;
+    double m_speed = 0; // m/s
+    QElapsedTimer m_sampleTimer;
+};
+
+#endif // BIKEPHYSICS_H
@@ -3,14 +3,18 @@
 #include <QDateTime>
 #include <QMetaEnum>
 #include <QBluetoothLocalDevice>
+#include <QTimer>
+#include <QCoreApplication>
 #include <QtXml>
+
+static const int fastReconnectTimeoutMs = 15000;
 #ifdef Q_OS_ANDROID
 #include "keepawakehelper.h"
 #include <QAndroidJniObject>
 #endif
 
 
-bluetooth::bluetooth(bool logs, QString deviceName, bool noWriteResistance, bool noHeartService, uint32_t pollDeviceTime, bool noConsole, bool testResistance, uint8_t bikeResistanceOffset, double bikeResistanceGain)
+bluetooth::bluetooth(bool logs, QString deviceName, bool noWriteResistance, bool noHeartService, uint32_t pollDeviceTime, bool noConsole, bool testResistance, uint8_t bikeResistanceOffset, double bikeResistanceGain, bool sharedDiscovery)
 {
     QSettings settings;
     bool trx_route_key = settings.value("trx_route_key", false).toBool();
@@ -25,7 +29,10 @@ bluetooth::bluetooth(bool logs, QString deviceName, bool noWriteResistance, bool
     this->logs = logs;
     this->bikeResistanceGain = bikeResistanceGain;
     this->bikeResistanceOffset = bikeResistanceOffset;
-    this->templateManager = TemplateInfoSenderBuilder::getInstance(this);
+    this->sharedDiscovery = sharedDiscovery;
+    // the templates are a singleton with a fixed port: with several sessions none of them owns it
+    if(!sharedDiscovery)
+        this->templateManager = TemplateInfoSenderBuilder::getInstance(this);
 
 #if !defined(WIN32) && !defined(Q_OS_IOS)
     if(!QBluetoothLocalDevice::allDevices().count())
@@ -37,6 +44,8 @@ bluetooth::bluetooth(bool logs, QString deviceName, bool noWriteResistance, bool
     {
         // Create a discovery agent and connect to its signals
         discoveryAgent = new QBluetoothDeviceDiscoveryAgent(this);
+        if(sharedDiscovery)
+            return;
         connect(discoveryAgent, SIGNAL(deviceDiscovered(QBluetoothDeviceInfo)),
                 this, SLOT(deviceDiscovered(QBluetoothDeviceInfo)));
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0))
@@ -80,7 +89,101 @@ bluetooth::bluetooth(bool logs, QString deviceName, bool noWriteResistance, bool
             discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
         else
             discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::ClassicMethod | QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+
+        startFastReconnect();
+    }
+}
+
+void bluetooth::startFastReconnect()
+{
+    // the devices of the previous session go through the same matching of the discovered ones
+    // while the scan keeps running: whichever reaches the device first connects it
+    QList<QBluetoothDeviceInfo> last = lastDevices();
+    if(!last.length())
+        return;
+
+    fastReconnect = true;
+    fastReconnectDevice = 0;
+    QTimer::singleShot(0, this, [this, last]() {
+        bluetoothdevice* before = device();
+        foreach(QBluetoothDeviceInfo b, last)
+        {
+            debug("fast reconnect: trying " + b.name());
+            deviceDiscovered(b);
+        }
+        if(!before && device())
+            fastReconnectDevice = device();
+    });
+    // the timeout of an attempt replaced by a restart() is ignored
+    const uint32_t attempt = ++fastReconnectAttempt;
+    QTimer::singleShot(fastReconnectTimeoutMs, this, [this, attempt]() {
+        if(attempt == fastReconnectAttempt)
+            fastReconnectTimeout();
+    });
+}
+
+void bluetooth::startTemplates(bluetoothdevice* device)
+{
+    if(templateManager)
+        templateManager->start(device);
+}
+
+QList<QBluetoothDeviceInfo> bluetooth::lastDevices()
+{
+    QSettings settings;
+    QList<QBluetoothDeviceInfo> last;
+    if(!settings.value("bluetooth_fast_reconnect", true).toBool())
+        return last;
+
+    QString name = settings.value("bluetooth_lastdevice_name", "").toString();
+    if(!name.length() || (filterDevice.length() && !filterDevice.startsWith("Disabled") && name.compare(filterDevice, Qt::CaseInsensitive)))
+        return last;
+
+    // the main device and the sensors the settings still ask for, with the keys saved at their connection
+    const char* keys[][3] = {
+        {"", "bluetooth_lastdevice_name", "bluetooth_lastdevice_address"},
+        {"heart_rate_belt_name", "hrm_lastdevice_name", "hrm_lastdevice_address"},
+        {"ftms_accessory_name", "ftms_accessory_lastdevice_name", "ftms_accessory_address"},
+        {"cadence_sensor_name", "csc_sensor_lastdevice_name", "csc_sensor_address"},
+    };
+    for(auto key : keys)
+    {
+        QString n = settings.value(key[1], "").toString();
+        QString address = settings.value(key[2], "").toString();
+        if(!n.length() || !address.length())
+            continue;
+        if(strlen(key[0]))
+        {
+            QString wanted = settings.value(key[0], "Disabled").toString();
+            if(wanted.startsWith("Disabled") || !n.startsWith(wanted))
+                continue;
+        }
+#ifndef Q_OS_IOS
+        QBluetoothDeviceInfo b(QBluetoothAddress(address), n, 0);
+#else
+        QBluetoothDeviceInfo b(QBluetoothUuid(address), n, 0);
+#endif
+        b.setCoreConfigurations(QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+        last.append(b);
+    }
+    return last;
+}
+
+void bluetooth::fastReconnectTimeout()
+{
+    if(!fastReconnect)
+        return;
+
+    if(!device() || device() != fastReconnectDevice)
+    {
+        // nothing matched the cached devices, or the scan created the device: it goes on as usual
+        fastReconnect = false;
+        return;
     }
+
+    debug("fast reconnect: no answer from " + device()->bluetoothDevice.name() + ", back to the discovery");
+    fastReconnectFailed = true;
+    restart();
 }
 
 bluetooth::~bluetooth()
@@ -249,7 +352,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                     connect(this, SIGNAL(searchingStop()), m3iBike, SLOT(searchingStop()));
                     if(!discoveryAgent->isActive())
                         emit searchingStop();
-                    templateManager->start(m3iBike);
+                    startTemplates(m3iBike);
                 }
             }
             else if(csc_as_bike && b.name().startsWith(cscName) && !cscBike && filter)
@@ -277,7 +380,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 connect(this, SIGNAL(searchingStop()), domyosBike, SLOT(searchingStop()));
                 if(!discoveryAgent->isActive())
                     emit searchingStop();
-                templateManager->start(domyosBike);
+                startTemplates(domyosBike);
             }
             else if(b.name().startsWith("Domyos-EL") && !b.name().startsWith("DomyosBridge") && !domyosElliptical && filter)
             {
@@ -291,7 +394,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 connect(this, SIGNAL(searchingStop()), domyosElliptical, SLOT(searchingStop()));
                 if(!discoveryAgent->isActive())
                     emit searchingStop();
-                templateManager->start(domyosElliptical);
+                startTemplates(domyosElliptical);
             }
             else if(b.name().toUpper().startsWith("E95S") && !soleElliptical && filter)
             {
@@ -330,7 +433,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 connect(this, SIGNAL(searchingStop()), domyos, SLOT(searchingStop()));
                 if(!discoveryAgent->isActive())
                     emit searchingStop();
-                templateManager->start(domyos);
+                startTemplates(domyos);
             }
             else if((b.name().toUpper().startsWith("HORIZON") || b.name().toUpper().startsWith("F80") || b.name().toUpper().startsWith("S77") || b.name().toUpper().startsWith("ESANGLINKER")) && !horizonTreadmill && filter)
             {
@@ -349,7 +452,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 connect(this, SIGNAL(searchingStop()), horizonTreadmill, SLOT(searchingStop()));
                 if(!discoveryAgent->isActive())
                     emit searchingStop();
-                templateManager->start(horizonTreadmill);
+                startTemplates(horizonTreadmill);
             }
             else if((b.name().toUpper().startsWith(">CABLE") || b.name().toUpper().startsWith("BIKE 1")) && !npeCableBike && filter)
             {
@@ -363,7 +466,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(echelonConnectSport, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(echelonConnectSport, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 npeCableBike->deviceDiscovered(b);
-                templateManager->start(npeCableBike);
+                startTemplates(npeCableBike);
             }
             else if(b.name().toUpper().startsWith("STAGES ") && !stagesBike && filter)
             {
@@ -377,7 +480,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(stagesBike, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(stagesBike, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 stagesBike->deviceDiscovered(b);
-                templateManager->start(stagesBike);
+                startTemplates(stagesBike);
             }
             else if(b.name().toUpper().startsWith("CR 00") && !ftmsRower && filter)
             {
@@ -391,7 +494,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(v, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(ftmsRower, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 ftmsRower->deviceDiscovered(b);
-                templateManager->start(ftmsRower);
+                startTemplates(ftmsRower);
             }
             else if(b.name().startsWith("ECH-ROW") && !echelonRower && filter)
             {
@@ -405,7 +508,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(echelonRower, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(echelonRower, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 echelonRower->deviceDiscovered(b);
-                templateManager->start(echelonRower);
+                startTemplates(echelonRower);
             }
             else if(b.name().startsWith("ECH") && !echelonRower && !echelonConnectSport && filter)
             {
@@ -419,7 +522,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(echelonConnectSport, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(echelonConnectSport, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 echelonConnectSport->deviceDiscovered(b);
-                templateManager->start(echelonConnectSport);
+                startTemplates(echelonConnectSport);
             }
             else if((b.name().toUpper().startsWith("IC BIKE") || b.name().toUpper().startsWith("C7-")) && !schwinnIC4Bike && filter)
             {
@@ -439,7 +542,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(echelonConnectSport, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(echelonConnectSport, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 schwinnIC4Bike->deviceDiscovered(b);
-                templateManager->start(schwinnIC4Bike);
+                startTemplates(schwinnIC4Bike);
             }
             else if(b.name().toUpper().startsWith("EW-BK") && !sportsTechBike && filter)
             {
@@ -453,7 +556,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(echelonConnectSport, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(echelonConnectSport, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 sportsTechBike->deviceDiscovered(b);
-                templateManager->start(sportsTechBike);
+                startTemplates(sportsTechBike);
             }
             else if(b.name().startsWith("YESOUL") && !yesoulBike && filter)
             {
@@ -467,7 +570,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(echelonConnectSport, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(echelonConnectSport, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 yesoulBike->deviceDiscovered(b);
-                templateManager->start(yesoulBike);
+                startTemplates(yesoulBike);
             }
             else if(b.name().startsWith("I_EB") && !proformBike && filter)
             {
@@ -481,7 +584,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(proformBike, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(proformBike, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 proformBike->deviceDiscovered(b);
-                templateManager->start(proformBike);
+                startTemplates(proformBike);
             }
             else if(b.name().startsWith("I_TL") && !proformTreadmill && filter)
             {
@@ -495,7 +598,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(proformtreadmill, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(proformtreadmill, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 proformTreadmill->deviceDiscovered(b);
-                templateManager->start(proformTreadmill);
+                startTemplates(proformTreadmill);
             }
             else if(b.name().toUpper().startsWith("ESLINKER") && !eslinkerTreadmill && filter)
             {
@@ -509,7 +612,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(proformtreadmill, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(proformtreadmill, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 eslinkerTreadmill->deviceDiscovered(b);
-                templateManager->start(eslinkerTreadmill);
+                startTemplates(eslinkerTreadmill);
             }
             else if(b.name().startsWith("Flywheel") && !flywheelBike && filter)
             {
@@ -523,7 +626,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(echelonConnectSport, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
                 //connect(echelonConnectSport, SIGNAL(inclinationChanged(double)), this, SLOT(inclinationChanged(double)));
                 flywheelBike->deviceDiscovered(b);
-                templateManager->start(flywheelBike);
+                startTemplates(flywheelBike);
             }
             else if((b.name().startsWith("TRX ROUTE KEY")) && !toorx && filter)
             {
@@ -534,7 +637,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(toorx, SIGNAL(disconnected()), this, SLOT(restart()));
                 connect(toorx, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 toorx->deviceDiscovered(b);
-                templateManager->start(toorx);
+                startTemplates(toorx);
             }
             else if(b.name().toUpper().startsWith("XT485") && !spiritTreadmill && filter)
             {
@@ -545,7 +648,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(spiritTreadmill, SIGNAL(disconnected()), this, SLOT(restart()));
                 connect(spiritTreadmill, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 spiritTreadmill->deviceDiscovered(b);
-                templateManager->start(spiritTreadmill);
+                startTemplates(spiritTreadmill);
             }
             else if(((b.name().startsWith("TOORX")) || (b.name().startsWith("V-RUN")) || (b.name().startsWith("i-Console+")) || (b.name().startsWith("i-Running"))  || (device.name().startsWith("F63"))) && !trxappgateusb && !trxappgateusbBike && !toorx_bike && !JLL_IC400_bike && filter)
             {
@@ -556,7 +659,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(trxappgateusb, SIGNAL(disconnected()), this, SLOT(restart()));
                 connect(trxappgateusb, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 trxappgateusb->deviceDiscovered(b);
-                templateManager->start(trxappgateusb);
+                startTemplates(trxappgateusb);
             }
             else if((((b.name().startsWith("TOORX") || b.name().toUpper().startsWith("I-CONSOLE+") || b.name().toUpper().startsWith("IBIKING+") || b.name().toUpper().startsWith("ICONSOLE+") || b.name().toUpper().startsWith("DKN MOTION")) && (toorx_bike || JLL_IC400_bike))) && !trxappgateusb && !trxappgateusbBike && filter)
             {
@@ -567,7 +670,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(trxappgateusb, SIGNAL(disconnected()), this, SLOT(restart()));
                 connect(trxappgateusbBike, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 trxappgateusbBike->deviceDiscovered(b);
-                templateManager->start(trxappgateusbBike);
+                startTemplates(trxappgateusbBike);
             }
             else if(b.name().toUpper().startsWith("BFCP") && !skandikaWiriBike && filter)
             {
@@ -578,7 +681,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(skandikaWiriBike, SIGNAL(disconnected()), this, SLOT(restart()));
                 connect(skandikaWiriBike, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 skandikaWiriBike->deviceDiscovered(b);
-                templateManager->start(skandikaWiriBike);
+                startTemplates(skandikaWiriBike);
             }
             else if((b.name().startsWith("FS-") && snode_bike) && !snodeBike && filter)
             {
@@ -589,7 +692,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(trxappgateusb, SIGNAL(disconnected()), this, SLOT(restart()));
                 connect(snodeBike, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 snodeBike->deviceDiscovered(b);
-                templateManager->start(snodeBike);
+                startTemplates(snodeBike);
             }
             else if((b.name().startsWith("FS-") && fitplus_bike) && !fitPlusBike && filter)
             {
@@ -600,7 +703,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 //connect(fitPlusBike, SIGNAL(disconnected()), this, SLOT(restart()));
                 connect(fitPlusBike, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 fitPlusBike->deviceDiscovered(b);
-                templateManager->start(fitPlusBike);
+                startTemplates(fitPlusBike);
             }
             else if(((b.name().startsWith("FS-") && !snode_bike && !fitplus_bike) || (b.name().startsWith("SW") && b.name().length() == 14)) && !fitshowTreadmill && filter)
             {
@@ -613,7 +716,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 connect(this, SIGNAL(searchingStop()), fitshowTreadmill, SLOT(searchingStop()));
                 if(!discoveryAgent->isActive())
                     emit searchingStop();
-                templateManager->start(fitshowTreadmill);
+                startTemplates(fitshowTreadmill);
             }
             else if(b.name().toUpper().startsWith("IC") && b.name().length() == 8 && !inspireBike && filter)
             {
@@ -631,7 +734,7 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device)
                 connect(this, SIGNAL(searchingStop()), inspireBike, SLOT(searchingStop()));
                 if(!discoveryAgent->isActive())
                     emit searchingStop();
-                templateManager->start(inspireBike);
+                startTemplates(inspireBike);
             }
             else if(b.name().toUpper().startsWith("CHRONO ") && !chronoBike && filter)
             {
@@ -658,6 +761,19 @@ void bluetooth::connectedAndDiscovered()
 {
     static bool firstConnected = true;
     QSettings settings;
+
+    if(fastReconnect)
+        debug("fast reconnect: connected");
+    fastReconnect = false;
+    if(device() && device()->bluetoothDevice.name().length())
+    {
+        settings.setValue("bluetooth_lastdevice_name", device()->bluetoothDevice.name());
+#ifndef Q_OS_IOS
+        settings.setValue("bluetooth_lastdevice_address", device()->bluetoothDevice.address().toString());
+#else
+        settings.setValue("bluetooth_lastdevice_address", device()->bluetoothDevice.deviceUuid().toString());
+#endif
+    }
     QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     QString ftmsAccessoryName = settings.value("ftms_accessory_name", "Disabled").toString();
     bool csc_as_bike = settings.value("cadence_sensor_as_bike", false).toBool();
@@ -679,6 +795,11 @@ void bluetooth::connectedAndDiscovered()
             settings.setValue("hrm_lastdevice_address", "");
     }
 
+    // every driver declares its own disconnected(): the snapshot has to say the machine is gone also
+    // when no update follows the disconnection
+    if(device())
+        connect(device(), SIGNAL(disconnected()), device(), SLOT(publishSample()), Qt::UniqueConnection);
+
     if(this->device() != nullptr)
     {
 #ifdef Q_OS_IOS
@@ -692,6 +813,7 @@ void bluetooth::connectedAndDiscovered()
 
             connect(heartRateBelt, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
             connect(heartRateBelt, SIGNAL(heartRate(uint8_t)), this->device(), SLOT(heartRate(uint8_t)));
+            connect(heartRateBelt, SIGNAL(rrInterval(double)), this->device(), SLOT(rrInterval(double)));
             QBluetoothDeviceInfo bt;
             bt.setDeviceUuid(QBluetoothUuid(settings.value("hrm_lastdevice_address", "").toString()));
             qDebug() << "UUID" << bt.deviceUuid();
@@ -713,6 +835,7 @@ void bluetooth::connectedAndDiscovered()
 
                 connect(heartRateBelt, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 connect(heartRateBelt, SIGNAL(heartRate(uint8_t)), this->device(), SLOT(heartRate(uint8_t)));
+                connect(heartRateBelt, SIGNAL(rrInterval(double)), this->device(), SLOT(rrInterval(double)));
                 heartRateBelt->deviceDiscovered(b);
 
                 break;
@@ -735,6 +858,7 @@ void bluetooth::connectedAndDiscovered()
                 connect(ftmsAccessory, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
                 connect(this->device(), SIGNAL(resistanceChanged(int8_t)), ftmsAccessory, SLOT(changeResistance(int8_t)));
                 connect(this->device(), SIGNAL(resistanceRead(int8_t)), ftmsAccessory, SLOT(resistanceReadFromTheBike(int8_t)));
+                connect(ftmsAccessory, SIGNAL(powerChanged(uint16_t)), this->device(), SLOT(powerSensor(uint16_t)));
                 ftmsAccessory->deviceDiscovered(b);
                 break;
             }
@@ -795,15 +919,20 @@ void bluetooth::restart()
     if(onlyDiscover)
     {
         onlyDiscover = false;
-        discoveryAgent->start();
+        if(!sharedDiscovery)
+            discoveryAgent->start();
         return;
     }
 
-    if(settings.value("bluetooth_no_reconnection", false).toBool())
+    // a failed fast reconnect isn't a disconnection of the device
+    if(settings.value("bluetooth_no_reconnection", false).toBool() && !fastReconnect)
         exit(0);
+    fastReconnect = false;
+    fastReconnectDevice = 0;
 
     devices.clear();
-    templateManager->stop();
+    if(templateManager)
+        templateManager->stop();
 
     if(device() && device()->VirtualDevice())
     {
@@ -978,7 +1107,14 @@ void bluetooth::restart()
         delete cadenceSensor;
         cadenceSensor = 0;
     }
-    discoveryAgent->start();
+    if(!sharedDiscovery)
+    {
+        discoveryAgent->start();
+        // the cached devices just failed to answer: only the discovery this time
+        if(!fastReconnectFailed)
+            startFastReconnect();
+    }
+    fastReconnectFailed = false;
 }
 
 bluetoothdevice* bluetooth::device()
@@ -1050,6 +1186,12 @@ bool bluetooth::handleSignal(int signal)
     {
         qDebug() << "SIGINT";
         QFile::remove("status.xml");
+        // the sessions are written on the way out of the event loop
+        if(sharedDiscovery)
+        {
+            QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+            return true;
+        }
         exit(0);
     }
     // Let the signal propagate as though we had not been there
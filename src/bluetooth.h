@@ -56,7 +56,7 @@ class bluetooth : public QObject, public SignalHandler
 {
     Q_OBJECT
 public:
-    explicit bluetooth(bool logs, QString deviceName = "", bool noWriteResistance = false, bool noHeartService = false, uint32_t pollDeviceTime = 200, bool noConsole = false, bool testResistance = false, uint8_t bikeResistanceOffset = 4, double bikeResistanceGain = 1.0);
+    explicit bluetooth(bool logs, QString deviceName = "", bool noWriteResistance = false, bool noHeartService = false, uint32_t pollDeviceTime = 200, bool noConsole = false, bool testResistance = false, uint8_t bikeResistanceOffset = 4, double bikeResistanceGain = 1.0, bool sharedDiscovery = false);
     ~bluetooth();
     bluetoothdevice* device();
     bluetoothdevice* heartRateDevice() {return heartRateBelt;}
@@ -64,6 +64,7 @@ public:
     bool onlyDiscover = false;
 
 private:
+    friend class benchmarks; // test/benchmarks
     TemplateInfoSenderBuilder * templateManager = 0;
     QFile* debugCommsLog = 0;
     QBluetoothDeviceDiscoveryAgent *discoveryAgent;
@@ -109,6 +110,15 @@ private:
     uint8_t bikeResistanceOffset = 4;
     double bikeResistanceGain = 1.0;
     bool forceHeartBeltOffForTimeout = false;
+    // a connection to the devices of the previous session is running alongside the discovery
+    bool fastReconnect = false;
+    // the device created by the connection to the cached devices, 0 if the scan created it
+    bluetoothdevice* fastReconnectDevice = 0;
+    // restart() called because the cached devices didn't answer
+    bool fastReconnectFailed = false;
+    uint32_t fastReconnectAttempt = 0;
+    // the devices come from the discovery of devicesessions, the own agent is never started
+    bool sharedDiscovery = false;
 
     bool handleSignal(int signal);
     void stateFileUpdate();
@@ -116,6 +126,10 @@ private:
     bool heartRateBeltAvaiable();
     bool ftmsAccessoryAvaiable();
     bool cscSensorAvaiable();
+    QList<QBluetoothDeviceInfo> lastDevices();
+    void startFastReconnect();
+    // none without the template manager (sessions)
+    void startTemplates(bluetoothdevice* device);
 
 signals:
     void deviceConnected();
@@ -137,6 +151,7 @@ private slots:
     void speedChanged(double);
     void inclinationChanged(double);
     void connectedAndDiscovered();
+    void fastReconnectTimeout();
 
 signals:
 
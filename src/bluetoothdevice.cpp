@@ -1,15 +1,25 @@
 #include "bluetoothdevice.h"
 #include <QTime>
 #include <QSettings>
+#include <QDebug>
 
 bluetoothdevice::bluetoothdevice()
 {
-
+    QSettings settings;
+    hrv.setWindow(settings.value("hrv_window", 120).toUInt());
+    // follows the device when it is moved to the bluetooth thread
+    arbiter.setParent(this);
+    connect(&arbiter, &commandarbiter::command, this, &bluetoothdevice::applyCommand);
 }
 
 bluetoothdevice::BLUETOOTH_TYPE bluetoothdevice::deviceType() { return bluetoothdevice::UNKNOWN; }
 void bluetoothdevice::start(){ requestStart = 1; }
-void bluetoothdevice::stop(){ requestStop = 1; }
+void bluetoothdevice::stop()
+{
+    requestStop = 1;
+    // here and not in the GUI, so the headless runs report them too
+    qDebug() << "commands" << arbiter.report();
+}
 metric bluetoothdevice::currentHeart(){ return Heart; }
 metric bluetoothdevice::currentSpeed(){ return Speed; }
 QTime bluetoothdevice::movingTime() {int hours = (int)(moving.value()/3600.0); return QTime(hours, (int)(moving.value()-((double)hours * 3600.0)) / 60.0, ((uint32_t) moving.value()) % 60,0); }
@@ -83,15 +93,33 @@ void* bluetoothdevice::VirtualDevice() { return nullptr; }
 bool bluetoothdevice::changeFanSpeed(uint8_t speed) { Q_UNUSED(speed); return false; }
 bool bluetoothdevice::connected() { return false; }
 double bluetoothdevice::elevationGain(){ return elevationAcc; }
-void bluetoothdevice::heartRate(uint8_t heart) { Heart.setValue(heart); }
+void bluetoothdevice::heartRate(uint8_t heart)
+{
+    sensors.publish(sensorbus::HEART, sensorbus::EXTERNAL, heart);
+    // the zone controller follows the samples of the belt, not the polls of the device
+    heartZoneSample(heart);
+}
+
+void bluetoothdevice::rrInterval(double rr)
+{
+    if(paused || !hrv.addBeat(rr))
+        return;
+    RMSSD = hrv.rmssd();
+    SDNN = hrv.sdnn();
+    const double alpha1 = hrv.dfaAlpha1();
+    if(alpha1 > 0)
+        DFAAlpha1 = alpha1;
+}
 void bluetoothdevice::disconnectBluetooth() {if(m_control) m_control->disconnectFromDevice();}
 metric bluetoothdevice::wattsMetric() {return m_watt;}
 void bluetoothdevice::setDifficult(double d) {m_difficult = d;}
 double bluetoothdevice::difficult() {return m_difficult;}
 void bluetoothdevice::cadenceSensor(uint8_t cadence) { Q_UNUSED(cadence) }
+void bluetoothdevice::powerSensor(uint16_t power) { Q_UNUSED(power) }
 
 void bluetoothdevice::update_metrics(const bool watt_calc, const double watts)
 {
+    TRACE_SPAN("update_metrics");
     QDateTime current = QDateTime::currentDateTime();
     double deltaTime = (((double)_lastTimeUpdate.msecsTo(current)) / ((double)1000.0));
     QSettings settings;
@@ -121,6 +149,110 @@ void bluetoothdevice::update_metrics(const bool watt_calc, const double watts)
 
     _lastTimeUpdate = current;
     _firstUpdate = false;
+    // the device drives the activity, so the polls adapt without the GUI too (headless, -no-gui)
+    pollscheduler::instance()->setActivity((!paused && (currentSpeed().value() > 0 || m_watt.value() > 0)) ? pollscheduler::RIDING : pollscheduler::PAUSED);
+    fuseSensors();
+    updateHeartZone();
+    publishSample();
+}
+
+void bluetoothdevice::updateHeartZone()
+{
+    if(requestHeartZoneTarget != -1)
+    {
+        const double target = requestHeartZoneTarget;
+        requestHeartZoneTarget = -1;
+        if(target > 0 && !heartZone.enabled())
+            heartZone.reset(heartZoneOutput());
+        if(target != heartZone.target())
+            qDebug() << "heart zone target" << target;
+        heartZone.setTarget(target);
+        heartZone.setMaximum(requestHeartZoneMaximum);
+    }
+
+    // without a belt the heart rate (machine, ANT+, watch) comes with the update of the device
+    if(!sensors.active(sensorbus::HEART, sensorbus::EXTERNAL))
+        heartZoneSample(Heart.value());
+}
+
+void bluetoothdevice::heartZoneSample(double heart)
+{
+    if(!heartZone.enabled() || paused || heart <= 0)
+        return;
+    if(heartZone.addSample(heart, QDateTime::currentMSecsSinceEpoch()))
+    {
+        qDebug() << "heart zone output" << heartZone.output() << "model gain" << heartZone.gain() << "tau" << heartZone.tau();
+        changeHeartZoneOutput(heartZone.output());
+    }
+}
+
+void bluetoothdevice::fuseSensors()
+{
+    double heart;
+    if(sensors.fuse(sensorbus::HEART, &heart))
+        Heart = heart;
+}
+
+void bluetoothdevice::publishSample()
+{
+    bluetoothdevicesample s;
+    memset(&s, 0, sizeof(s));
+    fillSample(&s);
+    measureActuation(s);
+    for(int c = 0; c < actuationmodel::CHANNELS; c++)
+        s.actuationLatency[c] = actuation.latency((actuationmodel::CHANNEL)c).value();
+    s.timestamp = QDateTime::currentMSecsSinceEpoch();
+    m_sample.write(s);
+    emit samplePublished(s.timestamp);
+}
+
+void bluetoothdevice::measureActuation(const bluetoothdevicesample& s)
+{
+    actuation.measure(actuationmodel::SPEED, s.speed.value);
+    switch(s.type)
+    {
+    case TREADMILL:
+        actuation.measure(actuationmodel::INCLINATION, s.treadmill.inclination.value);
+        break;
+    case BIKE:
+    case ROWING:
+        actuation.measure(actuationmodel::RESISTANCE, s.bike.resistance.value);
+        break;
+    case ELLIPTICAL:
+        actuation.measure(actuationmodel::INCLINATION, s.elliptical.inclination.value);
+        actuation.measure(actuationmodel::RESISTANCE, s.elliptical.resistance);
+        break;
+    default:
+        break;
+    }
+}
+
+void bluetoothdevice::fillSample(bluetoothdevicesample* s)
+{
+    s->type = deviceType();
+    s->connected = connected();
+    s->rssi = bluetoothDevice.rssi();
+    s->paused = paused;
+    s->speed = sampleOf(currentSpeed());
+    s->heart = sampleOf(currentHeart());
+    s->watt = sampleOf(m_watt);
+    s->odometer = odometer();
+    s->calories = calories();
+    s->jouls = m_jouls.value();
+    s->weightLoss = WeightLoss.value();
+    s->elevationGain = elevationGain();
+    s->difficult = m_difficult;
+    s->elapsed = seconds(elapsedTime());
+    s->moving = seconds(movingTime());
+    s->lapElapsed = seconds(lapElapsedTime());
+    s->pace = seconds(currentPace());
+    s->averagePace = seconds(averagePace());
+    s->maxPace = seconds(maxPace());
+    s->fanSpeed = fanSpeed();
+    s->rmssd = RMSSD.value();
+    s->sdnn = SDNN.value();
+    s->dfaAlpha1 = DFAAlpha1.value();
+    s->hrvZone = hrv.thresholdZone();
 }
 
 void bluetoothdevice::clearStats()
@@ -135,6 +267,51 @@ void bluetoothdevice::clearStats()
     elevationAcc = 0;
     m_watt.clear(false);
     WeightLoss.clear(false);
+    RMSSD.clear(false);
+    SDNN.clear(false);
+    DFAAlpha1.clear(false);
+    hrv.clear();
+
+    // the consumers read the snapshot, not the metrics
+    publishSample();
+}
+
+void bluetoothdevice::resume(const QList<SessionLine>& session, uint32_t movingSeconds, double joulsTotal)
+{
+    if(session.isEmpty())
+        return;
+
+    // the averages are rebuilt from the 1 Hz lines of the session
+    double speed[3] = {0, 0, 0};
+    double heart[3] = {0, 0, 0};
+    double watt[3] = {0, 0, 0};
+    foreach(SessionLine s, session)
+    {
+        const double values[3] = {s.speed, (double)s.heart, (double)s.watt};
+        double* stats[3] = {speed, heart, watt};
+        for(uint8_t i = 0; i < 3; i++)
+        {
+            if(values[i] == 0)
+                continue;
+            stats[i][0] += values[i];
+            stats[i][1]++;
+            if(values[i] > stats[i][2])
+                stats[i][2] = values[i];
+        }
+    }
+    const SessionLine& last = session.last();
+    elapsed.resume(last.elapsedTime, 0, 0, 0);
+    moving.resume(movingSeconds, 0, 0, 0);
+    Distance.resume(last.distance, 0, 0, 0);
+    KCal.resume(last.calories, 0, 0, 0);
+    m_jouls.resume(joulsTotal, 0, 0, 0);
+    elevationAcc = last.elevationGain;
+    // one line per second: the count of the non zero lines is their time
+    Speed.resume(0, speed[1] ? speed[0] / speed[1] : 0, speed[1], speed[2]);
+    Heart.resume(0, heart[1] ? heart[0] / heart[1] : 0, heart[1], heart[2]);
+    m_watt.resume(0, watt[1] ? watt[0] / watt[1] : 0, watt[1], watt[2]);
+    qDebug() << "resumed session of" << session.length() << "lines";
+    publishSample();
 }
 
 void bluetoothdevice::setPaused(bool p)
@@ -149,6 +326,9 @@ void bluetoothdevice::setPaused(bool p)
     m_jouls.setPaused(p);
     m_watt.setPaused(p);
     WeightLoss.setPaused(p);
+    RMSSD.setPaused(p);
+    SDNN.setPaused(p);
+    DFAAlpha1.setPaused(p);
 }
 
 void bluetoothdevice::setLap()
@@ -162,6 +342,9 @@ void bluetoothdevice::setLap()
     m_jouls.setLap(true);
     m_watt.setLap(false);
     WeightLoss.setLap(false);
+    RMSSD.setLap(false);
+    SDNN.setLap(false);
+    DFAAlpha1.setLap(false);
 }
 
 QStringList bluetoothdevice::metrics()
@@ -192,6 +375,7 @@ QStringList bluetoothdevice::metrics()
     r.append("Target Peloton Resistance");
     r.append("Target Cadence");
     r.append("Target Power");
+    r.append("HRV");
     return r;
 }
 
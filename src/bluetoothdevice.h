@@ -15,6 +15,15 @@
 #include <QtBluetooth/qlowenergyservicedata.h>
 #include <QBluetoothDeviceDiscoveryAgent>
 #include "metric.h"
+#include "seqlock.h"
+#include "sensorbus.h"
+#include "hrvanalyzer.h"
+#include "hrzonecontroller.h"
+#include "pollscheduler.h"
+#include "sessionline.h"
+#include "tracing.h"
+#include "actuationmodel.h"
+#include "commandarbiter.h"
 
 #if defined(Q_OS_IOS)
 #define SAME_BLUETOOTH_DEVICE(d1, d2) (d1.deviceUuid() == d2.deviceUuid())
@@ -22,6 +31,72 @@
 #define SAME_BLUETOOTH_DEVICE(d1, d2) (d1.address() == d2.address())
 #endif
 
+typedef struct metricsample
+{
+    double value;
+    double average;
+    double max;
+}metricsample;
+
+// immutable snapshot of the device, published by the device thread at every metric update.
+// The consumers (UI, web templates, virtual devices) read this copy instead of calling the
+// virtual getters one by one, and they can do it from any thread
+typedef struct bluetoothdevicesample
+{
+    uint8_t type; // bluetoothdevice::BLUETOOTH_TYPE
+    bool connected;
+    int16_t rssi; // dBm
+    bool paused;
+    metricsample speed;
+    metricsample heart;
+    metricsample watt;
+    double odometer;
+    double calories;
+    double jouls;
+    double weightLoss;
+    double elevationGain;
+    double difficult;
+    uint32_t elapsed; // seconds
+    uint32_t moving; // seconds
+    uint32_t lapElapsed; // seconds
+    uint32_t pace; // seconds per km
+    uint32_t averagePace;
+    uint32_t maxPace;
+    uint8_t fanSpeed;
+    double rmssd; // ms
+    double sdnn; // ms
+    double dfaAlpha1;
+    uint8_t hrvZone; // hrvanalyzer::thresholdZone
+    double actuationLatency[actuationmodel::CHANNELS]; // ms of the last step response, 0 until measured
+    union
+    {
+        struct
+        {
+            metricsample cadence;
+            metricsample resistance;
+            metricsample pelotonResistance;
+            double requestedResistance;
+            double requestedPelotonResistance;
+            double requestedCadence;
+            double requestedPower;
+            double crankRevolutions;
+            uint16_t lastCrankEventTime;
+        }bike; // BIKE and ROWING
+        struct
+        {
+            metricsample inclination;
+        }treadmill;
+        struct
+        {
+            metricsample inclination;
+            uint8_t cadence;
+            int8_t resistance;
+            double requestedResistance;
+        }elliptical;
+    };
+    qint64 timestamp; // msecs since epoch of the update
+}bluetoothdevicesample;
+
 class bluetoothdevice : public QObject
 {
     Q_OBJECT
@@ -47,6 +122,8 @@ public:
     virtual bool changeFanSpeed(uint8_t speed);
     virtual double elevationGain();
     virtual void clearStats();
+    // continues the interrupted session of the journal after clearStats
+    void resume(const QList<SessionLine>& session, uint32_t movingSeconds, double joulsTotal);
     QBluetoothDeviceInfo bluetoothDevice;
     void disconnectBluetooth();
     virtual void setPaused(bool p);
@@ -57,6 +134,16 @@ public:
     void setDifficult(double d);
     double difficult();
     double weightLoss() {return WeightLoss.value();}
+    metric currentRMSSD() {return RMSSD;}
+    metric currentSDNN() {return SDNN;}
+    metric currentDFAAlpha1() {return DFAAlpha1;}
+    // heart rate the device keeps driving its own output (0 disables), maximum of the output (0 device limit)
+    void setHeartZoneTarget(double bpm, double maximum = 0) {requestHeartZoneTarget = bpm; requestHeartZoneMaximum = maximum;}
+    // response of the machine to the requested targets, read by the train program on the thread of the device
+    actuationmodel* actuationModel() {return &actuation;}
+    metric actuationLatency(actuationmodel::CHANNEL c) {return actuation.latency(c);}
+    // the requests of every source go through it, the driver gets only the effective targets
+    commandarbiter* commands() {return &arbiter;}
 
     enum BLUETOOTH_TYPE {
         UNKNOWN = 0,
@@ -69,17 +156,27 @@ public:
     virtual BLUETOOTH_TYPE deviceType();
     static QStringList metrics();
     virtual uint8_t metrics_override_heartrate();
+    // sequence changes every time a new sample is published
+    bluetoothdevicesample lastSample(uint32_t* sequence = 0) {return m_sample.read(sequence);}
 
 public slots:
     virtual void start();
     virtual void stop();
     virtual void heartRate(uint8_t heart);
+    void rrInterval(double rr);
     virtual void cadenceSensor(uint8_t cadence);
+    virtual void powerSensor(uint16_t power);
 
 signals:
     void connectedAndDiscovered();
+    // a new sample is available in lastSample(), timestamp is the one of the sample
+    void samplePublished(qint64 timestamp);
     void cadenceChanged(uint8_t cadence);
 
+protected slots:
+    // a new snapshot for the consumers, at every update and when the device is cleared or disconnected
+    void publishSample();
+
 protected:
     QLowEnergyController* m_control = 0;
 
@@ -99,6 +196,15 @@ protected:
     double elevationAcc = 0;
     metric m_watt;
     metric WeightLoss;
+    metric RMSSD;
+    metric SDNN;
+    metric DFAAlpha1;
+    hrvanalyzer hrv;
+    hrzonecontroller heartZone;
+    actuationmodel actuation;
+    commandarbiter arbiter;
+    double requestHeartZoneTarget = -1;
+    double requestHeartZoneMaximum = 0;
 
     bool paused = false;
     bool autoResistanceEnable = true;
@@ -106,6 +212,26 @@ protected:
     QDateTime _lastTimeUpdate;
     bool _firstUpdate = true;
     void update_metrics(const bool watt_calc, const double watts);
+    virtual void fillSample(bluetoothdevicesample* s);
+    // the values of the sample close the steps requested to the machine
+    void measureActuation(const bluetoothdevicesample& s);
+    static metricsample sampleOf(metric m) {metricsample s; s.value = m.value(); s.average = m.average(); s.max = m.max(); return s;}
+    static uint32_t seconds(const QTime& t) {return t.hour() * 3600 + t.minute() * 60 + t.second();}
+
+    sensorbus sensors;
+    virtual void fuseSensors();
+    // applies the target requested by the UI, at every update of the device
+    void updateHeartZone();
+    // runs the zone controller on a new heart rate sample
+    void heartZoneSample(double heart);
+    // the output driven by the heart rate zone controller, none for the base device
+    virtual double heartZoneOutput() {return 0;}
+    virtual void changeHeartZoneOutput(double value) {Q_UNUSED(value)}
+    // the target of the channel the arbiter let through, none for the base device
+    virtual void applyCommand(actuationmodel::CHANNEL c, double value) {Q_UNUSED(c) Q_UNUSED(value)}
+
+private:
+    seqlock<bluetoothdevicesample> m_sample;
 };
 
 #endif // BLUETOOTHDEVICE_H
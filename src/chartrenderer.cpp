@@ -0,0 +1,364 @@
+#include "chartrenderer.h"
+#include "meanmaxcurve.h"
+#include "metric.h"
+#include <QPainter>
+#include <QRunnable>
+#include <QSettings>
+#include <QThread>
+#include <QThreadPool>
+#include <QDebug>
+#include <math.h>
+
+static const int marginLeft = 60;
+static const int marginRight = 20;
+static const int marginTop = 40;
+static const int marginBottom = 40;
+static const int jpegQuality = 85;
+
+chartrenderer::chartrenderer(const QList<SessionLine>& session)
+{
+    QSettings settings;
+    m_ftp = settings.value("ftp", 200.0).toDouble();
+    m_miles = settings.value("miles_unit", false).toBool();
+    metric::heartRateZones(m_heartZones);
+
+    // plain columns shared read only by the threads
+    const double speedConversion = m_miles ? 0.621371 : 1.0;
+    m_power.reserve(session.length());
+    m_heart.reserve(session.length());
+    m_speed.reserve(session.length());
+    m_cadence.reserve(session.length());
+    for(const SessionLine& s : session)
+    {
+        m_power.append(s.watt);
+        m_heart.append(s.heart);
+        m_speed.append(s.speed * speedConversion);
+        m_cadence.append(s.cadence);
+    }
+}
+
+QString chartrenderer::name(CHART chart)
+{
+    switch(chart)
+    {
+    case POWER: return "powerChart";
+    case HEART: return "heartChart";
+    case SPEED: return "speedChart";
+    case CADENCE: return "cadenceChart";
+    case ZONES: return "zonesChart";
+    case CURVES: return "curvesChart";
+    default: return "";
+    }
+}
+
+bool chartrenderer::empty(CHART chart) const
+{
+    const QVector<double>* v = 0;
+    switch(chart)
+    {
+    case POWER: v = &m_power; break;
+    case HEART: case ZONES: v = &m_heart; break;
+    case CURVES: return empty(POWER) && empty(SPEED) && empty(HEART);
+    case SPEED: v = &m_speed; break;
+    case CADENCE: v = &m_cadence; break;
+    default: return true;
+    }
+    for(double d : *v)
+        if(d > 0)
+            return false;
+    return true;
+}
+
+QImage chartrenderer::image(CHART chart, int width, int height) const
+{
+    switch(chart)
+    {
+    case POWER:
+    {
+        // same colors of the power chart of the app
+        QList<band> bands;
+        bands.append({0, QColor("white")});
+        bands.append({m_ftp * 0.55, QColor("limegreen")});
+        bands.append({m_ftp * 0.75, QColor("gold")});
+        bands.append({m_ftp * 0.90, QColor("orange")});
+        bands.append({m_ftp * 1.05, QColor("darkorange")});
+        bands.append({m_ftp * 1.20, QColor("orangered")});
+        bands.append({m_ftp * 1.50, QColor("red")});
+        return series(m_power, "Power", "W", QColor("black"), bands, width, height);
+    }
+    case HEART:
+    {
+        QList<band> bands;
+        bands.append({0, QColor("lightsteelblue")});
+        bands.append({m_heartZones[0], QColor("green")});
+        bands.append({m_heartZones[1], QColor("yellow")});
+        bands.append({m_heartZones[2], QColor("orange")});
+        bands.append({m_heartZones[3], QColor("red")});
+        return series(m_heart, "Heart Rate", "bpm", QColor("black"), bands, width, height);
+    }
+    case SPEED:
+        return series(m_speed, "Speed", m_miles ? "mi/h" : "km/h", QColor("steelblue"), QList<band>(), width, height);
+    case CADENCE:
+        return series(m_cadence, "Cadence", "rpm", QColor("darkgreen"), QList<band>(), width, height);
+    case ZONES:
+        return zones(width, height);
+    case CURVES:
+        return curves(width, height);
+    default:
+        return QImage();
+    }
+}
+
+QImage chartrenderer::series(const QVector<double>& values, const QString& title, const QString& unit, const QColor& color,
+                             const QList<band>& bands, int width, int height) const
+{
+    QImage img(width, height, QImage::Format_RGB32);
+    img.fill(Qt::white);
+    QPainter p(&img);
+    p.setRenderHint(QPainter::Antialiasing);
+
+    const QRect plot(marginLeft, marginTop, width - marginLeft - marginRight, height - marginTop - marginBottom);
+    const int n = values.length();
+    const int columns = plot.width();
+
+    // min and max of every pixel column
+    QVector<double> low(columns, 0);
+    QVector<double> high(columns, 0);
+    double top = 0;
+    for(int c = 0; c < columns && n; c++)
+    {
+        const int from = (int)((qint64)c * n / columns);
+        const int to = qMax(from + 1, (int)((qint64)(c + 1) * n / columns));
+        double mn = values.at(from);
+        double mx = mn;
+        for(int i = from + 1; i < to && i < n; i++)
+        {
+            const double v = values.at(i);
+            if(v < mn) mn = v;
+            if(v > mx) mx = v;
+        }
+        low[c] = mn;
+        high[c] = mx;
+        if(mx > top)
+            top = mx;
+    }
+    if(!bands.isEmpty() && bands.last().from * 1.1 > top)
+        top = bands.last().from * 1.1;
+    if(top <= 0)
+        top = 1;
+    // round the scale to a nice step
+    const double step = pow(10, floor(log10(top / 5)));
+    const double tick = (top / step > 25) ? step * 10 : (top / step > 10) ? step * 5 : step * 2;
+    top = ceil(top / tick) * tick;
+
+    auto y = [&](double v) { return plot.bottom() - v * plot.height() / top; };
+
+    for(int i = 0; i < bands.length(); i++)
+    {
+        const double upper = i + 1 < bands.length() ? bands.at(i + 1).from : top;
+        if(upper <= bands.at(i).from)
+            continue;
+        QColor c = bands.at(i).color;
+        c.setAlpha(110);
+        p.fillRect(QRectF(plot.left(), y(qMin(upper, top)), plot.width(), y(bands.at(i).from) - y(qMin(upper, top))), c);
+    }
+
+    // axes
+    p.setPen(QPen(QColor(0xd1, 0x89, 0x52), 2));
+    p.drawLine(plot.bottomLeft(), plot.bottomRight());
+    p.drawLine(plot.bottomLeft(), plot.topLeft());
+    p.setPen(QColor("gray"));
+    for(double v = tick; v <= top; v += tick)
+    {
+        p.drawLine(QPointF(plot.left(), y(v)), QPointF(plot.right(), y(v)));
+        p.drawText(QRectF(0, y(v) - 10, marginLeft - 6, 20), Qt::AlignRight | Qt::AlignVCenter, QString::number(v));
+    }
+    const int minutes = n / 60;
+    const int minuteTick = minutes > 120 ? 30 : minutes > 60 ? 15 : minutes > 20 ? 5 : 1;
+    for(int m = minuteTick; m <= minutes && n; m += minuteTick)
+    {
+        const double x = plot.left() + (double)m * 60 * plot.width() / n;
+        p.drawText(QRectF(x - 30, plot.bottom() + 4, 60, 20), Qt::AlignHCenter | Qt::AlignTop, QString::number(m) + "'");
+    }
+
+    // the polyline through the min and the max of every column draws the envelope of the series
+    QPolygonF line;
+    line.reserve(columns * 2);
+    for(int c = 0; c < columns && n; c++)
+    {
+        line.append(QPointF(plot.left() + c, y(low.at(c))));
+        if(high.at(c) != low.at(c))
+            line.append(QPointF(plot.left() + c, y(high.at(c))));
+    }
+    p.setPen(QPen(color, 1.5));
+    p.drawPolyline(line);
+
+    QFont f = p.font();
+    f.setBold(true);
+    f.setPointSize(14);
+    p.setFont(f);
+    p.setPen(Qt::black);
+    p.drawText(QRect(0, 0, width, marginTop), Qt::AlignCenter, title + " (" + unit + ")");
+    return img;
+}
+
+QImage chartrenderer::zones(int width, int height) const
+{
+    double seconds[5] = {0, 0, 0, 0, 0};
+    double total = 0;
+    for(double h : m_heart)
+    {
+        if(h <= 0)
+            continue;
+        uint8_t zone = 0;
+        while(zone < 4 && h >= m_heartZones[zone])
+            zone++;
+        seconds[zone]++;
+        total++;
+    }
+
+    QImage img(width, height, QImage::Format_RGB32);
+    img.fill(Qt::white);
+    QPainter p(&img);
+    p.setRenderHint(QPainter::Antialiasing);
+
+    const QColor colors[5] = {QColor("lightsteelblue"), QColor("green"), QColor("yellow"), QColor("orange"), QColor("red")};
+    const QRect plot(marginLeft, marginTop, width - marginLeft - marginRight, height - marginTop - marginBottom);
+    const double row = plot.height() / 5.0;
+    for(int z = 0; z < 5; z++)
+    {
+        const double share = total ? seconds[z] / total : 0;
+        const QRectF bar(plot.left(), plot.top() + row * (4 - z) + row * 0.15, plot.width() * 0.8 * share, row * 0.7);
+        p.fillRect(bar, colors[z]);
+        p.setPen(Qt::black);
+        p.drawText(QRectF(0, bar.top(), marginLeft - 6, bar.height()), Qt::AlignRight | Qt::AlignVCenter, "Z" + QString::number(z + 1));
+        p.drawText(QRectF(bar.right() + 6, bar.top(), width - bar.right() - 6, bar.height()), Qt::AlignLeft | Qt::AlignVCenter,
+                   QString::number(qRound(seconds[z] / 60)) + "' " + QString::number(share * 100, 'f', 0) + "%");
+    }
+
+    QFont f = p.font();
+    f.setBold(true);
+    f.setPointSize(14);
+    p.setFont(f);
+    p.drawText(QRect(0, 0, width, marginTop), Qt::AlignCenter, "Heart Rate Zones");
+    return img;
+}
+
+QImage chartrenderer::curves(int width, int height) const
+{
+    // power on the left scale (speed without a power meter), heart rate on the right one
+    const bool power = !empty(POWER);
+    const QList<uint32_t> durations = meanmaxcurve::defaultDurations();
+    const QList<double> left = meanmaxcurve::fromSamples(power ? m_power : m_speed, durations);
+    const QList<double> right = meanmaxcurve::fromSamples(m_heart, durations);
+    const int n = m_heart.length();
+
+    QImage img(width, height, QImage::Format_RGB32);
+    img.fill(Qt::white);
+    QPainter p(&img);
+    p.setRenderHint(QPainter::Antialiasing);
+
+    const QRect plot(marginLeft, marginTop, width - 2 * marginLeft, height - marginTop - marginBottom);
+    int last = 0;
+    while(last + 1 < durations.length() && durations.at(last + 1) <= (uint32_t)n)
+        last++;
+    const double span = log((double)durations.at(last) / durations.first());
+    auto x = [&](uint32_t d) { return plot.left() + (span > 0 ? log((double)d / durations.first()) * plot.width() / span : 0); };
+
+    double topLeft = 1;
+    double topRight = 1;
+    for(int i = 0; i <= last; i++)
+    {
+        topLeft = qMax(topLeft, left.at(i));
+        topRight = qMax(topRight, right.at(i));
+    }
+    topLeft = ceil(topLeft * 1.1);
+    topRight = ceil(topRight * 1.1);
+
+    p.setPen(QPen(QColor(0xd1, 0x89, 0x52), 2));
+    p.drawLine(plot.bottomLeft(), plot.bottomRight());
+    p.drawLine(plot.bottomLeft(), plot.topLeft());
+    p.drawLine(plot.bottomRight(), plot.topRight());
+    p.setPen(QColor("gray"));
+    for(int t = 1; t <= 4; t++)
+    {
+        const double yy = plot.bottom() - t * plot.height() / 4.0;
+        p.drawLine(QPointF(plot.left(), yy), QPointF(plot.right(), yy));
+        p.drawText(QRectF(0, yy - 10, marginLeft - 6, 20), Qt::AlignRight | Qt::AlignVCenter, QString::number(topLeft * t / 4, 'f', 0));
+        p.drawText(QRectF(plot.right() + 6, yy - 10, marginLeft - 6, 20), Qt::AlignLeft | Qt::AlignVCenter, QString::number(topRight * t / 4, 'f', 0));
+    }
+    for(int i = 0; i <= last; i++)
+    {
+        const uint32_t d = durations.at(i);
+        if(d != 1 && d != 5 && d != 30 && d != 60 && d != 300 && d != 1200 && d != 3600 && d != 10800)
+            continue;
+        p.drawText(QRectF(x(d) - 30, plot.bottom() + 4, 60, 20), Qt::AlignHCenter | Qt::AlignTop,
+                   d < 60 ? QString::number(d) + "\"" : QString::number(d / 60) + "'");
+    }
+
+    QPolygonF leftLine;
+    QPolygonF rightLine;
+    for(int i = 0; i <= last; i++)
+    {
+        if(left.at(i) > 0)
+            leftLine.append(QPointF(x(durations.at(i)), plot.bottom() - left.at(i) * plot.height() / topLeft));
+        if(right.at(i) > 0)
+            rightLine.append(QPointF(x(durations.at(i)), plot.bottom() - right.at(i) * plot.height() / topRight));
+    }
+    p.setPen(QPen(power ? QColor("black") : QColor("steelblue"), 2));
+    p.drawPolyline(leftLine);
+    p.setPen(QPen(QColor("red"), 2));
+    p.drawPolyline(rightLine);
+
+    QFont f = p.font();
+    f.setBold(true);
+    f.setPointSize(14);
+    p.setFont(f);
+    p.setPen(Qt::black);
+    p.drawText(QRect(0, 0, width, marginTop), Qt::AlignCenter,
+               QString("Best ") + (power ? "Power (W)" : (m_miles ? "Speed (mi/h)" : "Speed (km/h)")) + " / Heart Rate (bpm)");
+    return img;
+}
+
+class chartrenderertask : public QRunnable
+{
+public:
+    chartrenderertask(const chartrenderer* renderer, chartrenderer::CHART chart, int width, int height, const QString& filename, bool* ok) :
+        renderer(renderer), chart(chart), width(width), height(height), filename(filename), ok(ok) {}
+    void run() override
+    {
+        *ok = renderer->image(chart, width, height).save(filename, "JPG", jpegQuality);
+    }
+
+private:
+    const chartrenderer* renderer;
+    chartrenderer::CHART chart;
+    int width;
+    int height;
+    QString filename;
+    bool* ok;
+};
+
+QStringList chartrenderer::render(const QString& prefix, int width, int height) const
+{
+    QStringList filenames;
+    QStringList written;
+    bool ok[CHART_COUNT] = {false};
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    for(int c = 0; c < CHART_COUNT; c++)
+    {
+        filenames.append(prefix + name((CHART)c) + ".jpg");
+        if(!empty((CHART)c))
+            pool.start(new chartrenderertask(this, (CHART)c, width, height, filenames.last(), &ok[c]));
+    }
+    pool.waitForDone();
+    for(int c = 0; c < CHART_COUNT; c++)
+    {
+        if(ok[c])
+            written.append(filenames.at(c));
+        else if(!empty((CHART)c))
+            qDebug() << "chartrenderer: unable to save" << filenames.at(c);
+    }
+    return written;
+}
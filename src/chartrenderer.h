@@ -0,0 +1,62 @@
+#ifndef CHARTRENDERER_H
+#define CHARTRENDERER_H
+
+#include <QColor>
+#include <QImage>
+#include <QList>
+#include <QStringList>
+#include <QVector>
+#include "sessionline.h"
+
+// offscreen charts of a session for the workout report.
+// The charts are drawn with QPainter on QImages straight from the session lines, one chart per
+// thread of a pool, so they don't need the charts page on screen. Each series is reduced to the
+// min and the max of every pixel column before drawing: the cost of a chart depends on its width
+// and not on the length of the session, and the peaks are kept.
+class chartrenderer
+{
+public:
+    enum CHART
+    {
+        POWER = 0,
+        HEART,
+        SPEED,
+        CADENCE,
+        ZONES,
+        CURVES, // best efforts: the mean-maximal curves of power (or speed) and heart rate
+        CHART_COUNT,
+    };
+
+    // reads the settings (ftp, heart zones, units), call it from the main thread
+    chartrenderer(const QList<SessionLine>& session);
+
+    QImage image(CHART chart, int width, int height) const;
+    // renders all the charts with data in parallel and saves them as jpeg files named
+    // prefix + chart name + ".jpg", returns the files written
+    QStringList render(const QString& prefix, int width = 1200, int height = 500) const;
+
+    static QString name(CHART chart);
+
+private:
+    typedef struct band
+    {
+        double from;
+        QColor color;
+    }band;
+
+    QImage series(const QVector<double>& values, const QString& title, const QString& unit, const QColor& color,
+                  const QList<band>& bands, int width, int height) const;
+    QImage zones(int width, int height) const;
+    QImage curves(int width, int height) const;
+    bool empty(CHART chart) const;
+
+    QVector<double> m_power;
+    QVector<double> m_heart;
+    QVector<double> m_speed;
+    QVector<double> m_cadence;
+    double m_ftp;
+    double m_heartZones[4]; // bpm, lower bound of the zones 2..5
+    bool m_miles;
+};
+
+#endif // CHARTRENDERER_H
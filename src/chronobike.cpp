@@ -21,7 +21,7 @@ chronobike::chronobike(bool noWriteResistance, bool noHeartService)
     //initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
     connect(t_timeout, SIGNAL(timeout()), this, SLOT(connection_timeout()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 /*void chronobike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
@@ -84,7 +84,7 @@ void chronobike::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -127,10 +127,10 @@ void chronobike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void chronobike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("chronobike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -140,12 +140,11 @@ void chronobike::characteristicChanged(const QLowEnergyCharacteristic &character
         return;
 
     m_watt = (uint16_t)((uint8_t)newValue.at(17)) + ((uint16_t)((uint8_t)newValue.at(18)) << 8);
-    if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-        Cadence = ((uint8_t)newValue.at(8)) / 2;
+    sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, ((uint8_t)newValue.at(8)) / 2);
     if(!settings.value("speed_power_based", false).toBool())
         Speed = ((double)((uint16_t)((uint8_t)newValue.at(6)) + ((uint16_t)((uint8_t)newValue.at(7)) << 8))) / 100.0;
     else
-        Speed = metric::calculateSpeedFromPower(m_watt.value());
+        Speed = physics.speed(m_watt.value());
     KCal += ((( (0.048 * ((double)watts()) + 1.19) * settings.value("weight", 75.0).toFloat() * 3.5) / 200.0 ) / (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())))); //(( (0.048* Output in watts +1.19) * body weight in kg * 3.5) / 200 ) / 60
     Distance += ((Speed.value() / 3600000.0) * ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())) );
 
@@ -171,23 +170,21 @@ void chronobike::characteristicChanged(const QLowEnergyCharacteristic &character
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
-        {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-            lockscreen h;
-            long appleWatchHeartRate = h.heartRate();
-            h.setKcal(KCal.value());
-            h.setDistance(Distance.value());
-            Heart = appleWatchHeartRate;
-            debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
+        lockscreen h;
+        long appleWatchHeartRate = h.heartRate();
+        h.setKcal(KCal.value());
+        h.setDistance(Distance.value());
+        if(appleWatchHeartRate > 0)
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
+        debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-        }
     }
 
 #ifdef Q_OS_IOS
@@ -0,0 +1,172 @@
+#include "commandarbiter.h"
+#include "tracing.h"
+#include <QDateTime>
+#include <QThread>
+#include <QDebug>
+#include <string.h>
+
+static const qint64 window = 500; // ms, at most one write per channel in it
+// ms the source keeps the channel after its last request, against the sources with a lower priority
+static const qint64 hold[commandarbiter::SOURCES] = {0, 5000, 5000, 10000, 10000};
+// one trace series per channel, the tracing keeps the pointers so they are literals
+static const char* channelName[actuationmodel::CHANNELS] = {"speed", "inclination", "resistance"};
+static const char* droppedCounter[actuationmodel::CHANNELS] = {"commands_dropped_speed", "commands_dropped_inclination", "commands_dropped_resistance"};
+static const char* mergedCounter[actuationmodel::CHANNELS] = {"commands_merged_speed", "commands_merged_inclination", "commands_merged_resistance"};
+
+commandarbiter::commandarbiter(QObject* parent) : QObject(parent)
+{
+    memset(m_channels, 0, sizeof(m_channels));
+    // moves with the arbiter to the thread of the device
+    m_timer.setParent(this);
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+QString commandarbiter::sourceName(SOURCE source)
+{
+    switch(source)
+    {
+    case VIRTUAL:
+        return "virtual";
+    case HEARTZONE:
+        return "heart zone";
+    case PROGRAM:
+        return "program";
+    case TEMPLATE:
+        return "template";
+    case USER:
+        return "user";
+    default:
+        return "unknown";
+    }
+}
+
+void commandarbiter::submit(actuationmodel::CHANNEL c, double value, SOURCE source)
+{
+    // the timer and the state belong to the device thread
+    if(QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, [this, c, value, source]() {submit(c, value, source);}, Qt::QueuedConnection);
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    channel& ch = m_channels[c];
+
+    if(ch.owner > source && now - ch.owned < hold[ch.owner])
+    {
+        // only the request with the highest priority waits for the end of the hold
+        if(ch.deferred && ch.deferredSource > source)
+        {
+            ch.dropped++;
+            TRACE_COUNTER(droppedCounter[c], ch.dropped);
+            return;
+        }
+        if(ch.deferred)
+        {
+            ch.dropped++;
+            TRACE_COUNTER(droppedCounter[c], ch.dropped);
+        }
+        ch.deferred = true;
+        ch.deferredValue = value;
+        ch.deferredSource = source;
+        qDebug() << "commandarbiter: channel" << c << "request" << value << "of" << sourceName(source) << "held back, owned by" <<
+                    sourceName(ch.owner);
+        schedule(now);
+        return;
+    }
+    if(ch.deferred && ch.deferredSource <= source)
+    {
+        // superseded by a request with the same or a higher priority
+        ch.deferred = false;
+        ch.dropped++;
+        TRACE_COUNTER(droppedCounter[c], ch.dropped);
+    }
+    ch.owner = source;
+    ch.owned = now;
+
+    if(ch.pending)
+    {
+        ch.merged++;
+        TRACE_COUNTER(mergedCounter[c], ch.merged);
+        qDebug() << "commandarbiter: channel" << c << "request" << value << "of" << sourceName(source) << "supersedes" << ch.value;
+    }
+    else if(ch.sent && value == ch.last && now - ch.written < window)
+    {
+        ch.merged++;
+        TRACE_COUNTER(mergedCounter[c], ch.merged);
+        return;
+    }
+    ch.pending = true;
+    ch.value = value;
+
+    if(now - ch.written >= window)
+        write(c, now);
+    schedule(now);
+}
+
+void commandarbiter::write(actuationmodel::CHANNEL c, qint64 now)
+{
+    channel& ch = m_channels[c];
+    ch.pending = false;
+    ch.last = ch.value;
+    ch.written = now;
+    ch.sent++;
+    emit command(c, ch.value);
+}
+
+void commandarbiter::schedule(qint64 now)
+{
+    qint64 next = -1;
+    for(int c = 0; c < actuationmodel::CHANNELS; c++)
+    {
+        const channel& ch = m_channels[c];
+        if(ch.pending)
+        {
+            const qint64 left = window - (now - ch.written);
+            if(next < 0 || left < next)
+                next = left;
+        }
+        if(ch.deferred)
+        {
+            const qint64 left = hold[ch.owner] - (now - ch.owned);
+            if(next < 0 || left < next)
+                next = left;
+        }
+    }
+    if(next >= 0)
+        m_timer.start(next);
+    else
+        m_timer.stop();
+}
+
+void commandarbiter::flush()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for(int c = 0; c < actuationmodel::CHANNELS; c++)
+    {
+        channel& ch = m_channels[c];
+        if(ch.deferred && now - ch.owned >= hold[ch.owner])
+        {
+            // the hold is over: the request held back takes the channel
+            ch.deferred = false;
+            qDebug() << "commandarbiter: channel" << c << "applying" << ch.deferredValue << "of" << sourceName(ch.deferredSource) <<
+                        "after the hold";
+            submit((actuationmodel::CHANNEL)c, ch.deferredValue, ch.deferredSource);
+        }
+        if(ch.pending && now - ch.written >= window)
+            write((actuationmodel::CHANNEL)c, now);
+    }
+    schedule(now);
+}
+
+QString commandarbiter::report()
+{
+    QString r;
+    for(int c = 0; c < actuationmodel::CHANNELS; c++)
+    {
+        r += QString(channelName[c]) + ": " + QString::number(m_channels[c].sent) + " written, " +
+             QString::number(m_channels[c].merged) + " merged, " + QString::number(m_channels[c].dropped) + " dropped\n";
+    }
+    return r;
+}
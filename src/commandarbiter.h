@@ -0,0 +1,77 @@
+#ifndef COMMANDARBITER_H
+#define COMMANDARBITER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include "actuationmodel.h"
+
+// single entry point of the targets requested to a device by the sources that drive it.
+// For every channel:
+// - a request is held back while a source with a higher priority owns the channel (it requested
+//   within its hold time); the last one held back is applied when the hold ends
+// - a request that comes before the end of the write window supersedes the pending one, or it's
+//   dropped when it repeats the target just written
+// - at the end of the window only the last target goes to the driver
+// submit() can be called from any thread, it runs on the one of the arbiter (the device thread).
+class commandarbiter : public QObject
+{
+    Q_OBJECT
+
+public:
+    // from the lowest priority
+    enum SOURCE
+    {
+        VIRTUAL = 0, // the app connected to the virtual device
+        HEARTZONE, // heart rate zone loop of the device
+        PROGRAM, // train program, random program
+        TEMPLATE, // remote control of the templates
+        USER, // plus and minus of the UI
+        SOURCES
+    };
+
+    explicit commandarbiter(QObject* parent = 0);
+    void submit(actuationmodel::CHANNEL c, double value, SOURCE source);
+    // requests held back by a source with a higher priority and never applied
+    uint32_t dropped(actuationmodel::CHANNEL c) {return m_channels[c].dropped;}
+    // requests superseded in the write window or repeating the target written
+    uint32_t merged(actuationmodel::CHANNEL c) {return m_channels[c].merged;}
+    QString report();
+
+    static QString sourceName(SOURCE source);
+
+signals:
+    // the effective target of the channel, at most one for every write window
+    void command(actuationmodel::CHANNEL c, double value);
+
+private slots:
+    void flush();
+
+private:
+    typedef struct channel
+    {
+        SOURCE owner;
+        qint64 owned; // ms of the last request of the owner
+        bool pending;
+        double value; // pending target
+        double last; // last target written
+        qint64 written; // ms
+        uint32_t dropped;
+        uint32_t merged;
+        uint32_t sent;
+
+        // the last request held back by the owner
+        bool deferred;
+        double deferredValue;
+        SOURCE deferredSource;
+    }channel;
+
+    channel m_channels[actuationmodel::CHANNELS];
+    QTimer m_timer;
+
+    void write(actuationmodel::CHANNEL c, qint64 now);
+    // the timer at the first end of a write window or of a hold with a request behind it
+    void schedule(qint64 now);
+};
+
+#endif // COMMANDARBITER_H
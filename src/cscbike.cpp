@@ -22,7 +22,7 @@ cscbike::cscbike(bool noWriteResistance, bool noHeartService, bool noVirtualDevi
     this->noVirtualDevice = noVirtualDevice;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 /*
 void cscbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
@@ -53,30 +53,27 @@ void cscbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info,
 void cscbike::update()
 {
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     if(!noVirtualDevice)
     {
     #ifdef Q_OS_ANDROID
         if(settings.value("ant_heart", false).toBool())
         {
-            Heart = (uint8_t)KeepAwakeHelper::heart();
-            debug("Current Heart: " + QString::number(Heart.value()));
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
+            debug("Current Heart: " + QString::number(KeepAwakeHelper::heart()));
         }
     #endif
-        if(heartRateBeltName.startsWith("Disabled"))
-        {
     #ifdef Q_OS_IOS
     #ifndef IO_UNDER_QT
         lockscreen h;
         long appleWatchHeartRate = h.heartRate();
         h.setKcal(KCal.value());
         h.setDistance(Distance.value());
-        Heart = appleWatchHeartRate;
+        if(appleWatchHeartRate > 0)
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
         debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
     #endif
     #endif
-        }
     }
 
     if(Heart.value() > 0)
@@ -108,7 +105,7 @@ void cscbike::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -151,10 +148,10 @@ void cscbike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void cscbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("cscbike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -203,7 +200,7 @@ void cscbike::characteristicChanged(const QLowEnergyCharacteristic &characterist
     if(!settings.value("speed_power_based", false).toBool())
         Speed = Cadence.value() * settings.value("cadence_sensor_speed_ratio", 0.33).toDouble();
     else
-        Speed = metric::calculateSpeedFromPower(m_watt.value());
+        Speed = physics.speed(m_watt.value());
     debug("Current Speed: " + QString::number(Speed.value()));
 
     Distance += ((Speed.value() / 3600000.0) * ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())) );
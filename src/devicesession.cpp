@@ -0,0 +1,386 @@
+#include "devicesession.h"
+#include "homeform.h"
+#include "latencyhistogram.h"
+#include "qfit.h"
+#include "bike.h"
+#include "treadmill.h"
+#include <QDir>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QThread>
+#include <QDebug>
+#include <ctime>
+
+static const int notifyInterval = 100; // ms, 10Hz like the FTMS bikes
+static const double sustainedP99 = 50.0; // ms, over this the machines start queueing behind each other
+
+devicesession::devicesession(const QString& name, bluetooth* manager, const QString& trainProgram)
+{
+    m_name = name;
+    m_manager = manager;
+    m_trainProgram = trainProgram;
+}
+
+devicesession::devicesession(const QString& name, bluetoothdevice* device)
+{
+    m_name = name;
+    m_device = device;
+}
+
+devicesession::~devicesession()
+{
+    if(m_program)
+        delete m_program;
+}
+
+bluetoothdevice* devicesession::device()
+{
+    if(m_manager)
+        return m_manager->device();
+    return m_device;
+}
+
+void devicesession::start()
+{
+    Session.clear();
+    m_lastSequence = 0;
+    if(!m_timer)
+    {
+        m_timer = new QTimer(this);
+        connect(m_timer, SIGNAL(timeout()), this, SLOT(update()));
+    }
+    m_timer->start(1000);
+
+    if(m_manager && m_trainProgram.length() && !m_program)
+    {
+        m_program = trainprogram::load(m_trainProgram, m_manager);
+        connect(m_manager, SIGNAL(deviceConnected()), this, SLOT(programSignals()));
+        programSignals();
+    }
+    if(m_program)
+        m_program->restart();
+    qDebug() << "devicesession" << m_name << "started";
+}
+
+void devicesession::programSignals()
+{
+    bluetoothdevice* dev = device();
+    if(!m_program || !dev)
+        return;
+
+    // same wiring of homeform, the driver can be a new one after a restart of the manager
+    disconnect(m_program, nullptr, nullptr, nullptr);
+    connect(m_program, SIGNAL(start()), dev, SLOT(start()));
+    connect(m_program, SIGNAL(stop()), dev, SLOT(stop()));
+    connect(m_program, SIGNAL(changeSpeed(double)), ((treadmill*)dev), SLOT(changeSpeed(double)));
+    connect(m_program, SIGNAL(changeFanSpeed(uint8_t)), ((treadmill*)dev), SLOT(changeFanSpeed(uint8_t)));
+    connect(m_program, SIGNAL(changeInclination(double)), ((treadmill*)dev), SLOT(changeInclination(double)));
+    connect(m_program, SIGNAL(changeSpeedAndInclination(double, double)), ((treadmill*)dev), SLOT(changeSpeedAndInclination(double, double)));
+    connect(m_program, SIGNAL(changeResistance(int8_t)), ((bike*)dev), SLOT(changeResistance(int8_t)));
+    connect(m_program, SIGNAL(changeRequestedPelotonResistance(int8_t)), ((bike*)dev), SLOT(changeRequestedPelotonResistance(int8_t)));
+    connect(m_program, SIGNAL(changeCadence(int16_t)), ((bike*)dev), SLOT(changeCadence(int16_t)));
+    connect(m_program, SIGNAL(changePower(int32_t)), ((bike*)dev), SLOT(changePower(int32_t)));
+    connect(m_program, SIGNAL(changeGrade(double)), ((bike*)dev), SLOT(changeGrade(double)));
+    connect(((treadmill*)dev), SIGNAL(tapeStarted()), m_program, SLOT(onTapeStarted()));
+    connect(((bike*)dev), SIGNAL(bikeStarted()), m_program, SLOT(onTapeStarted()));
+    qDebug() << "devicesession" << m_name << "trainProgram associated to a device";
+}
+
+void devicesession::update()
+{
+    bluetoothdevice* dev = device();
+    if(!dev)
+        return;
+
+    // nothing new from the machine: it's not connected yet or it's gone, the line would be a copy
+    uint32_t sequence;
+    bluetoothdevicesample sample = dev->lastSample(&sequence);
+    if(sequence == m_lastSequence)
+        return;
+    m_lastSequence = sequence;
+
+    double inclination = 0;
+    double resistance = 0;
+    double peloton_resistance = 0;
+    double pace = 0;
+    uint8_t cadence = 0;
+    if(sample.type == bluetoothdevice::TREADMILL)
+    {
+        if(sample.speed.value && sample.pace)
+            pace = 10000 / sample.pace;
+        inclination = sample.treadmill.inclination.value;
+    }
+    else if(sample.type == bluetoothdevice::BIKE || sample.type == bluetoothdevice::ROWING)
+    {
+        cadence = sample.bike.cadence.value;
+        resistance = sample.bike.resistance.value;
+        peloton_resistance = sample.bike.pelotonResistance.value;
+    }
+    else if(sample.type == bluetoothdevice::ELLIPTICAL)
+    {
+        cadence = sample.elliptical.cadence;
+        resistance = sample.elliptical.resistance;
+        inclination = sample.elliptical.inclination.value;
+    }
+
+    SessionLine s(
+                sample.speed.value,
+                inclination,
+                sample.odometer,
+                sample.watt.value,
+                resistance,
+                peloton_resistance,
+                (uint8_t)sample.heart.value,
+                pace, cadence, sample.calories,
+                sample.elevationGain,
+                sample.elapsed,
+                false);
+    s.rmssd = sample.rmssd;
+    s.sdnn = sample.sdnn;
+    s.dfaAlpha1 = sample.dfaAlpha1;
+    Session.append(s);
+}
+
+QString devicesession::stop(const QString& path)
+{
+    if(m_timer)
+        m_timer->stop();
+    if(device())
+        device()->stop();
+
+    if(Session.isEmpty() || !device())
+        return "";
+
+    QString name = m_name;
+    name.replace(QRegExp("[^A-Za-z0-9_-]"), "_");
+    QString filename = path + name + "_" + Session.first().time.toString().replace(":", "_") + ".fit";
+    qfit::save(filename, Session, device()->deviceType());
+    qDebug() << "devicesession" << m_name << "saved" << Session.length() << "lines in" << filename;
+    return filename;
+}
+
+devicesessions::devicesessions(const QStringList& names, factory create, const QString& trainProgram)
+{
+    qRegisterMetaType<QBluetoothDeviceInfo>("QBluetoothDeviceInfo");
+
+    discoveryAgent = new QBluetoothDeviceDiscoveryAgent(this);
+    connect(discoveryAgent, SIGNAL(finished()), this, SLOT(finished()));
+    discoveryAgent->setLowEnergyDiscoveryTimeout(10000);
+
+    foreach(QString name, names)
+    {
+        devicesession* s = spawn(name, [name, create, trainProgram]() {
+            // the manager filters on the name, the agent it creates stays idle
+            devicesession* s = new devicesession(name, create(name), trainProgram);
+            s->start();
+            return s;
+        }, &m_threads);
+        // the managers are on other threads: every device found is queued to each of them
+        connect(discoveryAgent, SIGNAL(deviceDiscovered(QBluetoothDeviceInfo)), s->manager(), SLOT(deviceDiscovered(QBluetoothDeviceInfo)));
+        m_sessions.append(s);
+    }
+    startDiscovery();
+}
+
+devicesessions::~devicesessions()
+{
+    stop();
+}
+
+devicesession* devicesessions::spawn(const QString& name, std::function<devicesession*()> create, QList<QThread*>* threads)
+{
+    QThread* thread = new QThread();
+    thread->setObjectName("session " + name);
+    thread->start(QThread::HighPriority);
+    threads->append(thread);
+
+    QObject* context = new QObject();
+    context->moveToThread(thread);
+    devicesession* s = 0;
+    QMetaObject::invokeMethod(context, [&s, create]() {
+        s = create();
+    }, Qt::BlockingQueuedConnection);
+    context->deleteLater();
+    return s;
+}
+
+void devicesessions::close(QList<devicesession*>* sessions, QList<QThread*>* threads)
+{
+    for(int i = 0; i < sessions->length(); i++)
+    {
+        devicesession* s = sessions->at(i);
+        QMetaObject::invokeMethod(s, [s]() {
+            delete s;
+        }, Qt::BlockingQueuedConnection);
+        threads->at(i)->quit();
+        threads->at(i)->wait();
+        delete threads->at(i);
+    }
+    sessions->clear();
+    threads->clear();
+}
+
+void devicesessions::startDiscovery()
+{
+    QSettings settings;
+    if(!settings.value("trx_route_key", false).toBool())
+        discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    else
+        discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::ClassicMethod | QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+}
+
+void devicesessions::finished()
+{
+    // a machine can come later or come back after a restart of its manager
+    if(!stopped)
+        startDiscovery();
+}
+
+void devicesessions::stop()
+{
+    if(stopped)
+        return;
+    stopped = true;
+    discoveryAgent->stop();
+
+    QString path = homeform::getWritableAppDir();
+    foreach(devicesession* s, m_sessions)
+    {
+        QString filename;
+        QMetaObject::invokeMethod(s, "stop", Qt::BlockingQueuedConnection, Q_RETURN_ARG(QString, filename), Q_ARG(QString, path));
+    }
+    // the managers and the drivers are left to the end of the process, like the single manager of main
+    foreach(QThread* t, m_threads)
+    {
+        t->quit();
+        t->wait();
+    }
+}
+
+// a bike without bluetooth, the load test calls notify() like the driver does on a notification
+class loadtestbike : public bike
+{
+public:
+    void notify(double watt, double cadence, double heart)
+    {
+        const QDateTime now = QDateTime::currentDateTime();
+        if(lastNotify.isValid())
+        {
+            const double ms = lastNotify.msecsTo(now);
+            Distance += (Speed.value() / 3600000.0) * ms;
+            KCal += (((0.048 * watt + 1.19) * 75.0 * 3.5) / 200.0) / (60000.0 / ms);
+        }
+        lastNotify = now;
+        Cadence = cadence;
+        Speed = cadence * 0.37;
+        Heart = heart;
+        m_watt = watt;
+        update_metrics(false, watt);
+    }
+
+private:
+    QDateTime lastNotify;
+};
+
+QString devicesessions::loadTest(uint32_t machines, uint32_t seconds)
+{
+    QString r = "devicesessions load test, " + QString::number(seconds) + " s per step, " +
+                QString::number(1000 / notifyInterval) + "Hz per machine\n";
+    QString path = QDir::tempPath() + "/";
+    uint32_t sustained = 0;
+
+    QList<uint32_t> steps;
+    for(uint32_t n = 1; n < machines; n *= 2)
+        steps.append(n);
+    steps.append(machines);
+
+    foreach(uint32_t n, steps)
+    {
+        QList<devicesession*> sessions;
+        QList<QThread*> threads;
+        QList<loadtestbike*> bikes;
+        QList<latencyhistogram*> latencies;
+        for(uint32_t i = 0; i < n; i++)
+        {
+            loadtestbike* b = 0;
+            sessions.append(spawn("loadtest" + QString::number(i), [&b, i]() {
+                b = new loadtestbike();
+                devicesession* s = new devicesession("loadtest" + QString::number(i), b);
+                b->setParent(s);
+                s->start();
+                return s;
+            }, &threads));
+            bikes.append(b);
+            latencies.append(new latencyhistogram("machine " + QString::number(i)));
+        }
+
+        QElapsedTimer wall;
+        wall.start();
+        const clock_t cpu = ::clock();
+        uint32_t tick = 0;
+
+        // the notifications come from here, each one waits in the queue of its machine
+        QTimer feeder;
+        feeder.setTimerType(Qt::PreciseTimer);
+        QObject::connect(&feeder, &QTimer::timeout, [&]() {
+            tick++;
+            for(uint32_t i = 0; i < n; i++)
+            {
+                loadtestbike* b = bikes.at(i);
+                latencyhistogram* l = latencies.at(i);
+                const qint64 posted = wall.nsecsElapsed();
+                const double watt = 150 + ((tick + i * 7) % 100);
+                QMetaObject::invokeMethod(b, [b, l, &wall, posted, watt]() {
+                    l->record((wall.nsecsElapsed() - posted) / 1000000.0);
+                    b->notify(watt, 80 + ((int)watt % 20), 120 + ((int)watt % 40));
+                }, Qt::QueuedConnection);
+            }
+        });
+        feeder.start(notifyInterval);
+        QEventLoop loop;
+        QTimer::singleShot(seconds * 1000, &loop, &QEventLoop::quit);
+        loop.exec();
+        feeder.stop();
+
+        // the stop is queued behind the last notifications, so they are all counted
+        QElapsedTimer exportTime;
+        exportTime.start();
+        uint32_t lines = 0;
+        for(int i = 0; i < sessions.length(); i++)
+        {
+            devicesession* s = sessions.at(i);
+            QString filename;
+            QMetaObject::invokeMethod(s, "stop", Qt::BlockingQueuedConnection, Q_RETURN_ARG(QString, filename), Q_ARG(QString, path));
+            lines += s->Session.length();
+            if(filename.length())
+                QFile::remove(filename);
+        }
+        const qint64 exportMs = exportTime.elapsed();
+        const double cpuPercent = ((double)(::clock() - cpu) / CLOCKS_PER_SEC) * 100000.0 / wall.elapsed();
+
+        uint32_t notifications = 0;
+        double p99 = 0;
+        double max = 0;
+        foreach(latencyhistogram* l, latencies)
+        {
+            notifications += l->count();
+            p99 = qMax(p99, l->percentile(99));
+            max = qMax(max, l->max());
+            delete l;
+        }
+        close(&sessions, &threads);
+
+        r += QString::number(n) + " machines: " + QString::number(notifications) + " notifications, " +
+             QString::number(lines) + " session lines, latency p99 " + QString::number(p99) + "ms max " +
+             QString::number(max, 'f', 1) + "ms, cpu " + QString::number(cpuPercent, 'f', 0) + "% of a core, exports " +
+             QString::number(exportMs) + "ms\n";
+        if(p99 <= sustainedP99)
+            sustained = n;
+        else
+            break;
+    }
+
+    r += "sustained: " + QString::number(sustained) + " machines with a p99 latency under " + QString::number(sustainedP99) + "ms";
+    return r;
+}
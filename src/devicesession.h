@@ -0,0 +1,89 @@
+#ifndef DEVICESESSION_H
+#define DEVICESESSION_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+#include <QBluetoothDeviceDiscoveryAgent>
+#include <functional>
+#include "bluetooth.h"
+#include "sessionline.h"
+#include "trainprogram.h"
+
+// one machine of a multi-machine run: the bluetooth manager with its driver and virtual device,
+// the session buffer and the train program. The session lives on its own thread, so the event
+// queue of a machine holds only the notifications and timers of that machine.
+class devicesession : public QObject
+{
+    Q_OBJECT
+
+public:
+    // a machine reached through the manager, the manager looks only for the device named `name`
+    devicesession(const QString& name, bluetooth* manager, const QString& trainProgram = "");
+    // a machine driven directly by the caller (load test)
+    devicesession(const QString& name, bluetoothdevice* device);
+    ~devicesession();
+
+    bluetoothdevice* device();
+    bluetooth* manager() {return m_manager;}
+    QString name() {return m_name;}
+    QList<SessionLine> Session;
+
+public slots:
+    void start();
+    // ends the session and writes its fit file in `path`, returns the file name or an empty string
+    QString stop(const QString& path);
+
+private slots:
+    void update();
+    void programSignals();
+
+private:
+    QString m_name;
+    QString m_trainProgram;
+    bluetooth* m_manager = 0;
+    bluetoothdevice* m_device = 0;
+    trainprogram* m_program = 0;
+    QTimer* m_timer = 0;
+    uint32_t m_lastSequence = 0;
+};
+
+// the sessions of every machine of the box (-sessions). One discovery agent scans for all of
+// them and hands every device it finds to the managers, each one keeps the device it's filtered on.
+class devicesessions : public QObject
+{
+    Q_OBJECT
+
+public:
+    // creates the manager of a machine, on the thread of its session
+    typedef std::function<bluetooth*(const QString& name)> factory;
+
+    devicesessions(const QStringList& names, factory create, const QString& trainProgram = "");
+    ~devicesessions();
+    QList<devicesession*> sessions() {return m_sessions;}
+
+    // simulated machines notifying at 10Hz for `seconds`, in growing steps up to `machines`:
+    // reports the latency from the notification to its handling and the largest step that keeps it low
+    static QString loadTest(uint32_t machines, uint32_t seconds = 10);
+
+public slots:
+    // closes every session and writes their files
+    void stop();
+
+private slots:
+    void finished();
+
+private:
+    QBluetoothDeviceDiscoveryAgent* discoveryAgent = 0;
+    QList<devicesession*> m_sessions;
+    QList<QThread*> m_threads;
+    bool stopped = false;
+
+    void startDiscovery();
+    // runs `create` on a new thread named after the machine, the session belongs to that thread
+    static devicesession* spawn(const QString& name, std::function<devicesession*()> create, QList<QThread*>* threads);
+    static void close(QList<devicesession*>* sessions, QList<QThread*>* threads);
+};
+
+#endif // DEVICESESSION_H
@@ -11,6 +11,19 @@
 
 domyosbike::domyosbike(bool noWriteResistance, bool noHeartService, bool testResistance, uint8_t bikeResistanceOffset, double bikeResistanceGain)
 {
+    const uint8_t display2[] = {0xf0, 0xcd, 0x01, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xff,
+                                0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+    const uint8_t display[] = {0xf0, 0xcb, 0x03, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00, 0x02,
+                               0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00,
+                               0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0x00};
+    const uint8_t write[] = {0xf0, 0xad, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                             0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x01, 0xff,
+                             0xff, 0xff, 0x00};
+    displayDistanceFrame.setTemplate(display2, sizeof(display2));
+    displayFrame.setTemplate(display, sizeof(display));
+    resistanceFrame.setTemplate(write, sizeof(write));
+
     m_watt.setType(metric::METRIC_WATT);
     refresh = new QTimer(this);
 
@@ -22,7 +35,7 @@ domyosbike::domyosbike(bool noWriteResistance, bool noHeartService, bool testRes
 
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(300);
+    pollscheduler::instance()->add(refresh, 300);
 }
 
 domyosbike::~domyosbike()
@@ -34,6 +47,7 @@ domyosbike::~domyosbike()
 
 void domyosbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("domyosbike::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -41,13 +55,13 @@ void domyosbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString in
     {
         connect(this, SIGNAL(packetReceived()),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     if(gattCommunicationChannelService->state() != QLowEnergyService::ServiceState::ServiceDiscovered ||
@@ -62,10 +76,17 @@ void domyosbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString in
     if(!disable_log)
         qDebug() << " >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info;
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         qDebug() << " exit for timeout";
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void domyosbike::updateDisplay(uint16_t elapsed)
@@ -80,75 +101,54 @@ void domyosbike::updateDisplay(uint16_t elapsed)
     //if(bike_type == CHANG_YOW)
     if(distance)
     {
-        uint8_t display2[] = {0xf0, 0xcd, 0x01, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xff,
-                              0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-                              0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
-
-        display2[3] = ((((uint16_t)(odometer() * 10))) >> 8) & 0xFF;
-        display2[4] = (((uint16_t)(odometer() * 10))) & 0xFF;
+        displayDistanceFrame.set16(3, (uint16_t)(odometer() * 10));
 
-        for(uint8_t i=0; i<sizeof(display2)-1; i++)
+        if(displayDistanceFrame.changed())
         {
-            display2[26] += display2[i]; // the last byte is a sort of a checksum
+            writeCharacteristic(displayDistanceFrame.data(), 20, "updateDisplay2", false, false);
+            writeCharacteristic(displayDistanceFrame.data() + 20, displayDistanceFrame.length() - 20, "updateDisplay2", false, true);
+            displayDistanceFrame.sent();
         }
-
-        writeCharacteristic(display2, 20, "updateDisplay2", false, false);
-        writeCharacteristic(&display2[20], sizeof (display2) - 20, "updateDisplay2", false, true);
     }
 
-    uint8_t display[] = {0xf0, 0xcb, 0x03, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00, 0x02,
-                         0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00,
-                         0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0x00};
-
-    display[3] = (elapsed / 60) & 0xFF; // high byte for elapsed time (in seconds)
-    display[4] = (elapsed % 60 & 0xFF); // low byte for elasped time (in seconds)
-
-    display[7] = ((uint8_t)((uint16_t)(currentSpeed().value() * multiplier) >> 8)) & 0xFF;
-    display[8] = (uint8_t)(currentSpeed().value() * multiplier) & 0xFF;
+    displayFrame.set(3, (elapsed / 60) & 0xFF); // high byte for elapsed time (in seconds)
+    displayFrame.set(4, (elapsed % 60 & 0xFF)); // low byte for elasped time (in seconds)
 
-    display[12] = (uint8_t)currentHeart().value();
+    displayFrame.set16(7, (uint16_t)(currentSpeed().value() * multiplier));
 
-    //display[13] = ((((uint8_t)calories())) >> 8) & 0xFF;
-    //display[14] = (((uint8_t)calories())) & 0xFF;
+    displayFrame.set(12, (uint8_t)currentHeart().value());
 
     if(bike_type == TELINK)
     {
-        display[15] = ((((uint16_t)currentCadence().value()) * multiplier) >> 8) & 0xFF;
-        display[16] = (((uint16_t)currentCadence().value()) * multiplier) & 0xFF;
+        displayFrame.set16(15, ((uint16_t)currentCadence().value()) * multiplier);
     }
     else
     {
-        display[16] = ((uint8_t)(currentCadence().value() * multiplier));
+        displayFrame.set(16, (uint8_t)(currentCadence().value() * multiplier));
     }
 
-    display[19] = ((((uint16_t)calories()) * multiplier) >> 8) & 0xFF;
-    display[20] = (((uint16_t)calories()) * multiplier) & 0xFF;
+    displayFrame.set16(19, ((uint16_t)calories()) * multiplier);
 
-    for(uint8_t i=0; i<sizeof(display)-1; i++)
+    if(!displayFrame.changed())
     {
-       display[26] += display[i]; // the last byte is a sort of a checksum
+        // nothing to show, but the console still has to be polled
+        uint8_t noOpData[] = { 0xf0, 0xac, 0x9c };
+        writeCharacteristic(noOpData, sizeof(noOpData), "noOp", true, true);
+        return;
     }
 
-    writeCharacteristic(display, 20, "updateDisplay elapsed=" + QString::number(elapsed), false, false );
-    writeCharacteristic(&display[20], sizeof (display) - 20, "updateDisplay elapsed=" + QString::number(elapsed), false, true );
-
+    writeCharacteristic(displayFrame.data(), 20, "updateDisplay elapsed=" + QString::number(elapsed), false, false );
+    writeCharacteristic(displayFrame.data() + 20, displayFrame.length() - 20, "updateDisplay elapsed=" + QString::number(elapsed), false, true );
+    displayFrame.sent();
 }
 
 void domyosbike::forceResistance(int8_t requestResistance)
 {
-   uint8_t write[] = {0xf0, 0xad, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-                      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x01, 0xff,
-                      0xff, 0xff, 0x00};
+   resistanceFrame.set(10, requestResistance);
 
-   write[10] = requestResistance;
-
-   for(uint8_t i=0; i<sizeof(write)-1; i++)
-   {
-      write[22] += write[i]; // the last byte is a sort of a checksum
-   }
-
-   writeCharacteristic(write, 20, "forceResistance " + QString::number(requestResistance));
-   writeCharacteristic(&write[20], sizeof (write) - 20, "forceResistance " + QString::number(requestResistance));
+   writeCharacteristic(resistanceFrame.data(), 20, "forceResistance " + QString::number(requestResistance));
+   writeCharacteristic(resistanceFrame.data() + 20, resistanceFrame.length() - 20, "forceResistance " + QString::number(requestResistance));
+   resistanceFrame.sent();
 }
 
 void domyosbike::update()
@@ -216,7 +216,7 @@ void domyosbike::update()
         // ********************************************************************************************************
 
         // updating the treadmill console every second
-        if(sec1Update++ == (1000 / refresh->interval()))
+        if(sec1Update++ >= (1000 / refresh->interval()))
         {
             sec1Update = 0;
             if(incompletePackets == false)
@@ -282,10 +282,10 @@ void domyosbike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void domyosbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("domyosbike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);    
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     QByteArray value = newValue;
 
     qDebug() << " << " + QString::number(value.length()) + " " + value.toHex(' ');
@@ -360,13 +360,10 @@ void domyosbike::characteristicChanged(const QLowEnergyCharacteristic &character
 
     double ucadence = ((uint8_t)value.at(9));
     double cadenceFilter = settings.value("domyos_bike_cadence_filter", 0).toDouble();
-    if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-    {
-        if(cadenceFilter == 0 || cadenceFilter > ucadence)
-            Cadence = ucadence;
-        else
-            qDebug() << "cadence filter out " << ucadence << cadenceFilter;
-    }
+    if(cadenceFilter == 0 || cadenceFilter > ucadence)
+        sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, ucadence);
+    else
+        qDebug() << "cadence filter out " << ucadence << cadenceFilter;
 
     Resistance = value.at(14);    
     if(Resistance.value() < 1)
@@ -379,29 +376,27 @@ void domyosbike::characteristicChanged(const QLowEnergyCharacteristic &character
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
+        uint8_t heart = ((uint8_t)value.at(18));
+        if(heart == 0)
         {
-            uint8_t heart = ((uint8_t)value.at(18));
-            if(heart == 0)
-            {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
             lockscreen h;
             long appleWatchHeartRate = h.heartRate();
             h.setKcal(KCal.value());
             h.setDistance(Distance.value());
-            Heart = appleWatchHeartRate;
+            if(appleWatchHeartRate > 0)
+                sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
             qDebug() << "Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate);
 #endif
 #endif
-            }
-            else
-                Heart = heart;
         }
+        else
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, heart);
     }
 
     if(Cadence.value() > 0)
@@ -439,7 +434,7 @@ void domyosbike::characteristicChanged(const QLowEnergyCharacteristic &character
     if(!settings.value("speed_power_based", false).toBool())
         Speed = speed;
     else
-        Speed = metric::calculateSpeedFromPower(m_watt.value());
+        Speed = physics.speed(m_watt.value());
     KCal = kcal;
     Distance = distance;    
 }
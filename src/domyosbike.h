@@ -28,6 +28,7 @@
 
 #include "virtualbike.h"
 #include "bike.h"
+#include "domyosframe.h"
 
 #ifdef Q_OS_IOS
 #include "ios/lockscreen.h"
@@ -47,6 +48,7 @@ public:
     void* VirtualDevice();
 
 private:
+    friend class benchmarks; // test/benchmarks
     double GetSpeedFromPacket(QByteArray packet);
     double GetInclinationFromPacket(QByteArray packet);
     double GetKcalFromPacket(QByteArray packet);
@@ -81,6 +83,9 @@ private:
     bool searchStopped = false;
     uint8_t sec1Update = 0;
     QByteArray lastPacket;
+    domyosframe displayFrame;
+    domyosframe displayDistanceFrame;
+    domyosframe resistanceFrame;
     QDateTime lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
 
     enum _BIKE_TYPE {
@@ -9,6 +9,19 @@
 
 domyoselliptical::domyoselliptical(bool noWriteResistance, bool noHeartService, bool testResistance, uint8_t bikeResistanceOffset, double bikeResistanceGain)
 {
+    const uint8_t display2[] = {0xf0, 0xcd, 0x01, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xff,
+                                0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+    const uint8_t display[] = {0xf0, 0xcb, 0x03, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00, 0x02,
+                               0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00,
+                               0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0x00};
+    const uint8_t write[] = {0xf0, 0xad, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                             0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x01, 0xff,
+                             0xff, 0xff, 0x00};
+    displayDistanceFrame.setTemplate(display2, sizeof(display2));
+    displayFrame.setTemplate(display, sizeof(display));
+    resistanceFrame.setTemplate(write, sizeof(write));
+
     m_watt.setType(metric::METRIC_WATT);
     refresh = new QTimer(this);
 
@@ -20,7 +33,7 @@ domyoselliptical::domyoselliptical(bool noWriteResistance, bool noHeartService,
 
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(300);
+    pollscheduler::instance()->add(refresh, 300);
 }
 
 domyoselliptical::~domyoselliptical()
@@ -32,6 +45,7 @@ domyoselliptical::~domyoselliptical()
 
 void domyoselliptical::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("domyoselliptical::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -39,13 +53,13 @@ void domyoselliptical::writeCharacteristic(uint8_t* data, uint8_t data_len, QStr
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicChanged(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, QByteArray((const char*)data, data_len));
@@ -53,80 +67,67 @@ void domyoselliptical::writeCharacteristic(uint8_t* data, uint8_t data_len, QStr
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void domyoselliptical::updateDisplay(uint16_t elapsed)
 {
     //if(bike_type == CHANG_YOW)
     {
-        uint8_t display2[] = {0xf0, 0xcd, 0x01, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xff,
-                              0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-                              0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
-
-        display2[3] = ((((uint16_t)(odometer() * 10))) >> 8) & 0xFF;
-        display2[4] = (((uint16_t)(odometer() * 10))) & 0xFF;
+        displayDistanceFrame.set16(3, (uint16_t)(odometer() * 10));
 
-        for(uint8_t i=0; i<sizeof(display2)-1; i++)
+        if(displayDistanceFrame.changed())
         {
-            display2[26] += display2[i]; // the last byte is a sort of a checksum
+            writeCharacteristic(displayDistanceFrame.data(), 20, "updateDisplay2", false, false);
+            writeCharacteristic(displayDistanceFrame.data() + 20, displayDistanceFrame.length() - 20, "updateDisplay2", false, true);
+            displayDistanceFrame.sent();
         }
-
-        writeCharacteristic(display2, 20, "updateDisplay2", false, false);
-        writeCharacteristic(&display2[20], sizeof (display2) - 20, "updateDisplay2", false, true);
     }
 
-    uint8_t display[] = {0xf0, 0xcb, 0x03, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00, 0x02,
-                         0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00,
-                         0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0x00};
+    displayFrame.set(3, (elapsed / 60) & 0xFF); // high byte for elapsed time (in seconds)
+    displayFrame.set(4, (elapsed % 60 & 0xFF)); // low byte for elasped time (in seconds)
 
-    display[3] = (elapsed / 60) & 0xFF; // high byte for elapsed time (in seconds)
-    display[4] = (elapsed % 60 & 0xFF); // low byte for elasped time (in seconds)
+    displayFrame.set16(7, (uint16_t)(currentSpeed().value()));
 
-    display[7] = ((uint8_t)((uint16_t)(currentSpeed().value()) >> 8)) & 0xFF;
-    display[8] = (uint8_t)(currentSpeed().value()) & 0xFF;
+    displayFrame.set(12, (uint8_t)currentHeart().value());
 
-    display[12] = (uint8_t)currentHeart().value();
+    displayFrame.set(16, (uint8_t)currentCadence());
 
-    //display[13] = ((((uint8_t)calories())) >> 8) & 0xFF;
-    //display[14] = (((uint8_t)calories())) & 0xFF;
+    displayFrame.set16(19, (uint16_t)calories());
 
-    display[16] = (uint8_t)currentCadence();
-
-    display[19] = ((((uint16_t)calories())) >> 8) & 0xFF;
-    display[20] = (((uint16_t)calories())) & 0xFF;
-
-    for(uint8_t i=0; i<sizeof(display)-1; i++)
+    if(!displayFrame.changed())
     {
-       display[26] += display[i]; // the last byte is a sort of a checksum
+        // nothing to show, but the console still has to be polled
+        uint8_t noOpData[] = { 0xf0, 0xac, 0x9c };
+        writeCharacteristic(noOpData, sizeof(noOpData), "noOp", true, true);
+        return;
     }
 
-    writeCharacteristic(display, 20, "updateDisplay elapsed=" + QString::number(elapsed), false, false );
-    writeCharacteristic(&display[20], sizeof (display) - 20, "updateDisplay elapsed=" + QString::number(elapsed), false, true );
-
+    writeCharacteristic(displayFrame.data(), 20, "updateDisplay elapsed=" + QString::number(elapsed), false, false );
+    writeCharacteristic(displayFrame.data() + 20, displayFrame.length() - 20, "updateDisplay elapsed=" + QString::number(elapsed), false, true );
+    displayFrame.sent();
 }
 
 void domyoselliptical::forceResistanceAndInclination(int8_t requestResistance, uint8_t inclination)
 {
-   uint8_t write[] = {0xf0, 0xad, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-                      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x01, 0xff,
-                      0xff, 0xff, 0x00};
-
-   write[10] = requestResistance;
-
-   //write[13] = ((uint16_t)(inclination*10) >> 8) & 0xFF;
-   //write[14] = inclination; //need a hci snoof log about it
+   resistanceFrame.set(10, requestResistance);
 
-   for(uint8_t i=0; i<sizeof(write)-1; i++)
-   {
-      write[22] += write[i]; // the last byte is a sort of a checksum
-   }
+   //resistanceFrame.set16(13, (uint16_t)(inclination*10));
+   //resistanceFrame.set(14, inclination); //need a hci snoof log about it
 
-   writeCharacteristic(write, 20, "forceResistance " + QString::number(requestResistance) + " Inclination " + inclination);
-   writeCharacteristic(&write[20], sizeof (write) - 20, "forceResistance " + QString::number(requestResistance) + " Inclination " + inclination);
+   writeCharacteristic(resistanceFrame.data(), 20, "forceResistance " + QString::number(requestResistance) + " Inclination " + inclination);
+   writeCharacteristic(resistanceFrame.data() + 20, resistanceFrame.length() - 20, "forceResistance " + QString::number(requestResistance) + " Inclination " + inclination);
+   resistanceFrame.sent();
 }
 
 void domyoselliptical::update()
@@ -175,7 +176,7 @@ void domyoselliptical::update()
         // ********************************************************************************************************
 
         // updating the treadmill console every second
-        if(sec1Update++ == (1000 / refresh->interval()))
+        if(sec1Update++ >= (1000 / refresh->interval()))
         {
             sec1Update = 0;
             updateDisplay(elapsed.value());
@@ -248,10 +249,10 @@ void domyoselliptical::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void domyoselliptical::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("domyoselliptical::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);    
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -277,8 +278,7 @@ void domyoselliptical::characteristicChanged(const QLowEnergyCharacteristic &cha
     double kcal = GetKcalFromPacket(newValue);
     double distance = GetDistanceFromPacket(newValue) * settings.value("domyos_elliptical_speed_ratio", 1.0).toDouble();
 
-    if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-        Cadence = ((uint8_t)newValue.at(9));
+    sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, (uint8_t)newValue.at(9));
     Resistance = newValue.at(14);
     Inclination = newValue.at(21);
     if(Resistance < 1)
@@ -289,12 +289,11 @@ void domyoselliptical::characteristicChanged(const QLowEnergyCharacteristic &cha
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
-            Heart = ((uint8_t)newValue.at(18));
+        sensors.publish(sensorbus::HEART, sensorbus::MACHINE, ((uint8_t)newValue.at(18)));
     }
 
     CrankRevs++;
@@ -28,6 +28,7 @@
 
 #include "virtualtreadmill.h"
 #include "elliptical.h"
+#include "domyosframe.h"
 
 class domyoselliptical : public elliptical
 {
@@ -71,6 +72,9 @@ private:
     bool searchStopped = false;
     uint8_t sec1Update = 0;
     QByteArray lastPacket;
+    domyosframe displayFrame;
+    domyosframe displayDistanceFrame;
+    domyosframe resistanceFrame;
     QDateTime lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
 
     enum _BIKE_TYPE {
@@ -0,0 +1,44 @@
+#include "domyosframe.h"
+#include <string.h>
+
+domyosframe::domyosframe()
+{
+    memset(m_frame, 0, sizeof(m_frame));
+    memset(m_lastSent, 0, sizeof(m_lastSent));
+}
+
+void domyosframe::setTemplate(const uint8_t* frame, uint8_t length)
+{
+    Q_ASSERT(length <= MAX_LENGTH);
+    memcpy(m_frame, frame, length);
+    m_length = length;
+    m_sentOnce = false;
+
+    m_frame[m_length - 1] = 0;
+    for(uint8_t i = 0; i < m_length - 1; i++)
+        m_frame[m_length - 1] += m_frame[i]; // the last byte is a sort of a checksum
+}
+
+void domyosframe::set(uint8_t index, uint8_t value)
+{
+    Q_ASSERT(index < m_length - 1);
+    m_frame[m_length - 1] += (uint8_t)(value - m_frame[index]);
+    m_frame[index] = value;
+}
+
+void domyosframe::set16(uint8_t index, uint16_t value)
+{
+    set(index, (value >> 8) & 0xFF);
+    set(index + 1, value & 0xFF);
+}
+
+bool domyosframe::changed()
+{
+    return !m_sentOnce || memcmp(m_frame, m_lastSent, m_length);
+}
+
+void domyosframe::sent()
+{
+    memcpy(m_lastSent, m_frame, m_length);
+    m_sentOnce = true;
+}
@@ -0,0 +1,29 @@
+#ifndef DOMYOSFRAME_H
+#define DOMYOSFRAME_H
+
+#include <QtGlobal>
+
+// preformatted Domyos frame: the last byte is the additive checksum of all the others.
+// Only the changed fields are patched, the checksum follows incrementally and the frame
+// remembers what was sent last so an identical frame doesn't need another GATT write
+class domyosframe
+{
+public:
+    domyosframe();
+    void setTemplate(const uint8_t* frame, uint8_t length);
+    void set(uint8_t index, uint8_t value);
+    void set16(uint8_t index, uint16_t value);
+    uint8_t* data() {return m_frame;}
+    uint8_t length() {return m_length;}
+    bool changed();
+    void sent();
+
+private:
+    static const uint8_t MAX_LENGTH = 32;
+    uint8_t m_frame[MAX_LENGTH];
+    uint8_t m_lastSent[MAX_LENGTH];
+    uint8_t m_length = 0;
+    bool m_sentOnce = false;
+};
+
+#endif // DOMYOSFRAME_H
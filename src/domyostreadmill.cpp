@@ -54,6 +54,15 @@ QBluetoothUuid _gattNotifyCharacteristicId((QString)"49535343-1e4d-4bd9-ba61-23c
 
 domyostreadmill::domyostreadmill(uint32_t pollDeviceTime, bool noConsole, bool noHeartService, double forceInitSpeed, double forceInitInclination)
 {
+    const uint8_t display[] = {0xf0, 0xcb, 0x03, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00, 0x02,
+                               0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x01, 0x01, 0x00,
+                               0x0c, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00};
+    const uint8_t writeIncline[] = {0xf0, 0xad, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0x00};
+    displayFrame.setTemplate(display, sizeof(display));
+    speedInclineFrame.setTemplate(writeIncline, sizeof(writeIncline));
+
     m_watt.setType(metric::METRIC_WATT);
     this->noConsole = noConsole;
     this->noHeartService = noHeartService;
@@ -67,11 +76,12 @@ domyostreadmill::domyostreadmill(uint32_t pollDeviceTime, bool noConsole, bool n
     refresh = new QTimer(this);
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(pollDeviceTime);
+    pollscheduler::instance()->add(refresh, pollDeviceTime);
 }
 
 void domyostreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("domyostreadmill::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -79,13 +89,13 @@ void domyostreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QStri
     {
         connect(this, SIGNAL(packetReceived()),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     if(gattCommunicationChannelService->state() != QLowEnergyService::ServiceState::ServiceDiscovered ||
@@ -100,101 +110,92 @@ void domyostreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QStri
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void domyostreadmill::updateDisplay(uint16_t elapsed)
 {
-   uint8_t display[] = {0xf0, 0xcb, 0x03, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00, 0x02,
-                        0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x01, 0x01, 0x00,
-                        0x0c, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00};
-
    QSettings settings;
    bool distance = settings.value("domyos_treadmill_distance_display", true).toBool();
 
    if(elapsed > 5999) // 99:59
    {
-       display[3] = ((elapsed / 60) / 60) & 0xFF; // high byte for elapsed time (in seconds)
-       display[4] = ((elapsed / 60) % 60) & 0xFF; // low byte for elasped time (in seconds)
+       displayFrame.set(3, ((elapsed / 60) / 60) & 0xFF); // high byte for elapsed time (in seconds)
+       displayFrame.set(4, ((elapsed / 60) % 60) & 0xFF); // low byte for elasped time (in seconds)
    }
    else
    {
-       display[3] = (elapsed / 60) & 0xFF; // high byte for elapsed time (in seconds)
-       display[4] = (elapsed % 60 & 0xFF); // low byte for elasped time (in seconds)
+       displayFrame.set(3, (elapsed / 60) & 0xFF); // high byte for elapsed time (in seconds)
+       displayFrame.set(4, (elapsed % 60 & 0xFF)); // low byte for elasped time (in seconds)
    }
 
    if(distance)
    {
        if(odometer() < 10.0)
        {
-           display[7] = ((uint8_t)((uint16_t)(odometer() * 100) >> 8)) & 0xFF;
-           display[8] = (uint8_t)(odometer() * 100) & 0xFF;
-           display[9] = 0x02; // decimal position
+           displayFrame.set(7, ((uint8_t)((uint16_t)(odometer() * 100) >> 8)) & 0xFF);
+           displayFrame.set(8, (uint8_t)(odometer() * 100) & 0xFF);
+           displayFrame.set(9, 0x02); // decimal position
        }
        else if(odometer() < 100.0)
        {
-           display[7] = ((uint8_t)(odometer() * 10) >> 8) & 0xFF;
-           display[8] = (uint8_t)(odometer() * 10) & 0xFF;
-           display[9] = 0x01; // decimal position
+           displayFrame.set(7, ((uint8_t)(odometer() * 10) >> 8) & 0xFF);
+           displayFrame.set(8, (uint8_t)(odometer() * 10) & 0xFF);
+           displayFrame.set(9, 0x01); // decimal position
        }
        else
        {
-           display[7] = ((uint8_t)(odometer()) >> 8) & 0xFF;
-           display[8] = (uint8_t)(odometer()) & 0xFF;
-           display[9] = 0x00; // decimal position
+           displayFrame.set(7, ((uint8_t)(odometer()) >> 8) & 0xFF);
+           displayFrame.set(8, (uint8_t)(odometer()) & 0xFF);
+           displayFrame.set(9, 0x00); // decimal position
        }
    }
    else
    {
-       display[7] = 0x00;
-       display[8] = 0x00;
-       display[9] = 0x00; // decimal position
+       displayFrame.set(7, 0x00);
+       displayFrame.set(8, 0x00);
+       displayFrame.set(9, 0x00); // decimal position
    }
 
-   display[12] = (uint8_t)currentHeart().value();
+   displayFrame.set(12, (uint8_t)currentHeart().value());
 
-   display[16] = (uint8_t)(currentInclination().value() * 10.0);
+   displayFrame.set(16, (uint8_t)(currentInclination().value() * 10.0));
 
-   display[20] = (uint8_t)(currentSpeed().value() * 10.0);
+   displayFrame.set(20, (uint8_t)(currentSpeed().value() * 10.0));
 
-   display[23] = ((uint8_t)(calories()) >> 8) & 0xFF;
-   display[24] = (uint8_t)(calories()) & 0xFF;
+   displayFrame.set(23, ((uint8_t)(calories()) >> 8) & 0xFF);
+   displayFrame.set(24, (uint8_t)(calories()) & 0xFF);
 
-   for(uint8_t i=0; i<sizeof(display)-1; i++)
+   if(!displayFrame.changed())
    {
-      display[26] += display[i]; // the last byte is a sort of a checksum
+      // the console already shows these values, keep polling it
+      writeCharacteristic(noOpData, sizeof(noOpData), "noOp", false, true);
+      return;
    }
 
-   writeCharacteristic(display, 20, "updateDisplay elapsed=" + QString::number(elapsed), false, false );
-   writeCharacteristic(&display[20], sizeof (display) - 20, "updateDisplay elapsed=" + QString::number(elapsed), false, true );
+   writeCharacteristic(displayFrame.data(), 20, "updateDisplay elapsed=" + QString::number(elapsed), false, false );
+   writeCharacteristic(displayFrame.data() + 20, displayFrame.length() - 20, "updateDisplay elapsed=" + QString::number(elapsed), false, true );
+   displayFrame.sent();
 }
 
 void domyostreadmill::forceSpeedOrIncline(double requestSpeed, double requestIncline)
 {
-   uint8_t writeIncline[] = {0xf0, 0xad, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
-                 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-                             0xff, 0xff, 0x00};
-
-   writeIncline[4] = ((uint16_t)(requestSpeed*10) >> 8) & 0xFF;
-   writeIncline[5] = ((uint16_t)(requestSpeed*10) & 0xFF);
+   speedInclineFrame.set16(4, (uint16_t)(requestSpeed*10));
+   speedInclineFrame.set16(13, (uint16_t)(requestIncline*10));
 
-   writeIncline[13] = ((uint16_t)(requestIncline*10) >> 8) & 0xFF;
-   writeIncline[14] = ((uint16_t)(requestIncline*10) & 0xFF);
-
-   for(uint8_t i=0; i<sizeof(writeIncline)-1; i++)
-   {
-      //qDebug() << QString::number(writeIncline[i], 16);
-      writeIncline[22] += writeIncline[i]; // the last byte is a sort of a checksum
-   }
-
-   //qDebug() << "writeIncline crc" << QString::number(writeIncline[26], 16);
-
-
-   writeCharacteristic(writeIncline, 20, "forceSpeedOrIncline speed=" + QString::number(requestSpeed) + " incline=" + QString::number(requestIncline), false, false);
-   writeCharacteristic(&writeIncline[20], sizeof (writeIncline) - 20, "forceSpeedOrIncline speed=" + QString::number(requestSpeed) + " incline=" + QString::number(requestIncline), false, true);
+   writeCharacteristic(speedInclineFrame.data(), 20, "forceSpeedOrIncline speed=" + QString::number(requestSpeed) + " incline=" + QString::number(requestIncline), false, false);
+   writeCharacteristic(speedInclineFrame.data() + 20, speedInclineFrame.length() - 20, "forceSpeedOrIncline speed=" + QString::number(requestSpeed) + " incline=" + QString::number(requestIncline), false, true);
+   speedInclineFrame.sent();
 }
 
 bool domyostreadmill::sendChangeFanSpeed(uint8_t speed)
@@ -355,9 +356,9 @@ void domyostreadmill::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void domyostreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("domyostreadmill::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     bool domyos_treadmill_buttons = settings.value("domyos_treadmill_buttons", false).toBool();
     Q_UNUSED(characteristic);
     QByteArray value = newValue;
@@ -433,73 +434,73 @@ void domyostreadmill::characteristicChanged(const QLowEnergyCharacteristic &char
     {
         debug("increase speed button on console pressed!");
         if(domyos_treadmill_buttons)
-            changeSpeed(currentSpeed().value() + 0.2);
+            changeSpeed(currentSpeed().value() + 0.2, commandarbiter::USER);
     }
     else if(value.at(22) == 0x09)
     {
         debug("decrease speed button on console pressed!");
         if(domyos_treadmill_buttons)
-            changeSpeed(currentSpeed().value() - 0.2);
+            changeSpeed(currentSpeed().value() - 0.2, commandarbiter::USER);
     }
     else if(value.at(22) == 0x0c)
     {
         debug("increase inclination button on console pressed!");
         if(domyos_treadmill_buttons)
-            changeInclination(currentInclination().value() + 0.5);
+            changeInclination(currentInclination().value() + 0.5, commandarbiter::USER);
     }
     else if(value.at(22) == 0x0d)
     {
         debug("decrease inclination button on console pressed!");
         if(domyos_treadmill_buttons)
-            changeInclination(currentInclination().value() - 0.5);
+            changeInclination(currentInclination().value() - 0.5, commandarbiter::USER);
     }
     else if(value.at(22) == 0x11)
     {
         debug("22km/h speed button pressed!");
         if(domyos_treadmill_buttons)
-            changeSpeed(22.0);
+            changeSpeed(22.0, commandarbiter::USER);
     }
     else if(value.at(22) == 0x10)
     {
         debug("16km/h speed button pressed!");
         if(domyos_treadmill_buttons)
-            changeSpeed(16.0);
+            changeSpeed(16.0, commandarbiter::USER);
     }
     else if(value.at(22) == 0x0f)
     {
         debug("10km/h speed button pressed!");
         if(domyos_treadmill_buttons)
-            changeSpeed(10.0);
+            changeSpeed(10.0, commandarbiter::USER);
     }
     else if(value.at(22) == 0x0e)
     {
         debug("5km/h speed button pressed!");
         if(domyos_treadmill_buttons)
-            changeSpeed(5.0);
+            changeSpeed(5.0, commandarbiter::USER);
     }
     else if(value.at(22) == 0x15)
     {
         debug("15% inclination button on console pressed!");
         if(domyos_treadmill_buttons)
-            changeInclination(15.0);
+            changeInclination(15.0, commandarbiter::USER);
     }
     else if(value.at(22) == 0x14)
     {
         debug("10% inclination button on console pressed!");
         if(domyos_treadmill_buttons)
-            changeInclination(10.0);
+            changeInclination(10.0, commandarbiter::USER);
     }
     else if(value.at(22) == 0x13)
     {
         debug("5% inclination button on console pressed!");
         if(domyos_treadmill_buttons)
-            changeInclination(5.0);
+            changeInclination(5.0, commandarbiter::USER);
     }
     else if(value.at(22) == 0x12)
     {
         debug("0% inclination button on console pressed!");
         if(domyos_treadmill_buttons)
-            changeInclination(0.0);
+            changeInclination(0.0, commandarbiter::USER);
     }
 
     /*if ((uint8_t)value.at(1) != 0xbc && value.at(2) != 0x04)  // intense run, these are the bytes for the inclination and speed status
@@ -512,29 +513,27 @@ void domyostreadmill::characteristicChanged(const QLowEnergyCharacteristic &char
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
+        uint8_t heart = ((uint8_t)value.at(18));
+        if(heart == 0)
         {
-            uint8_t heart = ((uint8_t)value.at(18));
-            if(heart == 0)
-            {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
             lockscreen h;
-        long appleWatchHeartRate = h.heartRate();
-        h.setKcal(KCal.value());
-        h.setDistance(Distance.value());
-        Heart = appleWatchHeartRate;
-        debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
+            long appleWatchHeartRate = h.heartRate();
+            h.setKcal(KCal.value());
+            h.setDistance(Distance.value());
+            if(appleWatchHeartRate > 0)
+                sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
+            debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-            }
-            else
-                Heart = heart;
         }
+        else
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, heart);
     }
     FanSpeed = value.at(23);
 
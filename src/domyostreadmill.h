@@ -27,6 +27,7 @@
 
 #include "virtualtreadmill.h"
 #include "treadmill.h"
+#include "domyosframe.h"
 
 #ifdef Q_OS_IOS
 #include "ios/lockscreen.h"
@@ -48,6 +49,7 @@ public:
     void* VirtualDevice();
 
 private:
+    friend class benchmarks; // test/benchmarks
     bool sendChangeFanSpeed(uint8_t speed);
     double GetSpeedFromPacket(QByteArray packet);
     double GetInclinationFromPacket(QByteArray packet);
@@ -69,6 +71,8 @@ private:
     uint8_t sec1Update = 0;    
     uint8_t firstInit = 0;
     QByteArray lastPacket;
+    domyosframe displayFrame;
+    domyosframe speedInclineFrame;
     QDateTime lastTimeCharacteristicChanged;
     bool firstCharacteristicChanged = true;
 
@@ -26,11 +26,12 @@ echelonconnectsport::echelonconnectsport(bool noWriteResistance, bool noHeartSer
     this->bikeResistanceOffset = bikeResistanceOffset;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void echelonconnectsport::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("echelonconnectsport::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -204,10 +205,10 @@ double echelonconnectsport::bikeResistanceToPeloton(double resistance)
 
 void echelonconnectsport::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("echelonconnectsport::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);    
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     qDebug() << " << " + newValue.toHex(' ');
 
@@ -232,12 +233,11 @@ void echelonconnectsport::characteristicChanged(const QLowEnergyCharacteristic &
 
     double distance = GetDistanceFromPacket(newValue);
 
-    if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-        Cadence = ((uint8_t)newValue.at(10));
+    sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, (uint8_t)newValue.at(10));
     if(!settings.value("speed_power_based", false).toBool())
         Speed = 0.37497622 * ((double)Cadence.value());
     else
-        Speed = metric::calculateSpeedFromPower(m_watt.value());
+        Speed = physics.speed(m_watt.value());
     KCal += ((( (0.048 * ((double)watts()) + 1.19) * settings.value("weight", 75.0).toFloat() * 3.5) / 200.0 ) / (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())))); //(( (0.048* Output in watts +1.19) * body weight in kg * 3.5) / 200 ) / 60
     Distance += ((Speed.value() / 3600000.0) * ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())) );
 
@@ -251,23 +251,21 @@ void echelonconnectsport::characteristicChanged(const QLowEnergyCharacteristic &
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
-        {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-            lockscreen h;
-            long appleWatchHeartRate = h.heartRate();
-            h.setKcal(KCal.value());
-            h.setDistance(Distance.value());
-            Heart = appleWatchHeartRate;
-            qDebug() << "Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate);
+        lockscreen h;
+        long appleWatchHeartRate = h.heartRate();
+        h.setKcal(KCal.value());
+        h.setDistance(Distance.value());
+        if(appleWatchHeartRate > 0)
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
+        qDebug() << "Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate);
 #endif
 #endif
-        }
     }
     
 #ifdef Q_OS_IOS
@@ -40,11 +40,46 @@ void elliptical::update_metrics(const bool watt_calc, const double watts)
 
     _lastTimeUpdate = current;
     _firstUpdate = false;
+    fuseSensors();
+    updateHeartZone();
+    publishSample();
 }
 
 uint16_t elliptical::watts() {return 0;}
-void elliptical::changeResistance(int8_t resistance) { requestResistance = resistance; RequestedResistance = resistance;}
-void elliptical::changeInclination(double inclination){ requestInclination = inclination; }
+
+void elliptical::fuseSensors()
+{
+    bluetoothdevice::fuseSensors();
+    double cadence;
+    if(sensors.fuse(sensorbus::CADENCE, &cadence))
+        Cadence = cadence;
+}
+
+void elliptical::fillSample(bluetoothdevicesample* s)
+{
+    bluetoothdevice::fillSample(s);
+    s->elliptical.inclination = sampleOf(currentInclination());
+    s->elliptical.cadence = currentCadence();
+    s->elliptical.resistance = currentResistance();
+    s->elliptical.requestedResistance = lastRequestedResistance().value();
+}
+
+void elliptical::changeResistance(int8_t resistance, commandarbiter::SOURCE source) { arbiter.submit(actuationmodel::RESISTANCE, resistance, source); }
+void elliptical::changeInclination(double inclination, commandarbiter::SOURCE source){ arbiter.submit(actuationmodel::INCLINATION, inclination, source); }
+void elliptical::applyCommand(actuationmodel::CHANNEL c, double value)
+{
+    if(c == actuationmodel::RESISTANCE)
+    {
+        requestResistance = value;
+        RequestedResistance = value;
+        actuation.request(c, value, currentResistance());
+    }
+    else if(c == actuationmodel::INCLINATION)
+    {
+        requestInclination = value;
+        actuation.request(c, value, currentInclination().value());
+    }
+}
 double elliptical::currentCrankRevolutions() { return CrankRevs;}
 uint16_t elliptical::lastCrankEventTime() { return LastCrankEventTime;}
 int8_t elliptical::currentResistance() { return Resistance;}
@@ -57,46 +92,18 @@ bluetoothdevice::BLUETOOTH_TYPE elliptical::deviceType() { return bluetoothdevic
 
 void elliptical::clearStats()
 {
-    moving.clear(true);
-    elapsed.clear(true);
-    Speed.clear(false);
-    KCal.clear(true);
-    Distance.clear(true);
-    Heart.clear(false);
-    m_jouls.clear(true);
-    elevationAcc = 0;
-    m_watt.clear(false);
-    WeightLoss.clear(false);
-
     Inclination.clear(false);
+    bluetoothdevice::clearStats();
 }
 
 void elliptical::setPaused(bool p)
 {
-    paused = p;
-    moving.setPaused(p);
-    elapsed.setPaused(p);
-    Speed.setPaused(p);
-    KCal.setPaused(p);
-    Distance.setPaused(p);
-    Heart.setPaused(p);
-    m_jouls.setPaused(p);
-    m_watt.setPaused(p);
+    bluetoothdevice::setPaused(p);
     Inclination.setPaused(p);
-    WeightLoss.setPaused(p);
 }
 
 void elliptical::setLap()
 {
-    moving.setLap(true);
-    elapsed.setLap(true);
-    Speed.setLap(false);
-    KCal.setLap(true);
-    Distance.setLap(true);
-    Heart.setLap(false);
-    m_jouls.setLap(true);
-    m_watt.setLap(false);
-    WeightLoss.setLap(false);
-
+    bluetoothdevice::setLap();
     Inclination.setLap(false);
 }
@@ -25,8 +25,8 @@ public:
     uint16_t watts();
 
 public slots:
-    virtual void changeResistance(int8_t res);
-    virtual void changeInclination(double inclination);
+    virtual void changeResistance(int8_t res, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
+    virtual void changeInclination(double inclination, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
 
 signals:
     void bikeStarted();
@@ -41,6 +41,10 @@ protected:
     uint16_t LastCrankEventTime = 0;
     int8_t requestResistance = -1;
     double CrankRevs = 0;
+
+    void fuseSensors();
+    void fillSample(bluetoothdevicesample* s);
+    void applyCommand(actuationmodel::CHANNEL c, double value);
 };
 
 #endif // ELLIPTICAL_H
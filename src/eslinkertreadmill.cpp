@@ -22,11 +22,12 @@ eslinkertreadmill::eslinkertreadmill(uint32_t pollDeviceTime, bool noConsole, bo
     refresh = new QTimer(this);
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(pollDeviceTime);
+    pollscheduler::instance()->add(refresh, pollDeviceTime);
 }
 
 void eslinkertreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("eslinkertreadmill::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -34,13 +35,13 @@ void eslinkertreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QSt
     {
         connect(this, SIGNAL(packetReceived()),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, QByteArray((const char*)data, data_len), QLowEnergyService::WriteWithoutResponse);
@@ -48,10 +49,17 @@ void eslinkertreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QSt
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void eslinkertreadmill::updateDisplay(uint16_t elapsed)
@@ -127,6 +135,7 @@ void eslinkertreadmill::update()
         // updating the treadmill console every second
         if(sec1Update++ >= (1000 / refresh->interval()))
         {
+            sec1Update = 0;
             updateDisplay(elapsed.value());
         }
 
@@ -190,9 +199,9 @@ void eslinkertreadmill::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void eslinkertreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("eslinkertreadmill::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     Q_UNUSED(characteristic);
     QByteArray value = newValue;
 
@@ -209,13 +218,9 @@ void eslinkertreadmill::characteristicChanged(const QLowEnergyCharacteristic &ch
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
-    else
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
 #endif
-    {
-        /*if(heartRateBeltName.startsWith("Disabled"))
-            Heart = value.at(18);*/
-    }
+    //sensors.publish(sensorbus::HEART, sensorbus::MACHINE, value.at(18));
 
     if(!firstCharacteristicChanged)
         DistanceCalculated += ((speed / 3600.0) / ( 1000.0 / (lastTimeCharacteristicChanged.msecsTo(QDateTime::currentDateTime()))));
@@ -26,11 +26,12 @@ fitplusbike::fitplusbike(bool noWriteResistance, bool noHeartService, uint8_t bi
     this->bikeResistanceOffset = bikeResistanceOffset;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void fitplusbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("fitplusbike::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -176,10 +177,10 @@ void fitplusbike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void fitplusbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("fitplusbike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     qDebug() << " << " + newValue.toHex(' ');
 
@@ -194,12 +195,11 @@ void fitplusbike::characteristicChanged(const QLowEnergyCharacteristic &characte
     Resistance = 1;
     m_pelotonResistance = 1;
     emit resistanceRead(Resistance.value());
-    if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-        Cadence = ((uint8_t)newValue.at(8));
+    sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, (uint8_t)newValue.at(8));
     if(!settings.value("speed_power_based", false).toBool())
         Speed = (double)((((uint8_t)newValue.at(7)) << 8) | ((uint8_t)newValue.at(6))) / 10.0;
     else
-        Speed = metric::calculateSpeedFromPower(m_watt.value());
+        Speed = physics.speed(m_watt.value());
     KCal += ((( (0.048 * ((double)watts()) + 1.19) * settings.value("weight", 75.0).toFloat() * 3.5) / 200.0 ) / (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())))); //(( (0.048* Output in watts +1.19) * body weight in kg * 3.5) / 200 ) / 60
     Distance += ((Speed.value() / 3600000.0) * ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())) );
 
@@ -213,23 +213,21 @@ void fitplusbike::characteristicChanged(const QLowEnergyCharacteristic &characte
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
-        {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-            lockscreen h;
-            long appleWatchHeartRate = h.heartRate();
-            h.setKcal(KCal.value());
-            h.setDistance(Distance.value());
-            Heart = appleWatchHeartRate;
-            qDebug() << "Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate);
+        lockscreen h;
+        long appleWatchHeartRate = h.heartRate();
+        h.setKcal(KCal.value());
+        h.setDistance(Distance.value());
+        if(appleWatchHeartRate > 0)
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
+        qDebug() << "Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate);
 #endif
 #endif
-        }
     }
 
 #ifdef Q_OS_IOS
@@ -26,7 +26,7 @@ fitshowtreadmill::fitshowtreadmill(uint32_t pollDeviceTime, bool noConsole, bool
     refresh = new QTimer(this);
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(pollDeviceTime);
+    pollscheduler::instance()->add(refresh, pollDeviceTime);
 }
 
 fitshowtreadmill::~fitshowtreadmill() {
@@ -46,9 +46,11 @@ void fitshowtreadmill::scheduleWrite(const uint8_t* data, uint8_t data_len, cons
     bufferWrite.append((char)data_len);
     bufferWrite.append(QByteArray((const char*)data, data_len));
     debugMsgs.append(info);
+    TRACE_COUNTER("fitshowtreadmill::writeQueue", debugMsgs.length());
 }
 
 void fitshowtreadmill::writeCharacteristic(const uint8_t* data, uint8_t data_len, const QString& info) {
+    TRACE_SPAN("fitshowtreadmill::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
     QByteArray qba((const char*)data, data_len);
@@ -57,13 +59,20 @@ void fitshowtreadmill::writeCharacteristic(const uint8_t* data, uint8_t data_len
 
     connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
             &loop, SLOT(quit()));
-    timeout.singleShot(300, &loop, SLOT(quit()));
+    connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, qba);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if (timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 bool fitshowtreadmill::checkIncomingPacket(const uint8_t* data, uint8_t data_len) const {
@@ -252,9 +261,9 @@ void fitshowtreadmill::sendSportData() {
 }
 
 void fitshowtreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue) {
+    TRACE_SPAN("fitshowtreadmill::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     Q_UNUSED(characteristic);
     QByteArray value = newValue;
 
@@ -413,21 +422,19 @@ void fitshowtreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
                 Distance = distance;
 #ifdef Q_OS_ANDROID
                 if (settings.value("ant_heart", false).toBool())
-                    Heart = (uint8_t)KeepAwakeHelper::heart();
+                    sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
                 else
 #endif
                 {
-                    if (heartRateBeltName.startsWith("Disabled")) {
 #if defined(Q_OS_IOS) && !defined(IO_UNDER_QT)
-                        long appleWatchHeartRate = h->heartRate();
-                        h->setKcal(KCal.value());
-                        h->setDistance(Distance.value());
-                        Heart = appleWatchHeartRate;
-                        debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
-#else
-                        Heart = heart;
+                    long appleWatchHeartRate = h->heartRate();
+                    h->setKcal(KCal.value());
+                    h->setDistance(Distance.value());
+                    if(appleWatchHeartRate > 0)
+                        sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
+                    debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
-                    }
+                    sensors.publish(sensorbus::HEART, sensorbus::MACHINE, heart);
                 }
 
                 if (speed > 0) {
@@ -17,11 +17,12 @@ flywheelbike::flywheelbike(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void flywheelbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("flywheelbike::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
     if(wait_for_response)
@@ -73,7 +74,7 @@ void flywheelbike::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        /*if(sec1Update++ == (500 / refresh->interval()))
+        /*if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -191,7 +192,6 @@ void flywheelbike::decodeReceivedData(QByteArray buffer)
 void flywheelbike::updateStats()
 {
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     // calculate the acculamator every time on the current data, in order to avoid holes in peloton or strava
     KCal += ((( (0.048 * ((double)watts()) + 1.19) * settings.value("weight", 75.0).toFloat() * 3.5) / 200.0 ) / (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())))); //(( (0.048* Output in watts +1.19) * body weight in kg * 3.5) / 200 ) / 60
@@ -205,19 +205,17 @@ void flywheelbike::updateStats()
 
     lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
 
-    if(heartRateBeltName.startsWith("Disabled"))
-    {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
     lockscreen h;
     long appleWatchHeartRate = h.heartRate();
     h.setKcal(KCal.value());
     h.setDistance(Distance.value());
-    Heart = appleWatchHeartRate;
+    if(appleWatchHeartRate > 0)
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
     debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-    }
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
@@ -246,11 +244,11 @@ void flywheelbike::updateStats()
 
 void flywheelbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("flywheelbike::characteristicChanged");
     static uint8_t zero_fix_filter = 0;
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -268,7 +266,7 @@ void flywheelbike::characteristicChanged(const QLowEnergyCharacteristic &charact
 
 #ifdef Q_OS_ANDROID
             if(settings.value("ant_heart", false).toBool())
-                Heart = (uint8_t)KeepAwakeHelper::heart();
+                sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
 #endif
 
             uint16_t power = ((parsedData->power >> 8) & 0xFF);
@@ -287,13 +285,12 @@ void flywheelbike::characteristicChanged(const QLowEnergyCharacteristic &charact
 
                 Resistance = parsedData->brake_level;
                 emit resistanceRead(Resistance.value());
-                if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-                    Cadence = parsedData->cadence;
+                sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, parsedData->cadence);
                 m_watts = power;
                 if(!settings.value("speed_power_based", false).toBool())
                     Speed = ((double)speed) / 10.0;
                 else
-                    Speed = metric::calculateSpeedFromPower(m_watt.value());
+                    Speed = physics.speed(m_watt.value());
 
                 // https://www.facebook.com/groups/149984563348738/permalink/174268944253633/?comment_id=174366620910532&reply_comment_id=174666314213896
                 m_pelotonResistance = (Resistance.value() * 0.8173) + 9.2712;
@@ -21,11 +21,12 @@ ftmsbike::ftmsbike(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void ftmsbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("ftmsbike::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
     if(wait_for_response)
@@ -81,7 +82,7 @@ void ftmsbike::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -124,10 +125,10 @@ void ftmsbike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("ftmsbike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -169,7 +170,7 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
         if(!settings.value("speed_power_based", false).toBool())
             Speed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 100.0;
         else
-            Speed = metric::calculateSpeedFromPower(m_watt.value());
+            Speed = physics.speed(m_watt.value());
         index += 2;
         debug("Current Speed: " + QString::number(Speed.value()));
     }
@@ -184,8 +185,7 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
 
     if(Flags.instantCadence)
     {
-        if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-            Cadence = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 2.0;
+        sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 2.0);
         index += 2;
         debug("Current Cadence: " + QString::number(Cadence.value()));
     }
@@ -253,15 +253,15 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
         if(Flags.heartRate)
         {
-            Heart = ((double)((newValue.at(index))));
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, (uint8_t)newValue.at(index));
+            debug("Current Heart: " + QString::number((uint8_t)newValue.at(index)));
             index += 1;
-            debug("Current Heart: " + QString::number(Heart.value()));
         }
     }
 
@@ -288,19 +288,17 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
 
     lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
 
-    if(heartRateBeltName.startsWith("Disabled"))
-    {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
     lockscreen h;
     long appleWatchHeartRate = h.heartRate();
     h.setKcal(KCal.value());
     h.setDistance(Distance.value());
-    Heart = appleWatchHeartRate;
+    if(appleWatchHeartRate > 0)
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
     debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-    }
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
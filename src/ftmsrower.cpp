@@ -22,11 +22,12 @@ ftmsrower::ftmsrower(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void ftmsrower::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("ftmsrower::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
     if(wait_for_response)
@@ -82,7 +83,7 @@ void ftmsrower::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -125,10 +126,10 @@ void ftmsrower::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void ftmsrower::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("ftmsrower::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -255,15 +256,15 @@ void ftmsrower::characteristicChanged(const QLowEnergyCharacteristic &characteri
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
         if(Flags.heartRate)
         {
-            Heart = ((double)((newValue.at(index))));
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, (uint8_t)newValue.at(index));
+            debug("Current Heart: " + QString::number((uint8_t)newValue.at(index)));
             index += 1;
-            debug("Current Heart: " + QString::number(Heart.value()));
         }
     }
 
@@ -290,19 +291,17 @@ void ftmsrower::characteristicChanged(const QLowEnergyCharacteristic &characteri
 
     lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
 
-    if(heartRateBeltName.startsWith("Disabled"))
-    {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
     lockscreen h;
     long appleWatchHeartRate = h.heartRate();
     h.setKcal(KCal.value());
     h.setDistance(Distance.value());
-    Heart = appleWatchHeartRate;
+    if(appleWatchHeartRate > 0)
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
     debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-    }
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
@@ -9,7 +9,8 @@
 
 heartratebelt::heartratebelt()
 {
-
+    QSettings settings;
+    logPackets = settings.value("log_debug", false).toBool();
 }
 
 void heartratebelt::update()
@@ -34,19 +35,58 @@ void heartratebelt::disconnectBluetooth()
 
 void heartratebelt::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("heartratebelt::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     emit packetReceived();
 
-    debug(" << " + newValue.toHex(' '));
+    // the hex dump is built only when somebody reads it: a belt sends a packet per beat
+    if(logPackets)
+        debug(" << " + newValue.toHex(' '));
+
+    // Heart Rate Measurement: flags, 8 or 16 bit heart rate, optional energy expended, RR intervals
+    const uint8_t* p = (const uint8_t*)newValue.constData();
+    const int length = newValue.length();
+    if(length < 2)
+        return;
+
+    const uint8_t flags = p[0];
+    int index = 1;
+    uint16_t heart;
+    if(flags & 0x01)
+    {
+        if(length < 3)
+            return;
+        heart = p[1] | (p[2] << 8);
+        index = 3;
+    }
+    else
+    {
+        heart = p[1];
+        index = 2;
+    }
+
+    // sensor contact supported but not detected: the value is not reliable
+    if((flags & 0x06) != 0x04)
+    {
+        Heart = heart;
+        emit heartRate(heart > 255 ? 255 : (uint8_t)heart);
+    }
+
+    if(flags & 0x08)
+        index += 2; // energy expended
 
-    if(newValue.length() > 1)
+    if(flags & 0x10)
     {
-        Heart = newValue[1];
-        emit heartRate((uint8_t)Heart.value());
+        for(; index + 1 < length; index += 2)
+        {
+            const uint16_t rr = p[index] | (p[index + 1] << 8); // 1/1024 s
+            emit rrInterval((rr * 1000.0) / 1024.0);
+        }
     }
 
-    debug("Current heart: " + QString::number(Heart.value()));
+    if(logPackets)
+        debug("Current heart: " + QString::number(Heart.value()));
 }
 
 void heartratebelt::stateChanged(QLowEnergyService::ServiceState state)
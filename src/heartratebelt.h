@@ -38,12 +38,14 @@ public:
 private:
     QLowEnergyService* gattCommunicationChannelService = 0;
     QLowEnergyCharacteristic gattNotifyCharacteristic;
+    bool logPackets = false;
 
 signals:
     void disconnected();
     void debug(QString string);
     void packetReceived();
     void heartRate(uint8_t heart);
+    void rrInterval(double rr); // milliseconds
 
 public slots:
     void deviceDiscovered(const QBluetoothDeviceInfo &device);
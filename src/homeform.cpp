@@ -18,6 +18,10 @@
 #include "keepawakehelper.h"
 #include "gpx.h"
 #include "qfit.h"
+#include "chartrenderer.h"
+#include <QRunnable>
+#include <QThreadPool>
+#include "startuptiming.h"
 #include "material.h"
 
 #ifdef Q_OS_ANDROID
@@ -108,6 +112,7 @@ homeform::homeform(QQmlApplicationEngine* engine, bluetooth* bl)
     ftp = new DataObject("FTP Zone", "icons/icons/watt.png", "0", false, "ftp", 48, labelFontSize);
     heart = new DataObject("Heart (bpm)", "icons/icons/heart_red.png", "0", false, "heart", 48, labelFontSize);
     fan = new DataObject("Fan Speed", "icons/icons/fan.png", "0", true, "fan", 48, labelFontSize);
+    hrv = new DataObject("HRV rMSSD (ms)", "icons/icons/heart_red.png", "0", false, "hrv", 48, labelFontSize);
     jouls = new DataObject("KJouls", "icons/icons/joul.png", "0", false, "joul", 48, labelFontSize);
     elapsed = new DataObject("Elapsed", "icons/icons/clock.png", "0:00:00", false, "elapsed", valueElapsedFontSize, labelFontSize);
     moving_time = new DataObject("Moving T.", "icons/icons/clock.png", "0:00:00", false, "moving_time", valueElapsedFontSize, labelFontSize);
@@ -128,17 +133,15 @@ homeform::homeform(QQmlApplicationEngine* engine, bluetooth* bl)
     connect(bluetoothManager, SIGNAL(deviceFound(QString)), this, SLOT(deviceFound(QString)));
     connect(bluetoothManager, SIGNAL(deviceConnected()), this, SLOT(deviceConnected()));
     connect(bluetoothManager, SIGNAL(deviceConnected()), this, SLOT(trainProgramSignals()));
+    workoutModel = new sessionmodel(Session, this);
     engine->rootContext()->setContextProperty("rootItem", (QObject *)this);
 
     this->trainProgram = new trainprogram(QList<trainrow>(), bl);
 
     timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &homeform::update);
-    timer->start(1000);
-
-    backupTimer = new QTimer(this);
-    connect(backupTimer, &QTimer::timeout, this, &homeform::backup);
-    backupTimer->start(60000);
+    // the session is sampled at 1 Hz, this one is never stretched
+    pollscheduler::instance()->add(timer, 1000, pollscheduler::FIXED);
 
     QObject *rootObject = engine->rootObjects().first();
     QObject *home = rootObject->findChild<QObject*>("home");
@@ -163,6 +166,17 @@ homeform::homeform(QQmlApplicationEngine* engine, bluetooth* bl)
         this, SLOT(Lap()));
     QObject::connect(home, SIGNAL(peloton_start_workout()),
         this, SLOT(peloton_start_workout()));
+    QObject::connect(home, SIGNAL(journal_resume()),
+        this, SLOT(journal_resume()));
+    QObject::connect(home, SIGNAL(journal_discard()),
+        this, SLOT(journal_discard()));
+
+    // a journal still running belongs to a session the app didn't save: crash or kill
+    if(sessionjournal::pending(journalFileName()))
+    {
+        m_journalAskResume = true;
+        emit changeJournalAskResume(m_journalAskResume);
+    }
     QObject::connect(stack, SIGNAL(loadSettings(QUrl)),
         this, SLOT(loadSettings(QUrl)));
     QObject::connect(stack, SIGNAL(saveSettings(QUrl)),
@@ -305,25 +319,67 @@ QString homeform::getWritableAppDir() {
     return path;
 }
 
-void homeform::backup()
+void homeform::journal_resume()
 {
-    static uint8_t index = 0;
-    qDebug() << "saving fit file backup...";
+    QList<SessionLine> lines;
+    QList<int32_t> steps;
+    if(!sessionjournal::load(journalFileName(), lines, steps, resumeState) || lines.isEmpty())
+    {
+        qDebug() << "journal: nothing to resume";
+        return;
+    }
+    qDebug() << "journal: resuming" << lines.length() << "lines";
+
+    Session = lines;
+    workoutModel->reset();
+    powerCurve.clear();
+    heartCurve.clear();
+    speedCurve.clear();
+    lapAnalyzer.clear();
+    for(int i = 0; i < Session.length(); i++)
+    {
+        const SessionLine& s = Session.at(i);
+        powerCurve.addSample(s.watt);
+        heartCurve.addSample(s.heart);
+        speedCurve.addSample(s.speed);
+        lapAnalyzer.addSample(s, steps.at(i));
+    }
 
-    QString path = getWritableAppDir();
-    bluetoothdevice * dev = bluetoothManager->device();
-    if(dev)
+    QList<trainrow> rows = trainprogram::loadXML(journalTrainProgramFileName());
+    if(rows.length() && resumeState.trainProgramTicks >= 0)
     {
-        QString filename = path + QString::number(index) + backupFitFileName;
-        QFile::remove(filename);
-        qfit::save(filename, Session, dev->deviceType(), qobject_cast<m3ibike*>(dev)?QFIT_PROCESS_DISTANCENOISE:QFIT_PROCESS_NONE);
+        if(trainProgram)
+        {
+            trainProgram->stop();
+            delete trainProgram;
+        }
+        trainProgram = new trainprogram(rows, bluetoothManager);
+        trainProgramSignals();
+    }
+    journal.resume(journalFileName());
 
-        index++;
-        if(index > 1)
-            index = 0;
+    // the session waits paused for the start, then the device continues from the journal
+    resumePending = true;
+    stopped = false;
+    paused = true;
+    QSettings settings;
+    if(settings.value("top_bar_enabled", true).toBool())
+    {
+        emit stopIconChanged(stopIcon());
+        emit stopTextChanged(stopText());
+        emit stopColorChanged(stopColor());
+        emit startIconChanged(startIcon());
+        emit startTextChanged(startText());
+        emit startColorChanged(startColor());
     }
 }
 
+void homeform::journal_discard()
+{
+    qDebug() << "journal: discarded";
+    sessionjournal::discard(journalFileName());
+}
+
 QString homeform::stopColor()
 {
     return "#00000000";
@@ -352,7 +408,8 @@ QString homeform::startColor()
 void homeform::refresh_bluetooth_devices_clicked()
 {
     bluetoothManager->onlyDiscover = true;
-    bluetoothManager->restart();
+    // queued if the bluetooth manager runs on its own thread
+    QMetaObject::invokeMethod(bluetoothManager, "restart", Qt::AutoConnection);
 }
 
 homeform::~homeform()
@@ -381,8 +438,14 @@ void homeform::trainProgramSignals()
          disconnect(trainProgram, SIGNAL(changeRequestedPelotonResistance(int8_t)), ((bike*)bluetoothManager->device()), SLOT(changeRequestedPelotonResistance(int8_t)));
          disconnect(trainProgram, SIGNAL(changeCadence(int16_t)), ((bike*)bluetoothManager->device()), SLOT(changeCadence(int16_t)));
          disconnect(trainProgram, SIGNAL(changePower(int32_t)), ((bike*)bluetoothManager->device()), SLOT(changePower(int32_t)));
+         disconnect(trainProgram, SIGNAL(changeGrade(double)), ((bike*)bluetoothManager->device()), SLOT(changeGrade(double)));
          disconnect(((treadmill*)bluetoothManager->device()), SIGNAL(tapeStarted()), trainProgram, SLOT(onTapeStarted()));
          disconnect(((bike*)bluetoothManager->device()), SIGNAL(bikeStarted()), trainProgram, SLOT(onTapeStarted()));
+         disconnect(trainProgram, SIGNAL(changeSpeed(double)), pollscheduler::instance(), SLOT(transition()));
+         disconnect(trainProgram, SIGNAL(changeInclination(double)), pollscheduler::instance(), SLOT(transition()));
+         disconnect(trainProgram, SIGNAL(changeSpeedAndInclination(double, double)), pollscheduler::instance(), SLOT(transition()));
+         disconnect(trainProgram, SIGNAL(changeResistance(int8_t)), pollscheduler::instance(), SLOT(transition()));
+         disconnect(trainProgram, SIGNAL(changePower(int32_t)), pollscheduler::instance(), SLOT(transition()));
 
          connect(trainProgram, SIGNAL(start()), bluetoothManager->device(), SLOT(start()));
          connect(trainProgram, SIGNAL(stop()), bluetoothManager->device(), SLOT(stop()));
@@ -394,8 +457,15 @@ void homeform::trainProgramSignals()
          connect(trainProgram, SIGNAL(changeRequestedPelotonResistance(int8_t)), ((bike*)bluetoothManager->device()), SLOT(changeRequestedPelotonResistance(int8_t)));
          connect(trainProgram, SIGNAL(changeCadence(int16_t)), ((bike*)bluetoothManager->device()), SLOT(changeCadence(int16_t)));
          connect(trainProgram, SIGNAL(changePower(int32_t)), ((bike*)bluetoothManager->device()), SLOT(changePower(int32_t)));
+         connect(trainProgram, SIGNAL(changeGrade(double)), ((bike*)bluetoothManager->device()), SLOT(changeGrade(double)));
          connect(((treadmill*)bluetoothManager->device()), SIGNAL(tapeStarted()), trainProgram, SLOT(onTapeStarted()));
          connect(((bike*)bluetoothManager->device()), SIGNAL(bikeStarted()), trainProgram, SLOT(onTapeStarted()));
+         // the device is polled faster while it settles on a new target
+         connect(trainProgram, SIGNAL(changeSpeed(double)), pollscheduler::instance(), SLOT(transition()));
+         connect(trainProgram, SIGNAL(changeInclination(double)), pollscheduler::instance(), SLOT(transition()));
+         connect(trainProgram, SIGNAL(changeSpeedAndInclination(double, double)), pollscheduler::instance(), SLOT(transition()));
+         connect(trainProgram, SIGNAL(changeResistance(int8_t)), pollscheduler::instance(), SLOT(transition()));
+         connect(trainProgram, SIGNAL(changePower(int32_t)), pollscheduler::instance(), SLOT(transition()));
 
          qDebug() << "trainProgram associated to a device";
      }
@@ -408,7 +478,7 @@ void homeform::trainProgramSignals()
 QStringList homeform::tile_order()
 {
     QStringList r;
-    for(int i = 0; i < 25; i++)
+    for(int i = 0; i < 26; i++)
         r.append(QString::number(i));
     return r;
 }
@@ -420,6 +490,12 @@ void homeform::deviceConnected()
     if(first) return;
     first = true;
 
+    startuptiming::mark("device_connected");
+    startuptiming::save(getWritableAppDir() + "startup.csv");
+
+    // always queued, so the latency is the one of the event loop of the UI also without the I/O thread
+    connect(bluetoothManager->device(), &bluetoothdevice::samplePublished, this, &homeform::samplePublished, Qt::QueuedConnection);
+
     m_labelHelp = false;
     changeLabelHelp(m_labelHelp);
 
@@ -487,6 +563,9 @@ void homeform::deviceConnected()
 
             if(settings.value("tile_lapelapsed_enabled", false).toBool() && settings.value("tile_lapelapsed_order", 18).toInt() == i)
                 dataList.append(lapElapsed);
+
+            if(settings.value("tile_hrv_enabled", false).toBool() && settings.value("tile_hrv_order", 25).toInt() == i)
+                dataList.append(hrv);
         }
     }
     else if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE || bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
@@ -561,6 +640,9 @@ void homeform::deviceConnected()
 
             if(settings.value("tile_lapelapsed_enabled", false).toBool() && settings.value("tile_lapelapsed_order", 18).toInt() == i)
                 dataList.append(lapElapsed);
+
+            if(settings.value("tile_hrv_enabled", false).toBool() && settings.value("tile_hrv_order", 25).toInt() == i)
+                dataList.append(hrv);
         }
     }
     else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
@@ -629,6 +711,9 @@ void homeform::deviceConnected()
 
             if(settings.value("tile_lapelapsed_enabled", false).toBool() && settings.value("tile_lapelapsed_order", 18).toInt() == i)
                 dataList.append(lapElapsed);
+
+            if(settings.value("tile_hrv_enabled", false).toBool() && settings.value("tile_hrv_order", 25).toInt() == i)
+                dataList.append(hrv);
         }
     }
 
@@ -654,6 +739,27 @@ void homeform::deviceFound(QString name)
     emit infoChanged(m_info);        
 }
 
+void homeform::samplePublished(qint64 timestamp)
+{
+    const qint64 latency = QDateTime::currentMSecsSinceEpoch() - timestamp;
+    sampleLatency.record(latency);
+    TRACE_COUNTER("sample_latency_ms", latency);
+    if(sampleLatency.count() >= 60)
+    {
+        qDebug() << sampleLatency.report();
+        sampleLatency.clear();
+    }
+}
+
+void homeform::onDevice(std::function<void(bluetoothdevice*)> call)
+{
+    bluetoothdevice* device = bluetoothManager->device();
+    if(!device)
+        return;
+    // the device is the context: the call is dropped if it's deleted before it runs
+    QMetaObject::invokeMethod(device, [device, call]() {call(device);}, Qt::QueuedConnection);
+}
+
 void homeform::Plus(QString name)
 {
     if(name.contains("speed"))
@@ -662,7 +768,7 @@ void homeform::Plus(QString name)
         {
             if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
             {
-                ((treadmill*)bluetoothManager->device())->changeSpeed(((treadmill*)bluetoothManager->device())->currentSpeed().value() + 0.5);
+                onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeSpeed(((treadmill*)d)->currentSpeed().value() + 0.5, commandarbiter::USER);});
             }
         }
     }
@@ -672,11 +778,11 @@ void homeform::Plus(QString name)
         {
             if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
             {
-                ((treadmill*)bluetoothManager->device())->changeInclination(((treadmill*)bluetoothManager->device())->currentInclination().value() + 0.5);
+                onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeInclination(((treadmill*)d)->currentInclination().value() + 0.5, commandarbiter::USER);});
             }
             else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
             {
-                ((elliptical*)bluetoothManager->device())->changeInclination(((elliptical*)bluetoothManager->device())->currentInclination().value() + 0.5);
+                onDevice([](bluetoothdevice* d) {((elliptical*)d)->changeInclination(((elliptical*)d)->currentInclination().value() + 0.5, commandarbiter::USER);});
             }
         }
     }
@@ -688,22 +794,24 @@ void homeform::Plus(QString name)
                     bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL ||
                     bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
             {
-                bluetoothManager->device()->setDifficult(bluetoothManager->device()->difficult() + 0.03);
-                if(bluetoothManager->device()->difficult() == 0)
-                    bluetoothManager->device()->setDifficult(0.03);
+                onDevice([](bluetoothdevice* d) {
+                    d->setDifficult(d->difficult() + 0.03);
+                    if(d->difficult() == 0)
+                        d->setDifficult(0.03);
 
-                if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
-                {
-                    ((bike*)bluetoothManager->device())->changeResistance(((bike*)bluetoothManager->device())->currentResistance().value());
-                }
-                else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
-                {
-                    ((rower*)bluetoothManager->device())->changeResistance(((rower*)bluetoothManager->device())->currentResistance().value());
-                }
-                else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
-                {
-                    ((elliptical*)bluetoothManager->device())->changeResistance(((elliptical*)bluetoothManager->device())->currentResistance());
-                }
+                    if(d->deviceType() == bluetoothdevice::BIKE)
+                    {
+                        ((bike*)d)->changeResistance(((bike*)d)->currentResistance().value(), commandarbiter::USER);
+                    }
+                    else if(d->deviceType() == bluetoothdevice::ROWING)
+                    {
+                        ((rower*)d)->changeResistance(((rower*)d)->currentResistance().value(), commandarbiter::USER);
+                    }
+                    else if(d->deviceType() == bluetoothdevice::ELLIPTICAL)
+                    {
+                        ((elliptical*)d)->changeResistance(((elliptical*)d)->currentResistance(), commandarbiter::USER);
+                    }
+                });
             }
         }
     }
@@ -713,22 +821,21 @@ void homeform::Plus(QString name)
         {
             if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
             {
-                ((bike*)bluetoothManager->device())->changeResistance(((bike*)bluetoothManager->device())->currentResistance().value() + 1);
+                onDevice([](bluetoothdevice* d) {((bike*)d)->changeResistance(((bike*)d)->currentResistance().value() + 1, commandarbiter::USER);});
             }
             else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
             {
-                ((rower*)bluetoothManager->device())->changeResistance(((rower*)bluetoothManager->device())->currentResistance().value() + 1);
+                onDevice([](bluetoothdevice* d) {((rower*)d)->changeResistance(((rower*)d)->currentResistance().value() + 1, commandarbiter::USER);});
             }
             else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
             {
-                ((elliptical*)bluetoothManager->device())->changeResistance(((elliptical*)bluetoothManager->device())->currentResistance() + 1);
+                onDevice([](bluetoothdevice* d) {((elliptical*)d)->changeResistance(((elliptical*)d)->currentResistance() + 1, commandarbiter::USER);});
             }
         }
     }
     else if(name.contains("fan"))
     {
-        if(bluetoothManager->device())
-             bluetoothManager->device()->changeFanSpeed(bluetoothManager->device()->fanSpeed() + 1);
+        onDevice([](bluetoothdevice* d) {d->changeFanSpeed(d->fanSpeed() + 1);});
     }
     else if(name.contains("peloton_offset"))
     {
@@ -749,7 +856,7 @@ void homeform::Minus(QString name)
         {
             if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
             {
-                ((treadmill*)bluetoothManager->device())->changeSpeed(((treadmill*)bluetoothManager->device())->currentSpeed().value() - 0.5);
+                onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeSpeed(((treadmill*)d)->currentSpeed().value() - 0.5, commandarbiter::USER);});
             }
         }
     }
@@ -759,11 +866,11 @@ void homeform::Minus(QString name)
         {
             if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
             {
-                ((treadmill*)bluetoothManager->device())->changeInclination(((treadmill*)bluetoothManager->device())->currentInclination().value() - 0.5);
+                onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeInclination(((treadmill*)d)->currentInclination().value() - 0.5, commandarbiter::USER);});
             }
             else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
             {
-                ((elliptical*)bluetoothManager->device())->changeInclination(((elliptical*)bluetoothManager->device())->currentInclination().value() - 0.5);
+                onDevice([](bluetoothdevice* d) {((elliptical*)d)->changeInclination(((elliptical*)d)->currentInclination().value() - 0.5, commandarbiter::USER);});
             }
         }
     }
@@ -775,22 +882,24 @@ void homeform::Minus(QString name)
                     bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL ||
                     bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
             {
-                bluetoothManager->device()->setDifficult(bluetoothManager->device()->difficult() - 0.03);
-                if(bluetoothManager->device()->difficult() == 0)
-                    bluetoothManager->device()->setDifficult(-0.03);
+                onDevice([](bluetoothdevice* d) {
+                    d->setDifficult(d->difficult() - 0.03);
+                    if(d->difficult() == 0)
+                        d->setDifficult(-0.03);
 
-                if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
-                {
-                    ((bike*)bluetoothManager->device())->changeResistance(((bike*)bluetoothManager->device())->currentResistance().value());
-                }
-                else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
-                {
-                    ((rower*)bluetoothManager->device())->changeResistance(((rower*)bluetoothManager->device())->currentResistance().value());
-                }
-                else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
-                {
-                    ((elliptical*)bluetoothManager->device())->changeResistance(((elliptical*)bluetoothManager->device())->currentResistance());
-                }
+                    if(d->deviceType() == bluetoothdevice::BIKE)
+                    {
+                        ((bike*)d)->changeResistance(((bike*)d)->currentResistance().value(), commandarbiter::USER);
+                    }
+                    else if(d->deviceType() == bluetoothdevice::ROWING)
+                    {
+                        ((rower*)d)->changeResistance(((rower*)d)->currentResistance().value(), commandarbiter::USER);
+                    }
+                    else if(d->deviceType() == bluetoothdevice::ELLIPTICAL)
+                    {
+                        ((elliptical*)d)->changeResistance(((elliptical*)d)->currentResistance(), commandarbiter::USER);
+                    }
+                });
             }
         }
     }
@@ -800,22 +909,21 @@ void homeform::Minus(QString name)
         {
             if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
             {
-                ((bike*)bluetoothManager->device())->changeResistance(((bike*)bluetoothManager->device())->currentResistance().value() - 1);
+                onDevice([](bluetoothdevice* d) {((bike*)d)->changeResistance(((bike*)d)->currentResistance().value() - 1, commandarbiter::USER);});
             }
             else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
             {
-                ((rower*)bluetoothManager->device())->changeResistance(((rower*)bluetoothManager->device())->currentResistance().value() - 1);
+                onDevice([](bluetoothdevice* d) {((rower*)d)->changeResistance(((rower*)d)->currentResistance().value() - 1, commandarbiter::USER);});
             }
             else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
             {
-                ((elliptical*)bluetoothManager->device())->changeResistance(((elliptical*)bluetoothManager->device())->currentResistance() - 1);
+                onDevice([](bluetoothdevice* d) {((elliptical*)d)->changeResistance(((elliptical*)d)->currentResistance() - 1, commandarbiter::USER);});
             }
         }
     }
     else if(name.contains("fan"))
     {
-        if(bluetoothManager->device())
-             bluetoothManager->device()->changeFanSpeed(bluetoothManager->device()->fanSpeed() - 1);
+        onDevice([](bluetoothdevice* d) {d->changeFanSpeed(d->fanSpeed() - 1);});
     }
     else if(name.contains("peloton_offset"))
     {
@@ -835,24 +943,43 @@ void homeform::Start()
     if(!paused && !stopped)
     {
         paused = true;
-        if(bluetoothManager->device())
-            bluetoothManager->device()->stop();
+        onDevice([](bluetoothdevice* d) {d->stop();});
     }
     else
     {
         trainProgram->restart();
-        if(bluetoothManager->device())
-            bluetoothManager->device()->start();
+        onDevice([](bluetoothdevice* d) {d->start();});
 
         if(stopped)
         {
-            if(bluetoothManager->device())
-                bluetoothManager->device()->clearStats();
+            onDevice([](bluetoothdevice* d) {d->clearStats();});
             Session.clear();
-            chartImagesFilenames.clear();
+            workoutModel->reset();
+            powerCurve.clear();
+            heartCurve.clear();
+            speedCurve.clear();
+            lapAnalyzer.clear();
 
             stravaPelotonActivityName = "";
             stravaPelotonInstructorName = "";
+
+            journal.open(journalFileName(), bluetoothManager->device() ? bluetoothManager->device()->deviceType() : bluetoothdevice::UNKNOWN);
+            QFile::remove(journalTrainProgramFileName());
+            if(trainProgram->rows.length())
+                trainprogram::saveXML(journalTrainProgramFileName(), trainProgram->rows);
+        }
+        else if(resumePending && bluetoothManager->device())
+        {
+            resumePending = false;
+            const QList<SessionLine> session = Session;
+            const uint32_t moving = resumeState.moving;
+            const double jouls = resumeState.jouls;
+            onDevice([session, moving, jouls](bluetoothdevice* d) {
+                d->clearStats();
+                d->resume(session, moving, jouls);
+            });
+            if(resumeState.trainProgramTicks > 0)
+                trainProgram->seek(resumeState.trainProgramTicks);
         }
 
         paused = false;
@@ -870,24 +997,30 @@ void homeform::Start()
         emit startColorChanged(startColor());
     }
 
-    if(bluetoothManager->device())
-        bluetoothManager->device()->setPaused(paused | stopped);
+    const bool p = paused | stopped;
+    onDevice([p](bluetoothdevice* d) {d->setPaused(p);});
 }
 
 void homeform::Stop()
 {
     qDebug() << "Stop pressed - paused" << paused << "stopped" << stopped;
 
-    if(bluetoothManager->device())
-        bluetoothManager->device()->stop();
+    onDevice([](bluetoothdevice* d) {d->stop();});
 
     paused = false;
     stopped = true;    
 
     fit_save_clicked();
+    // after the fit file, it's attached to the mail
+    sendMail();
+    journal.finish();
+    if(tracing::enabled())
+        tracing::dump(getWritableAppDir() + "trace_" + QDateTime::currentDateTime().toString().replace(":", "_") + ".json");
+    workoutModel->reset();
+    resumePending = false;
 
-    if(bluetoothManager->device())
-        bluetoothManager->device()->setPaused(paused | stopped);
+    const bool p = paused | stopped;
+    onDevice([p](bluetoothdevice* d) {d->setPaused(p);});
 
     QSettings settings;
     if(settings.value("top_bar_enabled", true).toBool())
@@ -911,7 +1044,7 @@ void homeform::Lap()
     {
         if(bluetoothManager->device())
         {
-            bluetoothManager->device()->setLap();
+            onDevice([](bluetoothdevice* d) {d->setLap();});
             lapTrigger = true;
         }
     }
@@ -970,7 +1103,7 @@ QString homeform::signal()
     if(!bluetoothManager->device())
         return "icons/icons/signal-1.png";
 
-    int16_t rssi = bluetoothManager->device()->bluetoothDevice.rssi();
+    int16_t rssi = bluetoothManager->device()->lastSample().rssi;
     if(rssi > -40)
         return "icons/icons/signal-3.png";
     else if(rssi > -60)
@@ -981,8 +1114,8 @@ QString homeform::signal()
 
 void homeform::update()
 {
+    TRACE_SPAN("homeform::update");
     QSettings settings;
-    uint8_t currentHRZone = 1;
 
     if((paused || stopped) && settings.value("top_bar_enabled", true).toBool())
     {
@@ -1011,68 +1144,71 @@ void homeform::update()
 
         emit signalChanged(signal());
 
-        speed->setValue(QString::number(bluetoothManager->device()->currentSpeed().value() * unit_conversion, 'f', 1));
-        speed->setSecondLine("AVG: " + QString::number((bluetoothManager->device())->currentSpeed().average() * unit_conversion, 'f', 1) + " MAX: " + QString::number((bluetoothManager->device())->currentSpeed().max() * unit_conversion, 'f', 1));
-        heart->setValue(QString::number(bluetoothManager->device()->currentHeart().value(), 'f', 0));        
-        odometer->setValue(QString::number(bluetoothManager->device()->odometer() * unit_conversion, 'f', 2));
-        calories->setValue(QString::number(bluetoothManager->device()->calories(), 'f', 0));
-        fan->setValue(QString::number(bluetoothManager->device()->fanSpeed()));
-        jouls->setValue(QString::number(bluetoothManager->device()->jouls().value() / 1000.0, 'f', 1));
-        elapsed->setValue(bluetoothManager->device()->elapsedTime().toString("h:mm:ss"));
-        moving_time->setValue(bluetoothManager->device()->movingTime().toString("h:mm:ss"));
+        // the device can live on the bluetooth thread, so the live values come from its published sample
+        bluetoothdevicesample sample = bluetoothManager->device()->lastSample();
+
+        speed->setValue(QString::number(sample.speed.value * unit_conversion, 'f', 1));
+        speed->setSecondLine("AVG: " + QString::number(sample.speed.average * unit_conversion, 'f', 1) + " MAX: " + QString::number(sample.speed.max * unit_conversion, 'f', 1));
+        heart->setValue(QString::number(sample.heart.value, 'f', 0));
+        odometer->setValue(QString::number(sample.odometer * unit_conversion, 'f', 2));
+        calories->setValue(QString::number(sample.calories, 'f', 0));
+        fan->setValue(QString::number(sample.fanSpeed));
+        jouls->setValue(QString::number(sample.jouls / 1000.0, 'f', 1));
+        elapsed->setValue(QTime(0, 0).addSecs(sample.elapsed).toString("h:mm:ss"));
+        moving_time->setValue(QTime(0, 0).addSecs(sample.moving).toString("h:mm:ss"));
         if(trainProgram)
             peloton_offset->setValue(QString::number(trainProgram->offsetElapsedTime()) + " sec.");
-        lapElapsed->setValue(bluetoothManager->device()->lapElapsedTime().toString("h:mm:ss"));
-        avgWatt->setValue(QString::number(bluetoothManager->device()->wattsMetric().average(), 'f', 0));
+        lapElapsed->setValue(QTime(0, 0).addSecs(sample.lapElapsed).toString("h:mm:ss"));
+        avgWatt->setValue(QString::number(sample.watt.average, 'f', 0));
         datetime->setValue(QTime::currentTime().toString("hh:mm:ss"));
-        watts = bluetoothManager->device()->wattsMetric().value();
+        watts = sample.watt.value;
         watt->setValue(QString::number(watts));
-        weightLoss->setValue(QString::number(miles?bluetoothManager->device()->weightLoss() * 35.274:bluetoothManager->device()->weightLoss(), 'f', 2));
+        weightLoss->setValue(QString::number(miles?sample.weightLoss * 35.274:sample.weightLoss, 'f', 2));
 
-        if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
+        if(sample.type == bluetoothdevice::TREADMILL)
         {
-            if(bluetoothManager->device()->currentSpeed().value())
+            if(sample.speed.value && sample.pace)
             {
-                pace = 10000 / (((treadmill*)bluetoothManager->device())->currentPace().second() + (((treadmill*)bluetoothManager->device())->currentPace().minute() * 60));
+                pace = 10000 / sample.pace;
                 if(pace < 0) pace = 0;
             }
             else
             {
                 pace = 0;
             }
-            inclination = ((treadmill*)bluetoothManager->device())->currentInclination().value();
-            this->pace->setValue(((treadmill*)bluetoothManager->device())->currentPace().toString("m:ss"));
-            this->pace->setSecondLine("AVG: " + ((treadmill*)bluetoothManager->device())->averagePace().toString("m:ss") + " MAX: " + ((treadmill*)bluetoothManager->device())->maxPace().toString("m:ss"));
+            inclination = sample.treadmill.inclination.value;
+            this->pace->setValue(QTime(0, 0).addSecs(sample.pace).toString("m:ss"));
+            this->pace->setSecondLine("AVG: " + QTime(0, 0).addSecs(sample.averagePace).toString("m:ss") + " MAX: " + QTime(0, 0).addSecs(sample.maxPace).toString("m:ss"));
             this->inclination->setValue(QString::number(inclination, 'f', 1));
-            this->inclination->setSecondLine("AVG: " + QString::number(((treadmill*)bluetoothManager->device())->currentInclination().average(), 'f', 1) + " MAX: " + QString::number(((treadmill*)bluetoothManager->device())->currentInclination().max(), 'f', 1));
-            elevation->setValue(QString::number(((treadmill*)bluetoothManager->device())->elevationGain(), 'f', 1));
+            this->inclination->setSecondLine("AVG: " + QString::number(sample.treadmill.inclination.average, 'f', 1) + " MAX: " + QString::number(sample.treadmill.inclination.max, 'f', 1));
+            elevation->setValue(QString::number(sample.elevationGain, 'f', 1));
 
-            if(bluetoothManager->device()->currentSpeed().value() < 9)
+            if(sample.speed.value < 9)
             {
                 speed->setValueFontColor("white");
                 this->pace->setValueFontColor("white");
             }
-            else if(bluetoothManager->device()->currentSpeed().value() < 10)
+            else if(sample.speed.value < 10)
             {
                 speed->setValueFontColor("limegreen");
                 this->pace->setValueFontColor("limegreen");
             }
-            else if(bluetoothManager->device()->currentSpeed().value() < 11)
+            else if(sample.speed.value < 11)
             {
                 speed->setValueFontColor("gold");
                 this->pace->setValueFontColor("gold");
             }
-            else if(bluetoothManager->device()->currentSpeed().value() < 12)
+            else if(sample.speed.value < 12)
             {
                 speed->setValueFontColor("orange");
                 this->pace->setValueFontColor("orange");
             }
-            else if(bluetoothManager->device()->currentSpeed().value() < 13)
+            else if(sample.speed.value < 13)
             {
                 speed->setValueFontColor("darkorange");
                 this->pace->setValueFontColor("darkorange");
             }
-            else if(bluetoothManager->device()->currentSpeed().value() < 14)
+            else if(sample.speed.value < 14)
             {
                 speed->setValueFontColor("orangered");
                 this->pace->setValueFontColor("orangered");
@@ -1083,55 +1219,55 @@ void homeform::update()
                 this->pace->setValueFontColor("red");
             }
         }
-        else if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
+        else if(sample.type == bluetoothdevice::BIKE)
         {
-            cadence = ((bike*)bluetoothManager->device())->currentCadence().value();
-            resistance = ((bike*)bluetoothManager->device())->currentResistance().value();
-            peloton_resistance = ((bike*)bluetoothManager->device())->pelotonResistance().value();
+            cadence = sample.bike.cadence.value;
+            resistance = sample.bike.resistance.value;
+            peloton_resistance = sample.bike.pelotonResistance.value;
             this->peloton_resistance->setValue(QString::number(peloton_resistance, 'f', 0));
-            this->target_resistance->setValue(QString::number(((bike*)bluetoothManager->device())->lastRequestedResistance().value(), 'f', 0));
-            this->target_peloton_resistance->setValue(QString::number(((bike*)bluetoothManager->device())->lastRequestedPelotonResistance().value(), 'f', 0));
-            this->target_cadence->setValue(QString::number(((bike*)bluetoothManager->device())->lastRequestedCadence().value(), 'f', 0));
-            this->target_power->setValue(QString::number(((bike*)bluetoothManager->device())->lastRequestedPower().value(), 'f', 0));
+            this->target_resistance->setValue(QString::number(sample.bike.requestedResistance, 'f', 0));
+            this->target_peloton_resistance->setValue(QString::number(sample.bike.requestedPelotonResistance, 'f', 0));
+            this->target_cadence->setValue(QString::number(sample.bike.requestedCadence, 'f', 0));
+            this->target_power->setValue(QString::number(sample.bike.requestedPower, 'f', 0));
             this->resistance->setValue(QString::number(resistance, 'f', 0));
             this->cadence->setValue(QString::number(cadence));
 
-            this->cadence->setSecondLine("AVG: " + QString::number(((bike*)bluetoothManager->device())->currentCadence().average(), 'f', 0) + " MAX: " + QString::number(((bike*)bluetoothManager->device())->currentCadence().max(), 'f', 0));
-            this->resistance->setSecondLine("AVG: " + QString::number(((bike*)bluetoothManager->device())->currentResistance().average(), 'f', 0) + " MAX: " + QString::number(((bike*)bluetoothManager->device())->currentResistance().max(), 'f', 0));
-            this->peloton_resistance->setSecondLine("AVG: " + QString::number(((bike*)bluetoothManager->device())->pelotonResistance().average(), 'f', 0) + " MAX: " + QString::number(((bike*)bluetoothManager->device())->pelotonResistance().max(), 'f', 0));
-            this->target_resistance->setSecondLine(QString::number(bluetoothManager->device()->difficult() * 100.0,'f', 0) + "% @0%=" + QString::number(bluetoothManager->device()->difficult() * settings.value("bike_resistance_gain_f", 1.0).toDouble() * settings.value("bike_resistance_offset", 4.0).toDouble(),'f', 0));
+            this->cadence->setSecondLine("AVG: " + QString::number(sample.bike.cadence.average, 'f', 0) + " MAX: " + QString::number(sample.bike.cadence.max, 'f', 0));
+            this->resistance->setSecondLine("AVG: " + QString::number(sample.bike.resistance.average, 'f', 0) + " MAX: " + QString::number(sample.bike.resistance.max, 'f', 0));
+            this->peloton_resistance->setSecondLine("AVG: " + QString::number(sample.bike.pelotonResistance.average, 'f', 0) + " MAX: " + QString::number(sample.bike.pelotonResistance.max, 'f', 0));
+            this->target_resistance->setSecondLine(QString::number(sample.difficult * 100.0,'f', 0) + "% @0%=" + QString::number(sample.difficult * settings.value("bike_resistance_gain_f", 1.0).toDouble() * settings.value("bike_resistance_offset", 4.0).toDouble(),'f', 0));
         }
-        else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
+        else if(sample.type == bluetoothdevice::ROWING)
         {
-            cadence = ((rower*)bluetoothManager->device())->currentCadence().value();
-            resistance = ((rower*)bluetoothManager->device())->currentResistance().value();
-            peloton_resistance = ((rower*)bluetoothManager->device())->pelotonResistance().value();
+            cadence = sample.bike.cadence.value;
+            resistance = sample.bike.resistance.value;
+            peloton_resistance = sample.bike.pelotonResistance.value;
             this->peloton_resistance->setValue(QString::number(peloton_resistance, 'f', 0));
-            this->target_resistance->setValue(QString::number(((rower*)bluetoothManager->device())->lastRequestedResistance().value(), 'f', 0));
-            this->target_peloton_resistance->setValue(QString::number(((rower*)bluetoothManager->device())->lastRequestedPelotonResistance().value(), 'f', 0));
-            this->target_cadence->setValue(QString::number(((rower*)bluetoothManager->device())->lastRequestedCadence().value(), 'f', 0));
-            this->target_power->setValue(QString::number(((rower*)bluetoothManager->device())->lastRequestedPower().value(), 'f', 0));
+            this->target_resistance->setValue(QString::number(sample.bike.requestedResistance, 'f', 0));
+            this->target_peloton_resistance->setValue(QString::number(sample.bike.requestedPelotonResistance, 'f', 0));
+            this->target_cadence->setValue(QString::number(sample.bike.requestedCadence, 'f', 0));
+            this->target_power->setValue(QString::number(sample.bike.requestedPower, 'f', 0));
             this->resistance->setValue(QString::number(resistance, 'f', 0));
             this->cadence->setValue(QString::number(cadence));
 
-            this->cadence->setSecondLine("AVG: " + QString::number(((rower*)bluetoothManager->device())->currentCadence().average(), 'f', 0) + " MAX: " + QString::number(((rower*)bluetoothManager->device())->currentCadence().max(), 'f', 0));
-            this->resistance->setSecondLine("AVG: " + QString::number(((rower*)bluetoothManager->device())->currentResistance().average(), 'f', 0) + " MAX: " + QString::number(((rower*)bluetoothManager->device())->currentResistance().max(), 'f', 0));
-            this->peloton_resistance->setSecondLine("AVG: " + QString::number(((rower*)bluetoothManager->device())->pelotonResistance().average(), 'f', 0) + " MAX: " + QString::number(((rower*)bluetoothManager->device())->pelotonResistance().max(), 'f', 0));
-            this->target_resistance->setSecondLine(QString::number(bluetoothManager->device()->difficult() * 100.0,'f', 0) + "% @0%=" + QString::number(bluetoothManager->device()->difficult() * settings.value("bike_resistance_gain_f", 1.0).toDouble() * settings.value("bike_resistance_offset", 4.0).toDouble(),'f', 0));
+            this->cadence->setSecondLine("AVG: " + QString::number(sample.bike.cadence.average, 'f', 0) + " MAX: " + QString::number(sample.bike.cadence.max, 'f', 0));
+            this->resistance->setSecondLine("AVG: " + QString::number(sample.bike.resistance.average, 'f', 0) + " MAX: " + QString::number(sample.bike.resistance.max, 'f', 0));
+            this->peloton_resistance->setSecondLine("AVG: " + QString::number(sample.bike.pelotonResistance.average, 'f', 0) + " MAX: " + QString::number(sample.bike.pelotonResistance.max, 'f', 0));
+            this->target_resistance->setSecondLine(QString::number(sample.difficult * 100.0,'f', 0) + "% @0%=" + QString::number(sample.difficult * settings.value("bike_resistance_gain_f", 1.0).toDouble() * settings.value("bike_resistance_offset", 4.0).toDouble(),'f', 0));
         }
-        else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
+        else if(sample.type == bluetoothdevice::ELLIPTICAL)
         {
-            cadence = ((elliptical*)bluetoothManager->device())->currentCadence();
-            resistance = ((elliptical*)bluetoothManager->device())->currentResistance();
+            cadence = sample.elliptical.cadence;
+            resistance = sample.elliptical.resistance;
             //this->peloton_resistance->setValue(QString::number(((elliptical*)bluetoothManager->device())->pelotonResistance(), 'f', 0));
             this->resistance->setValue(QString::number(resistance));
             this->cadence->setValue(QString::number(cadence));
-            inclination = ((elliptical*)bluetoothManager->device())->currentInclination().value();
+            inclination = sample.elliptical.inclination.value;
             this->inclination->setValue(QString::number(inclination, 'f', 1));
-            this->inclination->setSecondLine("AVG: " + QString::number(((elliptical*)bluetoothManager->device())->currentInclination().average(), 'f', 1) + " MAX: " + QString::number(((elliptical*)bluetoothManager->device())->currentInclination().max(), 'f', 1));
-            elevation->setValue(QString::number(((elliptical*)bluetoothManager->device())->elevationGain(), 'f', 1));
+            this->inclination->setSecondLine("AVG: " + QString::number(sample.elliptical.inclination.average, 'f', 1) + " MAX: " + QString::number(sample.elliptical.inclination.max, 'f', 1));
+            elevation->setValue(QString::number(sample.elevationGain, 'f', 1));
         }
-        watt->setSecondLine("AVG: " + QString::number((bluetoothManager->device())->wattsMetric().average(), 'f', 0) + " MAX: " + QString::number((bluetoothManager->device())->wattsMetric().max(), 'f', 0));
+        watt->setSecondLine("AVG: " + QString::number(sample.watt.average, 'f', 0) + " MAX: " + QString::number(sample.watt.max, 'f', 0));
 
         double ftpPerc = 0;
         double ftpZone = 1;
@@ -1194,39 +1330,53 @@ void homeform::update()
         QString Z;
         double maxHeartRate = 220.0 - settings.value("age", 35).toDouble();
         if(maxHeartRate == 0) maxHeartRate = 190.0;
-        double percHeartRate = (bluetoothManager->device()->currentHeart().value() * 100) / maxHeartRate;
+        double percHeartRate = (sample.heart.value * 100) / maxHeartRate;
 
         if(percHeartRate < settings.value("heart_rate_zone1", 70.0).toDouble())
         {
             Z = "Z1";
-            currentHRZone = 1;
             heart->setValueFontColor("lightsteelblue");
         }
         else if(percHeartRate < settings.value("heart_rate_zone2", 80.0).toDouble())
         {
             Z = "Z2";
-            currentHRZone = 2;
             heart->setValueFontColor("green");
         }
         else if(percHeartRate < settings.value("heart_rate_zone3", 90.0).toDouble())
         {
             Z = "Z3";
-            currentHRZone = 3;
             heart->setValueFontColor("yellow");
         }
         else if(percHeartRate < settings.value("heart_rate_zone4", 100.0).toDouble())
         {
             Z = "Z4";
-            currentHRZone = 4;
             heart->setValueFontColor("orange");
         }
         else
         {
             Z = "Z5";
-            currentHRZone = 5;
             heart->setValueFontColor("red");
         }
-        heart->setSecondLine(Z + " AVG: " + QString::number((bluetoothManager->device())->currentHeart().average(), 'f', 0) + " MAX: " + QString::number((bluetoothManager->device())->currentHeart().max(), 'f', 0));
+        heart->setSecondLine(Z + " AVG: " + QString::number(sample.heart.average, 'f', 0) + " MAX: " + QString::number(sample.heart.max, 'f', 0));
+
+        // DFA-alpha1 crosses 0.75 at the aerobic threshold and 0.5 at the anaerobic one
+        hrv->setValue(QString::number(sample.rmssd, 'f', 0));
+        hrv->setSecondLine("SDNN: " + QString::number(sample.sdnn, 'f', 0) + " a1: " + QString::number(sample.dfaAlpha1, 'f', 2));
+        switch(sample.hrvZone)
+        {
+        case 1:
+            hrv->setValueFontColor("green");
+            break;
+        case 2:
+            hrv->setValueFontColor("orange");
+            break;
+        case 3:
+            hrv->setValueFontColor("red");
+            break;
+        default:
+            hrv->setValueFontColor("white");
+            break;
+        }
 
 /*
         if(trainProgram)
@@ -1248,17 +1398,19 @@ void homeform::update()
 #ifdef Q_OS_ANDROID
         if(settings.value("ant_cadence", false).toBool() && KeepAwakeHelper::antObject(false))
         {
-            KeepAwakeHelper::antObject(false)->callMethod<void>("setCadenceSpeedPower","(FII)V", (float)bluetoothManager->device()->currentSpeed().value(), (int)watts, (int)cadence);
+            KeepAwakeHelper::antObject(false)->callMethod<void>("setCadenceSpeedPower","(FII)V", (float)sample.speed.value, (int)watts, (int)cadence);
         }
 #endif
 
+        double heartZoneTarget = 0;
+        double heartZoneMaximum = 0;
         if(settings.value("trainprogram_random", false).toBool())
         {
             if(!paused && !stopped)
             {
                 static QRandomGenerator r;
                 static uint32_t last_seconds = 0;
-                uint32_t seconds = bluetoothManager->device()->elapsedTime().second() + (bluetoothManager->device()->elapsedTime().minute() * 60) + (bluetoothManager->device()->elapsedTime().hour() * 3600);
+                uint32_t seconds = sample.elapsed;
                 if((seconds / 60) < settings.value("trainprogram_total", 60).toUInt())
                 {
                     qDebug() << "trainprogram random seconds " + QString::number(seconds) + " last_change " + last_seconds + " period " + settings.value("trainprogram_period_seconds", 60).toUInt();
@@ -1266,7 +1418,7 @@ void homeform::update()
                     {
                         bool done = false;
 
-                        if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL && ((treadmill*)bluetoothManager->device())->currentSpeed().value() > 0.0f)
+                        if(sample.type == bluetoothdevice::TREADMILL && sample.speed.value > 0.0f)
                         {
                             double speed = settings.value("trainprogram_speed_min", 8).toUInt();
                             double incline = settings.value("trainprogram_incline_min", 0).toUInt();
@@ -1279,28 +1431,28 @@ void homeform::update()
                             {
                                 incline = (double)r.bounded(settings.value("trainprogram_incline_min", 0).toUInt() * 10, settings.value("trainprogram_incline_max", 15).toUInt() * 10) / 10.0;
                             }
-                            ((treadmill*)bluetoothManager->device())->changeSpeedAndInclination(speed, incline);
+                            onDevice([speed, incline](bluetoothdevice* d) {((treadmill*)d)->changeSpeedAndInclination(speed, incline);});
                             done = true;
                         }
-                        else if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
+                        else if(sample.type == bluetoothdevice::BIKE)
                         {
                             double resistance = settings.value("trainprogram_resistance_min", 1).toUInt();
                             if(settings.value("trainprogram_resistance_min", 1).toUInt() < settings.value("trainprogram_resistance_max", 32).toUInt())
                             {
                                 resistance = (double)r.bounded(settings.value("trainprogram_resistance_min", 1).toUInt(), settings.value("trainprogram_resistance_max", 32).toUInt());
                             }
-                            ((bike*)bluetoothManager->device())->changeResistance(resistance);
+                            onDevice([resistance](bluetoothdevice* d) {((bike*)d)->changeResistance(resistance);});
 
                             done = true;
                         }
-                        else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
+                        else if(sample.type == bluetoothdevice::ROWING)
                         {
                             double resistance = settings.value("trainprogram_resistance_min", 1).toUInt();
                             if(settings.value("trainprogram_resistance_min", 1).toUInt() < settings.value("trainprogram_resistance_max", 32).toUInt())
                             {
                                 resistance = (double)r.bounded(settings.value("trainprogram_resistance_min", 1).toUInt(), settings.value("trainprogram_resistance_max", 32).toUInt());
                             }
-                            ((rower*)bluetoothManager->device())->changeResistance(resistance);
+                            onDevice([resistance](bluetoothdevice* d) {((rower*)d)->changeResistance(resistance);});
 
                             done = true;
                         }
@@ -1317,113 +1469,72 @@ void homeform::update()
                         }
                     }
                 }
-                else if(bluetoothManager->device()->currentSpeed().value() > 0)
+                else if(sample.speed.value > 0)
                 {
-                    if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
+                    if(sample.type == bluetoothdevice::TREADMILL)
                     {
-                        ((treadmill*)bluetoothManager->device())->changeSpeedAndInclination(0,0);
+                        onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeSpeedAndInclination(0,0);});
                     }
-                    else if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
+                    else if(sample.type == bluetoothdevice::BIKE)
                     {
-                        ((bike*)bluetoothManager->device())->changeResistance(1);
+                        onDevice([](bluetoothdevice* d) {((bike*)d)->changeResistance(1);});
                     }
-                    else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
+                    else if(sample.type == bluetoothdevice::ROWING)
                     {
-                        ((rower*)bluetoothManager->device())->changeResistance(1);
+                        onDevice([](bluetoothdevice* d) {((rower*)d)->changeResistance(1);});
                     }
                 }
             }
         }
         else if(!settings.value("treadmill_pid_heart_zone", "Disabled").toString().contains("Disabled") ||
                 (trainProgram && trainProgram->currentRow().zoneHR > 0))
-        {            
-            static uint32_t last_seconds_pid_heart_zone = 0;
-            uint32_t seconds = bluetoothManager->device()->elapsedTime().second() + (bluetoothManager->device()->elapsedTime().minute() * 60) + (bluetoothManager->device()->elapsedTime().hour() * 3600);
-            uint8_t delta = 10;
+        {
+            // the device runs the controller on every heart rate sample, here only the target is chosen
             bool fromTrainProgram = trainProgram && trainProgram->currentRow().zoneHR > 0;
-            int8_t maxSpeed = 30;
-
+            uint8_t zone = settings.value("treadmill_pid_heart_zone", "Disabled").toString().toUInt();
             if(fromTrainProgram)
-                delta = trainProgram->currentRow().loopTimeHR;
-
-            if(last_seconds_pid_heart_zone == 0 || ((seconds - last_seconds_pid_heart_zone) >= delta))
             {
-                last_seconds_pid_heart_zone = seconds;
-                uint8_t zone = settings.value("treadmill_pid_heart_zone", "Disabled").toString().toUInt();
-                if(fromTrainProgram)
-                {
-                    zone = trainProgram->currentRow().zoneHR;
-                    if(trainProgram->currentRow().maxSpeed > 0)
-                        maxSpeed = trainProgram->currentRow().maxSpeed;
-                }
+                zone = trainProgram->currentRow().zoneHR;
+                if(sample.type == bluetoothdevice::TREADMILL && trainProgram->currentRow().maxSpeed > 0)
+                    heartZoneMaximum = trainProgram->currentRow().maxSpeed;
+            }
 
-                if(!stopped && !paused &&
-                        bluetoothManager->device()->currentHeart().value() &&
-                        bluetoothManager->device()->currentSpeed().value() > 0.0f)
-                {
-                    if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
-                    {
-                        const double step = 0.2;
-                        double currentSpeed = ((treadmill*)bluetoothManager->device())->currentSpeed().value();
-                        if(zone < currentHRZone)
-                        {
-                            ((treadmill*)bluetoothManager->device())->changeSpeedAndInclination(
-                                        currentSpeed - step,
-                                        ((treadmill*)bluetoothManager->device())->currentInclination().value());
-                        }
-                        else if(zone > currentHRZone && maxSpeed >= currentSpeed + step)
-                        {
-                            ((treadmill*)bluetoothManager->device())->changeSpeedAndInclination(
-                                        currentSpeed + step,
-                                        ((treadmill*)bluetoothManager->device())->currentInclination().value());
-                        }
-                    }
-                    else if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
-                    {
-                        const int step = 1;
-                        int8_t currentResistance = ((bike*)bluetoothManager->device())->currentResistance().value();
-                        if(zone < currentHRZone)
-                        {
-                            ((bike*)bluetoothManager->device())->changeResistance(currentResistance - step);
-                        }
-                        else if(zone > currentHRZone)
-                        {
-                            ((bike*)bluetoothManager->device())->changeResistance(currentResistance + step);
-                        }
-                    }
-                    else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
-                    {
-                        const int step = 1;
-                        int8_t currentResistance = ((rower*)bluetoothManager->device())->currentResistance().value();
-                        if(zone < currentHRZone)
-                        {
-                            ((rower*)bluetoothManager->device())->changeResistance(currentResistance - step);
-                        }
-                        else if(zone > currentHRZone)
-                        {
-                            ((rower*)bluetoothManager->device())->changeResistance(currentResistance + step);
-                        }
-                    }
-                }
+            if(!stopped && !paused &&
+                    sample.heart.value &&
+                    sample.speed.value > 0.0f &&
+                    sample.type != bluetoothdevice::ELLIPTICAL)
+            {
+                heartZoneTarget = hrzonecontroller::zoneTarget(zone);
             }
         }
+        onDevice([heartZoneTarget, heartZoneMaximum](bluetoothdevice* d) {d->setHeartZoneTarget(heartZoneTarget, heartZoneMaximum);});
 
         if(!stopped && !paused)
         {
             SessionLine s(
-                        bluetoothManager->device()->currentSpeed().value(),
+                        sample.speed.value,
                         inclination,
-                        bluetoothManager->device()->odometer(),
+                        sample.odometer,
                         watts,
                         resistance,
                         peloton_resistance,
-                        (uint8_t)bluetoothManager->device()->currentHeart().value(),
-                        pace, cadence, bluetoothManager->device()->calories(),
-                        bluetoothManager->device()->elevationGain(),
-                        bluetoothManager->device()->elapsedTime().second() + (bluetoothManager->device()->elapsedTime().minute() * 60) + (bluetoothManager->device()->elapsedTime().hour() * 3600),
+                        (uint8_t)sample.heart.value,
+                        pace, cadence, sample.calories,
+                        sample.elevationGain,
+                        sample.elapsed,
                         lapTrigger);
+            s.rmssd = sample.rmssd;
+            s.sdnn = sample.sdnn;
+            s.dfaAlpha1 = sample.dfaAlpha1;
 
             Session.append(s);
+            powerCurve.addSample(s.watt);
+            heartCurve.addSample(s.heart);
+            speedCurve.addSample(s.speed);
+            const bool program = trainProgram && trainProgram->rows.length();
+            lapAnalyzer.addSample(s, program ? trainProgram->currentRowIndex() : -1);
+            journal.append(s, sample.moving, sample.jouls, program ? trainProgram->elapsedTicks() : -1,
+                           program ? trainProgram->currentRowIndex() : -1);
 
             if(lapTrigger)
                 lapTrigger = false;
@@ -1443,7 +1554,7 @@ bool homeform::getDevice()
         toggle = !toggle;
         return toggle;
     }
-    return this->bluetoothManager->device()->connected();
+    return this->bluetoothManager->device()->lastSample().connected;
 }
 
 bool homeform::getLap()
@@ -1485,7 +1596,7 @@ void homeform::fit_save_clicked()
     if(dev)
     {
         QString filename = path + QDateTime::currentDateTime().toString().replace(":", "_") + ".fit";
-        qfit::save(filename, Session, dev->deviceType(), qobject_cast<m3ibike*>(dev)?QFIT_PROCESS_DISTANCENOISE:QFIT_PROCESS_NONE);
+        qfit::save(filename, Session, dev->deviceType(), qobject_cast<m3ibike*>(dev)?QFIT_PROCESS_DISTANCENOISE:QFIT_PROCESS_NONE, lapAnalyzer.laps(), lapAnalyzer.steps());
         lastFitFileSaved = filename;
 
         QSettings settings;
@@ -1947,6 +2058,72 @@ void homeform::smtpError(SmtpClient::SmtpError e)
     qDebug() << "SMTP ERROR" << e;
 }
 
+// renders the charts of the session and sends the workout mail, the smtp client blocks on its socket
+class workoutmailtask : public QRunnable
+{
+public:
+    workoutmailtask(homeform* form, const QString& recipient, const QString& subject, const QString& text,
+                    const QList<SessionLine>& session, const QString& chartPrefix, const QString& fitFile) :
+        form(form), recipient(recipient), subject(subject), text(text), charts(session), render(session.length() > 0),
+        chartPrefix(chartPrefix), fitFile(fitFile) {}
+
+    void run() override
+    {
+#if defined(SMTP_SERVER) && defined(SMTP_PASSWORD)
+#define _STR(x) #x
+#define STRINGIFY(x)  _STR(x)
+        SmtpClient smtp(STRINGIFY(SMTP_SERVER), 587, SmtpClient::TlsConnection);
+        QObject::connect(&smtp, SIGNAL(smtpError(SmtpClient::SmtpError)), form, SLOT(smtpError(SmtpClient::SmtpError)));
+        smtp.setUser(STRINGIFY(SMTP_USERNAME));
+        smtp.setPassword(STRINGIFY(SMTP_PASSWORD));
+
+        MimeMessage message;
+        message.setSender(new EmailAddress("no-reply@qzapp.it", "QZ"));
+        message.addRecipient(new EmailAddress(recipient, recipient));
+        message.setSubject(subject);
+
+        MimeText mimeText;
+        mimeText.setText(text);
+        message.addPart(&mimeText);
+
+        // the charts are drawn from the session, the charts page doesn't need to be on screen
+        const QStringList images = render ? charts.render(chartPrefix) : QStringList();
+        foreach(QString f, images)
+        {
+            MimeInlineFile* image = new MimeInlineFile((new QFile(f)));
+            // An unique content id must be setted
+            image->setContentId(f);
+            image->setContentType("image/jpg");
+            message.addPart(image);
+        }
+
+        if(fitFile.length())
+        {
+            MimeInlineFile* fit = new MimeInlineFile((new QFile(fitFile)));
+            fit->setContentId(fitFile);
+            fit->setContentType("application/octet-stream");
+            message.addPart(fit);
+        }
+
+        smtp.connectToHost();
+        smtp.login();
+        smtp.sendMail(message);
+        smtp.quit();
+        qDebug() << "workout mail sent with" << images.length() << "charts";
+#endif
+    }
+
+private:
+    homeform* form;
+    QString recipient;
+    QString subject;
+    QString text;
+    chartrenderer charts; // built on the GUI thread, it reads the settings
+    bool render;
+    QString chartPrefix;
+    QString fitFile;
+};
+
 void homeform::sendMail()
 {
     QSettings settings;
@@ -1956,7 +2133,6 @@ void homeform::sendMail()
     QString weightLossUnit = "Kg";
     double WeightLoss = 0;
 
-    // TODO: add a condition to avoid sending mail when the user look at the chart while is riding
     if(settings.value("user_email","").toString().length() == 0 || !bluetoothManager->device())
         return;
 
@@ -1965,58 +2141,21 @@ void homeform::sendMail()
         unit_conversion = 0.621371;
         weightLossUnit = "Oz";        
     }
-    WeightLoss = (miles?bluetoothManager->device()->weightLoss()*35.274:bluetoothManager->device()->weightLoss());
+    const bluetoothdevicesample sample = bluetoothManager->device()->lastSample();
+    WeightLoss = (miles?sample.weightLoss*35.274:sample.weightLoss);
 
-#ifdef SMTP_SERVER
-#define _STR(x) #x
-#define STRINGIFY(x)  _STR(x)
-    SmtpClient smtp(STRINGIFY(SMTP_SERVER), 587, SmtpClient::TlsConnection);
-    connect(&smtp, SIGNAL(smtpError(SmtpClient::SmtpError)), this, SLOT(smtpError(SmtpClient::SmtpError)));
-#else
-#warning "stmp server is unset!"
-    SmtpClient smtp("",25, SmtpClient::TlsConnection);
+#if !defined(SMTP_SERVER) || !defined(SMTP_PASSWORD)
+#warning "smtp server or credentials are unset!"
     return;
 #endif
 
-    // We need to set the username (your email address) and the password
-    // for smtp authentification.
-#ifdef SMTP_PASSWORD
-#define _STR(x) #x
-#define STRINGIFY(x)  _STR(x)
-    smtp.setUser(STRINGIFY(SMTP_USERNAME));
-#else
-    #warning "smtp username is unset!"
-    return;
-#endif
-#ifdef SMTP_PASSWORD
-#define _STR(x) #x
-#define STRINGIFY(x)  _STR(x)
-    smtp.setPassword(STRINGIFY(SMTP_PASSWORD));
-#else
-#warning "smtp password is unset!"
-    return;
-#endif
-
-    // Now we create a MimeMessage object. This will be the email.
-
-    MimeMessage message;
-
-    message.setSender(new EmailAddress("no-reply@qzapp.it", "QZ"));
-    message.addRecipient(new EmailAddress(settings.value("user_email","").toString(), settings.value("user_email","").toString()));
+    QString subject = "Test";
     if(Session.length())
     {
-        QString title = Session.first().time.toString();
+        subject = Session.first().time.toString();
         if(stravaPelotonActivityName.length())
-            title += " " + stravaPelotonActivityName + " - " + stravaPelotonInstructorName;
-        message.setSubject(title);
+            subject += " " + stravaPelotonActivityName + " - " + stravaPelotonInstructorName;
     }
-    else
-        message.setSubject("Test");
-
-    // Now add some text to the email.
-    // First we create a MimeText object.
-
-    MimeText text;
 
     QString textMessage = "Great workout!\n\n";
 
@@ -2029,35 +2168,49 @@ void homeform::sendMail()
     }
 
     textMessage += '\n';
-    textMessage += "Average Speed: " + QString::number(bluetoothManager->device()->currentSpeed().average() * unit_conversion, 'f', 1) + "\n";
-    textMessage += "Max Speed: " + QString::number(bluetoothManager->device()->currentSpeed().max() * unit_conversion, 'f', 1) + "\n";
-    textMessage += "Calories burned: " + QString::number(bluetoothManager->device()->calories(), 'f', 0) + "\n";
-    textMessage += "Distance: " + QString::number(bluetoothManager->device()->odometer() * unit_conversion, 'f', 1) + "\n";
-    textMessage += "Average Watt: " + QString::number(bluetoothManager->device()->wattsMetric().average(), 'f', 0) + "\n";
-    textMessage += "Max Watt: " + QString::number(bluetoothManager->device()->wattsMetric().max(), 'f', 0) + "\n";
-    textMessage += "Average Heart Rate: " + QString::number(bluetoothManager->device()->currentHeart().average(), 'f', 0) + "\n";
-    textMessage += "Max Heart Rate: " + QString::number(bluetoothManager->device()->currentHeart().max(), 'f', 0) + "\n";
-    textMessage += "Total Output: " + QString::number(bluetoothManager->device()->jouls().max() / 1000.0, 'f', 0) + "\n";
-    textMessage += "Elapsed Time: " + bluetoothManager->device()->elapsedTime().toString() + "\n";
-    textMessage += "Moving Time: " + bluetoothManager->device()->movingTime().toString() + "\n";
+    textMessage += "Average Speed: " + QString::number(sample.speed.average * unit_conversion, 'f', 1) + "\n";
+    textMessage += "Max Speed: " + QString::number(sample.speed.max * unit_conversion, 'f', 1) + "\n";
+    textMessage += "Calories burned: " + QString::number(sample.calories, 'f', 0) + "\n";
+    textMessage += "Distance: " + QString::number(sample.odometer * unit_conversion, 'f', 1) + "\n";
+    textMessage += "Average Watt: " + QString::number(sample.watt.average, 'f', 0) + "\n";
+    textMessage += "Max Watt: " + QString::number(sample.watt.max, 'f', 0) + "\n";
+    textMessage += "Average Heart Rate: " + QString::number(sample.heart.average, 'f', 0) + "\n";
+    textMessage += "Max Heart Rate: " + QString::number(sample.heart.max, 'f', 0) + "\n";
+    textMessage += "Total Output: " + QString::number(sample.jouls / 1000.0, 'f', 0) + "\n";
+    textMessage += "Elapsed Time: " + QTime(0, 0).addSecs(sample.elapsed).toString() + "\n";
+    textMessage += "Moving Time: " + QTime(0, 0).addSecs(sample.moving).toString() + "\n";
     textMessage += "Weight Loss ("+ weightLossUnit +"): " + QString::number(WeightLoss, 'f', 2) + "\n";
-    if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
+    if(powerCurve.best(5) > 0)
     {
-        textMessage += "Average Cadence: " + QString::number(((bike*)bluetoothManager->device())->currentCadence().average(), 'f', 0) + "\n";
-        textMessage += "Max Cadence: " + QString::number(((bike*)bluetoothManager->device())->currentCadence().max(), 'f', 0) + "\n";
-        textMessage += "Average Resistance: " + QString::number(((bike*)bluetoothManager->device())->currentResistance().average(), 'f', 0) + "\n";
-        textMessage += "Max Resistance: " + QString::number(((bike*)bluetoothManager->device())->currentResistance().max(), 'f', 0) + "\n";
-        textMessage += "Average Peloton Resistance: " + QString::number(((bike*)bluetoothManager->device())->pelotonResistance().average(), 'f', 0) + "\n";
-        textMessage += "Max Peloton Resistance: " + QString::number(((bike*)bluetoothManager->device())->pelotonResistance().max(), 'f', 0) + "\n";
+        textMessage += "Best Power 5s/1m/5m/20m/60m: " + QString::number(powerCurve.best(5), 'f', 0) + "/" + QString::number(powerCurve.best(60), 'f', 0) + "/" +
+                QString::number(powerCurve.best(300), 'f', 0) + "/" + QString::number(powerCurve.best(1200), 'f', 0) + "/" + QString::number(powerCurve.best(3600), 'f', 0) + "\n";
     }
-    else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
+    if(heartCurve.best(5) > 0)
+    {
+        textMessage += "Best Heart Rate 5s/1m/5m/20m/60m: " + QString::number(heartCurve.best(5), 'f', 0) + "/" + QString::number(heartCurve.best(60), 'f', 0) + "/" +
+                QString::number(heartCurve.best(300), 'f', 0) + "/" + QString::number(heartCurve.best(1200), 'f', 0) + "/" + QString::number(heartCurve.best(3600), 'f', 0) + "\n";
+    }
+    if(speedCurve.best(5) > 0)
     {
-        textMessage += "Average Cadence: " + QString::number(((rower*)bluetoothManager->device())->currentCadence().average(), 'f', 0) + "\n";
-        textMessage += "Max Cadence: " + QString::number(((rower*)bluetoothManager->device())->currentCadence().max(), 'f', 0) + "\n";
-        textMessage += "Average Resistance: " + QString::number(((rower*)bluetoothManager->device())->currentResistance().average(), 'f', 0) + "\n";
-        textMessage += "Max Resistance: " + QString::number(((rower*)bluetoothManager->device())->currentResistance().max(), 'f', 0) + "\n";
-        textMessage += "Average Peloton Resistance: " + QString::number(((rower*)bluetoothManager->device())->pelotonResistance().average(), 'f', 0) + "\n";
-        textMessage += "Max Peloton Resistance: " + QString::number(((rower*)bluetoothManager->device())->pelotonResistance().max(), 'f', 0) + "\n";
+        textMessage += "Best Speed 5s/1m/5m/20m/60m: " + QString::number(speedCurve.best(5) * unit_conversion, 'f', 1) + "/" + QString::number(speedCurve.best(60) * unit_conversion, 'f', 1) + "/" +
+                QString::number(speedCurve.best(300) * unit_conversion, 'f', 1) + "/" + QString::number(speedCurve.best(1200) * unit_conversion, 'f', 1) + "/" + QString::number(speedCurve.best(3600) * unit_conversion, 'f', 1) + "\n";
+    }
+    foreach(lapsummary step, lapAnalyzer.steps())
+    {
+        if(step.step < 0)
+            continue;
+        textMessage += "Step " + QString::number(step.step + 1) + ": " + QTime(0, 0).addSecs(step.elapsed).toString() +
+                " avg " + QString::number(step.avgPower, 'f', 0) + "W " + QString::number(step.avgHeart, 'f', 0) + "bpm " +
+                QString::number(step.avgSpeed * unit_conversion, 'f', 1) + (miles ? "mi/h" : "km/h") + "\n";
+    }
+    if(sample.type == bluetoothdevice::BIKE || sample.type == bluetoothdevice::ROWING)
+    {
+        textMessage += "Average Cadence: " + QString::number(sample.bike.cadence.average, 'f', 0) + "\n";
+        textMessage += "Max Cadence: " + QString::number(sample.bike.cadence.max, 'f', 0) + "\n";
+        textMessage += "Average Resistance: " + QString::number(sample.bike.resistance.average, 'f', 0) + "\n";
+        textMessage += "Max Resistance: " + QString::number(sample.bike.resistance.max, 'f', 0) + "\n";
+        textMessage += "Average Peloton Resistance: " + QString::number(sample.bike.pelotonResistance.average, 'f', 0) + "\n";
+        textMessage += "Max Peloton Resistance: " + QString::number(sample.bike.pelotonResistance.max, 'f', 0) + "\n";
     }
     textMessage += "\n\nQZ version: " + QApplication::applicationVersion();
 #ifdef Q_OS_ANDROID
@@ -2068,43 +2221,16 @@ void homeform::sendMail()
 #endif
     if(bluetoothManager)
     {
-        textMessage += "\nDevice: " + bluetoothManager->device()->bluetoothDevice.name();
+        // saved by the bluetooth thread when the device connected
+        textMessage += "\nDevice: " + settings.value("bluetooth_lastdevice_name", "").toString();
         if(bluetoothManager->heartRateDevice())
             textMessage += "\nHR Device: " + bluetoothManager->heartRateDevice()->bluetoothDevice.name();
     }
 
-
-    text.setText(textMessage);
-    message.addPart(&text);
-
-    foreach(QString f, chartImagesFilenames)
-    {
-        // Create a MimeInlineFile object for each image
-        MimeInlineFile* image = new MimeInlineFile((new QFile(f)));
-
-        // An unique content id must be setted
-        image->setContentId(f);
-        image->setContentType("image/jpg");
-        message.addPart(image);
-    }
-
-    if(lastFitFileSaved.length())
-    {
-        // Create a MimeInlineFile object for each image
-        MimeInlineFile* fit = new MimeInlineFile((new QFile(lastFitFileSaved)));
-
-        // An unique content id must be setted
-        fit->setContentId(lastFitFileSaved);
-        fit->setContentType("application/octet-stream");
-        message.addPart(fit);
-    }
-
-    smtp.connectToHost();
-    smtp.login();
-    smtp.sendMail(message);
-    smtp.quit();
-
-    // delete image variable TODO
+    // the charts and the smtp session would block the GUI: both run on the thread pool
+    const QString chartPrefix = getWritableAppDir() + (Session.length() ? Session.first().time.toString().replace(":", "_") : QString()) + "_";
+    QThreadPool::globalInstance()->start(new workoutmailtask(this, settings.value("user_email","").toString(), subject, textMessage,
+                                                             Session, chartPrefix, lastFitFileSaved));
 }
 
 #if defined(Q_OS_ANDROID)
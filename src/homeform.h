@@ -9,11 +9,17 @@
 #include <QChart>
 #include <QColor>
 #include <QQuickItemGrabResult>
+#include <functional>
 #include "screencapture.h"
 #include "bluetooth.h"
 #include "sessionline.h"
+#include "sessionmodel.h"
 #include "trainprogram.h"
 #include "peloton.h"
+#include "meanmaxcurve.h"
+#include "lapanalyzer.h"
+#include "sessionjournal.h"
+#include "latencyhistogram.h"
 #include "smtpclient/src/SmtpMime"
 
 class DataObject : public QObject
@@ -84,6 +90,7 @@ class homeform: public QObject
     Q_PROPERTY( bool device READ getDevice NOTIFY changeOfdevice)
     Q_PROPERTY( bool lap READ getLap NOTIFY changeOflap)
     Q_PROPERTY( bool pelotonAskStart READ pelotonAskStart NOTIFY changePelotonAskStart WRITE setPelotonAskStart)
+    Q_PROPERTY( bool journalAskResume READ journalAskResume NOTIFY changeJournalAskResume WRITE setJournalAskResume)
     Q_PROPERTY(int topBarHeight READ topBarHeight NOTIFY topBarHeightChanged)
     Q_PROPERTY(QString info READ info NOTIFY infoChanged)    
     Q_PROPERTY(QString signal READ signal NOTIFY signalChanged)
@@ -103,11 +110,11 @@ class homeform: public QObject
     Q_PROPERTY(QString workoutName READ workoutName)
     Q_PROPERTY(QString instructorName READ instructorName)
     Q_PROPERTY(int workout_sample_points READ workout_sample_points)
-    Q_PROPERTY(QList<double> workout_watt_points READ workout_watt_points)
-    Q_PROPERTY(QList<double> workout_heart_points READ workout_heart_points)
-    Q_PROPERTY(QList<double> workout_cadence_points READ workout_cadence_points)
-    Q_PROPERTY(QList<double> workout_peloton_resistance_points READ workout_peloton_resistance_points)
-    Q_PROPERTY(QList<double> workout_resistance_points READ workout_resistance_points)
+    Q_PROPERTY(sessionmodel* workout_model READ workout_model CONSTANT)
+    Q_PROPERTY(QList<double> workout_power_curve_points READ workout_power_curve_points)
+    Q_PROPERTY(QList<double> workout_heart_curve_points READ workout_heart_curve_points)
+    Q_PROPERTY(QList<double> workout_speed_curve_points READ workout_speed_curve_points)
+    Q_PROPERTY(QList<int> workout_curve_durations READ workout_curve_durations)
     Q_PROPERTY(double wattMaxChart READ wattMaxChart)
     Q_PROPERTY(bool autoResistance READ autoResistance NOTIFY autoResistanceChanged WRITE setAutoResistance)
 
@@ -123,22 +130,6 @@ public:
         s.capture(filenameScreenshot);
     }
 
-    Q_INVOKABLE void save_screenshot_chart(QQuickItem* item, QString filename)
-    {
-        if(!stopped) return;
-
-        QString path = getWritableAppDir();
-
-        QString filenameScreenshot = path + QDateTime::currentDateTime().toString().replace(":", "_") + "_" + filename.replace(":", "_") + ".jpg";
-        QSharedPointer<const QQuickItemGrabResult> grabResult = item->grabToImage();
-
-        connect(grabResult.data(), &QQuickItemGrabResult::ready, [=]() {
-            grabResult->saveToFile(filenameScreenshot);
-            //chartImages.append(grabResult->image());
-            chartImagesFilenames.append(filenameScreenshot);
-        });
-    }
-
     Q_INVOKABLE void update_chart_power(QQuickItem *item){
             if(QGraphicsScene *scene = item->findChild<QGraphicsScene *>()){
                 for(QGraphicsItem *it : scene->items()){
@@ -245,6 +236,8 @@ public:
     int pzpLogin() {return m_pzpLoginState;}
     bool pelotonAskStart() {return m_pelotonAskStart;}
     void setPelotonAskStart(bool value) {m_pelotonAskStart = value;}
+    bool journalAskResume() {return m_journalAskResume;}
+    void setJournalAskResume(bool value) {m_journalAskResume = value;}
     bool generalPopupVisible();
     bool labelHelp();
     QStringList metrics();
@@ -254,6 +247,7 @@ public:
     void setAutoResistance(bool value) { m_autoresistance = value; emit autoResistanceChanged(value); if(bluetoothManager->device()) bluetoothManager->device()->setAutoResistance(value); }
     void setGeneralPopupVisible(bool value);
     int workout_sample_points() { return Session.count();}
+    sessionmodel* workout_model() { return workoutModel;}
 
 #if defined(Q_OS_ANDROID)
     static QString getAndroidDataAppDir();
@@ -262,21 +256,32 @@ public:
 
     double wattMaxChart() {QSettings settings; if(bluetoothManager && bluetoothManager->device() && bluetoothManager->device()->wattsMetric().max() > (settings.value("ftp", 200.0).toDouble() * 2)) return bluetoothManager->device()->wattsMetric().max(); else { return settings.value("ftp", 200.0).toDouble() * 2;} }
 
-    Q_INVOKABLE void sendMail();
+    // called by Stop(), the charts and the mail are done on the thread pool
+    void sendMail();
 
-    QList<double> workout_watt_points() { QList<double> l; foreach(SessionLine s, Session) {l.append(s.watt);} return l; }
-    QList<double> workout_heart_points() { QList<double> l; foreach(SessionLine s, Session) {l.append(s.heart);} return l; }
-    QList<double> workout_cadence_points() { QList<double> l; foreach(SessionLine s, Session) {l.append(s.cadence);} return l; }
-    QList<double> workout_resistance_points() { QList<double> l; foreach(SessionLine s, Session) {l.append(s.resistance);} return l; }
-    QList<double> workout_peloton_resistance_points() { QList<double> l; foreach(SessionLine s, Session) {l.append(s.peloton_resistance);} return l; }
+    QList<double> workout_power_curve_points() { return powerCurve.curve(); }
+    QList<double> workout_heart_curve_points() { return heartCurve.curve(); }
+    QList<double> workout_speed_curve_points() { return speedCurve.curve(); }
+    QList<int> workout_curve_durations() { QList<int> l; foreach(uint32_t d, powerCurve.durations()) {l.append(d);} return l; }
 
 private:
+    friend class benchmarks; // test/benchmarks
     QList<QObject *> dataList;
     QList<SessionLine> Session;
+    sessionmodel* workoutModel = 0;
+    meanmaxcurve powerCurve;
+    meanmaxcurve heartCurve;
+    meanmaxcurve speedCurve;
+    lapanalyzer lapAnalyzer;
     bluetooth* bluetoothManager = 0;
     QQmlApplicationEngine* engine;
     trainprogram* trainProgram = 0;
-    QString backupFitFileName = "QZ-backup-" + QDateTime::currentDateTime().toString().replace(":", "_") + ".fit";
+    sessionjournal journal;
+    // the journal of an interrupted session loaded back, applied to the device at the start
+    bool resumePending = false;
+    sessionjournal::journalstate resumeState;
+    static QString journalFileName() {return getWritableAppDir() + "QZ-journal.bin";}
+    static QString journalTrainProgramFileName() {return getWritableAppDir() + "QZ-journal.xml";}
 
     int m_topBarHeight = 120;
     QString m_info = "Connecting...";
@@ -291,6 +296,7 @@ private:
 
     peloton* pelotonHandler = 0;
     bool m_pelotonAskStart = false;
+    bool m_journalAskResume = false;
     int m_pelotonLoginState = -1;
     int m_pzpLoginState = -1;
     QString stravaPelotonActivityName = "";
@@ -298,7 +304,6 @@ private:
 
     QString lastFitFileSaved = "";
 
-    QList<QString> chartImagesFilenames;
 
     bool m_autoresistance = true;
 
@@ -324,12 +329,14 @@ private:
     DataObject* target_peloton_resistance;
     DataObject* target_cadence;
     DataObject* target_power;
+    DataObject* hrv;
     DataObject* ftp;
     DataObject* lapElapsed;
     DataObject* weightLoss;
 
     QTimer* timer;
-    QTimer* backupTimer;
+
+    latencyhistogram sampleLatency = latencyhistogram("sample-to-UI latency");
 
     QString strava_code;
     QOAuth2AuthorizationCodeFlow* strava_connect();
@@ -339,7 +346,8 @@ private:
     bool strava_upload_file(QByteArray &data, QString remotename);
 
     void update();
-    void backup();
+    // the device can live on the bluetooth I/O thread: the calls that change it run there, queued
+    void onDevice(std::function<void(bluetoothdevice*)> call);
     bool getDevice();
     bool getLap();    
 
@@ -356,6 +364,7 @@ private slots:
     void Plus(QString);
     void deviceFound(QString name);
     void deviceConnected();
+    void samplePublished(qint64 timestamp);
     void trainprogram_open_clicked(QUrl fileName);
     void gpx_open_clicked(QUrl fileName);
     void gpx_save_clicked();
@@ -376,6 +385,8 @@ private slots:
     void pelotonLoginState(bool ok);
     void pzpLoginState(bool ok);
     void peloton_start_workout();
+    void journal_resume();
+    void journal_discard();
     void smtpError(SmtpClient::SmtpError e);
 
 signals:
@@ -395,6 +406,7 @@ signals:
  void tile_orderChanged(QStringList value);
  void changeLabelHelp(bool value);
  void changePelotonAskStart(bool value);
+ void changeJournalAskResume(bool value);
  void generalPopupVisibleChanged(bool value);
  void autoResistanceChanged(bool value);
  void pelotonLoginChanged(int ok);
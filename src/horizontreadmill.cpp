@@ -22,7 +22,7 @@ horizontreadmill::horizontreadmill(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 /*
 void horizontreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
@@ -73,7 +73,7 @@ void horizontreadmill::update()
         update_metrics(true, watts(settings.value("weight", 75.0).toFloat()));
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -149,11 +149,11 @@ void horizontreadmill::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("horizontreadmill::characteristicChanged");
     double heart;
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -270,7 +270,7 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
@@ -307,25 +307,23 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
         // todo
     }
 
-    if(heartRateBeltName.startsWith("Disabled"))
+    if(heart == 0 || settings.value("heart_ignore_builtin", false).toBool())
     {
-        if(heart == 0 || settings.value("heart_ignore_builtin", false).toBool())
-        {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-            lockscreen h;
+        lockscreen h;
         long appleWatchHeartRate = h.heartRate();
         h.setKcal(KCal.value());
         h.setDistance(Distance.value());
-        Heart = appleWatchHeartRate;
+        if(appleWatchHeartRate > 0)
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
         debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-        }
-        else
-        {
-            Heart = heart;
-        }
+    }
+    else
+    {
+        sensors.publish(sensorbus::HEART, sensorbus::MACHINE, heart);
     }
 
     lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
@@ -0,0 +1,160 @@
+#include "hrvanalyzer.h"
+#include <math.h>
+#include <string.h>
+
+static const double minRR = 300;   // 200 bpm
+static const double maxRR = 2000;  // 30 bpm
+static const double maxRRChange = 0.2;
+
+hrvanalyzer::hrvanalyzer()
+{
+    for(uint8_t i = 0; i < BOXES; i++)
+        m_logScale[i] = log((double)(MIN_BOX + i));
+    clear();
+}
+
+void hrvanalyzer::clear()
+{
+    m_head = 0;
+    m_count = 0;
+    m_last = 0;
+    m_sum = 0;
+    m_sumSquares = 0;
+    m_diffSquares = 0;
+    memset(m_boxes, 0, sizeof(m_boxes));
+}
+
+void hrvanalyzer::setWindow(uint16_t beats)
+{
+    if(beats < MAX_BOX * 2)
+        beats = MAX_BOX * 2;
+    if(beats > MAX_WINDOW)
+        beats = MAX_WINDOW;
+    m_window = beats;
+    clear();
+}
+
+bool hrvanalyzer::addBeat(double rr)
+{
+    // ectopic beats and missed detections: both the beat and the one after it differ too much from
+    // the previous one, so they are dropped without touching the window
+    const bool artifact = rr < minRR || rr > maxRR || (m_last > 0 && fabs(rr - m_last) > m_last * maxRRChange);
+    m_last = rr;
+    if(artifact)
+        return false;
+
+    if(m_count == m_window)
+    {
+        const uint16_t tail = (m_head + MAX_WINDOW - m_count) % MAX_WINDOW;
+        const double o = m_rr[tail];
+        const double next = m_rr[(tail + 1) % MAX_WINDOW];
+        m_sum -= o;
+        m_sumSquares -= o * o;
+        m_diffSquares -= (next - o) * (next - o);
+        m_count--;
+    }
+
+    if(m_count)
+    {
+        const double newest = m_rr[(m_head + MAX_WINDOW - 1) % MAX_WINDOW];
+        m_diffSquares += (rr - newest) * (rr - newest);
+    }
+    m_rr[m_head] = rr;
+    m_head = (m_head + 1) % MAX_WINDOW;
+    m_count++;
+    m_sum += rr;
+    m_sumSquares += rr * rr;
+
+    for(uint8_t i = 0; i < BOXES; i++)
+        addBox(i, rr);
+    return true;
+}
+
+void hrvanalyzer::addBox(uint8_t scale, double rr)
+{
+    dfabox& b = m_boxes[scale];
+    const double n = MIN_BOX + scale;
+
+    // a constant offset of the intervals is a linear trend of the profile and the box detrending
+    // removes it, so the profile is integrated from the first interval of the box to keep it small
+    if(b.n == 0)
+    {
+        b.reference = rr;
+        b.y = b.sy = b.syy = b.sxy = 0;
+    }
+    b.y += rr - b.reference;
+    b.sy += b.y;
+    b.syy += b.y * b.y;
+    b.sxy += b.n * b.y;
+    b.n++;
+    if(b.n < n)
+        return;
+
+    // residual of the least squares line of the profile over x = 0..n-1
+    const double sx = n * (n - 1) / 2;
+    const double sxx = (n - 1) * n * (2 * n - 1) / 6;
+    const double cxy = b.sxy - sx * b.sy / n;
+    double residual = b.syy - b.sy * b.sy / n - cxy * cxy / (sxx - sx * sx / n);
+    if(residual < 0)
+        residual = 0;
+    b.n = 0;
+
+    const uint16_t capacity = m_window / (MIN_BOX + scale);
+    if(b.count == capacity)
+    {
+        b.sum -= b.f2[(b.head + MAX_WINDOW / MIN_BOX - b.count) % (MAX_WINDOW / MIN_BOX)];
+        b.count--;
+    }
+    b.f2[b.head] = residual / n;
+    b.head = (b.head + 1) % (MAX_WINDOW / MIN_BOX);
+    b.count++;
+    b.sum += residual / n;
+}
+
+double hrvanalyzer::rmssd()
+{
+    if(m_count < 2 || m_diffSquares <= 0)
+        return 0;
+    return sqrt(m_diffSquares / (m_count - 1));
+}
+
+double hrvanalyzer::sdnn()
+{
+    if(m_count < 2)
+        return 0;
+    const double v = (m_sumSquares - m_sum * m_sum / m_count) / (m_count - 1);
+    return v > 0 ? sqrt(v) : 0;
+}
+
+double hrvanalyzer::dfaAlpha1()
+{
+    if(m_count < m_window)
+        return 0;
+
+    // slope of log F(n) against log n
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for(uint8_t i = 0; i < BOXES; i++)
+    {
+        const dfabox& b = m_boxes[i];
+        if(!b.count || b.sum <= 0)
+            return 0;
+        const double y = 0.5 * log(b.sum / b.count);
+        sx += m_logScale[i];
+        sy += y;
+        sxx += m_logScale[i] * m_logScale[i];
+        sxy += m_logScale[i] * y;
+    }
+    return (BOXES * sxy - sx * sy) / (BOXES * sxx - sx * sx);
+}
+
+uint8_t hrvanalyzer::thresholdZone()
+{
+    const double a = dfaAlpha1();
+    if(a <= 0)
+        return 0;
+    if(a > 0.75)
+        return 1;
+    if(a >= 0.5)
+        return 2;
+    return 3;
+}
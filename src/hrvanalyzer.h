@@ -0,0 +1,67 @@
+#ifndef HRVANALYZER_H
+#define HRVANALYZER_H
+
+#include <QtGlobal>
+
+// streaming heart rate variability over the last beats of the session.
+// The RR intervals are kept in a preallocated ring and every statistic is a set of running sums
+// updated when a beat enters or leaves the window, so a beat costs the same whatever the window is:
+// RMSSD and SDNN from the sums of the differences and of the intervals, DFA-alpha1 from the
+// detrended fluctuation of the non overlapping boxes of 4..16 beats
+class hrvanalyzer
+{
+public:
+    hrvanalyzer();
+    void clear();
+    void setWindow(uint16_t beats);
+    // RR interval in milliseconds, returns false if it has been rejected as an artifact
+    bool addBeat(double rr);
+
+    uint16_t beats() {return m_count;}
+    double rmssd();
+    double sdnn();
+    double dfaAlpha1();
+    // 0 not enough beats, 1 below the aerobic threshold (alpha1 > 0.75), 2 between the thresholds,
+    // 3 above the anaerobic threshold (alpha1 < 0.5)
+    uint8_t thresholdZone();
+
+    static const uint16_t MAX_WINDOW = 256;
+
+private:
+    static const uint8_t MIN_BOX = 4;
+    static const uint8_t MAX_BOX = 16;
+    static const uint8_t BOXES = MAX_BOX - MIN_BOX + 1;
+
+    typedef struct dfabox
+    {
+        // running sums of the box being filled, profile relative to the first beat of the box
+        double y;
+        double sy;
+        double syy;
+        double sxy;
+        double reference;
+        uint8_t n;
+        // fluctuation of the completed boxes in the window
+        double f2[MAX_WINDOW / MIN_BOX];
+        uint16_t head;
+        uint16_t count;
+        double sum;
+    }dfabox;
+
+    void addBox(uint8_t scale, double rr);
+
+    double m_rr[MAX_WINDOW];
+    uint16_t m_head = 0;
+    uint16_t m_count = 0;
+    uint16_t m_window = 120;
+    double m_last = 0;
+
+    double m_sum = 0;
+    double m_sumSquares = 0;
+    double m_diffSquares = 0;
+
+    dfabox m_boxes[BOXES];
+    double m_logScale[BOXES];
+};
+
+#endif // HRVANALYZER_H
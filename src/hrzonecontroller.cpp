@@ -0,0 +1,297 @@
+#include "hrzonecontroller.h"
+#include "metric.h"
+#include <QRandomGenerator>
+#include <QVector>
+#include <math.h>
+#include <string.h>
+
+static const double filterTau = 6.0;        // seconds, heart rate smoothing
+static const double estimateWindow = 5.0;   // seconds of samples for one estimation step
+static const qint64 maxGap = 10000;         // msecs without samples before starting over
+static const double forgetting = 0.98;
+static const uint16_t minUpdates = 6;       // estimation steps before trusting the estimates
+static const double heartDelay = 10.0;      // seconds, dead time of the heart response for the tuning
+
+hrzonecontroller::hrzonecontroller()
+{
+    memset(m_theta, 0, sizeof(m_theta));
+    memset(m_p, 0, sizeof(m_p));
+}
+
+void hrzonecontroller::setModel(double gain, double tau)
+{
+    m_priorGain = m_gain = gain;
+    m_priorTau = m_tau = tau;
+}
+
+void hrzonecontroller::setLimits(double minimum, double maximum, double maxRate, double resolution)
+{
+    m_minimum = minimum;
+    m_maximum = m_limit = maximum;
+    m_maxRate = maxRate;
+    m_resolution = resolution;
+}
+
+void hrzonecontroller::setMaximum(double maximum)
+{
+    m_limit = (maximum > m_minimum && maximum < m_maximum) ? maximum : m_maximum;
+}
+
+void hrzonecontroller::setTarget(double bpm)
+{
+    m_target = bpm;
+}
+
+void hrzonecontroller::reset(double output)
+{
+    if(output < m_minimum)
+        output = m_minimum;
+    m_output = m_sent = m_integral = output;
+    m_last = 0;
+    m_updates = 0;
+}
+
+double hrzonecontroller::zoneTarget(uint8_t zone)
+{
+    const double maxHeartRate = metric::maxHeartRate();
+    double bounds[5];
+    bounds[0] = maxHeartRate * 0.5;
+    metric::heartRateZones(bounds + 1);
+    if(zone < 1)
+        zone = 1;
+    if(zone > 5)
+        zone = 5;
+    // the last zone is open: aim a bit over its lower bound
+    return (zone == 5 ? bounds[4] + maxHeartRate * 0.025 : (bounds[zone - 1] + bounds[zone]) / 2.0);
+}
+
+void hrzonecontroller::estimate(double slope, double output, double heart)
+{
+    const double phi[3] = {output, 1.0, heart};
+    double pphi[3];
+    double denominator = forgetting;
+    for(int i = 0; i < 3; i++)
+    {
+        pphi[i] = m_p[i][0] * phi[0] + m_p[i][1] * phi[1] + m_p[i][2] * phi[2];
+        denominator += phi[i] * pphi[i];
+    }
+    const double error = slope - (m_theta[0] * phi[0] + m_theta[1] * phi[1] + m_theta[2] * phi[2]);
+    for(int i = 0; i < 3; i++)
+        m_theta[i] += pphi[i] * error / denominator;
+    for(int i = 0; i < 3; i++)
+        for(int j = 0; j < 3; j++)
+            m_p[i][j] = (m_p[i][j] - pphi[i] * pphi[j] / denominator) / forgetting;
+    m_updates++;
+
+    if(m_updates < minUpdates || m_theta[2] >= 0)
+        return;
+
+    // only physically sensible models close to the prior of the device family are used
+    const double tau = -1.0 / m_theta[2];
+    const double gain = m_theta[0] * tau;
+    if(tau < m_priorTau / 4 || tau > m_priorTau * 4 || gain < m_priorGain / 4 || gain > m_priorGain * 4)
+        return;
+    m_tau = tau;
+    m_gain = gain;
+}
+
+bool hrzonecontroller::addSample(double heart, qint64 msecs)
+{
+    if(!enabled() || heart <= 0)
+        return false;
+
+    if(m_last == 0 || msecs - m_last > maxGap)
+    {
+        m_heart = heart;
+        m_last = msecs;
+        m_windowHeart = heart;
+        m_windowOutput = 0;
+        m_windowTime = 0;
+
+        // estimation restarts from the current model, assuming the athlete at steady state
+        m_theta[0] = m_gain / m_tau;
+        m_theta[2] = -1.0 / m_tau;
+        m_theta[1] = -(m_theta[0] * m_output + m_theta[2] * heart);
+        memset(m_p, 0, sizeof(m_p));
+        m_p[0][0] = m_theta[0] * m_theta[0];
+        m_p[1][1] = 4.0;
+        m_p[2][2] = m_theta[2] * m_theta[2];
+        m_updates = 0;
+        return false;
+    }
+
+    const double dt = (msecs - m_last) / 1000.0;
+    if(dt <= 0)
+        return false;
+    m_last = msecs;
+    m_heart += (dt / (filterTau + dt)) * (heart - m_heart);
+
+    m_windowOutput += m_output * dt;
+    m_windowTime += dt;
+    if(m_windowTime >= estimateWindow)
+    {
+        const double slope = (m_heart - m_windowHeart) / m_windowTime;
+        const double output = m_windowOutput / m_windowTime;
+        // without excitation the regressors are collinear and the covariance would wind up
+        if(fabs(slope) > 0.05 || fabs(output - m_output) > m_resolution / 2)
+            estimate(slope, output, (m_heart + m_windowHeart) / 2.0);
+        m_windowHeart = m_heart;
+        m_windowOutput = 0;
+        m_windowTime = 0;
+    }
+
+    // PI from the internal model: closed loop as fast as the heart itself, plus its dead time
+    const double error = m_target - m_heart;
+    const double kp = m_tau / (m_gain * (m_tau + heartDelay));
+    const double ki = kp / m_tau;
+    double u = kp * error + m_integral + ki * error * dt;
+
+    double low = m_output - m_maxRate * dt;
+    double high = m_output + m_maxRate * dt;
+    if(low < m_minimum)
+        low = m_minimum;
+    if(high > m_limit)
+        high = m_limit;
+    if(u < low)
+        u = low;
+    if(u > high)
+        u = high;
+    if(u < m_minimum)
+        u = m_minimum;
+
+    // back calculation: the integral follows the clamped output, so it doesn't wind up on the limits
+    m_integral = u - kp * error;
+    m_output = u;
+
+    // a new command only a full step away from the last one: no dithering between two steps of the device
+    if(fabs(u - m_sent) < m_resolution)
+        return false;
+    m_sent = round(u / m_resolution) * m_resolution;
+    return true;
+}
+
+typedef struct hrathlete
+{
+    double gain;
+    double tau;
+    double delay;
+    double rest;
+}hrathlete;
+
+typedef struct hrsimulation
+{
+    double settle;  // seconds to stay in the zone
+    double overshoot;
+    double inZone;  // % of the time in the zone after the first entry
+    uint32_t commands;
+}hrsimulation;
+
+// first order heart with dead time and beat noise, driven by the controller (or by the fixed step
+// loop of the previous implementation) for 30 minutes at 2 samples per second
+static hrsimulation runSimulation(const hrathlete& a, bool fixedStep, double priorGain, double priorTau,
+                                  double minimum, double maximum, double maxRate, double resolution,
+                                  double step, double start, double target, double zoneWidth)
+{
+    const double dt = 0.5;
+    const int samples = 30 * 60 / dt;
+    const int delaySamples = a.delay / dt;
+    QVector<double> outputs(delaySamples + 1, start);
+    QRandomGenerator random(42);
+    hrzonecontroller c;
+    c.setModel(priorGain, priorTau);
+    c.setLimits(minimum, maximum, maxRate, resolution);
+    c.setTarget(target);
+    c.reset(start);
+
+    double heart = a.rest + a.gain * start;
+    double output = start;
+    double lastStep = 0;
+    hrsimulation r = {-1, 0, 0, 0};
+    int entered = -1;
+    int inZone = 0;
+    int outSince = 0;
+
+    for(int i = 0; i < samples; i++)
+    {
+        const double t = i * dt;
+        outputs[i % outputs.size()] = output;
+        const double delayed = outputs[(i + 1) % outputs.size()];
+        heart += (dt / a.tau) * (a.gain * delayed + a.rest - heart);
+        const double measured = round(heart + (random.generateDouble() - 0.5) * 3.0);
+        const bool zone = fabs(measured - target) <= zoneWidth / 2;
+
+        if(zone && entered < 0)
+            entered = i;
+        if(entered >= 0)
+        {
+            inZone += zone;
+            if(!zone)
+                outSince = i;
+            if(heart - target > r.overshoot)
+                r.overshoot = heart - target;
+        }
+
+        if(fixedStep)
+        {
+            if(t - lastStep >= 10)
+            {
+                lastStep = t;
+                if(measured > target + zoneWidth / 2 && output - step >= minimum)
+                {
+                    output -= step;
+                    r.commands++;
+                }
+                else if(measured < target - zoneWidth / 2 && output + step <= maximum)
+                {
+                    output += step;
+                    r.commands++;
+                }
+            }
+        }
+        else if(c.addSample(measured, (qint64)(t * 1000) + 1))
+        {
+            output = c.output();
+            r.commands++;
+        }
+    }
+    if(entered >= 0)
+    {
+        r.settle = (outSince + 1) * dt;
+        r.inZone = (inZone * 100.0) / (samples - entered);
+    }
+    return r;
+}
+
+QString hrzonecontroller::simulate()
+{
+    QString r;
+    const hrathlete athletes[] = {
+        {8, 40, 8, 60},   // the prior
+        {5, 30, 6, 65},   // fit, fast
+        {12, 60, 12, 70}, // unfit, slow
+    };
+    const char* names[] = {"nominal", "fast", "slow"};
+
+    for(int family = 0; family < 2; family++)
+    {
+        // treadmill: speed in km/h, bike: resistance levels with a lower gain per step
+        const bool treadmill = family == 0;
+        const double scale = treadmill ? 1.0 : 0.4;
+        for(uint8_t i = 0; i < sizeof(athletes) / sizeof(athletes[0]); i++)
+        {
+            hrathlete a = athletes[i];
+            a.gain *= scale;
+            const double target = a.rest + a.gain * (treadmill ? 10.5 : 22.5);
+            const double start = treadmill ? 6.0 : 8.0;
+            hrsimulation fixed = runSimulation(a, true, 8 * scale, 40, 1, treadmill ? 20 : 32, treadmill ? 0.25 : 0.5,
+                                               treadmill ? 0.1 : 1, treadmill ? 0.2 : 1, start, target, 10);
+            hrsimulation model = runSimulation(a, false, 8 * scale, 40, 1, treadmill ? 20 : 32, treadmill ? 0.25 : 0.5,
+                                               treadmill ? 0.1 : 1, treadmill ? 0.2 : 1, start, target, 10);
+            r += QString("%1 %2: fixed step settle %3 s overshoot %4 bpm in zone %5% commands %6 | model settle %7 s overshoot %8 bpm in zone %9% commands %10\n")
+                    .arg(treadmill ? "treadmill" : "bike").arg(names[i])
+                    .arg(fixed.settle, 0, 'f', 0).arg(fixed.overshoot, 0, 'f', 1).arg(fixed.inZone, 0, 'f', 0).arg(fixed.commands)
+                    .arg(model.settle, 0, 'f', 0).arg(model.overshoot, 0, 'f', 1).arg(model.inZone, 0, 'f', 0).arg(model.commands);
+        }
+    }
+    return r;
+}
@@ -0,0 +1,71 @@
+#ifndef HRZONECONTROLLER_H
+#define HRZONECONTROLLER_H
+
+#include <QString>
+
+// keeps the heart rate on a target driving one output of the device (treadmill speed, bike resistance).
+// The heart rate is modelled as a first order response to the output,
+//     tau * dHR/dt = gain * output + rest - HR
+// whose gain and time constant are estimated online (recursive least squares) from the prior of the
+// device family. A PI tuned on the model (IMC) computes the output at every heart rate sample,
+// clamped to the device limits and to a maximum rate of change, without integrating over the limits.
+class hrzonecontroller
+{
+public:
+    hrzonecontroller();
+    // gain: bpm for one unit of output, tau: seconds
+    void setModel(double gain, double tau);
+    void setLimits(double minimum, double maximum, double maxRate, double resolution);
+    void setMaximum(double maximum);
+    // 0 disables the controller
+    void setTarget(double bpm);
+    double target() {return m_target;}
+    bool enabled() {return m_target > 0;}
+    // bumpless start from the current output of the device
+    void reset(double output);
+    // a new heart rate sample, returns true when the quantized output changed
+    bool addSample(double heart, qint64 msecs);
+    double output() {return m_sent;}
+    double gain() {return m_gain;}
+    double tau() {return m_tau;}
+
+    // middle of the heart rate zone of the settings (zones 1..5), in bpm
+    static double zoneTarget(uint8_t zone);
+    // offline benchmark of the controller against the fixed step loop on simulated athletes
+    static QString simulate();
+
+private:
+    void estimate(double slope, double output, double heart);
+
+    double m_priorGain = 1;
+    double m_priorTau = 40;
+    double m_gain = 1;
+    double m_tau = 40;
+
+    double m_minimum = 0;
+    double m_maximum = 100;
+    double m_limit = 100;
+    double m_maxRate = 1;
+    double m_resolution = 1;
+
+    double m_target = 0;
+    double m_integral = 0;
+    double m_output = 0;
+    double m_sent = 0;
+
+    double m_heart = 0; // filtered
+    qint64 m_last = 0;
+
+    // estimation window
+    qint64 m_windowStart = 0;
+    double m_windowHeart = 0;
+    double m_windowOutput = 0;
+    double m_windowTime = 0;
+
+    // recursive least squares of dHR/dt = a * output + b + c * HR
+    double m_theta[3];
+    double m_p[3][3];
+    uint16_t m_updates = 0;
+};
+
+#endif // HRZONECONTROLLER_H
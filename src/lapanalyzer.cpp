@@ -0,0 +1,211 @@
+#include "lapanalyzer.h"
+#include "metric.h"
+#include <QSettings>
+#include <math.h>
+#include <string.h>
+
+static const uint32_t minAutoLap = 30;     // seconds before a lap can be split by the power
+static const uint16_t autoLapConfirm = 10; // seconds of the new power level to split the lap
+static const double autoLapWatts = 30;     // minimum change of the power, or 20% of the lap average
+static const double shortPowerTau = 5;     // seconds
+
+void lapanalyzer::accumulator::start(const SessionLine& from, int32_t step)
+{
+    startTime = lastTime = from.time;
+    startElapsed = lastElapsed = from.elapsedTime;
+    this->step = step;
+    startDistance = from.distance;
+    startCalories = from.calories;
+    startElevation = from.elevationGain;
+    last = from;
+
+    n = 0;
+    sumPower = maxPower = 0;
+    sumCadence = maxCadence = 0;
+    sumSpeed = maxSpeed = 0;
+    heartSamples = 0;
+    sumHeart = maxHeart = 0;
+    memset(timeInZone, 0, sizeof(timeInZone));
+    memset(npRing, 0, sizeof(npRing));
+    npSum = npFourth = 0;
+    npSamples = 0;
+    sx = sxx = sxy = 0;
+}
+
+void lapanalyzer::accumulator::add(const SessionLine& s, const double* zones)
+{
+    const double power = s.watt;
+    last = s;
+    lastTime = s.time;
+    lastElapsed = s.elapsedTime;
+
+    const uint8_t slot = n % NP_WINDOW;
+    n++;
+    sumPower += power;
+    if(power > maxPower)
+        maxPower = power;
+    sumCadence += s.cadence;
+    if(s.cadence > maxCadence)
+        maxCadence = s.cadence;
+    sumSpeed += s.speed;
+    if(s.speed > maxSpeed)
+        maxSpeed = s.speed;
+
+    npSum += power - npRing[slot];
+    npRing[slot] = power;
+    if(n >= NP_WINDOW)
+    {
+        const double rolling = npSum / NP_WINDOW;
+        npFourth += rolling * rolling * rolling * rolling;
+        npSamples++;
+    }
+
+    if(s.heart > 0)
+    {
+        const double x = n - 1;
+        uint8_t zone = 0;
+        while(zone < 4 && s.heart >= zones[zone])
+            zone++;
+        timeInZone[zone] += 1;
+        heartSamples++;
+        sumHeart += s.heart;
+        if(s.heart > maxHeart)
+            maxHeart = s.heart;
+        sx += x;
+        sxx += x * x;
+        sxy += x * s.heart;
+    }
+}
+
+lapsummary lapanalyzer::accumulator::summary(uint8_t trigger) const
+{
+    lapsummary r;
+    r.start = startTime;
+    r.end = lastTime;
+    r.startElapsed = startElapsed;
+    r.elapsed = lastElapsed - startElapsed;
+    r.trigger = trigger;
+    r.step = step;
+    r.distance = last.distance - startDistance;
+    r.calories = last.calories - startCalories;
+    r.ascent = last.elevationGain - startElevation;
+    r.work = sumPower / 1000.0; // 1 s per sample
+    r.avgPower = n ? sumPower / n : 0;
+    r.maxPower = maxPower;
+    r.normalizedPower = npSamples ? pow(npFourth / npSamples, 0.25) : r.avgPower;
+    r.avgCadence = n ? sumCadence / n : 0;
+    r.maxCadence = maxCadence;
+    r.avgSpeed = n ? sumSpeed / n : 0;
+    r.maxSpeed = maxSpeed;
+    r.avgHeart = heartSamples ? sumHeart / heartSamples : 0;
+    r.maxHeart = maxHeart;
+    r.heartDrift = 0;
+    const double m = heartSamples;
+    const double denominator = m * sxx - sx * sx;
+    if(m >= 2 && denominator > 0 && r.avgHeart > 0)
+    {
+        // rise of the trend line from the first to the last second of the lap
+        const double slope = (m * sxy - sx * sumHeart) / denominator;
+        r.heartDrift = slope * (n - 1) * 100.0 / r.avgHeart;
+    }
+    memcpy(r.timeInZone, timeInZone, sizeof(r.timeInZone));
+    return r;
+}
+
+lapanalyzer::lapanalyzer()
+{
+    clear();
+}
+
+void lapanalyzer::clear()
+{
+    QSettings settings;
+    m_lapOnSteps = settings.value("lap_workout_steps", false).toBool();
+    m_autoPower = settings.value("lap_auto_power", false).toBool();
+    metric::heartRateZones(m_zones);
+
+    m_laps.clear();
+    m_steps.clear();
+    m_currentStep = -1;
+    m_started = false;
+    m_shortPower = 0;
+    m_deviation = 0;
+}
+
+void lapanalyzer::closeLap(uint8_t trigger, const SessionLine from, int32_t step)
+{
+    m_laps.append(m_lap.summary(trigger));
+    m_lap.start(from, step);
+    m_shortPower = from.watt;
+    m_deviation = 0;
+}
+
+void lapanalyzer::addSample(const SessionLine& s, int32_t step)
+{
+    if(!m_started)
+    {
+        // the totals of the session start from zero, the distance from the first sample
+        SessionLine origin = s;
+        origin.elapsedTime = 0;
+        origin.calories = 0;
+        origin.elevationGain = 0;
+        m_lap.start(origin, step);
+        m_step.start(origin, step);
+        m_currentStep = step;
+        m_shortPower = s.watt;
+        m_started = true;
+    }
+
+    // a new workout step starts from the last sample of the previous one
+    if(step != m_currentStep)
+    {
+        const SessionLine from = m_step.lastSample();
+        m_steps.append(m_step.summary(STEP));
+        m_step.start(from, step);
+        if(m_lapOnSteps && m_lap.samples())
+            closeLap(STEP, m_lap.lastSample(), step);
+        m_currentStep = step;
+    }
+
+    m_lap.add(s, m_zones);
+    m_step.add(s, m_zones);
+
+    if(s.lapTrigger)
+        closeLap(MANUAL, s, step);
+    else if(m_autoPower)
+    {
+        m_shortPower += (s.watt - m_shortPower) / shortPowerTau;
+        const double average = m_lap.averagePower();
+        const double threshold = qMax(autoLapWatts, average * 0.2);
+        if(m_lap.samples() >= minAutoLap && fabs(m_shortPower - average) > threshold)
+            m_deviation++;
+        else
+            m_deviation = 0;
+        if(m_deviation >= autoLapConfirm)
+            closeLap(POWER, s, step);
+    }
+}
+
+QList<lapsummary> lapanalyzer::laps()
+{
+    QList<lapsummary> r = m_laps;
+    if(m_lap.samples())
+        r.append(m_lap.summary(SESSION_END));
+    return r;
+}
+
+QList<lapsummary> lapanalyzer::steps()
+{
+    QList<lapsummary> r = m_steps;
+    if(m_step.samples())
+        r.append(m_step.summary(SESSION_END));
+    return r;
+}
+
+QList<lapsummary> lapanalyzer::fromSession(const QList<SessionLine>& session)
+{
+    lapanalyzer a;
+    for(const SessionLine& s : session)
+        a.addSample(s);
+    return a.laps();
+}
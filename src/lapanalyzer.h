@@ -0,0 +1,129 @@
+#ifndef LAPANALYZER_H
+#define LAPANALYZER_H
+
+#include <QList>
+#include <QDateTime>
+#include "sessionline.h"
+
+typedef struct lapsummary
+{
+    QDateTime start;
+    QDateTime end;
+    uint32_t startElapsed; // seconds of the session
+    uint32_t elapsed; // seconds
+    uint8_t trigger; // lapanalyzer::TRIGGER that closed the lap
+    int32_t step; // row of the workout at the start of the lap, -1 without a workout
+    double distance; // km
+    double calories;
+    double ascent; // meters
+    double work; // kJ
+    double avgPower;
+    double maxPower;
+    double normalizedPower;
+    double avgCadence;
+    double maxCadence;
+    double avgHeart;
+    double maxHeart;
+    double avgSpeed; // km/h
+    double maxSpeed;
+    double heartDrift; // % of the average heart rate, from the heart rate trend over the lap
+    double timeInZone[5]; // seconds in the heart rate zones of the settings
+}lapsummary;
+
+// incremental summaries of the laps and of the workout steps of a 1 Hz session.
+// Every summary is a set of running sums updated by the sample in O(1) (the normalized power keeps
+// the last 30 s of power in a ring), so the laps are ready at any time and the export doesn't
+// scan the session again. A lap ends on the lap button, optionally on every workout step
+// (setting lap_workout_steps) and on the intervals detected from the power (setting lap_auto_power)
+class lapanalyzer
+{
+public:
+    enum TRIGGER
+    {
+        MANUAL = 0,
+        STEP,
+        POWER,
+        SESSION_END,
+    };
+
+    lapanalyzer();
+    void clear();
+    // step: current row of the workout, -1 without a workout
+    void addSample(const SessionLine& s, int32_t step = -1);
+
+    // the closed laps plus the current one, closed by the session end
+    QList<lapsummary> laps();
+    QList<lapsummary> steps();
+    lapsummary currentLap() {return m_lap.summary(SESSION_END);}
+
+    // batch mode for the sessions recorded without an analyzer
+    static QList<lapsummary> fromSession(const QList<SessionLine>& session);
+
+private:
+    static const uint8_t NP_WINDOW = 30;
+
+    class accumulator
+    {
+    public:
+        void start(const SessionLine& s, int32_t step);
+        void add(const SessionLine& s, const double* zones);
+        lapsummary summary(uint8_t trigger) const;
+        uint32_t samples() const {return n;}
+        const SessionLine& lastSample() const {return last;}
+        double averagePower() const {return n ? sumPower / n : 0;}
+
+    private:
+        QDateTime startTime;
+        QDateTime lastTime;
+        uint32_t startElapsed = 0;
+        uint32_t lastElapsed = 0;
+        int32_t step = -1;
+        double startDistance = 0;
+        double startCalories = 0;
+        double startElevation = 0;
+        SessionLine last;
+
+        uint32_t n = 0;
+        double sumPower = 0;
+        double maxPower = 0;
+        double sumCadence = 0;
+        double maxCadence = 0;
+        double sumSpeed = 0;
+        double maxSpeed = 0;
+        uint32_t heartSamples = 0;
+        double sumHeart = 0;
+        double maxHeart = 0;
+        double timeInZone[5];
+
+        // normalized power: 30 s rolling average, then the 4th power mean of it
+        double npRing[NP_WINDOW];
+        double npSum = 0;
+        double npFourth = 0;
+        uint32_t npSamples = 0;
+
+        // least squares line of the heart rate over the seconds of the lap
+        double sx = 0;
+        double sxx = 0;
+        double sxy = 0;
+    };
+
+    // by value: the baseline can be the last sample of the lap being restarted
+    void closeLap(uint8_t trigger, const SessionLine from, int32_t step);
+
+    accumulator m_lap;
+    accumulator m_step;
+    QList<lapsummary> m_laps;
+    QList<lapsummary> m_steps;
+    int32_t m_currentStep = -1;
+    bool m_started = false;
+
+    bool m_lapOnSteps = false;
+    bool m_autoPower = false;
+    double m_zones[4]; // bpm, lower bound of the zones 2..5
+
+    // interval detection: short average of the power against the average of the lap
+    double m_shortPower = 0;
+    uint16_t m_deviation = 0;
+};
+
+#endif // LAPANALYZER_H
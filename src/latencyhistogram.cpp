@@ -0,0 +1,51 @@
+#include "latencyhistogram.h"
+
+latencyhistogram::latencyhistogram(QString name, uint32_t maxMs)
+{
+    m_name = name;
+    // the last bucket collects everything over maxMs
+    m_buckets.fill(0, maxMs + 2);
+}
+
+void latencyhistogram::record(double ms)
+{
+    if(ms < 0) ms = 0;
+    int bucket = (int)ms;
+    if(bucket >= m_buckets.size() - 1)
+        bucket = m_buckets.size() - 1;
+    m_buckets[bucket]++;
+    m_count++;
+    if(ms > m_max)
+        m_max = ms;
+}
+
+void latencyhistogram::clear()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_max = 0;
+}
+
+double latencyhistogram::percentile(double p)
+{
+    if(!m_count) return 0;
+    uint32_t target = (uint32_t)((p / 100.0) * m_count);
+    if(target >= m_count) target = m_count - 1;
+    uint32_t acc = 0;
+    for(int i = 0; i < m_buckets.size(); i++)
+    {
+        acc += m_buckets.at(i);
+        if(acc > target)
+            return i;
+    }
+    return m_buckets.size() - 1;
+}
+
+QString latencyhistogram::report()
+{
+    return m_name + " samples " + QString::number(m_count) +
+            " p50 " + QString::number(percentile(50)) + "ms" +
+            " p90 " + QString::number(percentile(90)) + "ms" +
+            " p99 " + QString::number(percentile(99)) + "ms" +
+            " max " + QString::number(m_max, 'f', 1) + "ms";
+}
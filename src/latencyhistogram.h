@@ -0,0 +1,26 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QVector>
+#include <QString>
+
+// 1ms resolution histogram used to report latency percentiles without storing every sample
+class latencyhistogram
+{
+public:
+    latencyhistogram(QString name, uint32_t maxMs = 2000);
+    void record(double ms);
+    void clear();
+    uint32_t count() {return m_count;}
+    double percentile(double p);
+    double max() {return m_max;}
+    QString report();
+
+private:
+    QString m_name;
+    QVector<uint32_t> m_buckets;
+    uint32_t m_count = 0;
+    double m_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -239,7 +239,6 @@ m3ibike::m3ibike(bool noWriteResistance, bool noHeartService) {
 #if defined(Q_OS_IOS) || defined(Q_OS_ANDROID)
     qt_search = (QT_VERSION < QT_VERSION_CHECK(5, 12, 0))?false:settings.value("m3i_bike_qt_search", false).toBool();
 #endif
-    heartRateBeltDisabled = settings.value("heart_rate_belt_name", "Disabled").toString().startsWith("Disabled");
     m_watt.setType(metric::METRIC_WATT);
     this->noWriteResistance = noWriteResistance;
     this->noHeartService = noHeartService;
@@ -643,14 +642,15 @@ void m3ibike::processAdvertising(const QByteArray& data) {
         }
         emit resistanceRead(Resistance.value());
 
-        if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-            Cadence = k3.rpm;
+        sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, k3.rpm);
+        // the machine gives elapsed, calories and distance itself, so no update_metrics: only the sensor fusion
+        fuseSensors();
         m_watt = k3.watt;
         watts(); // to update avg and max
         if(!settings.value("speed_power_based", false).toBool())
             Speed = k3.speed;
         else
-            Speed = metric::calculateSpeedFromPower(m_watt.value());
+            Speed = physics.speed(m_watt.value());
         if(settings.value("m3i_bike_kcal", true).toBool())
             KCal = k3.calorie;
         else
@@ -679,24 +679,19 @@ void m3ibike::processAdvertising(const QByteArray& data) {
 
 #ifdef Q_OS_ANDROID
         if (antHeart)
-            Heart = (uint8_t)KeepAwakeHelper::heart();
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
         else
 #endif
         {
-            if (heartRateBeltDisabled) {
 #if defined(Q_OS_IOS) && !defined(IO_UNDER_QT)
-                long appleWatchHeartRate = h->heartRate();
-                h->setKcal(KCal.value());
-                h->setDistance(Distance.value());
-                if(appleWatchHeartRate == 0)
-                    Heart = k3.pulse;
-                else
-                    Heart = appleWatchHeartRate;
-                debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));                                    
-#else
-                Heart = k3.pulse;
+            long appleWatchHeartRate = h->heartRate();
+            h->setKcal(KCal.value());
+            h->setDistance(Distance.value());
+            if(appleWatchHeartRate > 0)
+                sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
+            debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
-            }
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, k3.pulse);
         }
 
 #if defined(Q_OS_IOS) && !defined(IO_UNDER_QT)
@@ -708,6 +703,9 @@ void m3ibike::processAdvertising(const QByteArray& data) {
         }
 #endif
 
+        updateHeartZone();
+        publishSample();
+
         debug("Current Elapsed: " + QString::number(elapsed.value()));
         debug("Current Resistance: " + QString::number(Resistance.value()));
         debug("Current Speed: " + QString::number(Speed.value()));
@@ -155,7 +155,6 @@ public slots:
     void searchingStop();
     void deviceDiscovered(const QBluetoothDeviceInfo &device);
 private:
-    bool heartRateBeltDisabled = true;
     bool antHeart = false;
     bool disconnecting = false;
     void initScan();
@@ -10,15 +10,22 @@
 #include <QStandardPaths>
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
+#include <QQuickWindow>
 #include <QSettings>
 #include <QDir>
 #include <QOperatingSystemVersion>
+#include <QThread>
 #include "virtualtreadmill.h"
 #include "domyostreadmill.h"
 #include "bluetooth.h"
 #include "mainwindow.h"
 #include "homeform.h"
 #include "qfit.h"
+#include "qfitreader.h"
+#include "hrzonecontroller.h"
+#include "startuptiming.h"
+#include "devicesession.h"
+#include "tracing.h"
 
 #ifdef Q_OS_ANDROID
 #include <QtAndroid>
@@ -50,6 +57,14 @@ bool battery_service = false;
 bool service_changed = false;
 bool bike_wheel_revs = false;
 bool run_cadence_sensor = false;
+bool bluetoothThread = false;
+uint32_t fitBenchmark = 0;
+QString fitImport;
+bool fitImportCheck = false;
+bool hrZoneSimulate = false;
+QStringList sessionNames;
+uint32_t sessionsLoadTest = 0;
+QString traceFile;
 QString trainProgram;
 QString deviceName = "";
 uint32_t pollDeviceTime = 200;
@@ -102,6 +117,8 @@ QCoreApplication* createApplication(int &argc, char *argv[])
             bike_wheel_revs = true;
         if (!qstrcmp(argv[i], "-run-cadence-sensor"))
             run_cadence_sensor = true;
+        if (!qstrcmp(argv[i], "-bluetooth-thread"))
+            bluetoothThread = true;
         if (!qstrcmp(argv[i], "-train"))
         {
             trainProgram = argv[++i];
@@ -122,6 +139,30 @@ QCoreApplication* createApplication(int &argc, char *argv[])
         {
             bikeResistanceOffset = atoi(argv[++i]);
         }
+        if (!qstrcmp(argv[i], "-fit-benchmark"))
+        {
+            fitBenchmark = atol(argv[++i]);
+        }
+        if (!qstrcmp(argv[i], "-fit-import"))
+        {
+            fitImport = argv[++i];
+        }
+        if (!qstrcmp(argv[i], "-fit-import-check"))
+            fitImportCheck = true;
+        if (!qstrcmp(argv[i], "-hr-zone-simulate"))
+            hrZoneSimulate = true;
+        if (!qstrcmp(argv[i], "-sessions"))
+        {
+            sessionNames = QString(argv[++i]).split(",");
+        }
+        if (!qstrcmp(argv[i], "-sessions-load-test"))
+        {
+            sessionsLoadTest = atol(argv[++i]);
+        }
+        if (!qstrcmp(argv[i], "-trace"))
+        {
+            traceFile = argv[++i];
+        }
     }
 
     if(nogui)
@@ -219,6 +260,8 @@ void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QS
 
 int main(int argc, char *argv[])
 {
+    startuptiming::start();
+
 #ifdef Q_OS_LINUX
 #ifndef Q_OS_ANDROID
     if (getuid()) 
@@ -241,6 +284,29 @@ int main(int argc, char *argv[])
     app->setOrganizationDomain("robertoviola.cloud");
     app->setApplicationName("qDomyos-Zwift");
 
+#if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
+    if(fitBenchmark)
+    {
+        printf("%s\n", qfit::benchmark(fitBenchmark).toLocal8Bit().constData());
+        return 0;
+    }
+    if(fitImport.length())
+    {
+        printf("%s\n", qfitreader::import(fitImport, fitImportCheck).toLocal8Bit().constData());
+        return 0;
+    }
+    if(hrZoneSimulate)
+    {
+        printf("%s", hrzonecontroller::simulate().toLocal8Bit().constData());
+        return 0;
+    }
+    if(sessionsLoadTest)
+    {
+        printf("%s\n", devicesessions::loadTest(sessionsLoadTest).toLocal8Bit().constData());
+        return 0;
+    }
+#endif
+
     QSettings settings;
 #if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
     if(forceQml)
@@ -260,6 +326,7 @@ int main(int argc, char *argv[])
         bikeResistanceOffset = settings.value("bike_resistance_offset", bikeResistanceOffset).toInt();
         bikeResistanceGain = settings.value("bike_resistance_gain_f", bikeResistanceGain).toDouble();
         deviceName = settings.value("filter_device", "Disabled").toString();
+        bluetoothThread = settings.value("bluetooth_thread", bluetoothThread).toBool();
     }
 #if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
     else
@@ -277,6 +344,12 @@ int main(int argc, char *argv[])
 #endif
 
     qInstallMessageHandler(myMessageOutput);
+    if(traceFile.length() || settings.value("tracing", false).toBool())
+        tracing::setEnabled(true);
+    if(traceFile.length())
+        QObject::connect(app.data(), &QCoreApplication::aboutToQuit, []() {
+            tracing::dump(traceFile);
+        });
     qDebug() << "version " << app->applicationVersion();
     foreach(QString s, settings.allKeys())
     {
@@ -321,7 +394,38 @@ int main(int argc, char *argv[])
     virtualbike* V = new virtualbike(new bike(), noWriteResistance, noHeartService);
     Q_UNUSED(V)
     return app->exec();*/
-    bluetooth* bl = new bluetooth(logs, deviceName, noWriteResistance, noHeartService, pollDeviceTime, noConsole, testResistance, bikeResistanceOffset, bikeResistanceGain);
+    // created here so the scheduler belongs to the main thread, whatever thread registers the first timer
+    pollscheduler::instance();
+#if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
+    if(sessionNames.length() && !forceQml)
+    {
+        // every machine of the list gets its manager, its thread and its session; one scan finds them all.
+        // No templates (web server, tcp client) in this mode
+        devicesessions* sessions = new devicesessions(sessionNames, [](const QString& name) {
+            return new bluetooth(logs, name, noWriteResistance, noHeartService, pollDeviceTime, noConsole, testResistance, bikeResistanceOffset, bikeResistanceGain, true);
+        }, trainProgram);
+        QObject::connect(app.data(), &QCoreApplication::aboutToQuit, sessions, &devicesessions::stop);
+        return app->exec();
+    }
+#endif
+    bluetooth* bl = 0;
+    if(bluetoothThread)
+    {
+        // the bluetooth manager, the drivers and the virtual devices it creates live on the I/O thread,
+        // so a long QML layout pass can't delay the notifications
+        QThread* ioThread = new QThread();
+        ioThread->setObjectName("bluetooth-io");
+        ioThread->start(QThread::HighPriority);
+        QObject* ioContext = new QObject();
+        ioContext->moveToThread(ioThread);
+        QMetaObject::invokeMethod(ioContext, [&bl]() {
+            bl = new bluetooth(logs, deviceName, noWriteResistance, noHeartService, pollDeviceTime, noConsole, testResistance, bikeResistanceOffset, bikeResistanceGain);
+        }, Qt::BlockingQueuedConnection);
+        ioContext->deleteLater();
+        qDebug() << "bluetooth running on its own thread";
+    }
+    else
+        bl = new bluetooth(logs, deviceName, noWriteResistance, noHeartService, pollDeviceTime, noConsole, testResistance, bikeResistanceOffset, bikeResistanceGain);
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
@@ -372,6 +476,19 @@ int main(int argc, char *argv[])
         }
 #endif
         engine.load(url);
+        startuptiming::mark("qml_loaded");
+        if(!engine.rootObjects().isEmpty())
+        {
+            if(QQuickWindow* window = qobject_cast<QQuickWindow*>(engine.rootObjects().first()))
+            {
+                // frameSwapped comes from the render thread, the mark is queued to this one
+                QSharedPointer<QMetaObject::Connection> frame(new QMetaObject::Connection);
+                *frame = QObject::connect(window, &QQuickWindow::frameSwapped, window, [frame]() {
+                    startuptiming::mark("first_frame");
+                    QObject::disconnect(*frame);
+                });
+            }
+        }
         homeform* h = new homeform(&engine, bl);
         QObject::connect(qobject_cast<QCoreApplication *>(app.data()), &QCoreApplication::aboutToQuit, h, &homeform::aboutToQuit);
 
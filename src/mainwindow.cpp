@@ -14,7 +14,7 @@ void MainWindow::load(bluetooth* b)
     connect(this->bluetoothManager, SIGNAL(deviceConnected()), this, SLOT(trainProgramSignals()));
     timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &MainWindow::update);
-    timer->start(1000);
+    pollscheduler::instance()->add(timer, 1000, pollscheduler::BACKGROUND);
 
 #ifdef Q_OS_ANDROID
     ui->groupTrain->setVisible(false);
@@ -58,18 +58,19 @@ void MainWindow::update()
         double peloton_resistance = 0;
         double watts = 0;
         double pace = 0;
+        const bluetoothdevicesample sample = bluetoothManager->device()->lastSample();
 
-        ui->speed->setText(QString::number(bluetoothManager->device()->currentSpeed().value(), 'f', 2));
-        ui->heartrate->setText(QString::number(bluetoothManager->device()->currentHeart().value()));
-        ui->odometer->setText(QString::number(bluetoothManager->device()->odometer(), 'f', 2));
-        ui->calories->setText(QString::number(bluetoothManager->device()->calories(), 'f', 0));
-        ui->fanBar->setValue(bluetoothManager->device()->fanSpeed());
+        ui->speed->setText(QString::number(sample.speed.value, 'f', 2));
+        ui->heartrate->setText(QString::number(sample.heart.value));
+        ui->odometer->setText(QString::number(sample.odometer, 'f', 2));
+        ui->calories->setText(QString::number(sample.calories, 'f', 0));
+        ui->fanBar->setValue(sample.fanSpeed);
 
-        if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
+        if(sample.type == bluetoothdevice::TREADMILL)
         {
-            if(bluetoothManager->device()->currentSpeed().value())
+            if(sample.speed.value && sample.pace)
             {
-                pace = 10000 / (((treadmill*)bluetoothManager->device())->currentPace().second() + (((treadmill*)bluetoothManager->device())->currentPace().minute() * 60));
+                pace = 10000 / sample.pace;
                 if(pace < 0) pace = 0;
             }
             else
@@ -77,35 +78,35 @@ void MainWindow::update()
                 pace = 0;
             }
             watts = ((treadmill*)bluetoothManager->device())->watts(ui->weight->text().toFloat());
-            inclination = ((treadmill*)bluetoothManager->device())->currentInclination().value();
-            ui->pace->setText(((treadmill*)bluetoothManager->device())->currentPace().toString("m:ss"));
+            inclination = sample.treadmill.inclination.value;
+            ui->pace->setText(QTime(0, 0).addSecs(sample.pace).toString("m:ss"));
             ui->watt->setText(QString::number(watts, 'f', 0));
             ui->inclination->setText(QString::number(inclination, 'f', 1));
-            ui->elevationGain->setText(QString::number(((treadmill*)bluetoothManager->device())->elevationGain(), 'f', 1));
+            ui->elevationGain->setText(QString::number(sample.elevationGain, 'f', 1));
         }
-        else if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
+        else if(sample.type == bluetoothdevice::BIKE)
         {
-            cadence = ((bike*)bluetoothManager->device())->currentCadence().value();
-            resistance = ((bike*)bluetoothManager->device())->currentResistance().value();
-            watts = ((bike*)bluetoothManager->device())->watts();
+            cadence = sample.bike.cadence.value;
+            resistance = sample.bike.resistance.value;
+            watts = sample.watt.value;
             ui->watt->setText(QString::number(watts));
             ui->resistance->setText(QString::number(resistance));
             ui->cadence->setText(QString::number(cadence));
         }
-        else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
+        else if(sample.type == bluetoothdevice::ROWING)
         {
-            cadence = ((rower*)bluetoothManager->device())->currentCadence().value();
-            resistance = ((rower*)bluetoothManager->device())->currentResistance().value();
-            watts = ((rower*)bluetoothManager->device())->watts();
+            cadence = sample.bike.cadence.value;
+            resistance = sample.bike.resistance.value;
+            watts = sample.watt.value;
             ui->watt->setText(QString::number(watts));
             ui->resistance->setText(QString::number(resistance));
             ui->cadence->setText(QString::number(cadence));
         }
-        else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
+        else if(sample.type == bluetoothdevice::ELLIPTICAL)
         {
-            cadence = ((elliptical*)bluetoothManager->device())->currentCadence();
-            resistance = ((elliptical*)bluetoothManager->device())->currentResistance();
-            watts = ((elliptical*)bluetoothManager->device())->watts();
+            cadence = sample.elliptical.cadence;
+            resistance = sample.elliptical.resistance;
+            watts = sample.watt.value;
             ui->watt->setText(QString::number(watts));
             ui->resistance->setText(QString::number(resistance));
             ui->cadence->setText(QString::number(cadence));
@@ -126,7 +127,7 @@ void MainWindow::update()
                 ui->trainProgramTotalDistance->setText("N/A");
         }
 
-        if(bluetoothManager->device()->connected())
+        if(sample.connected)
         {
             ui->connectionToTreadmill->setEnabled(true);
             if(bluetoothManager->device()->VirtualDevice())
@@ -161,16 +162,16 @@ void MainWindow::update()
             ui->connectionToTreadmill->setEnabled(false);
 
         SessionLine s(
-                      bluetoothManager->device()->currentSpeed().value(),
+                      sample.speed.value,
                       inclination,
-                      bluetoothManager->device()->odometer(),
+                      sample.odometer,
                       watts,
                       resistance,
                       peloton_resistance,
-                      (uint8_t)bluetoothManager->device()->currentHeart().value(),
-                      pace, cadence, bluetoothManager->device()->calories(),
-                      bluetoothManager->device()->elevationGain(),                      
-                      bluetoothManager->device()->elapsedTime().second() + (bluetoothManager->device()->elapsedTime().minute() * 60) + (bluetoothManager->device()->elapsedTime().hour() * 3600),
+                      (uint8_t)sample.heart.value,
+                      pace, cadence, sample.calories,
+                      sample.elevationGain,
+                      sample.elapsed,
                       false // TODO add lap
                     );
 
@@ -406,6 +407,14 @@ void MainWindow::loadTrainProgram(QString fileName)
     }
 }
 
+void MainWindow::onDevice(std::function<void(bluetoothdevice*)> call)
+{
+    bluetoothdevice* device = bluetoothManager->device();
+    if(!device)
+        return;
+    QMetaObject::invokeMethod(device, [device, call]() {call(device);}, Qt::QueuedConnection);
+}
+
 void MainWindow::on_load_clicked()
 {
     QString fileName = QFileDialog::getOpenFileName(this, tr("Open File"),
@@ -416,7 +425,7 @@ void MainWindow::on_load_clicked()
 
 void MainWindow::on_reset_clicked()
 {
-     if(bluetoothManager->device() && bluetoothManager->device()->currentSpeed().value() > 0) return;
+     if(bluetoothManager->device() && bluetoothManager->device()->lastSample().speed.value > 0) return;
 
     int countRow = 0;
      foreach(trainrow row, trainProgram->rows)
@@ -450,14 +459,14 @@ void MainWindow::on_reset_clicked()
 void MainWindow::on_stop_clicked()
 {
     if(bluetoothManager->device())
-        bluetoothManager->device()->stop();
+        onDevice([](bluetoothdevice* d) {d->stop();});
 }
 
 void MainWindow::on_start_clicked()
 {
      trainProgram->restart();
      if(bluetoothManager->device())
-         bluetoothManager->device()->start();
+         onDevice([](bluetoothdevice* d) {d->start();});
 }
 
 void MainWindow::on_groupTrain_clicked()
@@ -470,13 +479,13 @@ void MainWindow::on_groupTrain_clicked()
 void MainWindow::on_fanSpeedMinus_clicked()
 {
      if(bluetoothManager->device())
-          bluetoothManager->device()->changeFanSpeed(bluetoothManager->device()->fanSpeed() - 1);
+          onDevice([](bluetoothdevice* d) {d->changeFanSpeed(d->fanSpeed() - 1);});
 }
 
 void MainWindow::on_fanSpeedPlus_clicked()
 {
      if(bluetoothManager->device())
-          bluetoothManager->device()->changeFanSpeed(bluetoothManager->device()->fanSpeed() + 1);
+          onDevice([](bluetoothdevice* d) {d->changeFanSpeed(d->fanSpeed() + 1);});
 }
 
 void MainWindow::on_difficulty_valueChanged(int value)
@@ -518,7 +527,7 @@ void MainWindow::on_speedMinus_clicked()
     {
         if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
         {
-            ((treadmill*)bluetoothManager->device())->changeSpeed(((treadmill*)bluetoothManager->device())->currentSpeed().value() - 0.5);
+            onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeSpeed(((treadmill*)d)->currentSpeed().value() - 0.5, commandarbiter::USER);});
         }
     }
 }
@@ -529,7 +538,7 @@ void MainWindow::on_speedPlus_clicked()
     {
         if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
         {
-            ((treadmill*)bluetoothManager->device())->changeSpeed(((treadmill*)bluetoothManager->device())->currentSpeed().value() + 0.5);
+            onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeSpeed(((treadmill*)d)->currentSpeed().value() + 0.5, commandarbiter::USER);});
         }
     }
 }
@@ -540,7 +549,7 @@ void MainWindow::on_inclinationMinus_clicked()
     {
         if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
         {
-            ((treadmill*)bluetoothManager->device())->changeInclination(((treadmill*)bluetoothManager->device())->currentInclination().value() - 0.5);
+            onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeInclination(((treadmill*)d)->currentInclination().value() - 0.5, commandarbiter::USER);});
         }
     }
 }
@@ -551,7 +560,7 @@ void MainWindow::on_inclinationPlus_clicked()
     {
         if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
         {
-            ((treadmill*)bluetoothManager->device())->changeInclination(((treadmill*)bluetoothManager->device())->currentInclination().value() + 0.5);
+            onDevice([](bluetoothdevice* d) {((treadmill*)d)->changeInclination(((treadmill*)d)->currentInclination().value() + 0.5, commandarbiter::USER);});
         }
     }
 }
@@ -562,15 +571,15 @@ void MainWindow::on_resistanceMinus_clicked()
     {
         if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
         {
-            ((bike*)bluetoothManager->device())->changeResistance(((bike*)bluetoothManager->device())->currentResistance().value() - 1);
+            onDevice([](bluetoothdevice* d) {((bike*)d)->changeResistance(((bike*)d)->currentResistance().value() - 1, commandarbiter::USER);});
         }
         else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
         {
-            ((rower*)bluetoothManager->device())->changeResistance(((rower*)bluetoothManager->device())->currentResistance().value() - 1);
+            onDevice([](bluetoothdevice* d) {((rower*)d)->changeResistance(((rower*)d)->currentResistance().value() - 1, commandarbiter::USER);});
         }
         else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
         {
-            ((elliptical*)bluetoothManager->device())->changeResistance(((elliptical*)bluetoothManager->device())->currentResistance() - 1);
+            onDevice([](bluetoothdevice* d) {((elliptical*)d)->changeResistance(((elliptical*)d)->currentResistance() - 1, commandarbiter::USER);});
         }
     }
 }
@@ -581,15 +590,15 @@ void MainWindow::on_resistancePlus_clicked()
     {
         if(bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE)
         {
-            ((bike*)bluetoothManager->device())->changeResistance(((bike*)bluetoothManager->device())->currentResistance().value() + 1);
+            onDevice([](bluetoothdevice* d) {((bike*)d)->changeResistance(((bike*)d)->currentResistance().value() + 1, commandarbiter::USER);});
         }
         else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING)
         {
-            ((rower*)bluetoothManager->device())->changeResistance(((rower*)bluetoothManager->device())->currentResistance().value() + 1);
+            onDevice([](bluetoothdevice* d) {((rower*)d)->changeResistance(((rower*)d)->currentResistance().value() + 1, commandarbiter::USER);});
         }
         else if(bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL)
         {
-            ((elliptical*)bluetoothManager->device())->changeResistance(((elliptical*)bluetoothManager->device())->currentResistance() + 1);
+            onDevice([](bluetoothdevice* d) {((elliptical*)d)->changeResistance(((elliptical*)d)->currentResistance() + 1, commandarbiter::USER);});
         }
     }
 }
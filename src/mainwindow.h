@@ -6,6 +6,7 @@
 #include <QTime>
 #include <QDebug>
 #include <QTableWidgetItem>
+#include <functional>
 #include "trainprogram.h"
 #include "domyostreadmill.h"
 #include "sessionline.h"
@@ -29,6 +30,8 @@ private:
     void load(bluetooth* device);
     void loadTrainProgram(QString fileName);
     void createTrainProgram(QList<trainrow> rows);    
+    // the device can live on the bluetooth I/O thread: the calls that change it run there, queued
+    void onDevice(std::function<void(bluetoothdevice*)> call);
     bool editing = false;
     trainprogram* trainProgram = 0;
 
@@ -0,0 +1,85 @@
+#include "meanmaxcurve.h"
+
+meanmaxcurve::meanmaxcurve()
+{
+    m_durations = defaultDurations();
+    clear();
+}
+
+QList<uint32_t> meanmaxcurve::defaultDurations()
+{
+    QList<uint32_t> r;
+    r << 1 << 2 << 3 << 5 << 10 << 15 << 20 << 30 << 45
+      << 60 << 90 << 120 << 180 << 300 << 480 << 600 << 900 << 1200
+      << 1800 << 2700 << 3600 << 5400 << 7200 << 10800;
+    return r;
+}
+
+void meanmaxcurve::clear()
+{
+    m_best.clear();
+    for(int i = 0; i < m_durations.length(); i++)
+        m_best.append(0);
+    m_prefix.fill(0, m_durations.last() + 1);
+    m_samples = 0;
+}
+
+void meanmaxcurve::addSample(double value)
+{
+    const uint32_t n = m_samples + 1;
+    m_prefix[n % m_prefix.size()] = prefix(m_samples) + value;
+    m_samples = n;
+
+    // every window ending on the new sample is checked: the durations are sorted so we can stop
+    // at the first one longer than the workout itself
+    for(int i = 0; i < m_durations.length(); i++)
+    {
+        const uint32_t d = m_durations.at(i);
+        if(d > n)
+            break;
+        const double avg = (prefix(n) - prefix(n - d)) / d;
+        if(avg > m_best.at(i))
+            m_best[i] = avg;
+    }
+}
+
+double meanmaxcurve::best(uint32_t seconds)
+{
+    for(int i = 0; i < m_durations.length(); i++)
+    {
+        if(m_durations.at(i) == seconds)
+            return m_best.at(i);
+    }
+    return 0;
+}
+
+QList<double> meanmaxcurve::fromSamples(const QVector<double>& samples, const QList<uint32_t>& durations)
+{
+    QList<double> r;
+    const int n = samples.size();
+    QVector<double> prefix(n + 1);
+    prefix[0] = 0;
+    for(int i = 0; i < n; i++)
+        prefix[i + 1] = prefix[i] + samples.at(i);
+
+    const double* p = prefix.constData();
+    foreach(uint32_t d, durations)
+    {
+        double best = 0;
+        if((int)d <= n)
+        {
+            // branch free inner loop over contiguous memory, the compiler can vectorize it
+            const double* hi = p + d;
+            const int windows = n - d + 1;
+            double maxSum = 0;
+            for(int i = 0; i < windows; i++)
+            {
+                const double s = hi[i] - p[i];
+                maxSum = s > maxSum ? s : maxSum;
+            }
+            best = maxSum / d;
+        }
+        r.append(best);
+    }
+    return r;
+}
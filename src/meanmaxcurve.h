@@ -0,0 +1,35 @@
+#ifndef MEANMAXCURVE_H
+#define MEANMAXCURVE_H
+
+#include <QList>
+#include <QVector>
+
+// mean-maximal curve (best average over a window) for a 1 Hz metric stream.
+// the window durations are log spaced, so every new sample costs one check per duration
+// (O(durations), not O(samples)) and the prefix sums are kept in a ring as long as the longest
+// duration: memory doesn't grow with the workout and the whole curve can be read at any time
+class meanmaxcurve
+{
+public:
+    meanmaxcurve();
+    void clear();
+    void addSample(double value);
+    uint32_t samples() {return m_samples;}
+    double best(uint32_t seconds);
+    QList<uint32_t> durations() {return m_durations;}
+    QList<double> curve() {return m_best;}
+
+    static QList<uint32_t> defaultDurations();
+    // batch mode, used for imported/saved sessions where all the samples are already available
+    static QList<double> fromSamples(const QVector<double>& samples, const QList<uint32_t>& durations = defaultDurations());
+
+private:
+    QList<uint32_t> m_durations;
+    QList<double> m_best;
+    QVector<double> m_prefix; // ring of the prefix sums of the last longest duration + 1 samples
+    uint32_t m_samples;
+
+    double prefix(uint32_t n) {return m_prefix.at(n % m_prefix.size());}
+};
+
+#endif // MEANMAXCURVE_H
@@ -1,6 +1,7 @@
 #include "metric.h"
 #include <QSettings>
 #include <QDebug>
+#include <QDateTime>
 
 metric::metric()
 {
@@ -39,7 +40,19 @@ void metric::setValue(double v)
     }
     m_value = v;
 
-    if(paused) return;
+    if(paused)
+    {
+        m_lastSample = 0;
+        return;
+    }
+
+    if(m_resumeSeconds > 0)
+    {
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        if(value() != 0 && m_lastSample)
+            m_liveSeconds += (now - m_lastSample) / 1000.0;
+        m_lastSample = value() != 0 ? now : 0;
+    }
 
     if(value() != 0)
     {
@@ -72,6 +85,10 @@ void metric::clear(bool accumulator)
     m_totValue = 0;
     m_countValue = 0;
     m_min = 999999999;
+    m_resumeAverage = 0;
+    m_resumeSeconds = 0;
+    m_liveSeconds = 0;
+    m_lastSample = 0;
     clearLap(accumulator);
 }
 
@@ -88,10 +105,10 @@ double metric::lapValue()
 
 double metric::average()
 {
-    if(m_countValue == 0)
-        return 0;
-    else
-        return (m_totValue / m_countValue);
+    const double live = m_countValue ? (m_totValue / m_countValue) : 0;
+    if(m_resumeSeconds > 0)
+        return (m_resumeAverage * m_resumeSeconds + live * m_liveSeconds) / (m_resumeSeconds + m_liveSeconds);
+    return live;
 }
 
 double metric::lapAverage()
@@ -152,32 +169,36 @@ void metric::setLap(bool accumulator)
     clearLap(accumulator);
 }
 
-double metric::calculateSpeedFromPower(double power)
+void metric::resume(double value, double average, double seconds, double max)
 {
-    QSettings settings;
-    double twt = 9.8 * (settings.value("weight", 75.0).toFloat() + 0.0); // bike weight is null
-    double aero = 0.22691607640851885;
-    double hw = 0; // wind speed
-    double tr = twt * 0.005;
-    double tran = 0.95;
-    double p = power;
-    double  vel = 20;       // Initial guess
-    const uint8_t  MAX = 10;       // maximum iterations
-    double  TOL = 0.05;     // tolerance
-    for (int i=1; i < MAX; i++) {
-        double  tv = vel + hw;
-        double  aeroEff = (tv > 0.0) ? aero : -aero; // wind in face, must reverse effect
-        double  f = vel * (aeroEff * tv * tv + tr) - tran * p; // the function
-        double  fp = aeroEff * (3.0 * vel + hw) * tv + tr;     // the derivative
-        double  vNew = vel - f / fp;
-        if (qAbs(vNew - vel) < TOL)
-            return vNew * 3.6;  // success
-        vel = vNew;
-    }
-    return 0.0;  // failed to converge
+    m_offset -= value;
+    m_resumeAverage = average;
+    m_resumeSeconds = seconds;
+    m_liveSeconds = 0;
+    m_lastSample = 0;
+    if(max > m_max)
+        m_max = max;
 }
 
 double metric::calculateWeightLoss(double kcal)
 {
     return kcal / 7716.1854; // comes from 1 lbs = 3500 kcal. Converted to kg
 }
+
+double metric::maxHeartRate()
+{
+    QSettings settings;
+    double maxHeartRate = 220.0 - settings.value("age", 35).toDouble();
+    if(maxHeartRate == 0) maxHeartRate = 190.0;
+    return maxHeartRate;
+}
+
+void metric::heartRateZones(double zones[4])
+{
+    QSettings settings;
+    const double maxHeartRate = metric::maxHeartRate();
+    zones[0] = maxHeartRate * settings.value("heart_rate_zone1", 70.0).toDouble() / 100.0;
+    zones[1] = maxHeartRate * settings.value("heart_rate_zone2", 80.0).toDouble() / 100.0;
+    zones[2] = maxHeartRate * settings.value("heart_rate_zone3", 90.0).toDouble() / 100.0;
+    zones[3] = maxHeartRate * settings.value("heart_rate_zone4", 100.0).toDouble() / 100.0;
+}
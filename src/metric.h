@@ -2,6 +2,7 @@
 #define METRIC_H
 
 #include <math.h>
+#include <QtGlobal>
 
 class metric
 {
@@ -29,9 +30,15 @@ public:
     void operator += (double);
     void setPaused(bool p);
     void setLap(bool accumulator);
+    // continues a session: the accumulator starts from value, the average of the resumed part (non zero
+    // values for seconds) is merged with the live one by time, the live samples come at the poll rate
+    void resume(double value, double average, double seconds, double max);
 
-    static double calculateSpeedFromPower(double power);
     static double calculateWeightLoss(double kcal);
+    // from the settings (age, heart_rate_zone1..4)
+    static double maxHeartRate();
+    // bpm, lower bound of the heart rate zones 2..5
+    static void heartRateZones(double zones[4]);
 
 private:
     double m_value = 0;
@@ -49,6 +56,11 @@ private:
 
     _metric_type m_type = METRIC_OTHER;
 
+    double m_resumeAverage = 0;
+    double m_resumeSeconds = 0;
+    double m_liveSeconds = 0; // time covered by the non zero samples after a resume
+    qint64 m_lastSample = 0; // msecs
+
     bool paused = false;
 };
 
@@ -21,7 +21,7 @@ npecablebike::npecablebike(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 /*
 void npecablebike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
@@ -71,7 +71,7 @@ void npecablebike::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -114,10 +114,10 @@ void npecablebike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void npecablebike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("npecablebike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     qDebug() << " << char " << characteristic.uuid();
     debug(" << " + newValue.toHex(' '));
@@ -160,19 +160,16 @@ void npecablebike::characteristicChanged(const QLowEnergyCharacteristic &charact
             deltaT = LastCrankEventTime + 1024 - oldLastCrankEventTime;
         }
 
-        if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
+        if(CrankRevs != oldCrankRevs && deltaT)
         {
-            if(CrankRevs != oldCrankRevs && deltaT)
-            {
-                double cadence = ((CrankRevs - oldCrankRevs) / deltaT) * 1024 * 60;
-                if(cadence >= 0)
-                    Cadence = cadence;
-                lastGoodCadence = QDateTime::currentDateTime();
-            }
-            else if(lastGoodCadence.msecsTo(QDateTime::currentDateTime()) > 2000)
-            {
-                Cadence = 0;
-            }
+            double cadence = ((CrankRevs - oldCrankRevs) / deltaT) * 1024 * 60;
+            if(cadence >= 0)
+                sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, cadence);
+            lastGoodCadence = QDateTime::currentDateTime();
+        }
+        else if(lastGoodCadence.msecsTo(QDateTime::currentDateTime()) > 2000)
+        {
+            sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, 0);
         }
 
         debug("Current Cadence: " + QString::number(Cadence.value()));
@@ -183,7 +180,7 @@ void npecablebike::characteristicChanged(const QLowEnergyCharacteristic &charact
         if(!settings.value("speed_power_based", false).toBool())
             Speed = Cadence.value() * settings.value("cadence_sensor_speed_ratio", 0.33).toDouble();
         else
-            Speed = metric::calculateSpeedFromPower(m_watt.value());
+            Speed = physics.speed(m_watt.value());
         debug("Current Speed: " + QString::number(Speed.value()));
 
         Distance += ((Speed.value() / 3600000.0) * ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())) );
@@ -199,9 +196,10 @@ void npecablebike::characteristicChanged(const QLowEnergyCharacteristic &charact
     else if(characteristic.uuid() == QBluetoothUuid::HeartRateMeasurement)
     {
         if(newValue.length() > 1)
-            Heart = newValue[1];
-
-        debug("Current heart: " + QString::number(Heart.value()));
+        {
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, (uint8_t)newValue.at(1));
+            debug("Current heart: " + QString::number((uint8_t)newValue.at(1)));
+        }
     }
     else if(characteristic.uuid() == QBluetoothUuid::CyclingPowerMeasurement)
     {
@@ -214,11 +212,10 @@ void npecablebike::characteristicChanged(const QLowEnergyCharacteristic &charact
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
     {
-        Heart = (uint8_t)KeepAwakeHelper::heart();
-        debug("Current Heart: " + QString::number(Heart.value()));
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
+        debug("Current Heart: " + QString::number(KeepAwakeHelper::heart()));
     }
 #endif
-    if(heartRateBeltName.startsWith("Disabled") && Heart.value() == 0)
     {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
@@ -226,7 +223,8 @@ void npecablebike::characteristicChanged(const QLowEnergyCharacteristic &charact
     long appleWatchHeartRate = h.heartRate();
     h.setKcal(KCal.value());
     h.setDistance(Distance.value());
-    Heart = appleWatchHeartRate;
+    if(appleWatchHeartRate > 0)
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
     debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
@@ -218,7 +218,7 @@ void peloton::performance_onfinish(QNetworkReply* reply)
         r.resistance = ((bike*)bluetoothManager->device())->pelotonToBikeResistance(lower_resistances.at(i).toInt());
         r.requested_peloton_resistance = lower_resistances.at(i).toInt();
         r.cadence = lower_cadences.at(i).toInt();
-        trainrows.append(r);
+        trainprogram::appendSegment(trainrows, r);
     }
 
     if(log_request)
@@ -0,0 +1,184 @@
+#include "pollscheduler.h"
+#include "tracing.h"
+#include <QDateTime>
+#include <QSettings>
+#include <QDebug>
+
+// interval multiplier in percent, per task type and activity
+static const int activityFactor[pollscheduler::TASKS][pollscheduler::ACTIVITIES] = {
+    // RIDING, TRANSITION, PAUSED, IDLE
+    {100, 50, 200, 400}, // DEVICE
+    {100, 100, 100, 500}, // BACKGROUND
+    {100, 100, 100, 100}, // FIXED
+};
+
+static const int minInterval = 100;
+static const int maxDeviceInterval = 2000;
+static const qint64 transitionTime = 5000;
+static const uint8_t maxBackoff = 8;
+static const uint8_t timeoutsBeforeBackoff = 3;
+static const uint8_t oksBeforeRecover = 20;
+
+pollscheduler::pollscheduler(QObject *parent) : QObject(parent)
+{
+    QSettings settings;
+    m_adaptive = settings.value("poll_scheduler_adaptive", true).toBool();
+    m_idleAfter = settings.value("poll_scheduler_idle_timeout", 60000).toLongLong();
+}
+
+pollscheduler* pollscheduler::instance()
+{
+    static pollscheduler* s = new pollscheduler();
+    return s;
+}
+
+int pollscheduler::interval(const polltask& t)
+{
+    if(!m_adaptive || t.task == FIXED)
+        return t.base;
+
+    int v = (t.base * activityFactor[t.task][m_activity]) / 100;
+    v *= t.backoff;
+
+    if(t.task == DEVICE)
+    {
+        if(v > maxDeviceInterval && t.base <= maxDeviceInterval)
+            v = maxDeviceInterval;
+    }
+    if(v < minInterval)
+        v = minInterval;
+
+    // snap to a grid shared by all the timers, so that they tend to fire on the same wakeup
+    const int grid = (v < 1000 ? 50 : 500);
+    v = ((v + grid / 2) / grid) * grid;
+    return v;
+}
+
+void pollscheduler::apply(QTimer* timer, polltask& t)
+{
+    const int v = interval(t);
+    if(v == t.current)
+        return;
+    // the first apply starts the timer, the next ones must not restart a timer stopped by its owner
+    const bool first = (t.current == 0);
+    t.current = v;
+
+    // the timer could belong to the bluetooth thread: it can only be touched from there
+    const Qt::TimerType type = (t.task == DEVICE && m_activity == TRANSITION ? Qt::PreciseTimer : Qt::CoarseTimer);
+    QMetaObject::invokeMethod(timer, [timer, v, type, first]() {
+        timer->setTimerType(type);
+        if(first || timer->isActive())
+            timer->start(v);
+        else
+            timer->setInterval(v);
+    }, Qt::AutoConnection);
+}
+
+void pollscheduler::applyAll()
+{
+    for(QHash<QTimer*, polltask>::iterator i = m_tasks.begin(); i != m_tasks.end(); ++i)
+        apply(i.key(), i.value());
+}
+
+void pollscheduler::add(QTimer* timer, int interval, TASK task)
+{
+    QMutexLocker locker(&m_mutex);
+    polltask t;
+    t.base = interval;
+    t.current = 0;
+    t.task = task;
+    t.backoff = 1;
+    t.timeouts = 0;
+    t.oks = 0;
+    // a timer registered again (restarted by its owner) keeps its single destroyed connection
+    if(!m_tasks.contains(timer))
+    {
+        connect(timer, &QObject::destroyed, this, [this, timer]() {
+            QMutexLocker locker(&m_mutex);
+            m_tasks.remove(timer);
+        }, Qt::DirectConnection);
+    }
+    m_tasks.insert(timer, t);
+
+    apply(timer, m_tasks[timer]);
+}
+
+void pollscheduler::setBaseInterval(QTimer* timer, int interval)
+{
+    QMutexLocker locker(&m_mutex);
+    if(!m_tasks.contains(timer))
+        return;
+    polltask& t = m_tasks[timer];
+    t.base = interval;
+    t.current = 0;
+    apply(timer, t);
+}
+
+void pollscheduler::setActivity(ACTIVITY activity)
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_requested = activity;
+
+    if(activity == RIDING)
+        m_notRidingSince = 0;
+    else if(m_notRidingSince == 0)
+        m_notRidingSince = now;
+
+    ACTIVITY a = activity;
+    if(a == RIDING && now < m_transitionUntil)
+        a = TRANSITION;
+    else if(a == PAUSED && now - m_notRidingSince > m_idleAfter)
+        a = IDLE;
+
+    if(a == m_activity)
+        return;
+
+    qDebug() << "pollscheduler activity" << m_activity << "->" << a;
+    m_activity = a;
+    applyAll();
+}
+
+void pollscheduler::transition()
+{
+    QMutexLocker locker(&m_mutex);
+    m_transitionUntil = QDateTime::currentMSecsSinceEpoch() + transitionTime;
+    if(m_activity != RIDING)
+        return;
+
+    qDebug() << "pollscheduler activity" << m_activity << "->" << TRANSITION;
+    m_activity = TRANSITION;
+    applyAll();
+}
+
+void pollscheduler::writeResult(QTimer* timer, bool ok)
+{
+    QMutexLocker locker(&m_mutex);
+    if(!m_tasks.contains(timer))
+        return;
+    polltask& t = m_tasks[timer];
+
+    if(ok)
+    {
+        t.timeouts = 0;
+        if(t.backoff > 1 && ++t.oks >= oksBeforeRecover)
+        {
+            t.oks = 0;
+            t.backoff /= 2;
+            qDebug() << "pollscheduler link recovered, backoff" << t.backoff;
+            apply(timer, t);
+        }
+    }
+    else
+    {
+        t.oks = 0;
+        if(++t.timeouts >= timeoutsBeforeBackoff && t.backoff < maxBackoff)
+        {
+            t.timeouts = 0;
+            t.backoff *= 2;
+            qDebug() << "pollscheduler write timeouts, backoff" << t.backoff;
+            apply(timer, t);
+        }
+    }
+    TRACE_COUNTER("write_timeouts", t.timeouts);
+}
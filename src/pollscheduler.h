@@ -0,0 +1,72 @@
+#ifndef POLLSCHEDULER_H
+#define POLLSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+#include <QHash>
+
+// every periodic timer of the app (device polls, ui refresh, virtual devices) is registered here
+// with its nominal interval. The scheduler stretches or shrinks the intervals according to what the user
+// is doing (riding, erg transition, paused, idle) and to the link quality reported by the drivers, and it
+// snaps them to a common grid so the wakeups of the different timers coincide.
+class pollscheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum TASK {
+        DEVICE = 0,  // bluetooth polls, follow the activity and the link quality
+        BACKGROUND,  // housekeeping, only slowed down when idle
+        FIXED,       // sampling clocks (session, virtual devices), aligned but never scaled
+        TASKS
+    };
+
+    enum ACTIVITY {
+        RIDING = 0,
+        TRANSITION,
+        PAUSED,
+        IDLE,
+        ACTIVITIES
+    };
+
+    static pollscheduler* instance();
+
+    // registers the timer and starts it, call it again to restart a timer stopped by its owner
+    void add(QTimer* timer, int interval, TASK task = DEVICE);
+    void setBaseInterval(QTimer* timer, int interval);
+    void setActivity(ACTIVITY activity);
+    ACTIVITY activity() {return m_activity;}
+    void writeResult(QTimer* timer, bool ok);
+
+public slots:
+    void transition();
+
+private:
+    explicit pollscheduler(QObject *parent = nullptr);
+
+    typedef struct polltask
+    {
+        int base;
+        int current;
+        TASK task;
+        uint8_t backoff;  // multiplier applied while the link is timing out
+        uint8_t timeouts; // consecutive write timeouts
+        uint8_t oks;      // consecutive good writes since the last backoff change
+    }polltask;
+
+    int interval(const polltask& t);
+    void apply(QTimer* timer, polltask& t);
+    void applyAll();
+
+    QMutex m_mutex;
+    QHash<QTimer*, polltask> m_tasks;
+    ACTIVITY m_activity = RIDING;
+    ACTIVITY m_requested = RIDING;
+    qint64 m_notRidingSince = 0;
+    qint64 m_transitionUntil = 0;
+    bool m_adaptive = true;
+    qint64 m_idleAfter = 60000;
+};
+
+#endif // POLLSCHEDULER_H
@@ -122,7 +122,7 @@ void powerzonepack::search_workout_onfinish(QNetworkReply* reply)
         r.duration = QTime(0,0,lastSeconds.msecsTo(seconds) / 1000,0);
         r.power = power_graph.at(i - 1).toObject()["power_ratio"].toDouble() * settings.value("ftp", 200.0).toDouble();
         lastSeconds = seconds;
-        trainrows.append(r);
+        trainprogram::appendSegment(trainrows, r);
     }
 
     if(trainrows.length())
@@ -20,11 +20,12 @@ proformbike::proformbike(bool noWriteResistance, bool noHeartService, uint8_t bi
     this->bikeResistanceOffset = bikeResistanceOffset;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void proformbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("proformbike::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
     if(wait_for_response)
@@ -191,7 +192,7 @@ void proformbike::update()
             counterPoll = 0;
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -259,10 +260,10 @@ void proformbike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void proformbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("proformbike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -356,13 +357,12 @@ void proformbike::characteristicChanged(const QLowEnergyCharacteristic &characte
         }
         emit resistanceRead(Resistance.value());
 
-        if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-            Cadence = ((uint8_t)newValue.at(18));
+        sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, (uint8_t)newValue.at(18));
 
         if(!settings.value("speed_power_based", false).toBool())
             Speed = (settings.value("proform_wheel_ratio", 0.33).toDouble()) * ((double)Cadence.value());
         else
-            Speed = metric::calculateSpeedFromPower(m_watt.value());
+            Speed = physics.speed(m_watt.value());
         KCal += ((( (0.048 * ((double)watts()) + 1.19) * settings.value("weight", 75.0).toFloat() * 3.5) / 200.0 ) / (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())))); //(( (0.048* Output in watts +1.19) * body weight in kg * 3.5) / 200 ) / 60
         //KCal = (((uint16_t)((uint8_t)newValue.at(15)) << 8) + (uint16_t)((uint8_t) newValue.at(14)));
         Distance += ((Speed.value() / 3600000.0) * ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())) );
@@ -377,23 +377,21 @@ void proformbike::characteristicChanged(const QLowEnergyCharacteristic &characte
 
 #ifdef Q_OS_ANDROID
         if(settings.value("ant_heart", false).toBool())
-            Heart = (uint8_t)KeepAwakeHelper::heart();
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
         else
 #endif
         {
-            if(heartRateBeltName.startsWith("Disabled"))
-            {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-                lockscreen h;
-                long appleWatchHeartRate = h.heartRate();
-                h.setKcal(KCal.value());
-                h.setDistance(Distance.value());
-                Heart = appleWatchHeartRate;
-                debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
+            lockscreen h;
+            long appleWatchHeartRate = h.heartRate();
+            h.setKcal(KCal.value());
+            h.setDistance(Distance.value());
+            if(appleWatchHeartRate > 0)
+                sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
+            debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-            }
         }
 
     #ifdef Q_OS_IOS
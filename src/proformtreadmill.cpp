@@ -18,11 +18,12 @@ proformtreadmill::proformtreadmill(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void proformtreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("proformtreadmill::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
     if(wait_for_response)
@@ -106,7 +107,7 @@ void proformtreadmill::update()
             counterPoll = 0;
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -152,10 +153,10 @@ void proformtreadmill::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void proformtreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("proformtreadmill::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -186,23 +187,21 @@ void proformtreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
 
 #ifdef Q_OS_ANDROID
         if(settings.value("ant_heart", false).toBool())
-            Heart = (uint8_t)KeepAwakeHelper::heart();
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
         else
 #endif
         {
-            if(heartRateBeltName.startsWith("Disabled"))
-            {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-                lockscreen h;
-                long appleWatchHeartRate = h.heartRate();
-                h.setKcal(KCal.value());
-                h.setDistance(Distance.value());
-                Heart = appleWatchHeartRate;
-                debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
+            lockscreen h;
+            long appleWatchHeartRate = h.heartRate();
+            h.setKcal(KCal.value());
+            h.setDistance(Distance.value());
+            if(appleWatchHeartRate > 0)
+                sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
+            debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-            }
         }
 
         debug("Current Inclination: " + QString::number(Inclination.value()));
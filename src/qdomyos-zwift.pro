@@ -10,6 +10,8 @@ qtHaveModule(httpserver) {
 }
 
 CONFIG += c++11 console debug app_bundle
+# qml compiled ahead of time into the binary, settings.qml is the largest page
+CONFIG += qtquickcompiler
 macx: CONFIG += static
 
 # The following define makes your compiler emit warnings if you use
@@ -18,6 +20,9 @@ macx: CONFIG += static
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS IO_UNDER_QT SMTP_BUILD
 
+# spans and counters of tracing.h, qmake CONFIG+=notracing builds without them
+!CONFIG(notracing): DEFINES += QZ_TRACING
+
 # You can also make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
@@ -68,21 +73,40 @@ SOURCES += \
     ftmsrower.cpp \
 	     gpx.cpp \
 		heartratebelt.cpp \
+	latencyhistogram.cpp \
 	homeform.cpp \
    horizontreadmill.cpp \
 	inspirebike.cpp \
 	keepawakehelper.cpp \
 	     main.cpp \
 		metric.cpp \
+		meanmaxcurve.cpp \
     npecablebike.cpp \
    peloton.cpp \
    powerzonepack.cpp \
 	proformbike.cpp \
 	proformtreadmill.cpp \
 	qfit.cpp \
+	qfitwriter.cpp \
+	qfitreader.cpp \
+	hrvanalyzer.cpp \
+	hrzonecontroller.cpp \
+	lapanalyzer.cpp \
+	sessionjournal.cpp \
+	chartrenderer.cpp \
+	sessionmodel.cpp \
+	bikephysics.cpp \
+	startuptiming.cpp \
+	devicesession.cpp \
+	tracing.cpp \
+	actuationmodel.cpp \
+	commandarbiter.cpp \
+	telemetrystream.cpp \
    rower.cpp \
 	schwinnic4bike.cpp \
    screencapture.cpp \
+	sensorbus.cpp \
+	pollscheduler.cpp \
 	sessionline.cpp \
 	signalhandler.cpp \
     skandikawiribike.cpp \
@@ -117,6 +141,7 @@ SOURCES += \
 	     virtualtreadmill.cpp \
              m3ibike.cpp \
                 domyosbike.cpp \
+                domyosframe.cpp \
                scanrecordresult.cpp \
    zwiftworkout.cpp
 macx: SOURCES += macos/lockscreen.mm
@@ -365,6 +390,7 @@ HEADERS += \
 	flywheelbike.h \
 	ftmsbike.h \
 	 heartratebelt.h \
+	latencyhistogram.h \
 	homeform.h \
    horizontreadmill.h \
 	inspirebike.h \
@@ -374,15 +400,34 @@ HEADERS += \
         ios/M3iIOS-Interface.h \
 	material.h \
 	metric.h \
+	meanmaxcurve.h \
     npecablebike.h \
    peloton.h \
    powerzonepack.h \
 	proformbike.h \
 	proformtreadmill.h \
 	qfit.h \
+	qfitwriter.h \
+	qfitreader.h \
+	hrvanalyzer.h \
+	hrzonecontroller.h \
+	lapanalyzer.h \
+	sessionjournal.h \
+	chartrenderer.h \
+	sessionmodel.h \
+	bikephysics.h \
+	startuptiming.h \
+	devicesession.h \
+	tracing.h \
+	actuationmodel.h \
+	commandarbiter.h \
+	telemetrystream.h \
    rower.h \
 	schwinnic4bike.h \
    screencapture.h \
+	sensorbus.h \
+	pollscheduler.h \
+	seqlock.h \
 	sessionline.h \
 	signalhandler.h \
     skandikawiribike.h \
@@ -419,6 +464,7 @@ HEADERS += \
 	 virtualbike.h \
 	virtualtreadmill.h \
 	 domyosbike.h \
+	 domyosframe.h \
         yesoulbike.h \
         scanrecordresult.h \
    zwiftworkout.h
@@ -6,6 +6,13 @@
 #include "fit_mesg_broadcaster.hpp"
 #include "fit_file_id_mesg.hpp"
 #include "fit_date_time.hpp"
+#include "fit_field_description_mesg.hpp"
+#include "fit_developer_field.hpp"
+#include "meanmaxcurve.h"
+#include "lapanalyzer.h"
+#include "qfitwriter.h"
+#include <QElapsedTimer>
+#include <QDir>
 
 
 qfit::qfit(QObject *parent) : QObject(parent)
@@ -13,26 +20,28 @@ qfit::qfit(QObject *parent) : QObject(parent)
 
 }
 
-void qfit::save(QString filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type, uint32_t processFlag)
+void qfit::save(QString filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type, uint32_t processFlag, const QList<lapsummary>& laps,
+                const QList<lapsummary>& steps)
 {
-    std::list<fit::RecordMesg> records;
     fit::Encode encode( fit::ProtocolVersion::V20 );
+    qfitwriter writer;
+    const bool sdkEncoder = processFlag & QFIT_PROCESS_SDKENCODER;
     if(!session.length()) return;
     std::fstream file;
     double startingDistanceOffset = 0;
     if(session.length())
         startingDistanceOffset = session.first().distance;
 
-    file.open(filename.toStdString(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
-
-    if (!file.is_open())
+    if(sdkEncoder)
     {
-       printf("Error opening file ExampleActivity.fit\n");
-       return;
-    }
+        file.open(filename.toStdString(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
 
-    QFile output(filename);
-    output.open(QIODevice::WriteOnly);
+        if (!file.is_open())
+        {
+           printf("Error opening file ExampleActivity.fit\n");
+           return;
+        }
+    }
 
     fit::FileIdMesg fileIdMesg; // Every FIT file requires a File ID message
     fileIdMesg.SetType(FIT_FILE_ACTIVITY);
@@ -80,6 +89,72 @@ void qfit::save(QString filename, QList<SessionLine> session, bluetoothdevice::B
     }
     devIdMesg.SetDeveloperDataIndex(0);
 
+    // best efforts of the whole session as developer fields of the session message
+    QVector<double> wattSamples;
+    wattSamples.reserve(session.length());
+    foreach(SessionLine s, session)
+        wattSamples.append(s.watt);
+    QList<uint32_t> bestPowerDurations;
+    bestPowerDurations << 5 << 60 << 300 << 1200 << 3600;
+    QList<double> bestPower = meanmaxcurve::fromSamples(wattSamples, bestPowerDurations);
+    std::list<fit::FieldDescriptionMesg> bestPowerDescriptions;
+    for (int i = 0; i < bestPowerDurations.length(); i++)
+    {
+        fit::FieldDescriptionMesg desc;
+        desc.SetDeveloperDataIndex(0);
+        desc.SetFieldDefinitionNumber(i);
+        desc.SetFitBaseTypeId(FIT_FIT_BASE_TYPE_UINT16);
+        desc.SetFieldName(0, QString("best_power_" + QString::number(bestPowerDurations.at(i)) + "s").toStdWString());
+        desc.SetUnits(0, L"watts");
+        desc.SetNativeMesgNum(FIT_MESG_NUM_SESSION);
+        bestPowerDescriptions.push_back(desc);
+
+        fit::DeveloperField field(desc, devIdMesg);
+        field.SetUINT16Value(bestPower.at(i));
+        sessionMesg.AddDeveloperField(field);
+    }
+
+    // heart rate variability of the belt as developer fields of the records, only if the session has it
+    bool hrv = false;
+    foreach(SessionLine s, session)
+    {
+        if(s.rmssd > 0)
+        {
+            hrv = true;
+            break;
+        }
+    }
+    const FIT_UINT8 hrvFirstField = bestPowerDurations.length();
+    const wchar_t* hrvNames[] = {L"rmssd", L"sdnn", L"dfa_alpha1"};
+    const wchar_t* hrvUnits[] = {L"ms", L"ms", L""};
+    std::list<fit::FieldDescriptionMesg> hrvDescriptions;
+    if(hrv)
+    {
+        for (FIT_UINT8 i = 0; i < 3; i++)
+        {
+            fit::FieldDescriptionMesg desc;
+            desc.SetDeveloperDataIndex(0);
+            desc.SetFieldDefinitionNumber(hrvFirstField + i);
+            desc.SetFitBaseTypeId(FIT_FIT_BASE_TYPE_FLOAT32);
+            desc.SetFieldName(0, hrvNames[i]);
+            desc.SetUnits(0, hrvUnits[i]);
+            desc.SetNativeMesgNum(FIT_MESG_NUM_RECORD);
+            hrvDescriptions.push_back(desc);
+        }
+        writer.setRecordDeveloperFields(0, hrvFirstField, 3);
+    }
+
+    // laps from the summaries kept during the workout, computed here only for the sessions recorded without them
+    const QList<lapsummary> lapList = laps.isEmpty() ? lapanalyzer::fromSession(session) : laps;
+    sessionMesg.SetNumLaps(lapList.length());
+    fit::FieldDescriptionMesg heartDriftDescription;
+    heartDriftDescription.SetDeveloperDataIndex(0);
+    heartDriftDescription.SetFieldDefinitionNumber(hrvFirstField + 3);
+    heartDriftDescription.SetFitBaseTypeId(FIT_FIT_BASE_TYPE_FLOAT32);
+    heartDriftDescription.SetFieldName(0, L"hr_drift");
+    heartDriftDescription.SetUnits(0, L"%");
+    heartDriftDescription.SetNativeMesgNum(FIT_MESG_NUM_LAP);
+
     fit::ActivityMesg activityMesg;
     activityMesg.SetTimestamp(session.first().time.toSecsSinceEpoch() - 631065600L);
     activityMesg.SetTotalTimerTime(session.last().elapsedTime);
@@ -91,33 +166,24 @@ void qfit::save(QString filename, QList<SessionLine> session, bluetoothdevice::B
     activityMesg.SetEvent(FIT_EVENT_ACTIVITY);
     activityMesg.SetEventType(FIT_EVENT_TYPE_STOP);
 
-    fit::LapMesg lapMesg;
-    lapMesg.SetIntensity(FIT_INTENSITY_ACTIVE);
-    lapMesg.SetStartTime(session.first().time.toSecsSinceEpoch() - 631065600L);
-    lapMesg.SetTimestamp(session.first().time.toSecsSinceEpoch() - 631065600L);
-    lapMesg.SetEvent(FIT_EVENT_WORKOUT);
-    lapMesg.SetEventType(FIT_EVENT_TYPE_STOP);
-    lapMesg.SetLapTrigger(FIT_LAP_TRIGGER_TIME);
-    lapMesg.SetTotalElapsedTime(0);
-    lapMesg.SetTotalTimerTime(0);
-    if(type == bluetoothdevice::TREADMILL)
-    {
-        lapMesg.SetSport(FIT_SPORT_RUNNING);
-    }
-    else if(type == bluetoothdevice::ELLIPTICAL)
-    {
-        lapMesg.SetSport(FIT_SPORT_RUNNING);
-    }
-    else
-    {
-        lapMesg.SetSport(FIT_SPORT_CYCLING);
-    }        
+    auto write = [&](const fit::Mesg& mesg) {
+        if(sdkEncoder)
+            encode.Write(mesg);
+        else
+            writer.write(mesg);
+    };
 
-    encode.Open(file);
-    encode.Write(fileIdMesg);
-    encode.Write(devIdMesg);
-    encode.Write(sessionMesg);
-    encode.Write(activityMesg);
+    if(sdkEncoder)
+        encode.Open(file);
+    write(fileIdMesg);
+    write(devIdMesg);
+    for (std::list<fit::FieldDescriptionMesg>::iterator it = bestPowerDescriptions.begin(); it != bestPowerDescriptions.end(); ++it)
+        write(*it);
+    for (std::list<fit::FieldDescriptionMesg>::iterator it = hrvDescriptions.begin(); it != hrvDescriptions.end(); ++it)
+        write(*it);
+    write(heartDriftDescription);
+    write(sessionMesg);
+    write(activityMesg);
 
     fit::DateTime date((time_t)session.first().time.toSecsSinceEpoch());
     SessionLine sl;
@@ -141,43 +207,143 @@ void qfit::save(QString filename, QList<SessionLine> session, bluetoothdevice::B
     }
     for (int i = 0; i < session.length(); i++)
     {
-        fit::RecordMesg newRecord;
         sl = session.at(i);
-        //fit::DateTime date((time_t)session.at(i).time.toSecsSinceEpoch());
-        newRecord.SetHeartRate(sl.heart);
-        newRecord.SetCadence(sl.cadence);
-        newRecord.SetDistance((sl.distance - startingDistanceOffset) * 1000.0); //meters
-        newRecord.SetSpeed(sl.speed / 3.6); // meter per second
-        newRecord.SetPower(sl.watt);
-        newRecord.SetResistance(sl.resistance);
-        newRecord.SetCalories(sl.calories);
-        newRecord.SetAltitude(sl.elevationGain);
-
         // using just the start point as reference in order to avoid pause time
         // strava ignore the elapsed field
         // this workaround could leads an accuracy issue.
-        newRecord.SetTimestamp(date.GetTimeStamp() + i);
-        encode.Write(newRecord);
-
-        if(sl.lapTrigger)
+        if(sdkEncoder)
+        {
+            fit::RecordMesg newRecord;
+            //fit::DateTime date((time_t)session.at(i).time.toSecsSinceEpoch());
+            newRecord.SetHeartRate(sl.heart);
+            newRecord.SetCadence(sl.cadence);
+            newRecord.SetDistance((sl.distance - startingDistanceOffset) * 1000.0); //meters
+            newRecord.SetSpeed(sl.speed / 3.6); // meter per second
+            newRecord.SetPower(sl.watt);
+            newRecord.SetResistance(sl.resistance);
+            newRecord.SetCalories(sl.calories);
+            newRecord.SetAltitude(sl.elevationGain);
+            newRecord.SetTimestamp(date.GetTimeStamp() + i);
+            if(hrv)
+            {
+                const FIT_FLOAT32 values[] = {(FIT_FLOAT32)sl.rmssd, (FIT_FLOAT32)sl.sdnn, (FIT_FLOAT32)sl.dfaAlpha1};
+                int k = 0;
+                for (std::list<fit::FieldDescriptionMesg>::iterator it = hrvDescriptions.begin(); it != hrvDescriptions.end(); ++it, ++k)
+                {
+                    fit::DeveloperField field(*it, devIdMesg);
+                    field.SetFLOAT32Value(values[k]);
+                    newRecord.AddDeveloperField(field);
+                }
+            }
+            encode.Write(newRecord);
+        }
+        else
         {
-            lapMesg.SetTotalElapsedTime(sl.elapsedTime - lapMesg.GetTotalElapsedTime());
-            lapMesg.SetTotalTimerTime(sl.elapsedTime - lapMesg.GetTotalTimerTime());
+            const float values[] = {(float)sl.rmssd, (float)sl.sdnn, (float)sl.dfaAlpha1};
+            writer.writeRecord(date.GetTimeStamp() + i, sl.heart, sl.cadence,
+                               (sl.distance - startingDistanceOffset) * 1000.0, //meters
+                               sl.speed / 3.6, // meter per second
+                               sl.watt, sl.resistance, sl.calories, sl.elevationGain, values);
+        }
+    }
 
-            encode.Write(lapMesg);
+    for (int i = 0; i < lapList.length(); i++)
+    {
+        const lapsummary& lap = lapList.at(i);
+        fit::LapMesg lapMesg;
+        lapMesg.SetMessageIndex(i);
+        lapMesg.SetIntensity(FIT_INTENSITY_ACTIVE);
+        lapMesg.SetStartTime(lap.start.toSecsSinceEpoch() - 631065600L);
+        lapMesg.SetTimestamp(lap.end.toSecsSinceEpoch() - 631065600L);
+        lapMesg.SetEvent(FIT_EVENT_LAP);
+        lapMesg.SetEventType(FIT_EVENT_TYPE_STOP);
+        if(lap.trigger == lapanalyzer::MANUAL)
+            lapMesg.SetLapTrigger(FIT_LAP_TRIGGER_MANUAL);
+        else if(lap.trigger == lapanalyzer::STEP)
+            lapMesg.SetLapTrigger(FIT_LAP_TRIGGER_FITNESS_EQUIPMENT);
+        else if(lap.trigger == lapanalyzer::POWER)
+            lapMesg.SetLapTrigger(FIT_LAP_TRIGGER_TIME);
+        else
+            lapMesg.SetLapTrigger(FIT_LAP_TRIGGER_SESSION_END);
+        if(type == bluetoothdevice::TREADMILL || type == bluetoothdevice::ELLIPTICAL)
+            lapMesg.SetSport(FIT_SPORT_RUNNING);
+        else
+            lapMesg.SetSport(FIT_SPORT_CYCLING);
+        if(lap.step >= 0)
+            lapMesg.SetWktStepIndex(lap.step);
+        lapMesg.SetTotalElapsedTime(lap.elapsed);
+        lapMesg.SetTotalTimerTime(lap.elapsed);
+        lapMesg.SetTotalDistance(lap.distance * 1000.0); //meters
+        lapMesg.SetTotalCalories(lap.calories);
+        lapMesg.SetTotalAscent(lap.ascent);
+        lapMesg.SetTotalWork(lap.work * 1000.0); // joules
+        lapMesg.SetAvgPower(lap.avgPower);
+        lapMesg.SetMaxPower(lap.maxPower);
+        lapMesg.SetNormalizedPower(lap.normalizedPower);
+        lapMesg.SetAvgCadence(lap.avgCadence);
+        lapMesg.SetMaxCadence(lap.maxCadence);
+        lapMesg.SetAvgSpeed(lap.avgSpeed / 3.6); // meter per second
+        lapMesg.SetMaxSpeed(lap.maxSpeed / 3.6);
+        if(lap.avgHeart > 0)
+        {
+            lapMesg.SetAvgHeartRate(lap.avgHeart);
+            lapMesg.SetMaxHeartRate(lap.maxHeart);
+            for (FIT_UINT8 z = 0; z < 5; z++)
+                lapMesg.SetTimeInHrZone(z, lap.timeInZone[z]);
+            fit::DeveloperField field(heartDriftDescription, devIdMesg);
+            field.SetFLOAT32Value(lap.heartDrift);
+            lapMesg.AddDeveloperField(field);
+        }
+        write(lapMesg);
+    }
 
-            lapMesg.SetStartTime(sl.time.toSecsSinceEpoch() - 631065600L);
-            lapMesg.SetTimestamp(sl.time.toSecsSinceEpoch() - 631065600L);
-            lapMesg.SetEvent(FIT_EVENT_WORKOUT);
-            lapMesg.SetEventType(FIT_EVENT_LAP);
+    // the steps of the workout don't have to match the laps (lap_workout_steps off, manual laps)
+    FIT_MESSAGE_INDEX segmentIndex = 0;
+    for (const lapsummary& step : steps)
+    {
+        if(step.step < 0)
+            continue;
+        fit::SegmentLapMesg segmentMesg;
+        segmentMesg.SetMessageIndex(segmentIndex++);
+        segmentMesg.SetName(QString("Step " + QString::number(step.step + 1)).toStdWString());
+        segmentMesg.SetWktStepIndex(step.step);
+        segmentMesg.SetStartTime(step.start.toSecsSinceEpoch() - 631065600L);
+        segmentMesg.SetTimestamp(step.end.toSecsSinceEpoch() - 631065600L);
+        segmentMesg.SetEvent(FIT_EVENT_LAP);
+        segmentMesg.SetEventType(FIT_EVENT_TYPE_STOP);
+        if(type == bluetoothdevice::TREADMILL || type == bluetoothdevice::ELLIPTICAL)
+            segmentMesg.SetSport(FIT_SPORT_RUNNING);
+        else
+            segmentMesg.SetSport(FIT_SPORT_CYCLING);
+        segmentMesg.SetTotalElapsedTime(step.elapsed);
+        segmentMesg.SetTotalTimerTime(step.elapsed);
+        segmentMesg.SetTotalDistance(step.distance * 1000.0); //meters
+        segmentMesg.SetTotalCalories(step.calories);
+        segmentMesg.SetTotalAscent(step.ascent);
+        segmentMesg.SetTotalWork(step.work * 1000.0); // joules
+        segmentMesg.SetAvgPower(step.avgPower);
+        segmentMesg.SetMaxPower(step.maxPower);
+        segmentMesg.SetNormalizedPower(step.normalizedPower);
+        segmentMesg.SetAvgCadence(step.avgCadence);
+        segmentMesg.SetMaxCadence(step.maxCadence);
+        segmentMesg.SetAvgSpeed(step.avgSpeed / 3.6); // meter per second
+        segmentMesg.SetMaxSpeed(step.maxSpeed / 3.6);
+        if(step.avgHeart > 0)
+        {
+            segmentMesg.SetAvgHeartRate(step.avgHeart);
+            segmentMesg.SetMaxHeartRate(step.maxHeart);
+            for (FIT_UINT8 z = 0; z < 5; z++)
+                segmentMesg.SetTimeInHrZone(z, step.timeInZone[z]);
         }
+        write(segmentMesg);
     }
 
-    lapMesg.SetTotalElapsedTime(session.last().elapsedTime - lapMesg.GetTotalElapsedTime());
-    lapMesg.SetTotalTimerTime(session.last().elapsedTime - lapMesg.GetTotalTimerTime());
-    lapMesg.SetEvent(FIT_EVENT_LAP);
-    lapMesg.SetEventType(FIT_EVENT_TYPE_STOP);
-    encode.Write(lapMesg);
+    if(!sdkEncoder)
+    {
+        if(!writer.save(filename))
+            printf("Error writing %s\n", filename.toLocal8Bit().constData());
+        return;
+    }
 
     if (!encode.Close())
     {
@@ -189,3 +355,34 @@ void qfit::save(QString filename, QList<SessionLine> session, bluetoothdevice::B
     printf("Encoded FIT file ExampleActivity.fit.\n");
     return;
 }
+
+QString qfit::benchmark(uint32_t records)
+{
+    QList<SessionLine> session;
+    session.reserve(records);
+    QDateTime start = QDateTime::currentDateTime();
+    for (uint32_t i = 0; i < records; i++)
+    {
+        session.append(SessionLine(25.0 + (i % 10), 0, i * 0.007, 150 + (i % 100), 10, 30, 120 + (i % 40), 0, 80 + (i % 20),
+                                   i * 0.2, i * 0.01, i, (i % 600) == 599, start.addSecs(i)));
+    }
+
+    QString fast = QDir::tempPath() + "/qfit-benchmark-fast.fit";
+    QString sdk = QDir::tempPath() + "/qfit-benchmark-sdk.fit";
+    QElapsedTimer t;
+
+    t.start();
+    save(sdk, session, bluetoothdevice::BIKE, QFIT_PROCESS_SDKENCODER);
+    qint64 sdkTime = t.elapsed();
+
+    t.restart();
+    save(fast, session, bluetoothdevice::BIKE);
+    qint64 fastTime = t.elapsed();
+
+    QString r = "qfit benchmark " + QString::number(records) + " records: sdk " + QString::number(sdkTime) + " ms (" +
+                QString::number(QFile(sdk).size()) + " bytes), fast " + QString::number(fastTime) + " ms (" +
+                QString::number(QFile(fast).size()) + " bytes)";
+    QFile::remove(sdk);
+    QFile::remove(fast);
+    return r;
+}
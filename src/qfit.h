@@ -7,16 +7,22 @@
 #include <QGeoCoordinate>
 #include "sessionline.h"
 #include "bluetoothdevice.h"
+#include "lapanalyzer.h"
 
 #define QFIT_PROCESS_NONE 0
 #define QFIT_PROCESS_DISTANCENOISE 1
+#define QFIT_PROCESS_SDKENCODER 2 // generic (and slower) SDK encoder, kept as reference for the benchmark
 
 class qfit : public QObject
 {
     Q_OBJECT
 public:
     explicit qfit(QObject *parent = nullptr);
-    static void save(QString filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type, uint32_t processFlag = QFIT_PROCESS_NONE);
+    // laps: summaries kept during the workout by a lapanalyzer, computed from the session when empty
+    // steps: summaries of the workout steps, written as segment laps named after the step
+    static void save(QString filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type, uint32_t processFlag = QFIT_PROCESS_NONE,
+                     const QList<lapsummary>& laps = QList<lapsummary>(), const QList<lapsummary>& steps = QList<lapsummary>());
+    static QString benchmark(uint32_t records);
 
 signals:
 
@@ -0,0 +1,483 @@
+#include "qfitreader.h"
+#include "qfitwriter.h"
+#include "meanmaxcurve.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <fstream>
+#include <cmath>
+#include <limits>
+
+#include "fit_decode.hpp"
+#include "fit_mesg_broadcaster.hpp"
+#include "fit_record_mesg_listener.hpp"
+
+static const uint16_t MESG_NUM_RECORD = 20;
+static const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+enum FIELD {
+    F_TIMESTAMP = 0,
+    F_POWER,
+    F_HEART,
+    F_CADENCE,
+    F_SPEED,
+    F_ENHANCED_SPEED,
+    F_DISTANCE,
+    FIELDS
+};
+
+typedef struct fieldplan
+{
+    int offset; // from the first byte after the record header, -1 if the message doesn't have the field
+    uint8_t baseType;
+}fieldplan;
+
+typedef struct mesgplan
+{
+    bool defined;
+    bool bigEndian;
+    uint16_t global;
+    int size; // data bytes after the record header, developer fields included
+    fieldplan fields[FIELDS];
+}mesgplan;
+
+// size in bytes of the FIT base types, indexed by base type number (0 if we don't decode it)
+static const uint8_t baseTypeSize[17] = {1, 1, 1, 2, 2, 4, 4, 0, 4, 8, 1, 2, 4, 1, 8, 8, 8};
+
+static int fieldIndex(uint16_t global, uint8_t num)
+{
+    if(num == 253)
+        return F_TIMESTAMP;
+    if(global != MESG_NUM_RECORD)
+        return -1;
+    switch(num)
+    {
+    case 7: return F_POWER;
+    case 3: return F_HEART;
+    case 4: return F_CADENCE;
+    case 6: return F_SPEED;
+    case 73: return F_ENHANCED_SPEED;
+    case 5: return F_DISTANCE;
+    }
+    return -1;
+}
+
+static inline quint64 readUInt(const uchar* p, uint8_t size, bool bigEndian)
+{
+    quint64 v = 0;
+    if(bigEndian)
+    {
+        for(uint8_t i = 0; i < size; i++)
+            v = (v << 8) | p[i];
+    }
+    else
+    {
+        for(int i = size - 1; i >= 0; i--)
+            v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// raw value of a field, false if the field is missing or holds the invalid value of its base type
+static bool readField(const uchar* data, const fieldplan& f, bool bigEndian, double* value)
+{
+    if(f.offset < 0)
+        return false;
+
+    const uint8_t type = f.baseType & 0x1F;
+    const uint8_t size = baseTypeSize[type];
+    const quint64 v = readUInt(data + f.offset, size, bigEndian);
+    switch(type)
+    {
+    case 0:  // enum
+    case 2:  // uint8
+    case 13: // byte
+        if(v == 0xFF) return false;
+        *value = v;
+        return true;
+    case 4:  // uint16
+        if(v == 0xFFFF) return false;
+        *value = v;
+        return true;
+    case 6:  // uint32
+        if(v == 0xFFFFFFFF) return false;
+        *value = v;
+        return true;
+    case 15: // uint64
+        if(v == 0xFFFFFFFFFFFFFFFFULL) return false;
+        *value = v;
+        return true;
+    case 10: // uint8z
+    case 11: // uint16z
+    case 12: // uint32z
+    case 16: // uint64z
+        if(v == 0) return false;
+        *value = v;
+        return true;
+    case 1:  // sint8
+        if(v == 0x7F) return false;
+        *value = (int8_t)v;
+        return true;
+    case 3:  // sint16
+        if(v == 0x7FFF) return false;
+        *value = (int16_t)v;
+        return true;
+    case 5:  // sint32
+        if(v == 0x7FFFFFFF) return false;
+        *value = (int32_t)v;
+        return true;
+    case 14: // sint64
+        if(v == 0x7FFFFFFFFFFFFFFFULL) return false;
+        *value = (qint64)v;
+        return true;
+    case 8:  // float32
+    {
+        if(v == 0xFFFFFFFF) return false;
+        const quint32 u = v;
+        float fl;
+        memcpy(&fl, &u, sizeof(fl));
+        *value = fl;
+        return true;
+    }
+    case 9:  // float64
+    {
+        if(v == 0xFFFFFFFFFFFFFFFFULL) return false;
+        double d;
+        memcpy(&d, &v, sizeof(d));
+        *value = d;
+        return true;
+    }
+    }
+    return false;
+}
+
+bool qfitreader::decode(const uchar* d, qint64 size, bool checkCrc, qfitcolumns* out)
+{
+    if(size < 12 || d[0] < 12 || memcmp(d + 8, ".FIT", 4))
+    {
+        out->error = "not a FIT file";
+        return false;
+    }
+
+    const uint8_t headerSize = d[0];
+    const qint64 dataSize = (quint32)readUInt(d + 4, 4, false);
+    if(headerSize + dataSize > size)
+    {
+        out->error = "truncated file";
+        return false;
+    }
+
+    if(checkCrc)
+    {
+        if(headerSize + dataSize + 2 > size)
+        {
+            out->error = "missing crc";
+            return false;
+        }
+        const uint16_t crc = qfitwriter::crc16(0, d, headerSize + dataSize);
+        if(crc != readUInt(d + headerSize + dataSize, 2, false))
+        {
+            out->error = "bad crc";
+            return false;
+        }
+    }
+
+    mesgplan plans[16];
+    memset(plans, 0, sizeof(plans));
+
+    // a record every second is the common case
+    const int expected = dataSize / 20;
+    out->timestamp.reserve(expected);
+    out->power.reserve(expected);
+    out->heart.reserve(expected);
+    out->cadence.reserve(expected);
+    out->speed.reserve(expected);
+    out->distance.reserve(expected);
+
+    const uchar* p = d + headerSize;
+    const uchar* end = p + dataSize;
+    quint32 lastTimestamp = 0;
+
+    while(p < end)
+    {
+        const uint8_t header = *p++;
+        uint8_t local;
+        bool compressed = false;
+        quint32 compressedTimestamp = 0;
+
+        if(header & 0x80)
+        {
+            // compressed timestamp header: 5 bits of offset from the last full timestamp
+            local = (header >> 5) & 0x03;
+            const uint8_t offset = header & 0x1F;
+            compressedTimestamp = lastTimestamp + ((offset - (lastTimestamp & 0x1F)) & 0x1F);
+            lastTimestamp = compressedTimestamp;
+            compressed = true;
+        }
+        else if(header & 0x40)
+        {
+            local = header & 0x0F;
+            if(end - p < 5)
+                break;
+            mesgplan& plan = plans[local];
+            plan.defined = true;
+            plan.bigEndian = p[1];
+            plan.global = readUInt(p + 2, 2, plan.bigEndian);
+            const uint8_t fields = p[4];
+            p += 5;
+            if(end - p < fields * 3)
+                break;
+
+            for(int i = 0; i < FIELDS; i++)
+                plan.fields[i].offset = -1;
+            int offset = 0;
+            for(uint8_t i = 0; i < fields; i++, p += 3)
+            {
+                const int index = fieldIndex(plan.global, p[0]);
+                const uint8_t type = p[2] & 0x1F;
+                if(index >= 0 && type < 17 && baseTypeSize[type] && baseTypeSize[type] <= p[1])
+                {
+                    plan.fields[index].offset = offset;
+                    plan.fields[index].baseType = p[2];
+                }
+                offset += p[1];
+            }
+
+            if(header & 0x20)
+            {
+                // developer fields are only skipped
+                if(p >= end)
+                    break;
+                const uint8_t devFields = *p++;
+                if(end - p < devFields * 3)
+                    break;
+                for(uint8_t i = 0; i < devFields; i++, p += 3)
+                    offset += p[1];
+            }
+            plan.size = offset;
+            continue;
+        }
+        else
+            local = header & 0x0F;
+
+        const mesgplan& plan = plans[local];
+        if(!plan.defined)
+        {
+            out->error = "missing definition for local message " + QString::number(local);
+            return false;
+        }
+        if(end - p < plan.size)
+            break;
+
+        double v;
+        quint32 timestamp = compressed ? compressedTimestamp : 0xFFFFFFFF;
+        if(readField(p, plan.fields[F_TIMESTAMP], plan.bigEndian, &v))
+        {
+            timestamp = v;
+            lastTimestamp = timestamp;
+        }
+
+        if(plan.global == MESG_NUM_RECORD)
+        {
+            out->timestamp.append(timestamp);
+            out->power.append(readField(p, plan.fields[F_POWER], plan.bigEndian, &v) ? v : NaN);
+            out->heart.append(readField(p, plan.fields[F_HEART], plan.bigEndian, &v) ? v : NaN);
+            out->cadence.append(readField(p, plan.fields[F_CADENCE], plan.bigEndian, &v) ? v : NaN);
+            if(readField(p, plan.fields[F_SPEED], plan.bigEndian, &v) ||
+               readField(p, plan.fields[F_ENHANCED_SPEED], plan.bigEndian, &v))
+                out->speed.append(v / 1000.0);
+            else
+                out->speed.append(NaN);
+            out->distance.append(readField(p, plan.fields[F_DISTANCE], plan.bigEndian, &v) ? v / 100.0 : NaN);
+        }
+        p += plan.size;
+    }
+
+    if(p < end)
+    {
+        out->error = "truncated message";
+        return false;
+    }
+    return true;
+}
+
+qfitcolumns qfitreader::decode(const QString& filename, bool checkCrc)
+{
+    qfitcolumns c;
+    c.filename = filename;
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        c.error = file.errorString();
+        return c;
+    }
+
+    const qint64 size = file.size();
+    uchar* data = file.map(0, size);
+    if(data)
+    {
+        c.ok = decode(data, size, checkCrc, &c);
+        file.unmap(data);
+    }
+    else
+    {
+        // some file systems can't be mapped
+        const QByteArray all = file.readAll();
+        c.ok = decode((const uchar*)all.constData(), all.size(), checkCrc, &c);
+    }
+    return c;
+}
+
+class qfitreadertask : public QRunnable
+{
+public:
+    qfitreadertask(const QString& filename, bool checkCrc, qfitcolumns* out) : filename(filename), checkCrc(checkCrc), out(out) {}
+    void run() override
+    {
+        *out = qfitreader::decode(filename, checkCrc);
+    }
+
+private:
+    QString filename;
+    bool checkCrc;
+    qfitcolumns* out;
+};
+
+QVector<qfitcolumns> qfitreader::decode(const QStringList& filenames, bool checkCrc)
+{
+    QVector<qfitcolumns> results(filenames.length());
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    for(int i = 0; i < filenames.length(); i++)
+        pool.start(new qfitreadertask(filenames.at(i), checkCrc, &results[i]));
+    pool.waitForDone();
+    return results;
+}
+
+class qfitreadersdklistener : public fit::RecordMesgListener
+{
+public:
+    qfitcolumns c;
+    void OnMesg(fit::RecordMesg& m) override
+    {
+        c.timestamp.append(m.GetTimestamp());
+        c.power.append(m.IsPowerValid() ? m.GetPower() : NaN);
+        c.heart.append(m.IsHeartRateValid() ? m.GetHeartRate() : NaN);
+        c.cadence.append(m.IsCadenceValid() ? m.GetCadence() : NaN);
+        if(m.IsSpeedValid())
+            c.speed.append(m.GetSpeed());
+        else if(m.IsEnhancedSpeedValid())
+            c.speed.append(m.GetEnhancedSpeed());
+        else
+            c.speed.append(NaN);
+        c.distance.append(m.IsDistanceValid() ? m.GetDistance() : NaN);
+    }
+};
+
+static QString compareColumn(const char* name, const QVector<double>& a, const QVector<double>& b)
+{
+    for(int i = 0; i < a.length(); i++)
+    {
+        if(std::isnan(a.at(i)) != std::isnan(b.at(i)) ||
+           (!std::isnan(a.at(i)) && fabs(a.at(i) - b.at(i)) > 1e-4 * qMax(1.0, fabs(b.at(i)))))
+            return QString(name) + " differs at record " + QString::number(i) + ": " + QString::number(a.at(i)) + " sdk " + QString::number(b.at(i));
+    }
+    return "";
+}
+
+QString qfitreader::compareWithSdk(const QString& filename)
+{
+    qfitcolumns fast = decode(filename);
+    qfitreadersdklistener listener;
+    fit::Decode decode;
+    fit::MesgBroadcaster broadcaster;
+    broadcaster.AddListener((fit::RecordMesgListener &)listener);
+    std::fstream file;
+    file.open(filename.toStdString(), std::ios::in | std::ios::binary);
+    if(!file.is_open())
+        return "sdk can't open the file";
+
+    try
+    {
+        if(!decode.CheckIntegrity(file))
+            return fast.ok ? "sdk integrity check failed but the bulk decoder accepted the file" : "";
+        file.clear();
+        file.seekg(0, std::ios::beg);
+        decode.Read(&file, &broadcaster, &broadcaster, nullptr);
+    }
+    catch(const fit::RuntimeException& e)
+    {
+        return fast.ok ? QString("sdk error: ") + e.what() : "";
+    }
+
+    if(!fast.ok)
+        return "bulk decoder error: " + fast.error;
+
+    const qfitcolumns& sdk = listener.c;
+    if(fast.timestamp.length() != sdk.timestamp.length())
+        return "records " + QString::number(fast.timestamp.length()) + " sdk " + QString::number(sdk.timestamp.length());
+    if(fast.timestamp != sdk.timestamp)
+        return "timestamps differ";
+
+    QString r;
+    if((r = compareColumn("power", fast.power, sdk.power)).length()) return r;
+    if((r = compareColumn("heart", fast.heart, sdk.heart)).length()) return r;
+    if((r = compareColumn("cadence", fast.cadence, sdk.cadence)).length()) return r;
+    if((r = compareColumn("speed", fast.speed, sdk.speed)).length()) return r;
+    if((r = compareColumn("distance", fast.distance, sdk.distance)).length()) return r;
+    return "";
+}
+
+QString qfitreader::import(const QString& path, bool compare)
+{
+    QStringList files;
+    QFileInfo info(path);
+    if(info.isDir())
+    {
+        QDir dir(path);
+        foreach(QString f, dir.entryList(QStringList() << "*.fit" << "*.FIT", QDir::Files))
+            files.append(dir.filePath(f));
+    }
+    else
+        files.append(path);
+
+    QElapsedTimer t;
+    t.start();
+    QVector<qfitcolumns> results = decode(files);
+    const qint64 elapsed = t.elapsed();
+
+    QString r;
+    qint64 records = 0;
+    QList<uint32_t> durations;
+    durations << 300 << 1200;
+    foreach(qfitcolumns c, results)
+    {
+        if(!c.ok)
+        {
+            r += c.filename + ": " + c.error + "\n";
+            continue;
+        }
+        records += c.timestamp.length();
+
+        QVector<double> power = c.power;
+        for(int i = 0; i < power.length(); i++)
+            if(std::isnan(power.at(i)))
+                power[i] = 0;
+        QList<double> best = meanmaxcurve::fromSamples(power, durations);
+        r += c.filename + ": " + QString::number(c.timestamp.length()) + " records, best 5m " + QString::number(best.at(0), 'f', 0) +
+             "W, best 20m " + QString::number(best.at(1), 'f', 0) + "W";
+        if(compare)
+        {
+            const QString diff = compareWithSdk(c.filename);
+            r += diff.length() ? ", sdk MISMATCH " + diff : ", sdk ok";
+        }
+        r += "\n";
+    }
+    r += QString::number(files.length()) + " files, " + QString::number(records) + " records decoded in " + QString::number(elapsed) + " ms";
+    return r;
+}
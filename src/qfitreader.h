@@ -0,0 +1,41 @@
+#ifndef QFITREADER_H
+#define QFITREADER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// columns of the record messages of one activity file. Values the file doesn't have (or marks as
+// invalid) are NaN, so every column has the same length of timestamp
+typedef struct qfitcolumns
+{
+    QString filename;
+    bool ok = false;
+    QString error;
+    QVector<quint32> timestamp; // FIT time, seconds since UTC 00:00 Dec 31 1989
+    QVector<double> power;      // watts
+    QVector<double> heart;      // bpm
+    QVector<double> cadence;    // rpm
+    QVector<double> speed;      // m/s
+    QVector<double> distance;   // meters
+}qfitcolumns;
+
+// bulk decoder for importing activity libraries. The file is memory mapped, every definition message is
+// compiled into a plan with the offsets of the few fields we care about and the data messages are parsed
+// in place, without building a fit::Mesg for each of them.
+class qfitreader
+{
+public:
+    static qfitcolumns decode(const QString& filename, bool checkCrc = true);
+    // one file per core
+    static QVector<qfitcolumns> decode(const QStringList& filenames, bool checkCrc = true);
+    // decodes the file also through the SDK and reports the differences, empty if they match
+    static QString compareWithSdk(const QString& filename);
+    // -fit-import command line entry point
+    static QString import(const QString& path, bool compare);
+
+private:
+    static bool decode(const uchar* data, qint64 size, bool checkCrc, qfitcolumns* out);
+};
+
+#endif // QFITREADER_H
@@ -0,0 +1,270 @@
+#include "qfitwriter.h"
+#include <QFile>
+#include <QDebug>
+#include <sstream>
+#include <string.h>
+#include "fit_profile.hpp"
+
+// byte wise table of the FIT CRC-16 (reflected 0x8005), same results as fit::CRC::Get16
+static uint16_t crcTable[256];
+static bool crcTableInit()
+{
+    for(int i = 0; i < 256; i++)
+    {
+        uint16_t c = i;
+        for(int k = 0; k < 8; k++)
+            c = (c & 1) ? ((c >> 1) ^ 0xA001) : (c >> 1);
+        crcTable[i] = c;
+    }
+    return true;
+}
+static const bool crcTableReady = crcTableInit();
+
+static inline uint8_t* put16(uint8_t* p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    return p + 2;
+}
+
+static inline uint8_t* put32(uint8_t* p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+    return p + 4;
+}
+
+// same rounding of fit::FieldBase::SetFLOAT64Value, so the fast path writes the same bytes of the SDK
+static inline double scaled(float value, double scale, double offset)
+{
+    const double v = ((double)value + offset) * scale;
+    return v >= 0.0 ? v + 0.5 : v - 0.5;
+}
+
+qfitwriter::qfitwriter()
+{
+    Q_UNUSED(crcTableReady)
+    open();
+}
+
+void qfitwriter::open()
+{
+    m_data.clear();
+    m_crc = 0;
+    m_records = 0;
+    m_recordDefined = false;
+    m_developerFields = 0;
+    for(uint8_t i = 0; i < FIT_MAX_LOCAL_MESGS; i++)
+    {
+        m_lastDefinition[i].SetNum(FIT_MESG_NUM_INVALID);
+        m_lastDefinition[i].SetLocalNum(i);
+        m_lastDefinition[i].ClearFields();
+    }
+}
+
+uint16_t qfitwriter::crc16(uint16_t crc, const uint8_t* data, int length)
+{
+    for(int i = 0; i < length; i++)
+        crc = (crc >> 8) ^ crcTable[(crc ^ data[i]) & 0xFF];
+    return crc;
+}
+
+static uint16_t gf2MatrixTimes(const uint16_t* mat, uint16_t vec)
+{
+    uint16_t sum = 0;
+    while(vec)
+    {
+        if(vec & 1)
+            sum ^= *mat;
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+static void gf2MatrixSquare(uint16_t* square, const uint16_t* mat)
+{
+    for(int n = 0; n < 16; n++)
+        square[n] = gf2MatrixTimes(mat, mat[n]);
+}
+
+uint16_t qfitwriter::crc16Combine(uint16_t crcA, uint16_t crcB, qint64 lengthB)
+{
+    // the crc has no final xor, so crc(A+B) is crc(A) shifted through lengthB zero bytes xor crc(B):
+    // the shift operator is squared up like zlib's crc32_combine
+    uint16_t even[16];
+    uint16_t odd[16];
+
+    if(lengthB <= 0)
+        return crcA;
+
+    odd[0] = 0xA001; // one zero bit
+    uint16_t row = 1;
+    for(int n = 1; n < 16; n++)
+    {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    gf2MatrixSquare(even, odd); // two zero bits
+    gf2MatrixSquare(odd, even); // four zero bits
+
+    do
+    {
+        gf2MatrixSquare(even, odd);
+        if(lengthB & 1)
+            crcA = gf2MatrixTimes(even, crcA);
+        lengthB >>= 1;
+        if(!lengthB)
+            break;
+
+        gf2MatrixSquare(odd, even);
+        if(lengthB & 1)
+            crcA = gf2MatrixTimes(odd, crcA);
+        lengthB >>= 1;
+    } while(lengthB);
+
+    return crcA ^ crcB;
+}
+
+void qfitwriter::append(const uint8_t* data, int length)
+{
+    m_data.append((const char*)data, length);
+    m_crc = crc16(m_crc, data, length);
+}
+
+void qfitwriter::write(const fit::Mesg& mesg)
+{
+    Q_ASSERT(mesg.GetLocalNum() != RECORD_LOCAL_NUM);
+    fit::MesgDefinition mesgDefinition(mesg);
+    std::ostringstream out;
+    fit::MesgDefinition& last = m_lastDefinition[mesg.GetLocalNum()];
+
+    if(!last.Supports(mesgDefinition))
+    {
+        mesgDefinition.Write(out);
+        last = mesgDefinition;
+    }
+    mesg.Write(out, &last);
+
+    const std::string s = out.str();
+    append((const uint8_t*)s.data(), s.size());
+}
+
+void qfitwriter::setRecordDeveloperFields(uint8_t developerDataIndex, uint8_t firstField, uint8_t count)
+{
+    Q_ASSERT(!m_recordDefined && count <= MAX_DEVELOPER_FIELDS);
+    m_developerDataIndex = developerDataIndex;
+    m_developerFirstField = firstField;
+    m_developerFields = count;
+}
+
+void qfitwriter::writeRecordDefinition()
+{
+    // same fields, order and types the SDK derives from the RecordMesg built in qfit::save
+    const uint8_t definition[] = {
+        (uint8_t)(FIT_HDR_TYPE_DEF_BIT | (m_developerFields ? FIT_HDR_DEV_FIELD_BIT : 0) | RECORD_LOCAL_NUM), 0, 0 /* little endian */,
+        FIT_MESG_NUM_RECORD & 0xFF, (FIT_MESG_NUM_RECORD >> 8) & 0xFF,
+        9,
+        3, 1, FIT_BASE_TYPE_UINT8,     // heart_rate
+        4, 1, FIT_BASE_TYPE_UINT8,     // cadence
+        5, 4, FIT_BASE_TYPE_UINT32,    // distance
+        6, 2, FIT_BASE_TYPE_UINT16,    // speed
+        7, 2, FIT_BASE_TYPE_UINT16,    // power
+        10, 1, FIT_BASE_TYPE_UINT8,    // resistance
+        33, 2, FIT_BASE_TYPE_UINT16,   // calories
+        2, 2, FIT_BASE_TYPE_UINT16,    // altitude
+        253, 4, FIT_BASE_TYPE_UINT32,  // timestamp
+    };
+    append(definition, sizeof(definition));
+
+    if(m_developerFields)
+    {
+        uint8_t developer[1 + MAX_DEVELOPER_FIELDS * 3];
+        uint8_t* p = developer;
+        *p++ = m_developerFields;
+        for(uint8_t i = 0; i < m_developerFields; i++)
+        {
+            *p++ = m_developerFirstField + i;
+            *p++ = 4;
+            *p++ = m_developerDataIndex;
+        }
+        append(developer, p - developer);
+    }
+    m_recordDefined = true;
+}
+
+void qfitwriter::writeRecord(uint32_t timestamp, uint8_t heart, uint8_t cadence, float distance, float speed,
+                             uint16_t power, uint8_t resistance, uint16_t calories, float altitude,
+                             const float* developerValues)
+{
+    if(!m_recordDefined)
+        writeRecordDefinition();
+
+    const int size = RECORD_SIZE + m_developerFields * 4;
+    const int pos = m_data.size();
+    m_data.resize(pos + size);
+    uint8_t* start = (uint8_t*)m_data.data() + pos;
+    uint8_t* p = start;
+
+    *p++ = RECORD_LOCAL_NUM;
+    *p++ = heart;
+    *p++ = cadence;
+    p = put32(p, (uint32_t)scaled(distance, 100, 0));
+    p = put16(p, (uint16_t)scaled(speed, 1000, 0));
+    p = put16(p, power);
+    *p++ = resistance;
+    p = put16(p, calories);
+    p = put16(p, (uint16_t)scaled(altitude, 5, 500));
+    p = put32(p, timestamp);
+    for(uint8_t i = 0; i < m_developerFields; i++)
+    {
+        uint32_t v;
+        const float f = developerValues ? developerValues[i] : 0;
+        memcpy(&v, &f, 4);
+        p = put32(p, v);
+    }
+
+    m_crc = crc16(m_crc, start, size);
+    m_records++;
+}
+
+QByteArray qfitwriter::close()
+{
+    uint8_t header[FIT_FILE_HDR_SIZE];
+    uint8_t* p = header;
+    *p++ = FIT_FILE_HDR_SIZE;
+    *p++ = FIT_PROTOCOL_VERSION;
+    p = put16(p, FIT_PROFILE_VERSION);
+    p = put32(p, m_data.size());
+    *p++ = '.';
+    *p++ = 'F';
+    *p++ = 'I';
+    *p++ = 'T';
+    put16(p, crc16(0, header, FIT_FILE_HDR_SIZE - 2));
+
+    const uint16_t crc = crc16Combine(crc16(0, header, FIT_FILE_HDR_SIZE), m_crc, m_data.size());
+
+    QByteArray file;
+    file.reserve(FIT_FILE_HDR_SIZE + m_data.size() + 2);
+    file.append((const char*)header, FIT_FILE_HDR_SIZE);
+    file.append(m_data);
+    file.append((char)(crc & 0xFF));
+    file.append((char)(crc >> 8));
+    open();
+    return file;
+}
+
+bool qfitwriter::save(const QString& filename)
+{
+    QFile output(filename);
+    if(!output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "qfitwriter: error opening" << filename;
+        return false;
+    }
+    const QByteArray file = close();
+    return output.write(file) == file.size();
+}
@@ -0,0 +1,51 @@
+#ifndef QFITWRITER_H
+#define QFITWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include "fit_mesg.hpp"
+#include "fit_mesg_definition.hpp"
+
+// activity file writer specialized for the records qdomyos-zwift emits.
+// The record definition is written once on its own local message number and every record is
+// serialized straight into the output buffer, while the other (few) messages still go through the
+// SDK serialization. The CRC is updated while writing, so closing the file doesn't read it back.
+class qfitwriter
+{
+public:
+    qfitwriter();
+    void open();
+    void write(const fit::Mesg& mesg);
+    // float32 developer fields appended to every record: the caller writes their FieldDescriptionMesg,
+    // numbered from firstField, before the first record
+    void setRecordDeveloperFields(uint8_t developerDataIndex, uint8_t firstField, uint8_t count);
+    void writeRecord(uint32_t timestamp, uint8_t heart, uint8_t cadence, float distance, float speed,
+                     uint16_t power, uint8_t resistance, uint16_t calories, float altitude,
+                     const float* developerValues = nullptr);
+    QByteArray close();
+    bool save(const QString& filename);
+    uint32_t records() {return m_records;}
+
+    static uint16_t crc16(uint16_t crc, const uint8_t* data, int length);
+    // crc of A+B from crc(A), crc(B) and the length of B, in O(log length)
+    static uint16_t crc16Combine(uint16_t crcA, uint16_t crcB, qint64 lengthB);
+
+private:
+    static const uint8_t RECORD_LOCAL_NUM = 1;
+    static const uint8_t RECORD_SIZE = 20; // header + fields
+    static const uint8_t MAX_DEVELOPER_FIELDS = 8;
+
+    void append(const uint8_t* data, int length);
+    void writeRecordDefinition();
+
+    QByteArray m_data;
+    uint16_t m_crc = 0;
+    uint32_t m_records = 0;
+    bool m_recordDefined = false;
+    uint8_t m_developerDataIndex = 0;
+    uint8_t m_developerFirstField = 0;
+    uint8_t m_developerFields = 0;
+    fit::MesgDefinition m_lastDefinition[FIT_MAX_LOCAL_MESGS];
+};
+
+#endif // QFITWRITER_H
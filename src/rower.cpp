@@ -3,13 +3,31 @@
 
 rower::rower()
 {
-
+    // the heart rate follows the resistance of a rower slower than the one of a bike:
+    // about 2 bpm for each level, at most a level every 3 seconds
+    heartZone.setModel(2, 50);
+    heartZone.setLimits(1, 32, 0.34, 1);
 }
 
-void rower::changeResistance(int8_t resistance) { if(autoResistanceEnable) {requestResistance = resistance * m_difficult; emit resistanceChanged(requestResistance);} RequestedResistance = resistance * m_difficult; }
+void rower::changeResistance(int8_t resistance, commandarbiter::SOURCE source) { arbiter.submit(actuationmodel::RESISTANCE, resistance * m_difficult, source); }
+double rower::heartZoneOutput() { return currentResistance().value(); }
+// the output is already a resistance of the machine: no difficulty on it, unlike changeResistance
+void rower::changeHeartZoneOutput(double value) { arbiter.submit(actuationmodel::RESISTANCE, (int8_t)value, commandarbiter::HEARTZONE); }
 void rower::changeRequestedPelotonResistance(int8_t resistance) { RequestedPelotonResistance = resistance; }
 void rower::changeCadence(int16_t cadence) { RequestedCadence = cadence; }
-void rower::changePower(int32_t power) { RequestedPower = power; }
+void rower::changePower(int32_t power, commandarbiter::SOURCE source) { Q_UNUSED(source); RequestedPower = power; }
+void rower::applyCommand(actuationmodel::CHANNEL c, double value)
+{
+    if(c != actuationmodel::RESISTANCE)
+        return;
+    if(autoResistanceEnable)
+    {
+        requestResistance = value;
+        actuation.request(c, requestResistance, currentResistance().value());
+        emit resistanceChanged(requestResistance);
+    }
+    RequestedResistance = value;
+}
 double rower::currentCrankRevolutions() { return CrankRevs;}
 uint16_t rower::lastCrankEventTime() { return LastCrankEventTime;}
 metric rower::lastRequestedResistance() { return RequestedResistance; }
@@ -24,23 +42,34 @@ uint16_t rower::watts() { return 0; }
 metric rower::pelotonResistance() { return m_pelotonResistance; }
 int rower::pelotonToBikeResistance(int pelotonResistance) {return pelotonResistance;}
 uint8_t rower::resistanceFromPowerRequest(uint16_t power) {return power / 10;} // in order to have something
-void rower::cadenceSensor(uint8_t cadence) { Cadence.setValue(cadence); }
+void rower::cadenceSensor(uint8_t cadence) { sensors.publish(sensorbus::CADENCE, sensorbus::EXTERNAL, cadence); }
+
+void rower::fuseSensors()
+{
+    bluetoothdevice::fuseSensors();
+    double cadence;
+    if(sensors.fuse(sensorbus::CADENCE, &cadence))
+        Cadence = cadence;
+}
+
+void rower::fillSample(bluetoothdevicesample* s)
+{
+    bluetoothdevice::fillSample(s);
+    s->bike.cadence = sampleOf(currentCadence());
+    s->bike.resistance = sampleOf(currentResistance());
+    s->bike.pelotonResistance = sampleOf(pelotonResistance());
+    s->bike.requestedResistance = lastRequestedResistance().value();
+    s->bike.requestedPelotonResistance = lastRequestedPelotonResistance().value();
+    s->bike.requestedCadence = lastRequestedCadence().value();
+    s->bike.requestedPower = lastRequestedPower().value();
+    s->bike.crankRevolutions = currentCrankRevolutions();
+    s->bike.lastCrankEventTime = lastCrankEventTime();
+}
 
 bluetoothdevice::BLUETOOTH_TYPE rower::deviceType() { return bluetoothdevice::ROWING; }
 
 void rower::clearStats()
 {
-    moving.clear(true);
-    elapsed.clear(true);
-    Speed.clear(false);
-    KCal.clear(true);
-    Distance.clear(true);
-    Heart.clear(false);
-    m_jouls.clear(true);
-    elevationAcc = 0;
-    m_watt.clear(false);
-    WeightLoss.clear(false);
-
     RequestedPelotonResistance.clear(false);
     RequestedResistance.clear(false);
     RequestedCadence.clear(false);
@@ -48,20 +77,12 @@ void rower::clearStats()
     m_pelotonResistance.clear(false);
     Cadence.clear(false);
     Resistance.clear(false);
+    bluetoothdevice::clearStats();
 }
 
 void rower::setPaused(bool p)
 {
-    paused = p;
-    moving.setPaused(p);
-    elapsed.setPaused(p);
-    Speed.setPaused(p);
-    KCal.setPaused(p);
-    Distance.setPaused(p);
-    Heart.setPaused(p);
-    m_jouls.setPaused(p);
-    m_watt.setPaused(p);
-    WeightLoss.setPaused(p);
+    bluetoothdevice::setPaused(p);
     m_pelotonResistance.setPaused(p);
     Cadence.setPaused(p);
     Resistance.setPaused(p);
@@ -73,16 +94,7 @@ void rower::setPaused(bool p)
 
 void rower::setLap()
 {
-    moving.setLap(true);
-    elapsed.setLap(true);
-    Speed.setLap(false);
-    KCal.setLap(true);
-    Distance.setLap(true);
-    Heart.setLap(false);
-    m_jouls.setLap(true);
-    m_watt.setLap(false);
-    WeightLoss.setLap(false);
-
+    bluetoothdevice::setLap();
     RequestedPelotonResistance.setLap(false);
     RequestedResistance.setLap(false);
     RequestedCadence.setLap(false);
@@ -31,9 +31,9 @@ public:
     void setPaused(bool p);
 
 public slots:
-    virtual void changeResistance(int8_t res);
+    virtual void changeResistance(int8_t res, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
     virtual void changeCadence(int16_t cad);
-    virtual void changePower(int32_t power);
+    virtual void changePower(int32_t power, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
     virtual void changeRequestedPelotonResistance(int8_t resistance);
     virtual void cadenceSensor(uint8_t cadence);
 
@@ -54,6 +54,12 @@ protected:
     double CrankRevs = 0;
 
     metric m_pelotonResistance;
+
+    void fuseSensors();
+    void fillSample(bluetoothdevicesample* s);
+    double heartZoneOutput();
+    void changeHeartZoneOutput(double value);
+    void applyCommand(actuationmodel::CHANNEL c, double value);
 };
 
 #endif // ROWER_H
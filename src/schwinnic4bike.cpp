@@ -22,7 +22,7 @@ schwinnic4bike::schwinnic4bike(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 /*
 void schwinnic4bike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
@@ -72,7 +72,7 @@ void schwinnic4bike::update()
         update_metrics(false, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -115,11 +115,11 @@ void schwinnic4bike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void schwinnic4bike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("schwinnic4bike::characteristicChanged");
     double heart;
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -161,7 +161,7 @@ void schwinnic4bike::characteristicChanged(const QLowEnergyCharacteristic &chara
         if(!settings.value("speed_power_based", false).toBool())
             Speed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 100.0;
         else
-            Speed = metric::calculateSpeedFromPower(m_watt.value());
+            Speed = physics.speed(m_watt.value());
         index += 2;
         debug("Current Speed: " + QString::number(Speed.value()));
     }
@@ -243,7 +243,7 @@ void schwinnic4bike::characteristicChanged(const QLowEnergyCharacteristic &chara
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
@@ -290,25 +290,23 @@ void schwinnic4bike::characteristicChanged(const QLowEnergyCharacteristic &chara
 
     lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
 
-    if(heartRateBeltName.startsWith("Disabled"))
+    if(heart == 0)
     {
-        if(heart == 0)
-        {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-            lockscreen h;
+        lockscreen h;
         long appleWatchHeartRate = h.heartRate();
         h.setKcal(KCal.value());
         h.setDistance(Distance.value());
-        Heart = appleWatchHeartRate;
+        if(appleWatchHeartRate > 0)
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
         debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-        }
-        else
-        {
-            Heart = heart;
-        }
+    }
+    else
+    {
+        sensors.publish(sensorbus::HEART, sensorbus::MACHINE, heart);
     }
 
 #ifdef Q_OS_IOS
@@ -0,0 +1,96 @@
+#include "sensorbus.h"
+#include <QDateTime>
+#include <QSettings>
+#include <string.h>
+
+sensorbus::sensorbus()
+{
+    QSettings settings;
+    clear();
+    m_staleTimeout = settings.value("sensor_bus_stale_timeout", 3000).toInt();
+    bool machineFirst = settings.value("sensor_bus_prefer_machine", false).toBool();
+    for(int c = 0; c < CHANNELS; c++)
+    {
+        m_priority[c][MACHINE] = machineFirst ? SOURCES : 0;
+        m_priority[c][PHONE] = 1;
+        m_priority[c][EXTERNAL] = 2;
+    }
+}
+
+void sensorbus::clear()
+{
+    memset(m_queues, 0, sizeof(m_queues));
+}
+
+void sensorbus::setPriority(CHANNEL channel, SOURCE source, uint8_t priority)
+{
+    m_priority[channel][source] = priority;
+}
+
+void sensorbus::publish(CHANNEL channel, SOURCE source, double value)
+{
+    sensorqueue* q = &m_queues[channel][source];
+    q->head = (q->head + 1) % QUEUE_SIZE;
+    q->samples[q->head].value = value;
+    q->samples[q->head].timestamp = QDateTime::currentMSecsSinceEpoch();
+    if(q->count < QUEUE_SIZE)
+        q->count++;
+}
+
+bool sensorbus::active(CHANNEL channel)
+{
+    for(int s = 0; s < SOURCES; s++)
+    {
+        if(active(channel, (SOURCE)s))
+            return true;
+    }
+    return false;
+}
+
+bool sensorbus::active(CHANNEL channel, SOURCE source)
+{
+    const sensorqueue* q = &m_queues[channel][source];
+    return q->count && QDateTime::currentMSecsSinceEpoch() - q->samples[q->head].timestamp <= m_staleTimeout;
+}
+
+bool sensorbus::fuse(CHANNEL channel, double* value)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    sensorqueue* best = 0;
+    bool seen = false;
+
+    for(int s = 0; s < SOURCES; s++)
+    {
+        sensorqueue* q = &m_queues[channel][s];
+        if(!q->count)
+            continue;
+        seen = true;
+        if(now - q->samples[q->head].timestamp > m_staleTimeout)
+            continue;
+        if(!best || m_priority[channel][s] > m_priority[channel][best - m_queues[channel]])
+            best = q;
+    }
+
+    if(!best)
+    {
+        // every source went silent: better a zero than an old reading
+        if(seen)
+            *value = 0;
+        return seen;
+    }
+
+    // mean of the samples received since the previous tick, or the last one if nothing new arrived
+    double sum = 0;
+    uint8_t n = 0;
+    for(uint8_t i = 0; i < best->count; i++)
+    {
+        const sensorsample* sample = &best->samples[(best->head + QUEUE_SIZE - i) % QUEUE_SIZE];
+        if(sample->timestamp <= best->lastFused)
+            break;
+        sum += sample->value;
+        n++;
+    }
+    *value = n ? (sum / n) : best->samples[best->head].value;
+    best->lastFused = now;
+    return true;
+}
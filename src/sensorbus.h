@@ -0,0 +1,58 @@
+#ifndef SENSORBUS_H
+#define SENSORBUS_H
+
+#include <QtGlobal>
+
+// every source (the machine itself, an external belt/cadence sensor/power meter...) publishes timestamped
+// samples into its own queue. Once per tick the fusion picks, for each channel, the freshest source with
+// the highest priority and gives back one value aligned to the tick.
+class sensorbus
+{
+public:
+    enum CHANNEL {
+        HEART = 0,
+        CADENCE,
+        POWER,
+        CHANNELS
+    };
+
+    enum SOURCE {
+        MACHINE = 0,
+        PHONE, // ANT+ or Apple Watch, read by the phone
+        EXTERNAL, // bluetooth belt, cadence sensor, ftms accessory
+        SOURCES
+    };
+
+    sensorbus();
+    void publish(CHANNEL channel, SOURCE source, double value);
+    bool fuse(CHANNEL channel, double* value);
+    // a source of the channel has a sample newer than the stale timeout
+    bool active(CHANNEL channel);
+    bool active(CHANNEL channel, SOURCE source);
+    void setPriority(CHANNEL channel, SOURCE source, uint8_t priority);
+    void setStaleTimeout(qint64 ms) {m_staleTimeout = ms;}
+    void clear();
+
+private:
+    static const uint8_t QUEUE_SIZE = 8;
+
+    typedef struct sensorsample
+    {
+        double value;
+        qint64 timestamp;
+    }sensorsample;
+
+    typedef struct sensorqueue
+    {
+        sensorsample samples[QUEUE_SIZE];
+        uint8_t head;
+        uint8_t count;
+        qint64 lastFused;
+    }sensorqueue;
+
+    sensorqueue m_queues[CHANNELS][SOURCES];
+    uint8_t m_priority[CHANNELS][SOURCES];
+    qint64 m_staleTimeout = 3000;
+};
+
+#endif // SENSORBUS_H
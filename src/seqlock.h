@@ -0,0 +1,53 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+
+// single writer / multiple readers publication of a plain struct.
+// the writer never blocks, a reader simply retries if it raced with a write
+template <typename T>
+class seqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock needs a trivially copyable type");
+
+public:
+    seqlock() : m_seq(0) { memset(&m_value, 0, sizeof(T)); }
+
+    void write(const T& value)
+    {
+        const uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&m_value, &value, sizeof(T));
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // the sequence of the value read, when asked, comes from the same consistent read
+    T read(uint32_t* sequence = 0) const
+    {
+        T r;
+        uint32_t before, after;
+        do
+        {
+            before = m_seq.load(std::memory_order_acquire);
+            memcpy(&r, &m_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_seq.load(std::memory_order_relaxed);
+        } while((before & 1) || before != after);
+        if(sequence)
+            *sequence = before;
+        return r;
+    }
+
+    // even number, it changes every time a new value is published
+    uint32_t sequence() const { return m_seq.load(std::memory_order_acquire) & ~1u; }
+
+private:
+    std::atomic<uint32_t> m_seq;
+    T m_value;
+};
+
+#endif // SEQLOCK_H
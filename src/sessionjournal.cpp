@@ -0,0 +1,191 @@
+#include "sessionjournal.h"
+#include <QDebug>
+#include <atomic>
+#include <string.h>
+
+static const char journalMagic[4] = {'Q', 'Z', 'J', '1'};
+static const uint32_t journalVersion = 1;
+
+sessionjournal::sessionjournal()
+{
+
+}
+
+sessionjournal::~sessionjournal()
+{
+    if(m_header)
+        m_file.unmap((uchar*)m_header);
+}
+
+bool sessionjournal::valid(const journalheader* h)
+{
+    return !memcmp(h->magic, journalMagic, sizeof(journalMagic)) && h->version == journalVersion &&
+            h->recordSize == sizeof(journalrecord) && h->capacity == CAPACITY;
+}
+
+bool sessionjournal::map(const QString& filename, bool create)
+{
+    if(m_header)
+    {
+        m_file.unmap((uchar*)m_header);
+        m_header = 0;
+        m_records = 0;
+    }
+    m_file.close();
+    m_file.setFileName(filename);
+    if(!m_file.open(QIODevice::ReadWrite))
+    {
+        qDebug() << "journal: unable to open" << filename;
+        return false;
+    }
+
+    // the whole file is allocated once, the appends only touch the mapped pages
+    const qint64 size = sizeof(journalheader) + (qint64)CAPACITY * sizeof(journalrecord);
+    if(m_file.size() != size && !m_file.resize(size))
+    {
+        qDebug() << "journal: unable to allocate" << filename;
+        m_file.close();
+        return false;
+    }
+    uchar* p = m_file.map(0, size);
+    if(!p)
+    {
+        qDebug() << "journal: unable to map" << filename;
+        m_file.close();
+        return false;
+    }
+    m_header = (journalheader*)p;
+    m_records = (journalrecord*)(p + sizeof(journalheader));
+
+    if(create || !valid(m_header))
+    {
+        m_header->running = 0;
+        memcpy(m_header->magic, journalMagic, sizeof(journalMagic));
+        m_header->version = journalVersion;
+        m_header->recordSize = sizeof(journalrecord);
+        m_header->capacity = CAPACITY;
+        m_header->count = 0;
+    }
+    return true;
+}
+
+bool sessionjournal::open(const QString& filename, uint8_t deviceType)
+{
+    if(!map(filename, true))
+        return false;
+    m_header->deviceType = deviceType;
+    m_header->running = 1;
+    qDebug() << "journal: started" << filename;
+    return true;
+}
+
+bool sessionjournal::resume(const QString& filename)
+{
+    if(!map(filename, false))
+        return false;
+    m_header->running = 1;
+    qDebug() << "journal: resumed" << filename << m_header->count << "lines";
+    return true;
+}
+
+void sessionjournal::append(const SessionLine& s, uint32_t moving, double jouls, int32_t trainProgramTicks, int32_t trainProgramStep)
+{
+    if(!m_header)
+        return;
+
+    journalrecord& r = m_records[m_header->count % CAPACITY];
+    r.time = s.time.toMSecsSinceEpoch();
+    r.speed = s.speed;
+    r.distance = s.distance;
+    r.pace = s.pace;
+    r.calories = s.calories;
+    r.elevationGain = s.elevationGain;
+    r.jouls = jouls;
+    r.rmssd = s.rmssd;
+    r.sdnn = s.sdnn;
+    r.dfaAlpha1 = s.dfaAlpha1;
+    r.elapsed = s.elapsedTime;
+    r.moving = moving;
+    r.trainProgramTicks = trainProgramTicks;
+    r.trainProgramStep = trainProgramStep;
+    r.watt = s.watt;
+    r.inclination = s.inclination;
+    r.resistance = s.resistance;
+    r.pelotonResistance = s.peloton_resistance;
+    r.heart = s.heart;
+    r.cadence = s.cadence;
+    r.lap = s.lapTrigger;
+    // the line is complete before the count makes it visible: neither the compiler nor the CPU can
+    // move the stores of the record after the one of the count
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->count++;
+}
+
+void sessionjournal::finish()
+{
+    if(!m_header)
+        return;
+    m_header->running = 0;
+    m_file.unmap((uchar*)m_header);
+    m_file.close();
+    m_header = 0;
+    m_records = 0;
+    qDebug() << "journal: finished";
+}
+
+uint32_t sessionjournal::pending(const QString& filename)
+{
+    QFile f(filename);
+    journalheader h;
+    if(!f.open(QIODevice::ReadOnly) || f.read((char*)&h, sizeof(h)) != sizeof(h))
+        return 0;
+    if(!valid(&h) || !h.running)
+        return 0;
+    return h.count < CAPACITY ? h.count : CAPACITY;
+}
+
+bool sessionjournal::load(const QString& filename, QList<SessionLine>& session, QList<int32_t>& steps, journalstate& state)
+{
+    QFile f(filename);
+    journalheader h;
+    if(!f.open(QIODevice::ReadOnly) || f.read((char*)&h, sizeof(h)) != sizeof(h) || !valid(&h) || !h.count)
+        return false;
+
+    QByteArray data = f.readAll();
+    if((quint64)data.size() < (quint64)CAPACITY * sizeof(journalrecord))
+        return false;
+    const journalrecord* records = (const journalrecord*)data.constData();
+    const quint64 first = h.count > CAPACITY ? h.count - CAPACITY : 0;
+    session.clear();
+    steps.clear();
+    session.reserve(h.count - first);
+    steps.reserve(h.count - first);
+    for(quint64 i = first; i < h.count; i++)
+    {
+        const journalrecord& r = records[i % CAPACITY];
+        SessionLine s(r.speed, r.inclination, r.distance, r.watt, r.resistance, r.pelotonResistance, r.heart, r.pace,
+                      r.cadence, r.calories, r.elevationGain, r.elapsed, r.lap, QDateTime::fromMSecsSinceEpoch(r.time));
+        s.rmssd = r.rmssd;
+        s.sdnn = r.sdnn;
+        s.dfaAlpha1 = r.dfaAlpha1;
+        session.append(s);
+        steps.append(r.trainProgramStep);
+    }
+    const journalrecord& last = records[(h.count - 1) % CAPACITY];
+    state.deviceType = h.deviceType;
+    state.moving = last.moving;
+    state.jouls = last.jouls;
+    state.trainProgramTicks = last.trainProgramTicks;
+    return true;
+}
+
+void sessionjournal::discard(const QString& filename)
+{
+    QFile f(filename);
+    journalheader h;
+    if(!f.open(QIODevice::ReadWrite) || f.read((char*)&h, sizeof(h)) != sizeof(h))
+        return;
+    h.running = 0;
+    f.seek(0);
+    f.write((const char*)&h, sizeof(h));
+}
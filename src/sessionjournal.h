@@ -0,0 +1,91 @@
+#ifndef SESSIONJOURNAL_H
+#define SESSIONJOURNAL_H
+
+#include <QFile>
+#include <QList>
+#include "sessionline.h"
+
+// crash recovery journal of the session in progress.
+// The journal is a file of fixed size records mapped in memory: every line of the session is copied
+// into the next slot of the ring and the count in the header is updated after it, so appending costs
+// a memcpy and no system call. The kernel writes the pages back on its own, so the journal survives
+// a crash or a kill of the app (not a power loss of the whole device).
+// At the start of the app an unfinished journal can be loaded back to resume the workout.
+class sessionjournal
+{
+public:
+    // what the session lines alone don't carry
+    typedef struct journalstate
+    {
+        uint8_t deviceType;
+        uint32_t moving; // seconds
+        double jouls;
+        int32_t trainProgramTicks; // -1 without a train program
+    }journalstate;
+
+    sessionjournal();
+    ~sessionjournal();
+
+    // starts a new journal over the previous one
+    bool open(const QString& filename, uint8_t deviceType);
+    // continues an unfinished journal after load()
+    bool resume(const QString& filename);
+    void append(const SessionLine& s, uint32_t moving, double jouls, int32_t trainProgramTicks, int32_t trainProgramStep);
+    // the session has been saved: the journal isn't offered for a resume anymore
+    void finish();
+    bool isOpen() {return m_header != 0;}
+
+    // lines of an unfinished journal, 0 if there is nothing to resume
+    static uint32_t pending(const QString& filename);
+    static bool load(const QString& filename, QList<SessionLine>& session, QList<int32_t>& steps, journalstate& state);
+    static void discard(const QString& filename);
+
+    // 12 hours at 1 Hz, older lines are overwritten
+    static const uint32_t CAPACITY = 12 * 3600;
+
+private:
+    typedef struct journalheader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t capacity;
+        uint32_t running; // 0 once the session has been saved
+        uint32_t deviceType;
+        quint64 count; // lines appended since the start of the session
+    }journalheader;
+
+    typedef struct journalrecord
+    {
+        qint64 time; // msecs since epoch
+        double speed;
+        double distance;
+        double pace;
+        double calories;
+        double elevationGain;
+        double jouls;
+        float rmssd;
+        float sdnn;
+        float dfaAlpha1;
+        uint32_t elapsed;
+        uint32_t moving;
+        int32_t trainProgramTicks;
+        int32_t trainProgramStep;
+        uint16_t watt;
+        int8_t inclination;
+        int8_t resistance;
+        int8_t pelotonResistance;
+        uint8_t heart;
+        uint8_t cadence;
+        uint8_t lap;
+    }journalrecord;
+
+    bool map(const QString& filename, bool create);
+    static bool valid(const journalheader* h);
+
+    QFile m_file;
+    journalheader* m_header = 0;
+    journalrecord* m_records = 0;
+};
+
+#endif // SESSIONJOURNAL_H
@@ -20,6 +20,10 @@ public:
     double elevationGain;
     uint32_t elapsedTime;
     bool lapTrigger = false;
+    // heart rate variability from the RR intervals of the belt, 0 when not available
+    double rmssd = 0;
+    double sdnn = 0;
+    double dfaAlpha1 = 0;
 
     SessionLine();
     SessionLine(double speed, int8_t inclination, double distance, uint16_t watt, int8_t resistance, int8_t peloton_resistance, uint8_t heart, double pace, uint8_t cadence, double calories, double elevationGain, uint32_t elapsed, bool lap, QDateTime time = QDateTime::currentDateTime());
@@ -0,0 +1,78 @@
+#include "sessionmodel.h"
+
+sessionmodel::sessionmodel(const QList<SessionLine>& session, QObject* parent) : QAbstractTableModel(parent), m_session(session)
+{
+
+}
+
+int sessionmodel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+int sessionmodel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+QVariant sessionmodel::data(const QModelIndex& index, int role) const
+{
+    if(role != Qt::DisplayRole || !index.isValid())
+        return QVariant();
+
+    const int i = index.row() * m_stride;
+    // the session keeps growing during a workout, the rows follow it only on reset()
+    if(i >= m_session.length())
+        return QVariant();
+
+    const SessionLine& s = m_session.at(i);
+    switch(index.column())
+    {
+    case TIME: return (double)i * 1000.0;
+    case WATT: return (double)s.watt;
+    case HEART: return (double)s.heart;
+    case CADENCE: return (double)s.cadence;
+    case RESISTANCE: return (double)s.resistance;
+    case PELOTON_RESISTANCE: return (double)s.peloton_resistance;
+    case SPEED: return s.speed;
+    case INCLINATION: return (double)s.inclination;
+    default: return QVariant();
+    }
+}
+
+QVariant sessionmodel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch(section)
+    {
+    case TIME: return "time";
+    case WATT: return "watt";
+    case HEART: return "heart";
+    case CADENCE: return "cadence";
+    case RESISTANCE: return "resistance";
+    case PELOTON_RESISTANCE: return "peloton_resistance";
+    case SPEED: return "speed";
+    case INCLINATION: return "inclination";
+    default: return QVariant();
+    }
+}
+
+void sessionmodel::setStride(int value)
+{
+    if(value < 1)
+        value = 1;
+    if(value == m_stride)
+        return;
+    m_stride = value;
+    reset();
+    emit strideChanged(value);
+}
+
+void sessionmodel::reset()
+{
+    beginResetModel();
+    m_rows = (m_session.length() + m_stride - 1) / m_stride;
+    endResetModel();
+}
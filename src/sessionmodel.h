@@ -0,0 +1,54 @@
+#ifndef SESSIONMODEL_H
+#define SESSIONMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include "sessionline.h"
+
+// table view of the session for the charts of the QML pages.
+// The model reads the session lines in place: a row is one sample every `stride` seconds and the
+// columns are the series, so a VXYModelMapper feeds a LineSeries without copying the session into
+// a list per property access.
+class sessionmodel : public QAbstractTableModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int stride READ stride WRITE setStride NOTIFY strideChanged)
+
+public:
+    enum COLUMN
+    {
+        TIME = 0, // msecs from the start, for a DateTimeAxis
+        WATT,
+        HEART,
+        CADENCE,
+        RESISTANCE,
+        PELOTON_RESISTANCE,
+        SPEED,
+        INCLINATION,
+        COLUMN_COUNT,
+    };
+    Q_ENUM(COLUMN)
+
+    sessionmodel(const QList<SessionLine>& session, QObject* parent = 0);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    int stride() const {return m_stride;}
+    void setStride(int value);
+
+    // the session has been cleared or replaced, or it is complete and a page is going to read it
+    void reset();
+
+signals:
+    void strideChanged(int value);
+
+private:
+    const QList<SessionLine>& m_session;
+    int m_stride = 10;
+    int m_rows = 0;
+};
+
+#endif // SESSIONMODEL_H
@@ -104,6 +104,8 @@ import Qt.labs.settings 1.0
             property int  tile_target_cadence_order: 19
             property bool tile_target_power_enabled: false
             property int  tile_target_power_order: 20
+            property bool tile_hrv_enabled: false
+            property int  tile_hrv_order: 25
 
             property real heart_rate_zone1: 70.0
             property real heart_rate_zone2: 80.0
@@ -114,6 +116,7 @@ import Qt.labs.settings 1.0
             property real peloton_offset: 0
 
             property string treadmill_pid_heart_zone: "Disabled"
+            property bool trainprogram_lookahead: true
 
             property bool domyos_treadmill_buttons: false
             property bool domyos_treadmill_distance_display: true
@@ -173,6 +176,9 @@ import Qt.labs.settings 1.0
 
             property bool virtualbike_forceresistance: true
             property bool bluetooth_relaxed: false
+            property bool bluetooth_fast_reconnect: true
+            property bool bluetooth_thread: false
+            property bool tracing: false
             property bool battery_service: false
             property bool service_changed: false
             property bool virtual_device_enabled: true
@@ -181,6 +187,9 @@ import Qt.labs.settings 1.0
             property bool log_debug: false
             property bool virtual_device_onlyheart: false
             property bool virtual_device_echelon: false
+            property bool lap_workout_steps: false
+            property bool lap_auto_power: false
+            property real bike_weight: 0.0
         }
 
         ColumnLayout {
@@ -207,7 +216,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     RowLayout {
                         spacing: 10
@@ -257,6 +266,30 @@ import Qt.labs.settings 1.0
                         }
                     }
 
+                    RowLayout {
+                        spacing: 10
+                        Label {
+                            id: labelBikeWeight
+                            text: qsTr("Bike Weight") + "(" + (settings.miles_unit?"lbs":"kg") + ")"
+                            Layout.fillWidth: true
+                        }
+                        TextField {
+                            id: bikeWeightTextField
+                            text: (settings.miles_unit?settings.bike_weight * 2.20462:settings.bike_weight)
+                            horizontalAlignment: Text.AlignRight
+                            Layout.fillHeight: false
+                            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                            inputMethodHints: Qt.ImhFormattedNumbersOnly
+                            onAccepted: settings.bike_weight = text
+                        }
+                        Button {
+                            id: okBikeWeightButton
+                            text: "OK"
+                            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                            onClicked: settings.bike_weight = (settings.miles_unit?bikeWeightTextField.text / 2.20462:bikeWeightTextField.text)
+                        }
+                    }
+
                     RowLayout {
                         spacing: 10
                         Label {
@@ -481,7 +514,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     SwitchDelegate {
                         id: speedPowerBasedDelegate
@@ -642,7 +675,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent:  ColumnLayout {
+                sectionContent:  ColumnLayout {
                     spacing: 0
                     SwitchDelegate {
                         id: antCadenceDelegate
@@ -700,7 +733,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     AccordionCheckElement {
                         id: speedEnabledAccordion
@@ -1468,6 +1501,37 @@ import Qt.labs.settings 1.0
                             }
                         }
                     }
+                    AccordionCheckElement {
+                        id: hrvEnabledAccordion
+                        title: qsTr("HRV")
+                        linkedBoolSetting: "tile_hrv_enabled"
+                        settings: settings
+                        accordionContent: RowLayout {
+                            spacing: 10
+                            Label {
+                                id: labelhrvOrder
+                                text: qsTr("order index:")
+                                Layout.fillWidth: true
+                                horizontalAlignment: Text.AlignRight
+                            }
+                            ComboBox {
+                                id: hrvOrderTextField
+                                model: rootItem.tile_order
+                                displayText: settings.tile_hrv_order
+                                Layout.fillHeight: false
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onActivated: {
+                                    displayText = hrvOrderTextField.currentValue
+                                 }
+                            }
+                            Button {
+                                id: okhrvOrderButton
+                                text: "OK"
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onClicked: settings.tile_hrv_order = hrvOrderTextField.displayText
+                            }
+                        }
+                    }
 
 
                     AccordionCheckElement {
@@ -1513,7 +1577,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     SwitchDelegate {
                         id: topBarEnabledDelegate
@@ -1538,7 +1602,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     RowLayout {
                         spacing: 10
@@ -1643,7 +1707,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
 
                     RowLayout {
@@ -1925,7 +1989,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     RowLayout {
                         spacing: 10
@@ -1953,6 +2017,20 @@ import Qt.labs.settings 1.0
                             onClicked: settings.treadmill_pid_heart_zone = treadmillPidHRTextField.displayText
                         }
                     }
+                    SwitchDelegate {
+                        id: trainProgramLookaheadDelegate
+                        text: qsTr("Anticipate the Changes by the Machine Lag")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.trainprogram_lookahead
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.trainprogram_lookahead = checked
+                    }
                 }
                 AccordionCheckElement {
                     id: trainingProgramRandomAccordion
@@ -2162,7 +2240,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     SwitchDelegate {
                         id: domyosTreadmillButtonsDelegate
@@ -2202,7 +2280,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: SwitchDelegate {
+                sectionContent: SwitchDelegate {
                     id: inspirePelotonFormulaDelegate
                     text: qsTr("Advanced Peloton Formula")
                     spacing: 0
@@ -2223,7 +2301,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     SwitchDelegate {
                         id: toorxRouteKeyDelegate
@@ -2291,7 +2369,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: SwitchDelegate {
+                sectionContent: SwitchDelegate {
                     id: yesoulBikeDelegate
                     text: qsTr("Yesoul New Peloton Formula")
                     spacing: 0
@@ -2313,7 +2391,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: SwitchDelegate {
+                sectionContent: SwitchDelegate {
                     id: snodeBikeDelegate
                     text: qsTr("Snode Bike")
                     spacing: 0
@@ -2334,7 +2412,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: SwitchDelegate {
+                sectionContent: SwitchDelegate {
                     id: fitplusBikeDelegate
                     text: qsTr("Fit Plus Bike")
                     spacing: 0
@@ -2355,7 +2433,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: RowLayout {
+                sectionContent: RowLayout {
                     spacing: 10
                     Label {
                         id: labelflywheelBikeFilter
@@ -2385,7 +2463,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: RowLayout {
+                sectionContent: RowLayout {
                     spacing: 10
                     Label {
                         id: labelDomyosBikeCadenceFilter
@@ -2415,7 +2493,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: RowLayout {
+                sectionContent: RowLayout {
                     spacing: 10
                     Label {
                         id: labelDomyosEllipticalSpeedRatio
@@ -2445,7 +2523,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: RowLayout {
+                sectionContent: RowLayout {
                     spacing: 10
                     Label {
                         id: labelproformBikeWheelRatio
@@ -2475,7 +2553,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: RowLayout {
+                sectionContent: RowLayout {
                     spacing: 10
                     Label {
                         id: labelfitshowTreadmillUserId
@@ -2508,7 +2586,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     SwitchDelegate {
                         id: m3iBikeQtSearchDelegate
@@ -2598,7 +2676,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     RowLayout {
                         spacing: 10
@@ -2722,7 +2800,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 10
                     SwitchDelegate {
                         id: cadenceSensorAsBikeDelegate
@@ -2803,7 +2881,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 10
                     RowLayout {
                         spacing: 10
@@ -2847,7 +2925,7 @@ import Qt.labs.settings 1.0
                 indicatRectColor: Material.color(Material.Grey)
                 textColor: Material.color(Material.Grey)
                 color: Material.backgroundColor
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     RowLayout {
                         spacing: 10
@@ -2956,7 +3034,7 @@ import Qt.labs.settings 1.0
                 //width: 640
                 //anchors.top: acc1.bottom
                 //anchors.topMargin: 10
-                accordionContent: ColumnLayout {
+                sectionContent: ColumnLayout {
                     spacing: 0
                     SwitchDelegate {
                         id: bluetoothRelaxedDelegate
@@ -2973,6 +3051,51 @@ import Qt.labs.settings 1.0
                         onClicked: settings.bluetooth_relaxed = checked
                     }
 
+                    SwitchDelegate {
+                        id: bluetoothFastReconnectDelegate
+                        text: qsTr("Fast Reconnect to the Last Device")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.bluetooth_fast_reconnect
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.bluetooth_fast_reconnect = checked
+                    }
+
+                    SwitchDelegate {
+                        id: bluetoothThreadDelegate
+                        text: qsTr("Bluetooth on its own Thread (restart needed)")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.bluetooth_thread
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.bluetooth_thread = checked
+                    }
+
+                    SwitchDelegate {
+                        id: tracingDelegate
+                        text: qsTr("Trace the Data Path (saved at Stop)")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.tracing
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.tracing = checked
+                    }
+
                     SwitchDelegate {
                         id: batteryServiceDelegate
                         text: qsTr("Simulate Battery Service")
@@ -3152,6 +3275,36 @@ import Qt.labs.settings 1.0
                         Layout.fillWidth: true
                         onClicked: settings.log_debug = checked
                     }
+
+                    SwitchDelegate {
+                        id: lapWorkoutStepsDelegate
+                        text: qsTr("Lap on every workout step")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.lap_workout_steps
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.lap_workout_steps = checked
+                    }
+
+                    SwitchDelegate {
+                        id: lapAutoPowerDelegate
+                        text: qsTr("Auto Lap on power intervals")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.lap_auto_power
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.lap_auto_power = checked
+                    }
                 }
             }
         }
@@ -32,7 +32,9 @@ int POSIX_logicalToPhysical(int);
 
 SignalHandler::SignalHandler(int mask) : _mask(mask)
 {
-    assert(g_handler == NULL);
+    // the sessions of several machines (devicesessions) have a manager each: the first one gets the signals
+    if(g_handler != NULL)
+        return;
     g_handler = this;
 
 #if 0
@@ -60,6 +62,9 @@ SignalHandler::SignalHandler(int mask) : _mask(mask)
 
 SignalHandler::~SignalHandler()
 {
+    if(g_handler != this)
+        return;
+    g_handler = NULL;
 #if 0
     SetConsoleCtrlHandler(WIN32_handleFunc, FALSE);
 #else
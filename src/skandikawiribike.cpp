@@ -20,7 +20,7 @@ skandikawiribike::skandikawiribike(bool noWriteResistance, bool noHeartService,
 
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(300);
+    pollscheduler::instance()->add(refresh, 300);
 }
 
 skandikawiribike::~skandikawiribike()
@@ -32,6 +32,7 @@ skandikawiribike::~skandikawiribike()
 
 void skandikawiribike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("skandikawiribike::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -39,13 +40,13 @@ void skandikawiribike::writeCharacteristic(uint8_t* data, uint8_t data_len, QStr
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicChanged(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, QByteArray((const char*)data, data_len));
@@ -53,10 +54,17 @@ void skandikawiribike::writeCharacteristic(uint8_t* data, uint8_t data_len, QStr
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 /*
@@ -90,7 +98,7 @@ void skandikawiribike::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (1000 / refresh->interval()))
+        if(sec1Update++ >= (1000 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed.value());
@@ -195,10 +203,10 @@ char* skandikawiribike::itoa(int num, char* buffer, int base) {
 
 void skandikawiribike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("skandikawiribike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -222,12 +230,11 @@ void skandikawiribike::characteristicChanged(const QLowEnergyCharacteristic &cha
         if(!settings.value("speed_power_based", false).toBool())
             Speed = speed;
         else
-            Speed = metric::calculateSpeedFromPower(m_watt.value());
+            Speed = physics.speed(m_watt.value());
     }
     else if(newValue.at(1) == 0x10)
     {
-        if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-            Cadence = GetCadenceFromPacket(newValue);
+        sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, GetCadenceFromPacket(newValue));
     }
 
     double kcal = GetKcalFromPacket(newValue);
@@ -240,15 +247,11 @@ void skandikawiribike::characteristicChanged(const QLowEnergyCharacteristic &cha
     }
     emit resistanceRead(Resistance.value());
 
+    // no heart rate sensor on the machine
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
-    else
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
 #endif
-    {
-        if(heartRateBeltName.startsWith("Disabled"))
-            Heart = 0;
-    }
 
     if(Cadence.value() > 0)
     {
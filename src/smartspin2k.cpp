@@ -21,7 +21,7 @@ smartspin2k::smartspin2k(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void smartspin2k::resistanceReadFromTheBike(int8_t resistance)
@@ -33,6 +33,7 @@ void smartspin2k::resistanceReadFromTheBike(int8_t resistance)
 
 void smartspin2k::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("smartspin2k::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
     if(wait_for_response)
@@ -90,7 +91,7 @@ void smartspin2k::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -133,10 +134,10 @@ void smartspin2k::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void smartspin2k::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("smartspin2k::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -178,7 +179,7 @@ void smartspin2k::characteristicChanged(const QLowEnergyCharacteristic &characte
         if(!settings.value("speed_power_based", false).toBool())
             Speed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 100.0;
         else
-            Speed = metric::calculateSpeedFromPower(m_watt.value());
+            Speed = physics.speed(m_watt.value());
         index += 2;
         debug("Current Speed: " + QString::number(Speed.value()));
     }
@@ -193,8 +194,7 @@ void smartspin2k::characteristicChanged(const QLowEnergyCharacteristic &characte
 
     if(Flags.instantCadence)
     {
-        if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-            Cadence = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 2.0;
+        sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 2.0);
         index += 2;
         debug("Current Cadence: " + QString::number(Cadence.value()));
     }
@@ -231,6 +231,7 @@ void smartspin2k::characteristicChanged(const QLowEnergyCharacteristic &characte
         m_watt = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index))));
         index += 2;
         debug("Current Watt: " + QString::number(m_watt.value()));
+        emit powerChanged(m_watt.value());
     }
 
     if(Flags.avgPower)
@@ -261,15 +262,15 @@ void smartspin2k::characteristicChanged(const QLowEnergyCharacteristic &characte
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
         if(Flags.heartRate)
         {
-            Heart = ((double)((newValue.at(index))));
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, (uint8_t)newValue.at(index));
+            debug("Current Heart: " + QString::number((uint8_t)newValue.at(index)));
             index += 1;
-            debug("Current Heart: " + QString::number(Heart.value()));
         }
     }
 
@@ -296,19 +297,17 @@ void smartspin2k::characteristicChanged(const QLowEnergyCharacteristic &characte
 
     lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
 
-    if(heartRateBeltName.startsWith("Disabled"))
-    {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
     lockscreen h;
     long appleWatchHeartRate = h.heartRate();
     h.setKcal(KCal.value());
     h.setDistance(Distance.value());
-    Heart = appleWatchHeartRate;
+    if(appleWatchHeartRate > 0)
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
     debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-    }
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
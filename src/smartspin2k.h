@@ -77,6 +77,7 @@ private:
 signals:
     void disconnected();
     void debug(QString string);
+    void powerChanged(uint16_t power);
 
 public slots:
     void deviceDiscovered(const QBluetoothDeviceInfo &device);
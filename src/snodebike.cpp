@@ -24,7 +24,7 @@ snodebike::snodebike(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 /*
 void snodebike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
@@ -74,7 +74,7 @@ void snodebike::update()
         update_metrics(true, watts());
 
         // updating the treadmill console every second
-        if(sec1Update++ == (500 / refresh->interval()))
+        if(sec1Update++ >= (500 / refresh->interval()))
         {
             sec1Update = 0;
             //updateDisplay(elapsed);
@@ -117,11 +117,11 @@ void snodebike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void snodebike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("snodebike::characteristicChanged");
     double heart;
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -165,7 +165,7 @@ void snodebike::characteristicChanged(const QLowEnergyCharacteristic &characteri
         if(!settings.value("speed_power_based", false).toBool())
             Speed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 100.0;
         else
-            Speed = metric::calculateSpeedFromPower(m_watt.value());
+            Speed = physics.speed(m_watt.value());
         index += 2;
         debug("Current Speed: " + QString::number(Speed.value()));
     }
@@ -180,8 +180,7 @@ void snodebike::characteristicChanged(const QLowEnergyCharacteristic &characteri
 
     if(Flags.instantCadence)
     {
-        if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-            Cadence = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 2.0;
+        sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index)))) / 2.0);
         index += 2;
         debug("Current Cadence: " + QString::number(Cadence.value()));
     }
@@ -249,7 +248,7 @@ void snodebike::characteristicChanged(const QLowEnergyCharacteristic &characteri
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
@@ -296,25 +295,23 @@ void snodebike::characteristicChanged(const QLowEnergyCharacteristic &characteri
 
     lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
 
-    if(heartRateBeltName.startsWith("Disabled"))
+    if(heart == 0)
     {
-        if(heart == 0)
-        {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-            lockscreen h;
+        lockscreen h;
         long appleWatchHeartRate = h.heartRate();
         h.setKcal(KCal.value());
         h.setDistance(Distance.value());
-        Heart = appleWatchHeartRate;
+        if(appleWatchHeartRate > 0)
+            sensors.publish(sensorbus::HEART, sensorbus::PHONE, appleWatchHeartRate);
         debug("Current Heart from Apple Watch: " + QString::number(appleWatchHeartRate));
 #endif
 #endif
-        }
-        else
-        {
-            Heart = heart;
-        }
+    }
+    else
+    {
+        sensors.publish(sensorbus::HEART, sensorbus::MACHINE, heart);
     }
 
 #ifdef Q_OS_IOS
@@ -20,7 +20,7 @@ soleelliptical::soleelliptical(bool noWriteResistance, bool noHeartService, bool
 
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(300);
+    pollscheduler::instance()->add(refresh, 300);
 }
 
 soleelliptical::~soleelliptical()
@@ -32,6 +32,7 @@ soleelliptical::~soleelliptical()
 
 void soleelliptical::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("soleelliptical::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -39,13 +40,13 @@ void soleelliptical::writeCharacteristic(uint8_t* data, uint8_t data_len, QStrin
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicChanged(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, QByteArray((const char*)data, data_len));
@@ -53,10 +54,17 @@ void soleelliptical::writeCharacteristic(uint8_t* data, uint8_t data_len, QStrin
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void soleelliptical::forceResistanceAndInclination(int8_t requestResistance, uint8_t inclination)
@@ -120,7 +128,7 @@ void soleelliptical::update()
         // ********************************************************************************************************
 
         // updating the treadmill console every second
-        if(sec1Update++ == (1000 / refresh->interval()))
+        if(sec1Update++ >= (1000 / refresh->interval()))
         {
             sec1Update = 0;
         }
@@ -200,10 +208,10 @@ void soleelliptical::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void soleelliptical::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("soleelliptical::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
 
     debug(" << " + newValue.toHex(' '));
 
@@ -224,8 +232,7 @@ void soleelliptical::characteristicChanged(const QLowEnergyCharacteristic &chara
     //double distance = GetDistanceFromPacket(newValue) * settings.value("domyos_elliptical_speed_ratio", 1.0).toDouble();
     uint16_t watt = (newValue.at(13) << 8) | newValue.at(14);
 
-    if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-        Cadence = ((uint8_t)newValue.at(10));
+    sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, (uint8_t)newValue.at(10));
     m_watt = watt;
 
     //Inclination = newValue.at(21);
@@ -237,12 +244,11 @@ void soleelliptical::characteristicChanged(const QLowEnergyCharacteristic &chara
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
-            Heart = ((uint8_t)newValue.at(18));
+        sensors.publish(sensorbus::HEART, sensorbus::MACHINE, ((uint8_t)newValue.at(18)));
     }
 
     Distance += ((Speed.value() / 3600000.0) * ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime())) );
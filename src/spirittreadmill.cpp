@@ -15,11 +15,12 @@ spirittreadmill::spirittreadmill()
     refresh = new QTimer(this);
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void spirittreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("spirittreadmill::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -27,13 +28,13 @@ void spirittreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QStri
     {
         connect(this, SIGNAL(packetReceived()),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, QByteArray((const char*)data, data_len));
@@ -41,10 +42,17 @@ void spirittreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QStri
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void spirittreadmill::forceSpeedOrIncline(double requestSpeed, double requestIncline)
@@ -98,7 +106,7 @@ void spirittreadmill::update()
         update_metrics(true, watts(settings.value("weight", 75.0).toFloat()));
 
         // updating the treadmill console every second
-        if(sec1update++ == (1000 / refresh->interval()))
+        if(sec1update++ >= (1000 / refresh->interval()))
         {
             sec1update = 0;
             //updateDisplay(elapsed);
@@ -186,10 +194,10 @@ void spirittreadmill::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void spirittreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("spirittreadmill::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     emit packetReceived();
 
     debug(" << " + newValue.toHex(' '));
@@ -205,12 +213,11 @@ void spirittreadmill::characteristicChanged(const QLowEnergyCharacteristic &char
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
-            Heart = ((uint8_t)newValue.at(18));
+        sensors.publish(sensorbus::HEART, sensorbus::MACHINE, ((uint8_t)newValue.at(18)));
     }
 
     Distance += ((Speed.value() / 3600000.0) * ((double)lastTimeCharChanged.msecsTo(QTime::currentTime())) );
@@ -17,11 +17,12 @@ sportstechbike::sportstechbike(bool noWriteResistance, bool noHeartService)
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void sportstechbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("sportstechbike::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -29,13 +30,13 @@ void sportstechbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QStrin
     {
         connect(this, SIGNAL(packetReceived()),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, QByteArray((const char*)data, data_len));
@@ -43,10 +44,17 @@ void sportstechbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QStrin
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void sportstechbike::forceResistance(int8_t requestResistance)
@@ -90,7 +98,7 @@ void sportstechbike::update()
         update_metrics(false, 0);
 
         // updating the bike console every second
-        if(sec1update++ == (1000 / refresh->interval()))
+        if(sec1update++ >= (1000 / refresh->interval()))
         {
             sec1update = 0;
             //updateDisplay(elapsed);
@@ -113,10 +121,10 @@ void sportstechbike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void sportstechbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("sportstechbike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     emit packetReceived();
 
     debug(" << " + newValue.toHex(' '));
@@ -133,12 +141,11 @@ void sportstechbike::characteristicChanged(const QLowEnergyCharacteristic &chara
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
-            Heart = ((uint8_t)newValue.at(11));
+        sensors.publish(sensorbus::HEART, sensorbus::MACHINE, ((uint8_t)newValue.at(11)));
     }
     FanSpeed = 0;
 
@@ -160,13 +167,12 @@ void sportstechbike::characteristicChanged(const QLowEnergyCharacteristic &chara
     if(!settings.value("speed_power_based", false).toBool())
         Speed = speed;
     else
-        Speed = metric::calculateSpeedFromPower(m_watt.value());
+        Speed = physics.speed(m_watt.value());
     Resistance = requestResistance;
     emit resistanceRead(Resistance.value());
     KCal = kcal;
     Distance = DistanceCalculated;
-    if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-        Cadence = cadence;
+    sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, cadence);
     m_watt = watt;
 
     lastTimeCharChanged = QTime::currentTime();
@@ -0,0 +1,47 @@
+#include "startuptiming.h"
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+
+QElapsedTimer startuptiming::timer;
+QList<QPair<QString, qint64>> startuptiming::marks;
+
+void startuptiming::start()
+{
+    timer.start();
+    marks.clear();
+}
+
+void startuptiming::mark(const QString& name)
+{
+    if(!timer.isValid())
+        return;
+    for(const QPair<QString, qint64>& m : marks)
+        if(m.first == name)
+            return;
+
+    const qint64 ms = timer.elapsed();
+    marks.append(qMakePair(name, ms));
+    qDebug() << "startup:" << name << ms << "ms";
+}
+
+void startuptiming::save(const QString& filename)
+{
+    if(marks.isEmpty())
+        return;
+
+    QFile file(filename);
+    const bool header = !file.exists();
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+    {
+        qDebug() << "startup: unable to write" << filename;
+        return;
+    }
+    QTextStream out(&file);
+    if(header)
+        out << "date,mark,ms\n";
+    const QString date = QDateTime::currentDateTime().toString(Qt::ISODate);
+    for(const QPair<QString, qint64>& m : marks)
+        out << date << "," << m.first << "," << m.second << "\n";
+}
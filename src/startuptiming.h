@@ -0,0 +1,25 @@
+#ifndef STARTUPTIMING_H
+#define STARTUPTIMING_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+// timings of the app startup, to track the regressions of the time to the first frame and to the
+// connection of the device. The marks are measured from the start of main() and logged; save()
+// appends the marks of this startup to a csv file (date,mark,ms), so the startups can be compared
+class startuptiming
+{
+public:
+    static void start();
+    // records the first occurrence of the mark, the next ones are ignored
+    static void mark(const QString& name);
+    static void save(const QString& filename);
+
+private:
+    static QElapsedTimer timer;
+    static QList<QPair<QString, qint64>> marks;
+};
+
+#endif // STARTUPTIMING_H
@@ -1,7 +1,12 @@
 #include "tcpclientinfosender.h"
+#include "telemetrystream.h"
 
-TcpClientInfoSender::TcpClientInfoSender(const QString& id, QObject * parent):TemplateInfoSender(id, parent) {
+// bytes (queued records plus socket buffer) kept for a slow recorder before dropping the new samples
+static const int maxBacklog = 64 * 1024;
 
+TcpClientInfoSender::TcpClientInfoSender(const QString& id, QObject * parent):TemplateInfoSender(id, parent) {
+    connect(&sampleTimer, SIGNAL(timeout()), this, SLOT(sample()));
+    connect(&flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
 }
 TcpClientInfoSender::~TcpClientInfoSender() {
     innerStop();
@@ -20,7 +25,48 @@ bool TcpClientInfoSender::send(const QString& data) {
     return false;
 }
 
+bool TcpClientInfoSender::update(QJSEngine * eng) {
+    // the binary stream runs on its own timers
+    if (binary)
+        return true;
+    return TemplateInfoSender::update(eng);
+}
+
+bool TcpClientInfoSender::scripted() const {
+    return !binary;
+}
+
+void TcpClientInfoSender::setDevice(bluetoothdevice * dev) {
+    device = dev;
+}
+
+void TcpClientInfoSender::sample() {
+    if (!device || !isRunning())
+        return;
+    sequence++;
+    if (tcpSocket->bytesToWrite() + pending.size() + telemetrystream::RECORD_SIZE > maxBacklog) {
+        if (!(dropped++ % 100))
+            qDebug() << "Telemetry"<<templateId<<"recorder is behind, dropped"<<dropped<<"samples";
+        return;
+    }
+    const int size = pending.size();
+    pending.resize(size + telemetrystream::RECORD_SIZE);
+    telemetrystream::encode(device->lastSample(), sequence, pending.data() + size);
+    if (!flushTimer.isActive())
+        flush();
+}
+
+void TcpClientInfoSender::flush() {
+    if (pending.isEmpty() || !isRunning())
+        return;
+    tcpSocket->write(pending);
+    pending.clear();
+}
+
 void TcpClientInfoSender::innerStop() {
+    sampleTimer.stop();
+    flushTimer.stop();
+    pending.clear();
     if (tcpSocket) {
         if (isRunning()) {
             tcpSocket->close();
@@ -53,6 +99,11 @@ bool TcpClientInfoSender::init() {
         port = 4321;
     if (ip.isEmpty())
         ip = "127.0.0.1";
+    binary = settings.value("template_" + templateId + "_binary", false).toBool();
+    sampleInterval = settings.value("template_" + templateId + "_rate_ms", 100).toInt();
+    if (sampleInterval < 20)
+        sampleInterval = 20;
+    flushInterval = settings.value("template_" + templateId + "_flush_ms", 500).toInt();
     tcpSocket = new QTcpSocket(this);
     connect(tcpSocket, SIGNAL(connected()), this, SLOT(debugConnected()));
     connect(tcpSocket, SIGNAL(connectionClosed()), this, SLOT(reinit()));
@@ -65,6 +116,16 @@ bool TcpClientInfoSender::init() {
 
 void TcpClientInfoSender::debugConnected() {
     qDebug() << "Connected"<<tcpSocket->state();
+    if (binary) {
+        // the records are batched by the flush timer, Nagle would only add latency on top of it
+        tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        tcpSocket->write(telemetrystream::schema(sampleInterval));
+        pending.reserve((flushInterval / sampleInterval + 1) * telemetrystream::RECORD_SIZE);
+        sampleTimer.start(sampleInterval);
+        // a flush interval not longer than the sample interval writes every record as it's taken
+        if (flushInterval > sampleInterval)
+            flushTimer.start(flushInterval);
+    }
 }
 
 void TcpClientInfoSender::socketError(int err) {
@@ -3,6 +3,7 @@
 
 #include "templateinfosender.h"
 #include <QTcpSocket>
+#include <QTimer>
 
 class TcpClientInfoSender : public TemplateInfoSender
 {
@@ -12,15 +13,30 @@ public:
     virtual ~TcpClientInfoSender();
     virtual bool isRunning() const;
     virtual bool send(const QString& data);
+    virtual bool update(QJSEngine * eng);
+    virtual bool scripted() const;
+    virtual void setDevice(bluetoothdevice * dev);
 protected:
     QTcpSocket * tcpSocket = 0;
     QString ip;
     int port;
+    // binary telemetry (telemetrystream) sampled from the device instead of the template script
+    bool binary = false;
+    int sampleInterval = 100;
+    int flushInterval = 500;
+    bluetoothdevice * device = 0;
+    QTimer sampleTimer;
+    QTimer flushTimer;
+    QByteArray pending;
+    uint32_t sequence = 0;
+    uint32_t dropped = 0;
     virtual bool init();
     virtual void innerStop();
 private slots:
     void readyRead();
     void debugConnected();
+    void sample();
+    void flush();
     void socketError(int err);
     void stateChanged(QAbstractSocket::SocketState socketState);
 };
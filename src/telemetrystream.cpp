@@ -0,0 +1,136 @@
+#include "telemetrystream.h"
+#include <QtEndian>
+#include <string.h>
+
+typedef struct telemetryfield
+{
+    const char* name;
+    uint8_t type;
+    uint16_t offset;
+}telemetryfield;
+
+enum
+{
+    OFFSET_SYNC = 0,
+    OFFSET_VERSION = 2,
+    OFFSET_TYPE = 3,
+    OFFSET_SEQUENCE = 4,
+    OFFSET_TIMESTAMP = 8,
+    OFFSET_ELAPSED = 16,
+    OFFSET_FLAGS = 20,
+    OFFSET_FAN = 21,
+    OFFSET_HRV_ZONE = 22,
+    OFFSET_SPEED = 24,
+    OFFSET_HEART = 28,
+    OFFSET_WATT = 32,
+    OFFSET_CADENCE = 36,
+    OFFSET_RESISTANCE = 40,
+    OFFSET_INCLINATION = 44,
+    OFFSET_ODOMETER = 48,
+    OFFSET_CALORIES = 52,
+    OFFSET_ELEVATION = 56,
+    OFFSET_RMSSD = 60,
+    OFFSET_DFA_ALPHA1 = 64,
+};
+
+// the byte 23 is reserved, the flags are bit 0 connected and bit 1 paused
+static const telemetryfield fields[] = {
+    {"sync", telemetrystream::UINT16, OFFSET_SYNC},
+    {"version", telemetrystream::UINT8, OFFSET_VERSION},
+    {"device_type", telemetrystream::UINT8, OFFSET_TYPE},
+    {"sequence", telemetrystream::UINT32, OFFSET_SEQUENCE},
+    {"timestamp", telemetrystream::INT64, OFFSET_TIMESTAMP},
+    {"elapsed", telemetrystream::UINT32, OFFSET_ELAPSED},
+    {"flags", telemetrystream::UINT8, OFFSET_FLAGS},
+    {"fan", telemetrystream::UINT8, OFFSET_FAN},
+    {"hrv_zone", telemetrystream::UINT8, OFFSET_HRV_ZONE},
+    {"speed", telemetrystream::FLOAT32, OFFSET_SPEED},
+    {"heart", telemetrystream::FLOAT32, OFFSET_HEART},
+    {"watts", telemetrystream::FLOAT32, OFFSET_WATT},
+    {"cadence", telemetrystream::FLOAT32, OFFSET_CADENCE},
+    {"resistance", telemetrystream::FLOAT32, OFFSET_RESISTANCE},
+    {"inclination", telemetrystream::FLOAT32, OFFSET_INCLINATION},
+    {"odometer", telemetrystream::FLOAT32, OFFSET_ODOMETER},
+    {"calories", telemetrystream::FLOAT32, OFFSET_CALORIES},
+    {"elevation", telemetrystream::FLOAT32, OFFSET_ELEVATION},
+    {"rmssd", telemetrystream::FLOAT32, OFFSET_RMSSD},
+    {"dfa_alpha1", telemetrystream::FLOAT32, OFFSET_DFA_ALPHA1},
+};
+
+static inline void putFloat(char* record, uint16_t offset, double value)
+{
+    const float f = (float)value;
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    qToLittleEndian<quint32>(u, record + offset);
+}
+
+QByteArray telemetrystream::schema(uint16_t intervalMs)
+{
+    const uint8_t count = sizeof(fields) / sizeof(fields[0]);
+    QByteArray r("QZTS");
+    char header[6];
+    header[0] = VERSION;
+    header[1] = count;
+    qToLittleEndian<quint16>(RECORD_SIZE, header + 2);
+    qToLittleEndian<quint16>(intervalMs, header + 4);
+    r.append(header, sizeof(header));
+    for(uint8_t i = 0; i < count; i++)
+    {
+        char field[4];
+        const uint8_t length = strlen(fields[i].name);
+        field[0] = fields[i].type;
+        qToLittleEndian<quint16>(fields[i].offset, field + 1);
+        field[3] = length;
+        r.append(field, sizeof(field));
+        r.append(fields[i].name, length);
+    }
+    return r;
+}
+
+void telemetrystream::encode(const bluetoothdevicesample& sample, uint32_t sequence, char* record)
+{
+    double cadence = 0;
+    double resistance = 0;
+    double inclination = 0;
+    switch(sample.type)
+    {
+    case bluetoothdevice::BIKE:
+    case bluetoothdevice::ROWING:
+        cadence = sample.bike.cadence.value;
+        resistance = sample.bike.resistance.value;
+        break;
+    case bluetoothdevice::TREADMILL:
+        inclination = sample.treadmill.inclination.value;
+        break;
+    case bluetoothdevice::ELLIPTICAL:
+        cadence = sample.elliptical.cadence;
+        resistance = sample.elliptical.resistance;
+        inclination = sample.elliptical.inclination.value;
+        break;
+    default:
+        break;
+    }
+
+    qToLittleEndian<quint16>(SYNC, record + OFFSET_SYNC);
+    record[OFFSET_VERSION] = VERSION;
+    record[OFFSET_TYPE] = sample.type;
+    qToLittleEndian<quint32>(sequence, record + OFFSET_SEQUENCE);
+    qToLittleEndian<qint64>(sample.timestamp, record + OFFSET_TIMESTAMP);
+    qToLittleEndian<quint32>(sample.elapsed, record + OFFSET_ELAPSED);
+    record[OFFSET_FLAGS] = (sample.connected ? 0x01 : 0) | (sample.paused ? 0x02 : 0);
+    record[OFFSET_FAN] = sample.fanSpeed;
+    record[OFFSET_HRV_ZONE] = sample.hrvZone;
+    record[OFFSET_HRV_ZONE + 1] = 0;
+    putFloat(record, OFFSET_SPEED, sample.speed.value);
+    putFloat(record, OFFSET_HEART, sample.heart.value);
+    putFloat(record, OFFSET_WATT, sample.watt.value);
+    putFloat(record, OFFSET_CADENCE, cadence);
+    putFloat(record, OFFSET_RESISTANCE, resistance);
+    putFloat(record, OFFSET_INCLINATION, inclination);
+    putFloat(record, OFFSET_ODOMETER, sample.odometer);
+    putFloat(record, OFFSET_CALORIES, sample.calories);
+    putFloat(record, OFFSET_ELEVATION, sample.elevationGain);
+    putFloat(record, OFFSET_RMSSD, sample.rmssd);
+    putFloat(record, OFFSET_DFA_ALPHA1, sample.dfaAlpha1);
+}
@@ -0,0 +1,38 @@
+#ifndef TELEMETRYSTREAM_H
+#define TELEMETRYSTREAM_H
+
+#include <QByteArray>
+#include "bluetoothdevice.h"
+
+// native binary framing of the device samples for the data logging consumers of the tcp templates.
+// After the connection the sender writes one schema frame describing the record, then a stream of
+// fixed size little endian records, one per sample:
+//
+//   schema: "QZTS" | u8 version | u8 field count | u16 record size | u16 sample interval ms |
+//           field count * (u8 type | u16 offset | u8 name length | name)
+//   record: u16 sync 0x5A51 ("QZ") | u8 version | u8 device type | u32 sequence | ... (see fields)
+//
+// The sequence grows by one for every sample taken and it isn't reset by a reconnection, so a
+// recorder sees the samples dropped behind a slow link as a gap.
+class telemetrystream
+{
+public:
+    enum FIELD_TYPE
+    {
+        UINT8 = 1,
+        UINT16 = 2,
+        UINT32 = 3,
+        INT64 = 4,
+        FLOAT32 = 5,
+    };
+
+    static const uint8_t VERSION = 1;
+    static const uint16_t SYNC = 0x5A51;
+    static const uint16_t RECORD_SIZE = 68;
+
+    static QByteArray schema(uint16_t intervalMs);
+    // writes RECORD_SIZE bytes into record
+    static void encode(const bluetoothdevicesample& sample, uint32_t sequence, char* record);
+};
+
+#endif // TELEMETRYSTREAM_H
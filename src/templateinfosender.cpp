@@ -41,6 +41,14 @@ bool TemplateInfoSender::update(QJSEngine * eng) {
         return false;
 }
 
+bool TemplateInfoSender::scripted() const {
+    return true;
+}
+
+void TemplateInfoSender::setDevice(bluetoothdevice * dev) {
+    Q_UNUSED(dev);
+}
+
 QString TemplateInfoSender::js() const {
     return jscript;
 }
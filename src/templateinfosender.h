@@ -5,6 +5,8 @@
 #include <QSettings>
 #include <QJSEngine>
 
+class bluetoothdevice;
+
 class TemplateInfoSender: public QObject
 {
     Q_OBJECT
@@ -15,7 +17,10 @@ public:
     virtual bool send(const QString& data) = 0;
     bool init(const QString& script);
     void stop();
-    bool update(QJSEngine * eng);
+    virtual bool update(QJSEngine * eng);
+    // false when the sender builds its payload without the template script and its context
+    virtual bool scripted() const;
+    virtual void setDevice(bluetoothdevice * dev);
     QString js() const;
     QString getId() const;
 signals:
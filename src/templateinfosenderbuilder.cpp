@@ -29,9 +29,15 @@ TemplateInfoSenderBuilder::~TemplateInfoSenderBuilder() {
 }
 
 void TemplateInfoSenderBuilder::onUpdateTimeout() {
-    buildContext();
+    TRACE_SPAN("TemplateInfoSenderBuilder::onUpdateTimeout");
     QHash<QString,TemplateInfoSender *>::Iterator it;
     bool rv;
+    for(it = templateInfoMap.begin(); it != templateInfoMap.end(); it++) {
+        if (it.value()->scripted()) {
+            buildContext();
+            break;
+        }
+    }
     for(it = templateInfoMap.begin(); it != templateInfoMap.end(); it++) {
         rv = it.value()->update(engine);
         if (!rv)
@@ -179,6 +185,7 @@ TemplateInfoSender * TemplateInfoSenderBuilder::newTemplate(const QString& id, c
         }
         qDebug() << "Template Registered"<<id <<" type"<<tp<<" Template"<<dataTempl;
         templateInfoMap.insert(id, tempInfo);
+        tempInfo->setDevice(device);
         tempInfo->init(dataTempl);
         connect(tempInfo, SIGNAL(onDataReceived(QByteArray)), this, SLOT(onDataReceived(QByteArray)));
     }
@@ -191,8 +198,12 @@ void TemplateInfoSenderBuilder::reinit() {
 
 void TemplateInfoSenderBuilder::start(bluetoothdevice * dev) {
     device = dev;
+    QHash<QString,TemplateInfoSender *>::Iterator it;
+    for(it = templateInfoMap.begin(); it != templateInfoMap.end(); it++) {
+        it.value()->setDevice(dev);
+    }
 
-    updateTimer.start(1000);
+    pollscheduler::instance()->add(&updateTimer, 1000, pollscheduler::BACKGROUND);
 }
 
 QStringList TemplateInfoSenderBuilder::templateIdList() const {
@@ -248,13 +259,13 @@ void TemplateInfoSenderBuilder::onSetResistance(const QJsonValue& msgContent, Te
         if (tp == bluetoothdevice::BIKE || tp == bluetoothdevice::ROWING) {
             int res;
             if ((res = resVal.toInt()) >= 0 && res < 255) {
-                ((bike *)device)->changeResistance((uint8_t)res);
+                ((bike *)device)->changeResistance((uint8_t)res, commandarbiter::TEMPLATE);
                 outObj["value"] = res;
             }
         }
         else {
             double resd;
-            ((treadmill *)device)->changeInclination(resd = resVal.toDouble());
+            ((treadmill *)device)->changeInclination(resd = resVal.toDouble(), commandarbiter::TEMPLATE);
             outObj["value"] = resd;
         }
     }
@@ -290,7 +301,7 @@ void TemplateInfoSenderBuilder::onSetPower(const QJsonValue& msgContent, Templat
             (device->deviceType() == bluetoothdevice::BIKE || device->deviceType() == bluetoothdevice::ROWING)) {
         int val;
         if ((val = resVal.toInt()) > 0) {
-            ((bike *)device)->changePower((uint32_t)val);
+            ((bike *)device)->changePower((uint32_t)val, commandarbiter::TEMPLATE);
             outObj["value"] = val;
         }
     }
@@ -327,7 +338,7 @@ void TemplateInfoSenderBuilder::onSetSpeed(const QJsonValue& msgContent, Templat
     outObj["value"] = QJsonValue(QJsonValue::Null);
     if (device  && msgContent.isObject()  && (obj = msgContent.toObject()).contains("value")  && (resVal = msgContent["value"]).isDouble() &&
             device->deviceType() == bluetoothdevice::TREADMILL && (vald = resVal.toDouble()) >= 0) {
-        ((treadmill *)device)->changeSpeed(vald);
+        ((treadmill *)device)->changeSpeed(vald, commandarbiter::TEMPLATE);
         outObj["value"] = vald;
     }
     QJsonObject main;
@@ -417,7 +428,6 @@ void TemplateInfoSenderBuilder::onLoadTrainingPrograms(const QJsonValue& msgCont
             item["requested_peloton_resistance"] = row.requested_peloton_resistance;
             item["cadence"] = row.cadence;
             item["forcespeed"] = row.forcespeed;
-            item["loopTimeHR"] = row.loopTimeHR;
             item["zoneHR"] = row.zoneHR;
             item["maxSpeed"] = row.maxSpeed;
             outArr.append(item);
@@ -450,7 +460,6 @@ void TemplateInfoSenderBuilder::onSaveTrainingProgram(const QJsonValue& msgConte
            if (row.contains("requested_peloton_resistance")) tR.requested_peloton_resistance = row["requested_peloton_resistance"].toInt();
            if (row.contains("cadence")) tR.cadence = row["cadence"].toInt();
            if (row.contains("forcespeed")) tR.forcespeed = (bool)row["forcespeed"].toInt();
-           if (row.contains("loopTimeHR")) tR.loopTimeHR = row["loopTimeHR"].toInt();
            if (row.contains("zoneHR")) tR.zoneHR = row["zoneHR"].toInt();
            if (row.contains("maxSpeed")) tR.maxSpeed = row["maxSpeed"].toInt();
            trainRows.append(tR);
@@ -576,55 +585,66 @@ void TemplateInfoSenderBuilder::buildContext()  {
     if (!device)
         obj.setProperty("deviceId", QJSValue());
     else {
-        QTime el = device->elapsedTime();
+        const bluetoothdevicesample sample = device->lastSample();
+        QTime el = QTime(0, 0).addSecs(sample.elapsed);
         QString name;
-        bluetoothdevice::BLUETOOTH_TYPE tp = device->deviceType();
+        bluetoothdevice::BLUETOOTH_TYPE tp = (bluetoothdevice::BLUETOOTH_TYPE)sample.type;
 
-        metric dep;
 #ifdef Q_OS_IOS
         obj.setProperty("deviceId", device->bluetoothDevice.deviceUuid().toString());
 #else
         obj.setProperty("deviceId", device->bluetoothDevice.address().toString());
 #endif
         obj.setProperty("deviceName", (name = device->bluetoothDevice.name()).isEmpty()?QString("N/A"):name);
-        obj.setProperty("deviceRSSI", device->bluetoothDevice.rssi());
-        obj.setProperty("deviceType", (int)device->deviceType());
-        obj.setProperty("deviceConnected", (bool)device->connected());
+        obj.setProperty("deviceRSSI", sample.rssi);
+        obj.setProperty("deviceType", (int)tp);
+        obj.setProperty("deviceConnected", sample.connected);
         obj.setProperty("elapsed_s", el.second());
         obj.setProperty("elapsed_m", el.minute());
         obj.setProperty("elapsed_h", el.hour());
-        el = device->currentPace();
+        el = QTime(0, 0).addSecs(sample.pace);
         obj.setProperty("pace_s", el.second());
         obj.setProperty("pace_m", el.minute());
         obj.setProperty("pace_h", el.hour());
-        el = device->movingTime();
+        el = QTime(0, 0).addSecs(sample.moving);
         obj.setProperty("moving_s", el.second());
         obj.setProperty("moving_m", el.minute());
         obj.setProperty("moving_h", el.hour());
-        obj.setProperty("speed", (dep = device->currentSpeed()).value());
-        obj.setProperty("speed_avg", dep.average());
-        obj.setProperty("calories", device->calories());
-        obj.setProperty("distance", device->odometer());
-        obj.setProperty("heart", (dep = device->currentHeart()).value());
-        obj.setProperty("heart_avg", dep.average());
-        obj.setProperty("jouls", device->jouls().value());
-        obj.setProperty("elevation", device->elevationGain());
-        obj.setProperty("difficult", device->difficult());
-        obj.setProperty("watts", (dep = device->wattsMetric()).value());
-        obj.setProperty("watts_avg", dep.average());
+        obj.setProperty("speed", sample.speed.value);
+        obj.setProperty("speed_avg", sample.speed.average);
+        obj.setProperty("calories", sample.calories);
+        obj.setProperty("distance", sample.odometer);
+        obj.setProperty("heart", sample.heart.value);
+        obj.setProperty("heart_avg", sample.heart.average);
+        obj.setProperty("jouls", sample.jouls);
+        obj.setProperty("elevation", sample.elevationGain);
+        obj.setProperty("difficult", sample.difficult);
+        obj.setProperty("watts", sample.watt.value);
+        obj.setProperty("watts_avg", sample.watt.average);
+        obj.setProperty("rmssd", sample.rmssd);
+        obj.setProperty("sdnn", sample.sdnn);
+        obj.setProperty("dfa_alpha1", sample.dfaAlpha1);
+        obj.setProperty("hrv_zone", sample.hrvZone);
+        obj.setProperty("speed_latency", sample.actuationLatency[actuationmodel::SPEED]);
+        obj.setProperty("inclination_latency", sample.actuationLatency[actuationmodel::INCLINATION]);
+        obj.setProperty("resistance_latency", sample.actuationLatency[actuationmodel::RESISTANCE]);
         if (tp == bluetoothdevice::BIKE || tp == bluetoothdevice::ROWING) {
-            obj.setProperty("peloton_resistance", (dep = ((bike *)device)->pelotonResistance()).value());
-            obj.setProperty("peloton_resistance_avg", dep.average());
-            obj.setProperty("cadence", (dep = ((bike *)device)->currentCadence()).value());
-            obj.setProperty("cadence_avg", dep.average());
-            obj.setProperty("resistance", (dep = ((bike *)device)->currentResistance()).value());
-            obj.setProperty("resistance_avg", dep.average());
-            obj.setProperty("cranks", ((bike *)device)->currentCrankRevolutions());
-            obj.setProperty("cranktime", ((bike *)device)->lastCrankEventTime());
+            obj.setProperty("peloton_resistance", sample.bike.pelotonResistance.value);
+            obj.setProperty("peloton_resistance_avg", sample.bike.pelotonResistance.average);
+            obj.setProperty("cadence", sample.bike.cadence.value);
+            obj.setProperty("cadence_avg", sample.bike.cadence.average);
+            obj.setProperty("resistance", sample.bike.resistance.value);
+            obj.setProperty("resistance_avg", sample.bike.resistance.average);
+            obj.setProperty("cranks", sample.bike.crankRevolutions);
+            obj.setProperty("cranktime", sample.bike.lastCrankEventTime);
+        }
+        else if (tp == bluetoothdevice::ELLIPTICAL) {
+            obj.setProperty("resistance", sample.elliptical.inclination.value);
+            obj.setProperty("resistance_avg", sample.elliptical.inclination.average);
         }
         else {
-            obj.setProperty("resistance", (dep = ((treadmill *)device)->currentInclination()).value());
-            obj.setProperty("resistance_avg", dep.average());
+            obj.setProperty("resistance", sample.treadmill.inclination.value);
+            obj.setProperty("resistance_avg", sample.treadmill.inclination.average);
         }
     }
 }
@@ -21,6 +21,7 @@ public:
     QStringList templateIdList() const;
     ~TemplateInfoSenderBuilder();
 private:
+    friend class benchmarks; // test/benchmarks
     bool validFileTemplateType(const QString& tp) const;
     void buildContext();
     void createTemplatesFromFolder(const QString& folder, QStringList& dirTemplates);
@@ -0,0 +1,378 @@
+#include <QApplication>
+#include <QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QXmlStreamReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QQmlApplicationEngine>
+#include <QSysInfo>
+#include "metric.h"
+#include "qfit.h"
+#include "gpx.h"
+#include "zwiftworkout.h"
+#include "trainprogram.h"
+#include "templateinfosender.h"
+#include "templateinfosenderbuilder.h"
+#include "homeform.h"
+#include "domyostreadmill.h"
+#include "domyosbike.h"
+
+// notifications of a Domyos T900 (btlogs/heart200andstop.log): the 26 bytes status comes in a 20 bytes
+// and a 6 bytes packet, with a display status in the middle. A Domyos bike sends the same frames.
+static const char* domyosNotifications[] = {
+    "f0bc00000064000b003c000000000a000000cd00", "0b010000013b",
+    "f0bc00000064000b003c000000000a000000cd00", "0b010000013b",
+    "f0bc00000064000b003c000000000a000000cd00", "0b010000013b",
+    "f0bc00000064000b003c000000000a000000cd00", "0b010000013b",
+    "f0db030014ff010000020100cf00010000010100", "0b01ffffffffbf",
+    "f0bc00000064000b003c000000000a000000cd00", "0b010000013b",
+    "f0bc00000064000b003c000000000a000000cd00", "0b010000013b",
+    "f0bc00000064000b003c000000000a000000cc00", "0b010000013a",
+    "f0bc00000064000b003c000000000a000000cc00", "0b010000013a",
+    "f0bc00000064000b003c000000000a000000cc00", "0b010000013a",
+    "f0bc00000064000b003c000000000a000000cc00", "0b010000013a",
+};
+
+class benchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void metric_setValue();
+    void domyostreadmill_characteristicChanged();
+    void domyosbike_characteristicChanged();
+    void qfit_save_data();
+    void qfit_save();
+    void gpx_open();
+    void zwiftworkout_load();
+    void trainprogram_rowAt();
+    void template_buildContext();
+    void template_update();
+    void homeform_update();
+
+private:
+    QTemporaryDir dir;
+    QList<QByteArray> notifications;
+    QString gpxFile;
+    QString zwoFile;
+    bluetooth* manager = 0;
+    domyostreadmill* treadmill = 0;
+    QQmlApplicationEngine* engine = 0;
+    homeform* home = 0;
+
+    // a controller that is never connected, the parsers check its error
+    template <class T> void attach(T* device);
+    // the recorded notifications through the parser of the driver
+    template <class T> void feed(T* device);
+    void writeGpx(uint32_t points);
+    void writeZwo(uint32_t blocks);
+};
+
+template <class T> void benchmarks::attach(T* device)
+{
+    QBluetoothDeviceInfo info(QBluetoothAddress("00:00:00:00:00:00"), "benchmarks", 0);
+    device->bluetoothDevice = info;
+    device->m_control = QLowEnergyController::createCentral(info, device);
+}
+
+template <class T> void benchmarks::feed(T* device)
+{
+    const QLowEnergyCharacteristic characteristic;
+    foreach(const QByteArray& n, notifications)
+        device->characteristicChanged(characteristic, n);
+}
+
+void benchmarks::writeGpx(uint32_t points)
+{
+    gpxFile = dir.path() + "/benchmarks.gpx";
+    QFile f(gpxFile);
+    QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QTextStream out(&f);
+    const QDateTime start = QDateTime(QDate(2021, 1, 1), QTime(10, 0, 0), Qt::UTC);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<gpx version=\"1.1\" creator=\"benchmarks\"><trk><trkseg>\n";
+    for(uint32_t i = 0; i < points; i++)
+    {
+        out << "<trkpt lat=\"" << QString::number(45.0 + i * 0.00005, 'f', 7) << "\" lon=\"" << QString::number(9.0 + i * 0.00005, 'f', 7) <<
+               "\"><ele>" << QString::number(100.0 + 50.0 * qSin(i / 300.0), 'f', 1) << "</ele><time>" <<
+               start.addSecs(i).toString(Qt::ISODate) << "</time></trkpt>\n";
+    }
+    out << "</trkseg></trk></gpx>\n";
+}
+
+void benchmarks::writeZwo(uint32_t blocks)
+{
+    zwoFile = dir.path() + "/benchmarks.zwo";
+    QFile f(zwoFile);
+    QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QTextStream out(&f);
+    out << "<workout_file><name>benchmarks</name><sportType>bike</sportType><workout>\n";
+    out << "<Warmup Duration=\"600\" PowerLow=\"0.4\" PowerHigh=\"0.75\"/>\n";
+    for(uint32_t i = 0; i < blocks; i++)
+    {
+        out << "<SteadyState Duration=\"300\" Power=\"0.8\"/>\n";
+        out << "<IntervalsT Repeat=\"6\" OnDuration=\"30\" OffDuration=\"30\" OnPower=\"1.2\" OffPower=\"0.5\"/>\n";
+        out << "<Ramp Duration=\"120\" PowerLow=\"0.6\" PowerHigh=\"0.9\"/>\n";
+        out << "<FreeRide Duration=\"60\"/>\n";
+    }
+    out << "<Cooldown Duration=\"600\" PowerLow=\"0.75\" PowerHigh=\"0.4\"/>\n";
+    out << "</workout></workout_file>\n";
+}
+
+void benchmarks::initTestCase()
+{
+    QVERIFY(dir.isValid());
+    for(uint32_t i = 0; i < sizeof(domyosNotifications) / sizeof(domyosNotifications[0]); i++)
+        notifications.append(QByteArray::fromHex(domyosNotifications[i]));
+    writeGpx(3600);
+    writeZwo(20);
+
+    // the settings of the benchmarks application start from the defaults at every run,
+    // with the qz template enabled so the template benchmarks have a script to evaluate
+    QSettings settings;
+    settings.clear();
+    settings.setValue("template_qz_type", "TcpClient");
+    settings.setValue("template_qz_enabled", true);
+    settings.sync();
+
+    // shared discovery: the manager doesn't scan, its driver is the treadmill below
+    manager = new bluetooth(false, "", false, false, 200, false, false, 4, 1.0, true);
+    treadmill = new domyostreadmill();
+    attach(treadmill);
+    feed(treadmill);
+    treadmill->publishSample();
+    manager->domyos = treadmill;
+
+    // left alive at the end: the destructor of homeform saves the workout files
+    engine = new QQmlApplicationEngine();
+    engine->load(QUrl(QStringLiteral("qrc:/main.qml")));
+    if(!engine->rootObjects().isEmpty())
+        home = new homeform(engine, manager);
+
+    // as the app without -log: the messages are dropped before reaching a handler
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false\n*.info=false"));
+}
+
+void benchmarks::metric_setValue()
+{
+    metric m;
+    double v = 0;
+    QBENCHMARK
+    {
+        for(uint32_t i = 0; i < 1000; i++)
+            m.setValue(v += 0.1);
+    }
+}
+
+// one iteration is the whole recorded sequence
+void benchmarks::domyostreadmill_characteristicChanged()
+{
+    domyostreadmill device;
+    attach(&device);
+    QBENCHMARK
+    {
+        feed(&device);
+    }
+}
+
+void benchmarks::domyosbike_characteristicChanged()
+{
+    domyosbike device;
+    attach(&device);
+    QBENCHMARK
+    {
+        feed(&device);
+    }
+}
+
+void benchmarks::qfit_save_data()
+{
+    QTest::addColumn<uint32_t>("records");
+    QTest::newRow("1000") << (uint32_t)1000;
+    QTest::newRow("10000") << (uint32_t)10000;
+    QTest::newRow("100000") << (uint32_t)100000;
+}
+
+void benchmarks::qfit_save()
+{
+    QFETCH(uint32_t, records);
+    QList<SessionLine> session;
+    session.reserve(records);
+    const QDateTime start = QDateTime::currentDateTime();
+    for (uint32_t i = 0; i < records; i++)
+    {
+        session.append(SessionLine(25.0 + (i % 10), 0, i * 0.007, 150 + (i % 100), 10, 30, 120 + (i % 40), 0, 80 + (i % 20),
+                                   i * 0.2, i * 0.01, i, (i % 600) == 599, start.addSecs(i)));
+    }
+    const QString filename = dir.path() + "/benchmarks.fit";
+    QBENCHMARK
+    {
+        qfit::save(filename, session, bluetoothdevice::BIKE);
+    }
+    QVERIFY(QFile(filename).size() > 0);
+}
+
+void benchmarks::gpx_open()
+{
+    int points = 0;
+    QBENCHMARK
+    {
+        gpx g;
+        points = g.open(gpxFile).count();
+    }
+    QVERIFY(points > 0);
+}
+
+void benchmarks::zwiftworkout_load()
+{
+    int rows = 0;
+    QBENCHMARK
+    {
+        rows = zwiftworkout::load(zwoFile).count();
+    }
+    QVERIFY(rows > 0);
+}
+
+// one iteration looks up every second of the program
+void benchmarks::trainprogram_rowAt()
+{
+    trainprogram program(zwiftworkout::load(zwoFile), 0);
+    const uint32_t seconds = QTime(0, 0, 0).secsTo(program.duration());
+    QVERIFY(seconds > 0);
+    int32_t power = 0;
+    QBENCHMARK
+    {
+        for(uint32_t s = 0; s < seconds; s++)
+            power += program.rowAt(s).power;
+    }
+    QVERIFY(power != 0);
+}
+
+void benchmarks::template_buildContext()
+{
+    TemplateInfoSenderBuilder* builder = TemplateInfoSenderBuilder::getInstance();
+    builder->start(treadmill);
+    builder->updateTimer.stop();
+    QBENCHMARK
+    {
+        builder->buildContext();
+    }
+}
+
+void benchmarks::template_update()
+{
+    TemplateInfoSenderBuilder* builder = TemplateInfoSenderBuilder::getInstance();
+    if(builder->templateInfoMap.isEmpty())
+        QSKIP("no template enabled");
+    builder->start(treadmill);
+    builder->updateTimer.stop();
+    QBENCHMARK
+    {
+        builder->buildContext();
+        foreach(TemplateInfoSender* t, builder->templateInfoMap)
+            t->update(builder->engine);
+    }
+}
+
+void benchmarks::homeform_update()
+{
+    if(!home)
+        QSKIP("main.qml not loaded");
+    QBENCHMARK
+    {
+        home->update();
+    }
+}
+
+// the results as json, for the comparison between the releases
+static bool writeJson(const QString& xmlFile, const QString& jsonFile, int failures)
+{
+    QFile xml(xmlFile);
+    if(!xml.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader reader(&xml);
+    while(!reader.atEnd())
+    {
+        reader.readNext();
+        if(!reader.isStartElement())
+            continue;
+        if(reader.name() == QLatin1String("TestFunction"))
+            function = reader.attributes().value("name").toString();
+        else if(reader.name() == QLatin1String("BenchmarkResult"))
+        {
+            QXmlStreamAttributes a = reader.attributes();
+            QJsonObject r;
+            r["name"] = function;
+            r["tag"] = a.value("tag").toString();
+            r["metric"] = a.value("metric").toString();
+            r["value"] = a.value("value").toDouble(); // per iteration
+            r["iterations"] = a.value("iterations").toInt();
+            results.append(r);
+        }
+    }
+    if(reader.hasError())
+        return false;
+
+    QJsonObject root;
+    root["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["qt"] = QString(qVersion());
+    root["cpu"] = QSysInfo::currentCpuArchitecture();
+    root["os"] = QSysInfo::prettyProductName();
+    root["failures"] = failures;
+    root["results"] = results;
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    if(jsonFile.isEmpty())
+    {
+        QTextStream(stdout) << json;
+        return true;
+    }
+    QFile out(jsonFile);
+    if(!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return out.write(json) == json.length();
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    // not the settings of the app
+    app.setOrganizationName("qdomyos-zwift");
+    app.setApplicationName("benchmarks");
+
+    QStringList args = app.arguments();
+    QString jsonFile;
+    int i = args.indexOf("-json");
+    if(i > 0 && i + 1 < args.length())
+    {
+        jsonFile = args.at(i + 1);
+        args.removeAt(i + 1);
+        args.removeAt(i);
+    }
+
+    QTemporaryDir tmp;
+    const QString xmlFile = tmp.path() + "/benchmarks.xml";
+    args << "-o" << xmlFile + ",xml";
+    // the text log on the console, unless stdout is the json
+    if(jsonFile.length())
+        args << "-o" << "-,txt";
+
+    benchmarks b;
+    const int failures = QTest::qExec(&b, args);
+    if(!writeJson(xmlFile, jsonFile, failures))
+    {
+        qWarning() << "benchmarks: unable to write the json results";
+        return 1;
+    }
+    return failures;
+}
+
+#include "benchmarks.moc"
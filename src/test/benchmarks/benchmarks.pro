@@ -0,0 +1,26 @@
+# benchmarks of the hot paths of the app, built from the same sources:
+#   qmake && make && ./benchmarks -platform offscreen -json results.json
+# without -json the results are printed on stdout, the other arguments go to QtTest (-iterations, -callgrind, function names)
+
+APP = $$PWD/../..
+
+QT += $$fromfile($$APP/qdomyos-zwift.pro, QT)
+QT += testlib
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += $$fromfile($$APP/qdomyos-zwift.pro, DEFINES)
+
+INCLUDEPATH += $$APP $$APP/fit-sdk
+
+# the sources of the app without its main
+APP_SOURCES = $$fromfile($$APP/qdomyos-zwift.pro, SOURCES)
+APP_SOURCES -= main.cpp
+for(f, APP_SOURCES): SOURCES += $$APP/$$f
+for(f, $$list($$fromfile($$APP/qdomyos-zwift.pro, HEADERS))): HEADERS += $$APP/$$f
+for(f, $$list($$fromfile($$APP/qdomyos-zwift.pro, FORMS))): FORMS += $$APP/$$f
+for(f, $$list($$fromfile($$APP/qdomyos-zwift.pro, RESOURCES))): RESOURCES += $$APP/$$f
+
+SOURCES += \
+        benchmarks.cpp
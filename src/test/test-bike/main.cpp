@@ -1,8 +1,110 @@
-#include <QCoreApplication>
+#include <QApplication>
+#include <QtTest>
+#include "domyosbike.h"
+#include "domyostreadmill.h"
+
+class testbike : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void bike_hrvClearStats();
+    void bike_hrvLap();
+    void treadmill_hrvClearStats();
+    void treadmill_hrvLap();
+
+private:
+    // beats alternating around 800 ms, well inside the artifact limits of the analyzer
+    static void beats(bluetoothdevice* device, int count);
+    static void hrvClearStats(bluetoothdevice* device);
+    static void hrvLap(bluetoothdevice* device);
+};
+
+void testbike::initTestCase()
+{
+    QSettings settings;
+    settings.clear();
+    settings.sync();
+}
+
+void testbike::beats(bluetoothdevice* device, int count)
+{
+    for(int i = 0; i < count; i++)
+        device->rrInterval(i % 2 ? 780 : 820);
+}
+
+void testbike::hrvClearStats(bluetoothdevice* device)
+{
+    beats(device, 200);
+    QVERIFY(device->currentRMSSD().value() > 0);
+    QVERIFY(device->currentSDNN().max() > 0);
+
+    // the HRV of the previous workout doesn't carry over
+    device->clearStats();
+    QCOMPARE(device->currentRMSSD().max(), 0.0);
+    QCOMPARE(device->currentRMSSD().average(), 0.0);
+    QCOMPARE(device->currentSDNN().max(), 0.0);
+    QCOMPARE(device->currentDFAAlpha1().max(), 0.0);
+
+    // and the analyzer starts from an empty window
+    beats(device, 1);
+    QCOMPARE(device->currentRMSSD().value(), 0.0);
+}
+
+void testbike::hrvLap(bluetoothdevice* device)
+{
+    beats(device, 200);
+    QVERIFY(device->currentRMSSD().lapMax() > 0);
+
+    device->setLap();
+    QCOMPARE(device->currentRMSSD().lapMax(), 0.0);
+    QCOMPARE(device->currentSDNN().lapMax(), 0.0);
+    QVERIFY(device->currentRMSSD().max() > 0);
+
+    // no beat is taken while paused
+    device->setPaused(true);
+    const double rmssd = device->currentRMSSD().value();
+    device->rrInterval(1000);
+    QCOMPARE(device->currentRMSSD().value(), rmssd);
+    QCOMPARE(device->currentRMSSD().lapMax(), 0.0);
+    device->setPaused(false);
+}
+
+void testbike::bike_hrvClearStats()
+{
+    domyosbike device;
+    hrvClearStats(&device);
+}
+
+void testbike::bike_hrvLap()
+{
+    domyosbike device;
+    hrvLap(&device);
+}
+
+void testbike::treadmill_hrvClearStats()
+{
+    domyostreadmill device;
+    hrvClearStats(&device);
+}
+
+void testbike::treadmill_hrvLap()
+{
+    domyostreadmill device;
+    hrvLap(&device);
+}
 
 int main(int argc, char *argv[])
 {
-    QCoreApplication a(argc, argv);
+    QApplication app(argc, argv);
+    // not the settings of the app
+    app.setOrganizationName("qdomyos-zwift");
+    app.setApplicationName("test-bike");
 
-    return a.exec();
+    testbike t;
+    return QTest::qExec(&t, argc, argv);
 }
+
+#include "main.moc"
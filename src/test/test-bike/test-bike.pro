@@ -1,18 +1,25 @@
-QT -= gui
+# tests of the devices, built from the sources of the app:
+#   qmake && make && ./test-bike -platform offscreen
+
+APP = $$PWD/../..
+
+QT += $$fromfile($$APP/qdomyos-zwift.pro, QT)
+QT += testlib
 
 CONFIG += c++11 console
 CONFIG -= app_bundle
 
-# The following define makes your compiler emit warnings if you use
-# any Qt feature that has been marked deprecated (the exact warnings
-# depend on your compiler). Please consult the documentation of the
-# deprecated API in order to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
+DEFINES += $$fromfile($$APP/qdomyos-zwift.pro, DEFINES)
+
+INCLUDEPATH += $$APP $$APP/fit-sdk
 
-# You can also make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+# the sources of the app without its main
+APP_SOURCES = $$fromfile($$APP/qdomyos-zwift.pro, SOURCES)
+APP_SOURCES -= main.cpp
+for(f, APP_SOURCES): SOURCES += $$APP/$$f
+for(f, $$list($$fromfile($$APP/qdomyos-zwift.pro, HEADERS))): HEADERS += $$APP/$$f
+for(f, $$list($$fromfile($$APP/qdomyos-zwift.pro, FORMS))): FORMS += $$APP/$$f
+for(f, $$list($$fromfile($$APP/qdomyos-zwift.pro, RESOURCES))): RESOURCES += $$APP/$$f
 
 SOURCES += \
         main.cpp
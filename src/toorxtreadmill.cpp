@@ -10,7 +10,7 @@ toorxtreadmill::toorxtreadmill()
     refresh = new QTimer(this);
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(1000);
+    pollscheduler::instance()->add(refresh, 1000);
 }
 
 void toorxtreadmill::deviceDiscovered(const QBluetoothDeviceInfo &device)
@@ -259,11 +259,12 @@ void toorxtreadmill::readSocket()
             KCal = GetCaloriesFromPacket(line);
             Speed = GetSpeedFromPacket(line);
             Inclination = GetInclinationFromPacket(line);
-            Heart = GetHeartRateFromPacket(line);
+            const uint8_t heart = GetHeartRateFromPacket(line);
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, heart);
 
             debug("Current speed: " + QString::number(Speed.value()));
             debug("Current incline: " + QString::number(Inclination.value()));
-            debug("Current heart: " + QString::number(Heart.value()));
+            debug("Current heart: " + QString::number(heart));
             debug("Current KCal: " + QString::number(KCal.value()));
             debug("Current Distance: " + QString::number(Distance.value()));
         }
@@ -0,0 +1,137 @@
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QTextStream>
+#include <QThread>
+#include <QDebug>
+#include <chrono>
+
+std::atomic<bool> tracing::s_enabled(false);
+
+static const uint32_t ringSize = 1 << 16; // events kept per thread, the oldest are overwritten
+
+enum EVENT_TYPE
+{
+    COMPLETE = 0,
+    COUNTER,
+};
+
+typedef struct tracingevent
+{
+    const char* name;
+    int64_t ts; // ns
+    int64_t dur; // ns
+    double value;
+    uint8_t type;
+}tracingevent;
+
+// written only by its thread: head is published after the event, so the dump reads complete events
+// (an event can still be overwritten while the dump reads it when the ring wraps)
+typedef struct tracingring
+{
+    tracingevent events[ringSize];
+    std::atomic<uint64_t> head;
+    uint32_t tid;
+    QString name;
+}tracingring;
+
+static QMutex ringsMutex;
+static QList<tracingring*> rings;
+static thread_local tracingring* localRing = 0;
+static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+// the ring outlives its thread, so the events of a finished thread are in the dump too
+static tracingring* ring()
+{
+    if(localRing)
+        return localRing;
+
+    tracingring* r = new tracingring();
+    r->head.store(0);
+    QThread* t = QThread::currentThread();
+    QMutexLocker locker(&ringsMutex);
+    r->tid = rings.length() + 1;
+    r->name = (t && t->objectName().length()) ? t->objectName() : ("thread " + QString::number(r->tid));
+    if(QCoreApplication::instance() && t == QCoreApplication::instance()->thread())
+        r->name = "main";
+    rings.append(r);
+    localRing = r;
+    return r;
+}
+
+static void record(uint8_t type, const char* name, int64_t ts, int64_t dur, double value)
+{
+    tracingring* r = ring();
+    const uint64_t head = r->head.load(std::memory_order_relaxed);
+    tracingevent& e = r->events[head % ringSize];
+    e.type = type;
+    e.name = name;
+    e.ts = ts;
+    e.dur = dur;
+    e.value = value;
+    r->head.store(head + 1, std::memory_order_release);
+}
+
+void tracing::setEnabled(bool enabled)
+{
+    qDebug() << "tracing" << enabled;
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+int64_t tracing::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void tracing::complete(const char* name, int64_t start, int64_t end)
+{
+    record(COMPLETE, name, start, end - start, 0);
+}
+
+void tracing::counter(const char* name, double value)
+{
+    record(COUNTER, name, now(), 0, value);
+}
+
+bool tracing::dump(const QString& filename)
+{
+    QFile f(filename);
+    if(!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "tracing: unable to write" << filename;
+        return false;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    uint32_t count = 0;
+    QTextStream out(&f);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"qdomyos-zwift\"}}";
+
+    QMutexLocker locker(&ringsMutex);
+    foreach(tracingring* r, rings)
+    {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << r->tid <<
+               ",\"args\":{\"name\":\"" << r->name << "\"}}";
+
+        const uint64_t head = r->head.load(std::memory_order_acquire);
+        for(uint64_t i = head > ringSize ? head - ringSize : 0; i < head; i++)
+        {
+            const tracingevent& e = r->events[i % ringSize];
+            // us with the ns as decimals
+            out << ",\n{\"name\":\"" << e.name << "\",\"pid\":" << pid << ",\"tid\":" << r->tid <<
+                   ",\"ts\":" << QString::number(e.ts / 1000.0, 'f', 3);
+            if(e.type == COMPLETE)
+                out << ",\"ph\":\"X\",\"dur\":" << QString::number(e.dur / 1000.0, 'f', 3) << "}";
+            else
+                out << ",\"ph\":\"C\",\"args\":{\"value\":" << e.value << "}}";
+            count++;
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    qDebug() << "tracing:" << count << "events in" << filename;
+    return f.error() == QFile::NoError;
+}
@@ -0,0 +1,51 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QString>
+#include <atomic>
+#include <stdint.h>
+
+// spans and counters along the data path (notification of the driver, update_metrics, homeform::update,
+// template tick, virtual device notification, writes to the machine), dumped in the Chrome trace format
+// that chrome://tracing and ui.perfetto.dev open.
+// Every thread writes into a ring of its own without locks, the dump reads the rings of all the threads.
+// Without QZ_TRACING the macros compile to nothing; with it an event costs two clock reads when tracing
+// is on (-trace or the tracing setting) and a relaxed load when it's off.
+class tracing
+{
+public:
+    static void setEnabled(bool enabled);
+    static bool enabled() {return s_enabled.load(std::memory_order_relaxed);}
+    // ns from the start of the process
+    static int64_t now();
+    static void complete(const char* name, int64_t start, int64_t end);
+    static void counter(const char* name, double value);
+    // writes the events collected so far by every thread, the names must be string literals
+    static bool dump(const QString& filename);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class tracingspan
+{
+public:
+    explicit tracingspan(const char* name) : m_name(name), m_start(tracing::enabled() ? tracing::now() : -1) {}
+    ~tracingspan() {if(m_start >= 0) tracing::complete(m_name, m_start, tracing::now());}
+
+private:
+    const char* m_name;
+    int64_t m_start;
+};
+
+#ifdef QZ_TRACING
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SPAN(name) tracingspan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_COUNTER(name, value) do { if(tracing::enabled()) tracing::counter(name, value); } while(0)
+#else
+#define TRACE_SPAN(name)
+#define TRACE_COUNTER(name, value)
+#endif
+
+#endif // TRACING_H
@@ -22,6 +22,55 @@ uint32_t trainprogram::calculateTimeForRow(int32_t row)
             (rows[row].duration.hour() * 3600));
 }
 
+uint32_t trainprogram::calculateTimeForBlock(int32_t row, int32_t* blockRows)
+{
+    *blockRows = qBound(1, (int32_t)rows[row].repeatRows, rows.length() - row);
+    uint32_t pass = 0;
+    for(int32_t i = row; i < row + *blockRows; i++)
+        pass += calculateTimeForRow(i);
+    return pass;
+}
+
+bool trainprogram::locate(int32_t elapsed, int32_t* row, uint32_t* rowElapsed)
+{
+    if(elapsed < 0)
+        elapsed = 0;
+
+    uint32_t start = 0;
+    int32_t blockRows;
+    for(int32_t i = 0; i < rows.length(); i += blockRows)
+    {
+        const uint32_t pass = calculateTimeForBlock(i, &blockRows);
+        const uint32_t repeat = qMax((uint16_t)1, rows[i].repeat);
+        if((uint32_t)elapsed < start + pass * repeat)
+        {
+            uint32_t t = ((uint32_t)elapsed - start) % pass;
+            for(int32_t j = i; j < i + blockRows; j++)
+            {
+                const uint32_t len = calculateTimeForRow(j);
+                if(t < len)
+                {
+                    *row = j;
+                    *rowElapsed = t;
+                    return true;
+                }
+                t -= len;
+            }
+        }
+        start += pass * repeat;
+    }
+    return false;
+}
+
+trainrow trainprogram::evaluate(int32_t row, uint32_t rowElapsed)
+{
+    trainrow r = rows.at(row);
+    const uint32_t len = calculateTimeForRow(row);
+    if(r.power != -1 && r.powerEnd != -1 && len)
+        r.power = r.power + (int32_t)(((double)(r.powerEnd - r.power) * rowElapsed) / len);
+    return r;
+}
+
 void trainprogram::scheduler()
 {
     QSettings settings;
@@ -42,51 +91,56 @@ void trainprogram::scheduler()
     // entry point
     if(ticks == 1 && currentStep == 0)
     {
+        trainrow first = evaluate(0, 0);
         if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
         {
-            if(rows[0].forcespeed && rows[0].speed)
+            if(first.forcespeed && first.speed)
             {
-                qDebug() << "trainprogram change speed" + QString::number(rows[0].speed);
-                emit changeSpeedAndInclination(rows[0].speed, rows[0].inclination);
+                qDebug() << "trainprogram change speed" + QString::number(first.speed);
+                emit changeSpeedAndInclination(first.speed, first.inclination);
             }
             else
             {
-                qDebug() << "trainprogram change inclination" + QString::number(rows[0].inclination);
-                emit changeInclination(rows[0].inclination);
+                qDebug() << "trainprogram change inclination" + QString::number(first.inclination);
+                emit changeInclination(first.inclination);
             }
         }
         else
         {
-            if(rows[0].resistance != -1)
+            // the grade of a route drives the virtual speed
+            if(first.inclination != -200)
+                emit changeGrade(first.inclination);
+
+            if(first.resistance != -1)
             {
-                qDebug() << "trainprogram change resistance" + QString::number(rows[0].resistance);
-                emit changeResistance(rows[0].resistance);
+                qDebug() << "trainprogram change resistance" + QString::number(first.resistance);
+                emit changeResistance(first.resistance);
             }
 
-            if(rows[0].cadence != -1)
+            if(first.cadence != -1)
             {
-                qDebug() << "trainprogram change cadence" + QString::number(rows[0].cadence);
-                emit changeCadence(rows[0].cadence);
+                qDebug() << "trainprogram change cadence" + QString::number(first.cadence);
+                emit changeCadence(first.cadence);
             }
 
-            if(rows[0].power != -1)
+            if(first.power != -1)
             {
-                qDebug() << "trainprogram change power" + QString::number(rows[0].power);
-                emit changePower(rows[0].power);
+                qDebug() << "trainprogram change power" + QString::number(first.power);
+                emit changePower(first.power);
             }
 
 
-            if(rows[0].requested_peloton_resistance != -1)
+            if(first.requested_peloton_resistance != -1)
             {
-                qDebug() << "trainprogram change requested peloton resistance" + QString::number(rows[0].requested_peloton_resistance);
-                emit changeRequestedPelotonResistance(rows[0].requested_peloton_resistance);
+                qDebug() << "trainprogram change requested peloton resistance" + QString::number(first.requested_peloton_resistance);
+                emit changeRequestedPelotonResistance(first.requested_peloton_resistance);
             }
         }
 
-        if(rows[0].fanspeed != -1)
+        if(first.fanspeed != -1)
         {
-            qDebug() << "trainprogram change fanspeed" + QString::number(rows[0].fanspeed);
-            emit changeFanSpeed(rows[0].fanspeed);
+            qDebug() << "trainprogram change fanspeed" + QString::number(first.fanspeed);
+            emit changeFanSpeed(first.fanspeed);
         }
     }
 
@@ -94,69 +148,77 @@ void trainprogram::scheduler()
 
     qDebug() << "trainprogram elapsed " + QString::number(ticks) + "current row len" + QString::number(currentRowLen);
 
-    uint32_t calculatedLine;
-    uint32_t calculatedElapsedTime = 0;
-    for(calculatedLine = 0; calculatedLine < rows.length(); calculatedLine++)
+    int32_t calculatedLine;
+    uint32_t calculatedRowElapsed;
+    if(!locate(ticks, &calculatedLine, &calculatedRowElapsed))
     {
-        calculatedElapsedTime += calculateTimeForRow(calculatedLine);
-
-        if(calculatedElapsedTime > ticks)
-            break;
+        qDebug() << "trainprogram ends!";
+        started = false;
+        emit stop();
+        return;
     }
 
-    if(calculatedLine != currentStep)
+    // a repeat block plays the same rows again, so a new segment is a new row or a new start
+    const uint32_t calculatedStart = ticks - calculatedRowElapsed;
+    currentStepElapsed = calculatedRowElapsed;
+    trainrow row = evaluate(calculatedLine, calculatedRowElapsed);
+
+    if(calculatedLine != currentStep || calculatedStart != currentStepStart)
     {
-        if(calculateTimeForRow(calculatedLine))
+        currentStep = calculatedLine;
+        currentStepStart = calculatedStart;
+        if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
         {
-            currentStep = calculatedLine;
-            if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL)
+            // only the components that didn't go out ahead of the boundary
+            const bool inclinationEarly = early(actuationmodel::INCLINATION, calculatedStart);
+            if(row.forcespeed && row.speed && !early(actuationmodel::SPEED, calculatedStart))
             {
-                if(rows[currentStep].forcespeed && rows[currentStep].speed)
-                {
-                    qDebug() << "trainprogram change speed" + QString::number(rows[currentStep].speed);
-                    emit changeSpeedAndInclination(rows[currentStep].speed, rows[currentStep].inclination);
-                }
-                qDebug() << "trainprogram change inclination" + QString::number(rows[currentStep].inclination);
-                emit changeInclination(rows[currentStep].inclination);
+                qDebug() << "trainprogram change speed" + QString::number(row.speed);
+                if(inclinationEarly)
+                    emit changeSpeed(row.speed);
+                else
+                    emit changeSpeedAndInclination(row.speed, row.inclination);
             }
-            else
+            if(!inclinationEarly)
             {
-                if(rows[currentStep].resistance != -1)
-                {
-                    qDebug() << "trainprogram change resistance" + QString::number(rows[currentStep].resistance);
-                    emit changeResistance(rows[currentStep].resistance);
-                }
+                qDebug() << "trainprogram change inclination" + QString::number(row.inclination);
+                emit changeInclination(row.inclination);
+            }
+        }
+        else
+        {
+            if(row.inclination != -200)
+                emit changeGrade(row.inclination);
 
-                if(rows[currentStep].cadence != -1)
-                {
-                    qDebug() << "trainprogram change cadence" + QString::number(rows[currentStep].cadence);
-                    emit changeCadence(rows[currentStep].cadence);
-                }
+            if(row.resistance != -1 && !early(actuationmodel::RESISTANCE, calculatedStart))
+            {
+                qDebug() << "trainprogram change resistance" + QString::number(row.resistance);
+                emit changeResistance(row.resistance);
+            }
 
-                if(rows[currentStep].power != -1)
-                {
-                    qDebug() << "trainprogram change power" + QString::number(rows[currentStep].power);
-                    emit changePower(rows[currentStep].power);
-                }
+            if(row.cadence != -1)
+            {
+                qDebug() << "trainprogram change cadence" + QString::number(row.cadence);
+                emit changeCadence(row.cadence);
+            }
 
-                if(rows[currentStep].requested_peloton_resistance != -1)
-                {
-                    qDebug() << "trainprogram change requested peloton resistance" + QString::number(rows[currentStep].requested_peloton_resistance);
-                    emit changeRequestedPelotonResistance(rows[currentStep].requested_peloton_resistance);
-                }
+            if(row.power != -1 && !early(actuationmodel::RESISTANCE, calculatedStart))
+            {
+                qDebug() << "trainprogram change power" + QString::number(row.power);
+                emit changePower(row.power);
             }
 
-            if(rows[currentStep].fanspeed != -1)
+            if(row.requested_peloton_resistance != -1)
             {
-                qDebug() << "trainprogram change fanspeed" + QString::number(rows[currentStep].fanspeed);
-                emit changeFanSpeed(rows[currentStep].fanspeed);
+                qDebug() << "trainprogram change requested peloton resistance" + QString::number(row.requested_peloton_resistance);
+                emit changeRequestedPelotonResistance(row.requested_peloton_resistance);
             }
         }
-        else
+
+        if(row.fanspeed != -1)
         {
-            qDebug() << "trainprogram ends!";
-            started = false;
-            emit stop();
+            qDebug() << "trainprogram change fanspeed" + QString::number(row.fanspeed);
+            emit changeFanSpeed(row.fanspeed);
         }
     }
     else
@@ -167,13 +229,102 @@ void trainprogram::scheduler()
         }
         else
         {
-            if(rows.length() > currentStep && rows[currentStep].power != -1)
+            // the ramp doesn't take back the power of the next segment once it went out
+            if(row.power != -1 && !early(actuationmodel::RESISTANCE, calculatedStart + calculateTimeForRow(calculatedLine)))
+            {
+                qDebug() << "trainprogram change power" + QString::number(row.power);
+                emit changePower(row.power);
+            }
+        }
+    }
+
+    if(settings.value("trainprogram_lookahead", true).toBool())
+        lookahead(calculatedStart + calculateTimeForRow(calculatedLine));
+}
+
+void trainprogram::lookahead(uint32_t nextStart)
+{
+    int32_t line;
+    uint32_t rowElapsed;
+    if(!locate(nextStart, &line, &rowElapsed))
+        return;
+
+    // the getters of the driver belong to the device thread: only the snapshot and the model are read here
+    bluetoothdevice* device = bluetoothManager->device();
+    actuationmodel* model = device->actuationModel();
+    const bluetoothdevicesample sample = device->lastSample();
+    const trainrow next = evaluate(line, 0);
+    const double remaining = (int64_t)nextStart - ticks;
+
+    if(sample.type == bluetoothdevice::TREADMILL)
+    {
+        if(next.forcespeed && next.speed && !early(actuationmodel::SPEED, nextStart) &&
+           model->lag(actuationmodel::SPEED, sample.speed.value, next.speed) >= remaining)
+        {
+            qDebug() << "trainprogram change speed" + QString::number(next.speed) + " ahead of " + QString::number(remaining) + "s";
+            earlyStart[actuationmodel::SPEED] = nextStart;
+            emit changeSpeed(next.speed);
+        }
+        if(next.inclination != -200 && !early(actuationmodel::INCLINATION, nextStart) &&
+           model->lag(actuationmodel::INCLINATION, sample.treadmill.inclination.value, next.inclination) >= remaining)
+        {
+            qDebug() << "trainprogram change inclination" + QString::number(next.inclination) + " ahead of " + QString::number(remaining) + "s";
+            earlyStart[actuationmodel::INCLINATION] = nextStart;
+            emit changeInclination(next.inclination);
+        }
+    }
+    else if(sample.type == bluetoothdevice::BIKE || sample.type == bluetoothdevice::ROWING)
+    {
+        // the power is reached moving the resistance, the lag is the one of its resistance
+        double resistance = -1;
+        if(next.resistance != -1)
+            resistance = next.resistance * sample.difficult;
+        else if(next.power != -1)
+            resistance = powerResistance(device, nextStart, next.power);
+        if(resistance != -1 && !early(actuationmodel::RESISTANCE, nextStart) &&
+           model->lag(actuationmodel::RESISTANCE, sample.bike.resistance.value, resistance) >= remaining)
+        {
+            earlyStart[actuationmodel::RESISTANCE] = nextStart;
+            if(next.resistance != -1)
+            {
+                qDebug() << "trainprogram change resistance" + QString::number(next.resistance) + " ahead of " + QString::number(remaining) + "s";
+                emit changeResistance(next.resistance);
+            }
+            if(next.power != -1)
             {
-                qDebug() << "trainprogram change power" + QString::number(rows[currentStep].power);
-                emit changePower(rows[currentStep].power);
+                qDebug() << "trainprogram change power" + QString::number(next.power) + " ahead of " + QString::number(remaining) + "s";
+                emit changePower(next.power);
             }
         }
     }
+    else if(sample.type == bluetoothdevice::ELLIPTICAL)
+    {
+        // the rows drive only the resistance of an elliptical
+        if(next.resistance != -1 && !early(actuationmodel::RESISTANCE, nextStart) &&
+           model->lag(actuationmodel::RESISTANCE, sample.elliptical.resistance, next.resistance) >= remaining)
+        {
+            qDebug() << "trainprogram change resistance" + QString::number(next.resistance) + " ahead of " + QString::number(remaining) + "s";
+            earlyStart[actuationmodel::RESISTANCE] = nextStart;
+            emit changeResistance(next.resistance);
+        }
+    }
+}
+
+double trainprogram::powerResistance(bluetoothdevice* device, uint32_t start, int32_t power)
+{
+    if(powerStart != start || powerTarget != power)
+    {
+        // once per segment, on the thread of the device; -1 until it answers. A new result for every
+        // request, so a late answer for the previous segment can't be taken for this one
+        powerStart = start;
+        powerTarget = power;
+        powerResult = QSharedPointer<QAtomicInt>(new QAtomicInt(-1));
+        QSharedPointer<QAtomicInt> result = powerResult;
+        QMetaObject::invokeMethod(device, [device, result, power]() {
+            result->storeRelease(((bike*)device)->resistanceFromPowerRequest(power));
+        }, Qt::QueuedConnection);
+    }
+    return powerResult->loadAcquire();
 }
 
 void trainprogram::increaseElapsedTime(uint32_t i)
@@ -198,9 +349,19 @@ void trainprogram::restart()
     ticks = 0;
     offset = 0;
     currentStep = 0;
+    currentStepStart = 0;
+    currentStepElapsed = 0;
+    for(int c = 0; c < actuationmodel::CHANNELS; c++)
+        earlyStart[c] = -1;
     started = true;
 }
 
+void trainprogram::seek(uint32_t elapsed)
+{
+    restart();
+    ticks = elapsed;
+}
+
 bool trainprogram::saveXML(QString filename, const QList<trainrow>& rows) {
     QFile output(filename);
     if (rows.size() && output.open(QIODevice::WriteOnly)) {
@@ -223,6 +384,12 @@ bool trainprogram::saveXML(QString filename, const QList<trainrow>& rows) {
                 stream.writeAttribute("cadence", QString::number(row.cadence));
             if (row.power>=0)
                 stream.writeAttribute("power", QString::number(row.power));
+            if (row.powerEnd>=0)
+                stream.writeAttribute("powerend", QString::number(row.powerEnd));
+            if (row.repeat>1) {
+                stream.writeAttribute("repeat", QString::number(row.repeat));
+                stream.writeAttribute("repeatrows", QString::number(row.repeatRows));
+            }
             stream.writeAttribute("forcespeed", row.forcespeed?"1":"0");
             if (row.fanspeed>=0)
                 stream.writeAttribute("fanspeed", QString::number(row.fanspeed));
@@ -230,8 +397,6 @@ bool trainprogram::saveXML(QString filename, const QList<trainrow>& rows) {
                 stream.writeAttribute("maxspeed", QString::number(row.maxSpeed));
             if (row.zoneHR>=0)
                 stream.writeAttribute("zonehr", QString::number(row.zoneHR));
-            if (row.loopTimeHR>=0)
-                stream.writeAttribute("looptimehr", QString::number(row.loopTimeHR));
             stream.writeEndElement();
         }
         stream.writeEndElement();
@@ -287,12 +452,16 @@ QList<trainrow> trainprogram::loadXML(QString filename)
                 row.cadence = atts.value("cadence").toInt();
             if(atts.hasAttribute("power"))
                 row.power = atts.value("power").toInt();
+            if(atts.hasAttribute("powerend"))
+                row.powerEnd = atts.value("powerend").toInt();
+            if(atts.hasAttribute("repeat"))
+                row.repeat = atts.value("repeat").toUInt();
+            if(atts.hasAttribute("repeatrows"))
+                row.repeatRows = atts.value("repeatrows").toUInt();
             if(atts.hasAttribute("maxspeed"))
                 row.maxSpeed = atts.value("maxspeed").toInt();
             if(atts.hasAttribute("zonehr"))
                 row.zoneHR = atts.value("zonehr").toInt();
-            if(atts.hasAttribute("looptimehr"))
-                row.loopTimeHR = atts.value("looptimehr").toInt();
             if(atts.hasAttribute("forcespeed"))
                 row.forcespeed = atts.value("forcespeed").toInt()?true:false ;
             list.append(row);
@@ -310,50 +479,78 @@ trainrow trainprogram::currentRow()
 {
     if(started && rows.length())
     {
-        return rows.at(currentStep);
+        return evaluate(currentStep, currentStepElapsed);
     }
     return trainrow();
 }
 
-QTime trainprogram::currentRowElapsedTime()
+trainrow trainprogram::rowAt(uint32_t elapsed)
 {
-    uint32_t calculatedLine;
-    uint32_t calculatedElapsedTime = 0;
+    int32_t row;
+    uint32_t rowElapsed;
 
-    if(rows.length() == 0) return QTime(0,0,0);
+    if(rows.length() == 0 || !locate(elapsed, &row, &rowElapsed)) return trainrow();
 
-    for(calculatedLine = 0; calculatedLine < rows.length(); calculatedLine++)
-    {
-        uint32_t currentLine = calculateTimeForRow(calculatedLine);
-        calculatedElapsedTime += currentLine;
+    return evaluate(row, rowElapsed);
+}
 
-        if(calculatedElapsedTime > ticks)
-            return QTime(0,0,calculatedElapsedTime - currentLine + ticks);
-    }
-    return QTime(0,0,0);
+QTime trainprogram::currentRowElapsedTime()
+{
+    int32_t row;
+    uint32_t rowElapsed;
+
+    if(rows.length() == 0 || !locate(ticks, &row, &rowElapsed)) return QTime(0,0,0);
+
+    return QTime(0,0,0).addSecs(ticks - rowElapsed + ticks);
 }
 
 QTime trainprogram::duration()
 {
-    QTime total(0,0,0,0);
-    foreach (trainrow row, rows) {
-        total = total.addSecs((row.duration.hour() * 3600) + (row.duration.minute() * 60) + row.duration.second());
-    }
-    return total;
+    uint32_t total = 0;
+    int32_t blockRows;
+    for(int32_t i = 0; i < rows.length(); i += blockRows)
+        total += calculateTimeForBlock(i, &blockRows) * qMax((uint16_t)1, rows[i].repeat);
+    return QTime(0,0,0,0).addSecs(total);
 }
 
 double trainprogram::totalDistance()
 {
     double distance = 0;
-    foreach (trainrow row, rows) {
-        if(row.duration.hour() || row.duration.minute() || row.duration.second())
+    int32_t blockRows;
+    for(int32_t i = 0; i < rows.length(); i += blockRows)
+    {
+        calculateTimeForBlock(i, &blockRows);
+        const uint16_t repeat = qMax((uint16_t)1, rows[i].repeat);
+        for(int32_t j = i; j < i + blockRows; j++)
         {
-            if(!row.forcespeed)
+            const trainrow& row = rows.at(j);
+            if(calculateTimeForRow(j))
             {
-                return -1;
+                if(!row.forcespeed)
+                {
+                    return -1;
+                }
+                distance += calculateTimeForRow(j) * repeat * (row.speed / 3600);
             }
-            distance += ((row.duration.hour() * 3600) + (row.duration.minute() * 60) + row.duration.second()) * (row.speed / 3600);
         }
     }
     return distance;
 }
+
+void trainprogram::appendSegment(QList<trainrow>& rows, const trainrow& row)
+{
+    if(rows.length())
+    {
+        trainrow& last = rows.last();
+        if(last.repeat <= 1 && row.repeat <= 1 && last.powerEnd == -1 && row.powerEnd == -1 &&
+           last.speed == row.speed && last.fanspeed == row.fanspeed && last.inclination == row.inclination &&
+           last.resistance == row.resistance && last.requested_peloton_resistance == row.requested_peloton_resistance &&
+           last.cadence == row.cadence && last.forcespeed == row.forcespeed &&
+           last.zoneHR == row.zoneHR && last.maxSpeed == row.maxSpeed && last.power == row.power)
+        {
+            last.duration = last.duration.addSecs(QTime(0,0,0).secsTo(row.duration));
+            return;
+        }
+    }
+    rows.append(row);
+}
@@ -3,6 +3,8 @@
 #include <QTime>
 #include <QTimer>
 #include <QObject>
+#include <QSharedPointer>
+#include <QAtomicInt>
 #include "bluetooth.h"
 
 class trainrow
@@ -16,10 +18,14 @@ public:
     int8_t requested_peloton_resistance = -1;
     int16_t cadence = -1;
     bool forcespeed = false;
-    int8_t loopTimeHR = 10;
     int8_t zoneHR = -1;
     int8_t maxSpeed = -1;
     int32_t power = -1;
+
+    // parametric segments, evaluated at the current second instead of being expanded in rows of one second
+    int32_t powerEnd = -1; // with power: linear ramp from power to powerEnd over the duration
+    uint16_t repeat = 1; // the block of repeatRows rows starting from this one is played repeat times
+    uint16_t repeatRows = 1;
 };
 
 class trainprogram: public QObject
@@ -32,11 +38,17 @@ public:
     static trainprogram* load(QString filename, bluetooth* b);
     static QList<trainrow> loadXML(QString filename);
     static bool saveXML(QString filename, const QList<trainrow>& rows);
+    // appends the row, or extends the last one when the targets are the same
+    static void appendSegment(QList<trainrow>& rows, const trainrow& row);
     QTime totalElapsedTime();
     QTime currentRowElapsedTime();
     QTime duration();
     double totalDistance();
     trainrow currentRow();
+    // the row with its ramps evaluated at the given second of the program, an empty row after the end
+    trainrow rowAt(uint32_t elapsed);
+    uint16_t currentRowIndex() {return currentStep;}
+    int32_t elapsedTicks() {return ticks;}
     void increaseElapsedTime(uint32_t i);
     void decreaseElapsedTime(uint32_t i);
     int32_t offsetElapsedTime() {return offset;}
@@ -46,6 +58,8 @@ public:
     bool enabled = true;
 
     void restart();
+    // restarts from the given second of the program, for a resumed session
+    void seek(uint32_t elapsed);
     void scheduler(int tick);
 
 public slots:
@@ -63,14 +77,34 @@ signals:
     void changeCadence(int16_t cadence);
     void changePower(int32_t power);
     void changeSpeedAndInclination(double speed, double inclination);
+    // bikes: grade of the route, for the virtual speed
+    void changeGrade(double grade);
 
 private:
     uint32_t calculateTimeForRow(int32_t row);
+    // one pass of the repeat block starting from row, the number of rows in blockRows
+    uint32_t calculateTimeForBlock(int32_t row, int32_t* blockRows);
+    // row and seconds into the row at the given second of the program, false after the end
+    bool locate(int32_t elapsed, int32_t* row, uint32_t* rowElapsed);
+    // the row with its ramps evaluated at the seconds into the row
+    trainrow evaluate(int32_t row, uint32_t rowElapsed);
+    // issues the commands of the segment starting at nextStart ahead of it by the lag of the machine
+    void lookahead(uint32_t nextStart);
+    // the command of the channel for the segment starting at start went out ahead of it
+    bool early(actuationmodel::CHANNEL c, uint32_t start) {return earlyStart[c] == (int64_t)start;}
+    // resistance of the bike for the power of the segment starting at start, -1 while it's not known yet
+    double powerResistance(bluetoothdevice* device, uint32_t start, int32_t power);
     bluetooth* bluetoothManager;
     bool started = false;
     int32_t ticks = 0;
     uint16_t currentStep = 0;
+    uint32_t currentStepStart = 0; // second of the program the current segment started at
+    uint32_t currentStepElapsed = 0;
     int32_t offset = 0;
+    int64_t earlyStart[actuationmodel::CHANNELS] = {-1, -1, -1}; // per channel, start of the segment issued ahead
+    int64_t powerStart = -1; // segment and power of powerResult
+    int32_t powerTarget = -1;
+    QSharedPointer<QAtomicInt> powerResult;
     QTimer timer;
 };
 
@@ -3,14 +3,38 @@
 
 treadmill::treadmill()
 {
-
+    // about 8 bpm for each km/h, 0.1 km/h steps, at most 1 km/h every 4 seconds
+    heartZone.setModel(8, 40);
+    heartZone.setLimits(1, 30, 0.25, 0.1);
 }
 
-void treadmill::changeSpeed(double speed){ requestSpeed = speed;}
-void treadmill::changeInclination(double inclination){ requestInclination = inclination; }
+void treadmill::changeSpeed(double speed, commandarbiter::SOURCE source){ arbiter.submit(actuationmodel::SPEED, speed, source);}
+void treadmill::changeInclination(double inclination, commandarbiter::SOURCE source){ arbiter.submit(actuationmodel::INCLINATION, inclination, source); }
 bool treadmill::changeFanSpeed(uint8_t speed){ requestFanSpeed = speed; return true; }
-void treadmill::changeSpeedAndInclination(double speed, double inclination){ requestSpeed = speed; requestInclination = inclination;}
+void treadmill::changeSpeedAndInclination(double speed, double inclination, commandarbiter::SOURCE source){ changeSpeed(speed, source); changeInclination(inclination, source);}
 metric treadmill::currentInclination(){ return Inclination; }
+double treadmill::heartZoneOutput() { return currentSpeed().value(); }
+void treadmill::changeHeartZoneOutput(double value) { changeSpeedAndInclination(value, currentInclination().value(), commandarbiter::HEARTZONE); }
+
+void treadmill::applyCommand(actuationmodel::CHANNEL c, double value)
+{
+    if(c == actuationmodel::SPEED)
+    {
+        requestSpeed = value;
+        actuation.request(c, value, currentSpeed().value());
+    }
+    else if(c == actuationmodel::INCLINATION)
+    {
+        requestInclination = value;
+        actuation.request(c, value, currentInclination().value());
+    }
+}
+
+void treadmill::fillSample(bluetoothdevicesample* s)
+{
+    bluetoothdevice::fillSample(s);
+    s->treadmill.inclination = sampleOf(currentInclination());
+}
 uint8_t treadmill::fanSpeed() { return FanSpeed; };
 bool treadmill::connected() { return false; }
 bluetoothdevice::BLUETOOTH_TYPE treadmill::deviceType() { return bluetoothdevice::TREADMILL; }
@@ -48,6 +72,9 @@ void treadmill::update_metrics(const bool watt_calc, const double watts)
 
     _lastTimeUpdate = current;
     _firstUpdate = false;
+    fuseSensors();
+    updateHeartZone();
+    publishSample();
 }
 
 uint16_t treadmill::watts(double weight)
@@ -70,46 +97,18 @@ uint16_t treadmill::watts(double weight)
 
 void treadmill::clearStats()
 {
-    moving.clear(true);
-    elapsed.clear(true);
-    Speed.clear(false);
-    KCal.clear(true);
-    Distance.clear(true);
-    Heart.clear(false);
-    m_jouls.clear(true);
-    elevationAcc = 0;
-    m_watt.clear(false);
-    WeightLoss.clear(false);
-
     Inclination.clear(false);
+    bluetoothdevice::clearStats();
 }
 
 void treadmill::setPaused(bool p)
 {
-    paused = p;
-    moving.setPaused(p);
-    elapsed.setPaused(p);
-    Speed.setPaused(p);
-    KCal.setPaused(p);
-    Distance.setPaused(p);
-    Heart.setPaused(p);
-    m_jouls.setPaused(p);
-    m_watt.setPaused(p);
+    bluetoothdevice::setPaused(p);
     Inclination.setPaused(p);
-    WeightLoss.setPaused(p);
 }
 
 void treadmill::setLap()
 {
-    moving.setLap(true);
-    elapsed.setLap(true);
-    Speed.setLap(false);
-    KCal.setLap(true);
-    Distance.setLap(true);
-    Heart.setLap(false);
-    m_jouls.setLap(true);
-    m_watt.setLap(false);
-    WeightLoss.setLap(false);
-
+    bluetoothdevice::setLap();
     Inclination.setLap(false);
 }
@@ -21,9 +21,9 @@ public:
 
 public slots:
     virtual bool changeFanSpeed(uint8_t speed);
-    virtual void changeSpeed(double speed);
-    virtual void changeInclination(double inclination);
-    virtual void changeSpeedAndInclination(double speed, double inclination);
+    virtual void changeSpeed(double speed, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
+    virtual void changeInclination(double inclination, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
+    virtual void changeSpeedAndInclination(double speed, double inclination, commandarbiter::SOURCE source = commandarbiter::PROGRAM);
 
 signals:
     void tapeStarted();
@@ -33,6 +33,10 @@ protected:
     double requestSpeed = -1;
     double requestInclination = -1;
     double requestFanSpeed = -1;
+    void fillSample(bluetoothdevicesample* s);
+    double heartZoneOutput();
+    void changeHeartZoneOutput(double value);
+    void applyCommand(actuationmodel::CHANNEL c, double value);
 };
 
 #endif // TREADMILL_H
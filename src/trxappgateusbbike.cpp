@@ -17,11 +17,12 @@ trxappgateusbbike::trxappgateusbbike(bool noWriteResistance, bool noHeartService
     this->noHeartService = noHeartService;
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void trxappgateusbbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("trxappgateusbbike::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -29,13 +30,13 @@ void trxappgateusbbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QSt
     {
         connect(this, SIGNAL(packetReceived()),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, QByteArray((const char*)data, data_len));
@@ -43,10 +44,17 @@ void trxappgateusbbike::writeCharacteristic(uint8_t* data, uint8_t data_len, QSt
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void trxappgateusbbike::forceResistance(int8_t requestResistance)
@@ -86,7 +94,7 @@ void trxappgateusbbike::update()
         update_metrics(false, 0);
 
         // updating the bike console every second
-        if(sec1update++ == (1000 / refresh->interval()))
+        if(sec1update++ >= (1000 / refresh->interval()))
         {
             sec1update = 0;
             //updateDisplay(elapsed);
@@ -148,10 +156,10 @@ void trxappgateusbbike::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void trxappgateusbbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("trxappgateusbbike::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     emit packetReceived();
 
     debug(" << " + newValue.toHex(' '));
@@ -208,17 +216,14 @@ void trxappgateusbbike::characteristicChanged(const QLowEnergyCharacteristic &ch
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
     else
 #endif
     {
-        if(heartRateBeltName.startsWith("Disabled"))
-        {
-            if(bike_type != JLL_IC400)
-                Heart = ((uint8_t)(newValue.at(15)) - 1);
-            else
-                Heart = ((uint8_t)(newValue.at(17))) + (((uint8_t)(newValue.at(16))) * 83);
-        }
+        if(bike_type != JLL_IC400)
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, ((uint8_t)(newValue.at(15)) - 1));
+        else
+            sensors.publish(sensorbus::HEART, sensorbus::MACHINE, ((uint8_t)(newValue.at(17))) + (((uint8_t)(newValue.at(16))) * 83));
     }
     FanSpeed = 0;
 
@@ -240,11 +245,10 @@ void trxappgateusbbike::characteristicChanged(const QLowEnergyCharacteristic &ch
     if(!settings.value("speed_power_based", false).toBool())
         Speed = speed;
     else
-        Speed = metric::calculateSpeedFromPower(m_watt.value());
+        Speed = physics.speed(m_watt.value());
     KCal = kcal;
     Distance = DistanceCalculated;
-    if(settings.value("cadence_sensor_name", "Disabled").toString().startsWith("Disabled"))
-        Cadence = cadence;
+    sensors.publish(sensorbus::CADENCE, sensorbus::MACHINE, cadence);
     m_watt = watt;
 
     double ac=0.01243107769;
@@ -576,7 +580,7 @@ void trxappgateusbbike::deviceDiscovered(const QBluetoothDeviceInfo &device)
 
         if(JLL_IC400_bike)
         {
-            refresh->start(500);
+            pollscheduler::instance()->setBaseInterval(refresh, 500);
             bike_type = TYPE::JLL_IC400;
             qDebug() << "JLL_IC400 bike found";
         }
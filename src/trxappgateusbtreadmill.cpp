@@ -15,11 +15,12 @@ trxappgateusbtreadmill::trxappgateusbtreadmill()
     refresh = new QTimer(this);
     initDone = false;
     connect(refresh, SIGNAL(timeout()), this, SLOT(update()));
-    refresh->start(200);
+    pollscheduler::instance()->add(refresh, 200);
 }
 
 void trxappgateusbtreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len, QString info, bool disable_log, bool wait_for_response)
 {
+    TRACE_SPAN("trxappgateusbtreadmill::writeCharacteristic");
     QEventLoop loop;
     QTimer timeout;
 
@@ -27,13 +28,13 @@ void trxappgateusbtreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len
     {
         connect(this, SIGNAL(packetReceived()),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
     else
     {
         connect(gattCommunicationChannelService, SIGNAL(characteristicWritten(QLowEnergyCharacteristic,QByteArray)),
                 &loop, SLOT(quit()));
-        timeout.singleShot(300, &loop, SLOT(quit()));
+        connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
     }
 
     gattCommunicationChannelService->writeCharacteristic(gattWriteCharacteristic, QByteArray((const char*)data, data_len));
@@ -41,10 +42,17 @@ void trxappgateusbtreadmill::writeCharacteristic(uint8_t* data, uint8_t data_len
     if(!disable_log)
         debug(" >> " + QByteArray((const char*)data, data_len).toHex(' ') + " // " + info);
 
+    timeout.setSingleShot(true);
+    timeout.start(300);
     loop.exec();
 
     if(timeout.isActive() == false)
+    {
         debug(" exit for timeout");
+        pollscheduler::instance()->writeResult(refresh, false);
+    }
+    else
+        pollscheduler::instance()->writeResult(refresh, true);
 }
 
 void trxappgateusbtreadmill::forceSpeedOrIncline(double requestSpeed, double requestIncline)
@@ -89,7 +97,7 @@ void trxappgateusbtreadmill::update()
         update_metrics(true, watts(settings.value("weight", 75.0).toFloat()));
 
         // updating the treadmill console every second
-        if(sec1update++ == (1000 / refresh->interval()))
+        if(sec1update++ >= (1000 / refresh->interval()))
         {
             sec1update = 0;
             //updateDisplay(elapsed);
@@ -183,10 +191,10 @@ void trxappgateusbtreadmill::serviceDiscovered(const QBluetoothUuid &gatt)
 
 void trxappgateusbtreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("trxappgateusbtreadmill::characteristicChanged");
     //qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     QSettings settings;
-    QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
     emit packetReceived();
 
     debug(" << " + newValue.toHex(' '));
@@ -219,13 +227,8 @@ void trxappgateusbtreadmill::characteristicChanged(const QLowEnergyCharacteristi
 
 #ifdef Q_OS_ANDROID
     if(settings.value("ant_heart", false).toBool())
-        Heart = (uint8_t)KeepAwakeHelper::heart();
-    else
+        sensors.publish(sensorbus::HEART, sensorbus::PHONE, KeepAwakeHelper::heart());
 #endif
-    {
-        if(heartRateBeltName.startsWith("Disabled"))
-            Heart = 0;
-    }
     FanSpeed = 0;
 
     if(!firstCharChanged)
@@ -376,7 +376,7 @@ virtualbike::virtualbike(bike* t, bool noWriteResistance, bool noHeartService, u
 
     //! [Provide Heartbeat]    
     QObject::connect(&bikeTimer, SIGNAL(timeout()), this, SLOT(bikeProvider()));
-    bikeTimer.start(1000);
+    pollscheduler::instance()->add(&bikeTimer, 1000, pollscheduler::FIXED);
     //! [Provide Heartbeat]
     QObject::connect(leController, SIGNAL(disconnected()), this, SLOT(reconnect()));
     QObject::connect(leController, SIGNAL(error(QLowEnergyController::Error)), this, SLOT(error(QLowEnergyController::Error)));
@@ -389,19 +389,21 @@ void virtualbike::slopeChanged(int16_t iresistance)
     bool erg_mode = settings.value("zwift_erg", false).toBool();
 
     qDebug() << "new requested resistance zwift erg grade " + QString::number(iresistance) + " enabled " + force_resistance;
+    Bike->changeGrade((double)iresistance / 100.0);
     double resistance = ((double)iresistance * 1.5) / 100.0;
     qDebug() << "calculated erg grade " + QString::number(resistance);
     if(force_resistance && !erg_mode)
-        Bike->changeResistance((int8_t)(round(resistance * bikeResistanceGain)) + bikeResistanceOffset + 1); // resistance start from 1
+        Bike->changeResistance((int8_t)(round(resistance * bikeResistanceGain)) + bikeResistanceOffset + 1, commandarbiter::VIRTUAL); // resistance start from 1
 }
 
 void virtualbike::powerChanged(uint16_t power)
 {
-    Bike->changePower(power);
+    Bike->changePower(power, commandarbiter::VIRTUAL);
 }
 
 void virtualbike::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("virtualbike::characteristicChanged");
     QByteArray reply;
     QSettings settings;
     bool force_resistance = settings.value("virtualbike_forceresistance", true).toBool();
@@ -419,7 +421,7 @@ void virtualbike::characteristicChanged(const QLowEnergyCharacteristic &characte
             uint8_t uresistance = newValue.at(1);
             uresistance = uresistance / 10;
             if(force_resistance && !erg_mode)
-                Bike->changeResistance(uresistance);
+                Bike->changeResistance(uresistance, commandarbiter::VIRTUAL);
             qDebug() << "new requested resistance " + QString::number(uresistance) + " enabled " + force_resistance;
             reply.append((quint8)FTMS_RESPONSE_CODE);
             reply.append((quint8)FTMS_SET_TARGET_RESISTANCE_LEVEL);
@@ -554,6 +556,7 @@ void virtualbike::characteristicChanged(const QLowEnergyCharacteristic &characte
 
 void virtualbike::writeCharacteristic(QLowEnergyService* service, QLowEnergyCharacteristic characteristic, QByteArray value)
 {
+    TRACE_SPAN("virtualbike::writeCharacteristic");
     try {
        qDebug() << "virtualbike::writeCharacteristic " + service->serviceName() + " " + characteristic.name() + " " + value.toHex(' ');
        service->writeCharacteristic(characteristic, value); // Potentially causes notification.
@@ -614,6 +617,7 @@ void virtualbike::reconnect()
 
 void virtualbike::bikeProvider()
 {
+    TRACE_SPAN("virtualbike::bikeProvider");
     QSettings settings;
     bool cadence = settings.value("bike_cadence_sensor", false).toBool();
     bool battery = settings.value("battery_service", false).toBool();
@@ -623,14 +627,16 @@ void virtualbike::bikeProvider()
     bool echelon = settings.value("virtual_device_echelon", false).toBool();
     bool erg_mode = settings.value("zwift_erg", false).toBool();
     
-    uint16_t normalizeSpeed = (uint16_t)qRound(Bike->currentSpeed().value() * 100);
+    // one consistent snapshot of the bike for all the characteristics of this tick
+    const bluetoothdevicesample sample = Bike->lastSample();
+    uint16_t normalizeSpeed = (uint16_t)qRound(sample.speed.value * 100);
     
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
     if(h)
     {
-        h->virtualbike_updateFTMS(normalizeSpeed, (char)Bike->currentResistance().value(), (uint16_t)Bike->currentCadence().value() * 2, (uint16_t)Bike->wattsMetric().value());
-        h->virtualbike_setHeartRate(Bike->currentHeart().value());
+        h->virtualbike_updateFTMS(normalizeSpeed, (char)sample.bike.resistance.value, (uint16_t)sample.bike.cadence.value * 2, (uint16_t)sample.watt.value);
+        h->virtualbike_setHeartRate(sample.heart.value);
         if(!erg_mode)
             slopeChanged(h->virtualbike_getCurrentSlope());
         else
@@ -667,16 +673,16 @@ void virtualbike::bikeProvider()
                 value.append((char)(normalizeSpeed & 0xFF)); // speed
                 value.append((char)(normalizeSpeed >> 8) & 0xFF); // speed
 
-                value.append((char)((uint16_t)(Bike->currentCadence().value() * 2) & 0xFF)); // cadence
-                value.append((char)(((uint16_t)(Bike->currentCadence().value() * 2) >> 8) & 0xFF)); // cadence
+                value.append((char)((uint16_t)(sample.bike.cadence.value * 2) & 0xFF)); // cadence
+                value.append((char)(((uint16_t)(sample.bike.cadence.value * 2) >> 8) & 0xFF)); // cadence
 
-                value.append((char)Bike->currentResistance().value()); // resistance
+                value.append((char)sample.bike.resistance.value); // resistance
                 value.append((char)(0)); // resistance
 
-                value.append((char)(((uint16_t)Bike->wattsMetric().value()) & 0xFF)); // watts
-                value.append((char)(((uint16_t)Bike->wattsMetric().value()) >> 8) & 0xFF); // watts
+                value.append((char)(((uint16_t)sample.watt.value) & 0xFF)); // watts
+                value.append((char)(((uint16_t)sample.watt.value) >> 8) & 0xFF); // watts
 
-                value.append(char(Bike->currentHeart().value())); // Actual value.
+                value.append(char(sample.heart.value)); // Actual value.
                 value.append((char)0); // Bkool FTMS protocol HRM offset 1280 fix
 
                 if(!serviceFIT)
@@ -698,12 +704,12 @@ void virtualbike::bikeProvider()
             else if(power)
             {
                 value.append((char)0x10); // crank data present
-                value.append((char)(((uint16_t)Bike->wattsMetric().value()) & 0xFF)); // watt
-                value.append((char)(((uint16_t)Bike->wattsMetric().value()) >> 8) & 0xFF); // watt
-                value.append((char)(((uint16_t)Bike->currentCrankRevolutions()) & 0xFF)); // revs count
-                value.append((char)(((uint16_t)Bike->currentCrankRevolutions()) >> 8) & 0xFF); // revs count
-                value.append((char)(Bike->lastCrankEventTime() & 0xff)); // eventtime
-                value.append((char)(Bike->lastCrankEventTime() >> 8) & 0xFF); // eventtime
+                value.append((char)(((uint16_t)sample.watt.value) & 0xFF)); // watt
+                value.append((char)(((uint16_t)sample.watt.value) >> 8) & 0xFF); // watt
+                value.append((char)(((uint16_t)sample.bike.crankRevolutions) & 0xFF)); // revs count
+                value.append((char)(((uint16_t)sample.bike.crankRevolutions) >> 8) & 0xFF); // revs count
+                value.append((char)(sample.bike.lastCrankEventTime & 0xff)); // eventtime
+                value.append((char)(sample.bike.lastCrankEventTime >> 8) & 0xFF); // eventtime
 
                 if(!service)
                 {
@@ -729,11 +735,11 @@ void virtualbike::bikeProvider()
                 {
                     value.append((char)0x03); // crank and wheel data present
 
-                    if(Bike->currentSpeed().value())
+                    if(sample.speed.value)
                     {
                         const double wheelCircumference = 2000.0; // millimeters
                         wheelRevs++;
-                        lastWheelTime += (uint16_t)(1024.0 / ((Bike->currentSpeed().value() / 3.6) / (wheelCircumference / 1000.0) ));
+                        lastWheelTime += (uint16_t)(1024.0 / ((sample.speed.value / 3.6) / (wheelCircumference / 1000.0) ));
                     }
                     value.append((char)((wheelRevs & 0xFF))); // wheel count
                     value.append((char)((wheelRevs >> 8) & 0xFF)); // wheel count
@@ -742,10 +748,10 @@ void virtualbike::bikeProvider()
                     value.append((char)(lastWheelTime & 0xff)); // eventtime
                     value.append((char)(lastWheelTime >> 8) & 0xFF); // eventtime
                 }
-                value.append((char)(((uint16_t)Bike->currentCrankRevolutions()) & 0xFF)); // revs count
-                value.append((char)(((uint16_t)Bike->currentCrankRevolutions()) >> 8) & 0xFF); // revs count
-                value.append((char)(Bike->lastCrankEventTime() & 0xff)); // eventtime
-                value.append((char)(Bike->lastCrankEventTime() >> 8) & 0xFF); // eventtime
+                value.append((char)(((uint16_t)sample.bike.crankRevolutions) & 0xFF)); // revs count
+                value.append((char)(((uint16_t)sample.bike.crankRevolutions) >> 8) & 0xFF); // revs count
+                value.append((char)(sample.bike.lastCrankEventTime & 0xff)); // eventtime
+                value.append((char)(sample.bike.lastCrankEventTime >> 8) & 0xFF); // eventtime
 
                 if(!service)
                 {
@@ -774,13 +780,13 @@ void virtualbike::bikeProvider()
         value.append(0x09);
         value.append((char)0x00); // elapsed
         value.append((char)0x00); // elapsed
-        value.append((uint8_t)(((uint32_t)(Bike->odometer() * 100)) >> 24)); // distance
-        value.append((uint8_t)(((uint32_t)(Bike->odometer() * 100)) >> 16)); // distance
-        value.append((uint8_t)(((uint32_t)(Bike->odometer() * 100)) >> 8)); // distance
-        value.append((uint8_t)(Bike->odometer() * 100));       // distance
+        value.append((uint8_t)(((uint32_t)(sample.odometer * 100)) >> 24)); // distance
+        value.append((uint8_t)(((uint32_t)(sample.odometer * 100)) >> 16)); // distance
+        value.append((uint8_t)(((uint32_t)(sample.odometer * 100)) >> 8)); // distance
+        value.append((uint8_t)(sample.odometer * 100));       // distance
         value.append((char)0x00);
-        value.append(Bike->currentCadence().value());
-        value.append((uint8_t)Bike->currentHeart().value());
+        value.append((char)sample.bike.cadence.value);
+        value.append((uint8_t)sample.heart.value);
 
         uint8_t sum = 0;
         for(uint8_t i=0; i<value.length(); i++)
@@ -812,7 +818,7 @@ void virtualbike::bikeProvider()
         resistance.append(0xf0);
         resistance.append(0xd2);
         resistance.append(0x01);
-        resistance.append(Bike->currentResistance().value());
+        resistance.append((char)sample.bike.resistance.value);
 
         sum = 0;
         for(uint8_t i=0; i<resistance.length(); i++)
@@ -820,9 +826,9 @@ void virtualbike::bikeProvider()
            sum += resistance[i]; // the last byte is a sort of a checksum
         }
         resistance.append(sum);
-        if(oldresistance != ((uint8_t)Bike->currentResistance().value()))
+        if(oldresistance != ((uint8_t)sample.bike.resistance.value))
             writeCharacteristic(service, characteristic, resistance);
-        oldresistance = ((uint8_t)Bike->currentResistance().value());
+        oldresistance = ((uint8_t)sample.bike.resistance.value);
 
     }
     //characteristic
@@ -176,13 +176,14 @@ virtualtreadmill::virtualtreadmill(bluetoothdevice* t, bool noHeartService)
 
     //! [Provide Heartbeat]    
     QObject::connect(&treadmillTimer, SIGNAL(timeout()), this, SLOT(treadmillProvider()));
-    treadmillTimer.start(1000);
+    pollscheduler::instance()->add(&treadmillTimer, 1000, pollscheduler::FIXED);
     //! [Provide Heartbeat]
     QObject::connect(leController, SIGNAL(disconnected()), this, SLOT(reconnect()));
 }
 
 void virtualtreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    TRACE_SPAN("virtualtreadmill::characteristicChanged");
     emit debug("characteristicChanged " + QString::number(characteristic.uuid().toUInt16()) + " " + newValue);
 
     char a;
@@ -200,7 +201,7 @@ void virtualtreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
             uint16_t uspeed = a + (((uint16_t)b) << 8);
             double requestSpeed = (double)uspeed / 100.0;
             if(treadMill->deviceType() == bluetoothdevice::TREADMILL)
-                ((treadmill*)treadMill)->changeSpeed(requestSpeed);
+                ((treadmill*)treadMill)->changeSpeed(requestSpeed, commandarbiter::VIRTUAL);
             emit debug("new requested speed " + QString::number(requestSpeed));
          }
          else if ((char)newValue.at(0)== 0x03) // Set Target Inclination
@@ -213,7 +214,7 @@ void virtualtreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
               if(requestIncline < 0)
                  requestIncline = 0;
               if(treadMill->deviceType() == bluetoothdevice::TREADMILL)
-                  ((treadmill*)treadMill)->changeInclination(requestIncline);
+                  ((treadmill*)treadMill)->changeInclination(requestIncline, commandarbiter::VIRTUAL);
               emit debug("new requested incline " +QString::number(requestIncline));
          }
          else if ((char)newValue.at(0)== 0x07) // Start request
@@ -253,6 +254,7 @@ void virtualtreadmill::reconnect()
 
 void virtualtreadmill::treadmillProvider()
 {
+    TRACE_SPAN("virtualtreadmill::treadmillProvider");
     QSettings settings;
     bool cadence = settings.value("run_cadence_sensor", false).toBool();
 
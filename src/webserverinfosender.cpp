@@ -4,7 +4,12 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QNetworkReply>
+#include <QTcpSocket>
+#include <QUrlQuery>
+#include "bluetoothdevice.h"
 
+// a subscriber further behind than this skips the events until its socket drains
+static const qint64 maxSubscriberBacklog = 64 * 1024;
 
 WebServerInfoSender::WebServerInfoSender(const QString& id, QObject * parent):TemplateInfoSender(id, parent) {
     fetcher = new QNetworkAccessManager(this);
@@ -53,7 +58,101 @@ bool WebServerInfoSender::send(const QString& data) {
         return false;
 }
 
+bool WebServerInfoSender::update(QJSEngine * eng) {
+    publishSnapshot();
+    return TemplateInfoSender::update(eng);
+}
+
+void WebServerInfoSender::setDevice(bluetoothdevice * dev) {
+    device = dev;
+}
+
+void WebServerInfoSender::publishSnapshot() {
+    QJsonObject obj;
+    if (device) {
+        const bluetoothdevicesample sample = device->lastSample();
+        bluetoothdevice::BLUETOOTH_TYPE tp = (bluetoothdevice::BLUETOOTH_TYPE)sample.type;
+        obj["deviceType"] = (int)tp;
+        obj["deviceConnected"] = sample.connected;
+        obj["paused"] = sample.paused;
+        obj["timestamp"] = sample.timestamp;
+        obj["elapsed"] = (int)sample.elapsed;
+        obj["moving"] = (int)sample.moving;
+        obj["pace"] = (int)sample.pace;
+        obj["speed"] = sample.speed.value;
+        obj["speed_avg"] = sample.speed.average;
+        obj["calories"] = sample.calories;
+        obj["distance"] = sample.odometer;
+        obj["heart"] = sample.heart.value;
+        obj["heart_avg"] = sample.heart.average;
+        obj["jouls"] = sample.jouls;
+        obj["elevation"] = sample.elevationGain;
+        obj["difficult"] = sample.difficult;
+        obj["watts"] = sample.watt.value;
+        obj["watts_avg"] = sample.watt.average;
+        obj["rmssd"] = sample.rmssd;
+        obj["sdnn"] = sample.sdnn;
+        obj["dfa_alpha1"] = sample.dfaAlpha1;
+        obj["hrv_zone"] = sample.hrvZone;
+        obj["speed_latency"] = sample.actuationLatency[actuationmodel::SPEED];
+        obj["inclination_latency"] = sample.actuationLatency[actuationmodel::INCLINATION];
+        obj["resistance_latency"] = sample.actuationLatency[actuationmodel::RESISTANCE];
+        if (tp == bluetoothdevice::BIKE || tp == bluetoothdevice::ROWING) {
+            obj["peloton_resistance"] = sample.bike.pelotonResistance.value;
+            obj["cadence"] = sample.bike.cadence.value;
+            obj["cadence_avg"] = sample.bike.cadence.average;
+            obj["resistance"] = sample.bike.resistance.value;
+            obj["resistance_avg"] = sample.bike.resistance.average;
+        }
+        else if (tp == bluetoothdevice::ELLIPTICAL) {
+            obj["cadence"] = sample.elliptical.cadence;
+            obj["resistance"] = sample.elliptical.inclination.value;
+            obj["resistance_avg"] = sample.elliptical.inclination.average;
+        }
+        else {
+            obj["resistance"] = sample.treadmill.inclination.value;
+            obj["resistance_avg"] = sample.treadmill.inclination.average;
+        }
+    }
+    obj["sequence"] = (qint64)++snapshotSequence;
+    const QByteArray json = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+    const QByteArray sequence = QByteArray::number(snapshotSequence);
+
+    snapshotResponse = "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: application/json\r\n"
+                       "Cache-Control: no-cache\r\n"
+                       "Access-Control-Allow-Origin: *\r\n"
+                       "Content-Length: " + QByteArray::number(json.size()) + "\r\n"
+                       "\r\n" + json;
+    liveEvent = "id: " + sequence + "\ndata: " + json + "\n\n";
+
+    for (QTcpSocket * socket: liveClients) {
+        if (socket->bytesToWrite() < maxSubscriberBacklog)
+            socket->write(liveEvent);
+    }
+    for (QTcpSocket * socket: pollClients) {
+        disconnect(socket, SIGNAL(disconnected()), this, SLOT(subscriberDisconnected()));
+        socket->write(snapshotResponse);
+    }
+    pollClients.clear();
+}
+
+void WebServerInfoSender::addSubscriber(QTcpSocket * socket, QList<QTcpSocket *>& list) {
+    if (!socket)
+        return;
+    connect(socket, SIGNAL(disconnected()), this, SLOT(subscriberDisconnected()), Qt::UniqueConnection);
+    list << socket;
+}
+
+void WebServerInfoSender::subscriberDisconnected() {
+    QTcpSocket * socket = qobject_cast<QTcpSocket *>(sender());
+    liveClients.removeAll(socket);
+    pollClients.removeAll(socket);
+}
+
 void WebServerInfoSender::innerStop() {
+    liveClients.clear();
+    pollClients.clear();
     if (innerTcpServer) {
         if (isRunning())
             innerTcpServer->close();
@@ -101,6 +200,31 @@ bool WebServerInfoSender::init() {
                 });
             }
         }
+        httpServer->route("/api/snapshot", [this] (const QHttpServerRequest &request, QHttpServerResponder &&responder) {
+            bool ok;
+            quint32 since = QUrlQuery(request.url()).queryItemValue("since").toUInt(&ok);
+            if (snapshotResponse.isEmpty())
+                publishSnapshot();
+            // long poll: a client already holding the last snapshot waits for the next tick
+            if (ok && since >= snapshotSequence)
+                addSubscriber(responder.socket(), pollClients);
+            else
+                responder.socket()->write(snapshotResponse);
+        });
+        httpServer->route("/api/live", [this] (const QHttpServerRequest &request, QHttpServerResponder &&responder) {
+            Q_UNUSED(request);
+            QTcpSocket * socket = responder.socket();
+            if (snapshotResponse.isEmpty())
+                publishSnapshot();
+            socket->write("HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/event-stream\r\n"
+                          "Cache-Control: no-cache\r\n"
+                          "Connection: keep-alive\r\n"
+                          "Access-Control-Allow-Origin: *\r\n"
+                          "\r\n");
+            socket->write(liveEvent);
+            addSubscriber(socket, liveClients);
+        });
         if (listen()) {
             qDebug() << "WebServer listening on port" << port<< " "<<relative2Absolute;
             connect(httpServer, SIGNAL(newWebSocketConnection()), this, SLOT(onNewConnection()));
@@ -25,11 +25,24 @@ public:
     virtual ~WebServerInfoSender();
     virtual bool isRunning() const;
     virtual bool send(const QString& data);
+    virtual bool update(QJSEngine * eng);
+    virtual void setDevice(bluetoothdevice * dev);
 private:
     QHttpServer * httpServer = 0;
     QStringList folders;
     bool listen();
     void processFetcher(QWebSocket * sender, const QByteArray& data);
+    // /api/live (server sent events) and /api/snapshot (json, long poll with ?since=<sequence>):
+    // the snapshot of the device is serialized once per tick and the same buffers are written to
+    // every subscriber
+    void publishSnapshot();
+    void addSubscriber(QTcpSocket * socket, QList<QTcpSocket *>& list);
+    bluetoothdevice * device = 0;
+    quint32 snapshotSequence = 0;
+    QByteArray snapshotResponse;
+    QByteArray liveEvent;
+    QList<QTcpSocket *> liveClients;
+    QList<QTcpSocket *> pollClients;
 protected:
     virtual void innerStop();
     int port;
@@ -48,6 +61,7 @@ private slots:
     void processFetcherRequest(QString message);
     void processBinaryMessage(QByteArray message);
     void socketDisconnected();
+    void subscriberDisconnected();
     void ignoreSSLErrors(QNetworkReply *, const QList<QSslError> &);
 };
 
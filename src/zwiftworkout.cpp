@@ -4,6 +4,7 @@
 QList<trainrow> zwiftworkout::load(QString filename)
 {
     QSettings settings;
+    const double ftp = settings.value("ftp", 200.0).toDouble();
     QList<trainrow> list;
     QFile input(filename);
     input.open(QIODevice::ReadOnly);
@@ -42,16 +43,17 @@ QList<trainrow> zwiftworkout::load(QString filename)
                     OffPower = atts.value("OffPower").toDouble();
                 }
 
-                for(uint32_t i=0; i<repeat; i++)
-                {
-                    trainrow row;
-                    row.duration = QTime(OnDuration / 3600, OnDuration / 60, OnDuration % 60, 0);
-                    row.power = OnPower * settings.value("ftp", 200.0).toDouble();
-                    list.append(row);
-                    row.duration = QTime(OffDuration / 3600, OffDuration / 60, OffDuration % 60, 0);
-                    row.power = OffPower * settings.value("ftp", 200.0).toDouble();
-                    list.append(row);
-                }
+                // a block of the on and the off rows played repeat times
+                trainrow row;
+                row.duration = QTime(0, 0, 0, 0).addSecs(OnDuration);
+                row.power = OnPower * ftp;
+                row.repeat = repeat;
+                row.repeatRows = 2;
+                list.append(row);
+                row = trainrow();
+                row.duration = QTime(0, 0, 0, 0).addSecs(OffDuration);
+                row.power = OffPower * ftp;
+                list.append(row);
             }
             else if(stream.name().contains("FreeRide"))
             {
@@ -67,10 +69,10 @@ QList<trainrow> zwiftworkout::load(QString filename)
                 }
 
                 trainrow row;
-                row.duration = QTime(Duration / 3600, Duration / 60, Duration % 60, 0);
+                row.duration = QTime(0, 0, 0, 0).addSecs(Duration);
                 list.append(row);
             }
-            else if(stream.name().contains("Ramp"))
+            else if(stream.name().contains("Ramp") || stream.name().contains("Warmup") || stream.name().contains("Cooldown"))
             {
                 uint32_t Duration = 1;
                 double PowerLow = 1;
@@ -88,16 +90,12 @@ QList<trainrow> zwiftworkout::load(QString filename)
                     PowerHigh = atts.value("PowerHigh").toDouble();
                 }
 
-                for(uint32_t i=0; i<Duration; i++)
-                {
-                    trainrow row;
-                    row.duration = QTime(0, 0, 1, 0);
-                    if(PowerHigh > PowerLow)
-                        row.power = (PowerLow + (((PowerHigh - PowerLow) / Duration) * i)) * settings.value("ftp", 200.0).toDouble();
-                    else
-                        row.power = (PowerLow - (((PowerLow - PowerHigh) / Duration) * i)) * settings.value("ftp", 200.0).toDouble();
-                    list.append(row);
-                }
+                // evaluated by the train program at every second of the row
+                trainrow row;
+                row.duration = QTime(0, 0, 0, 0).addSecs(Duration);
+                row.power = PowerLow * ftp;
+                row.powerEnd = PowerHigh * ftp;
+                list.append(row);
             }
             else if(stream.name().contains("SteadyState"))
             {
@@ -113,8 +111,8 @@ QList<trainrow> zwiftworkout::load(QString filename)
                 }
 
                 trainrow row;
-                row.duration = QTime(Duration / 3600, Duration / 60, Duration % 60, 0);
-                row.power = Power * settings.value("ftp", 200.0).toDouble();
+                row.duration = QTime(0, 0, 0, 0).addSecs(Duration);
+                row.power = Power * ftp;
                 list.append(row);
             }
         }
@@ -220,15 +220,6 @@ function x_editable_configure_maxSpeed(idx, row) {
     };
 }
 
-function x_editable_configure_loopTimeHR(idx, row) {
-    return {
-        validate: x_editable_validate_number(parseFloat, 1, 100, 'Loop Time'),
-        name: 'loopTimeHR',
-        type: 'inputspinner',
-        display: x_editable_seconds_display
-    };
-}
-
 function training_duration_init(form) {
     let training_duration = $(`
         <div class="form-group">
@@ -249,7 +240,6 @@ let training_fields_defaults = {
     requested_peloton_resistance:-1,
     cadence:-1,
     forcespeed: false,
-    loopTimeHR: 10,
     zoneHR:-1,
     maxSpeed:-1
 };
@@ -353,10 +343,6 @@ let training_templates = {
                         <label for="hrzones-maxspeed">Max Speed</label>
                         <input type="number" placeholder="Max Speed" id="hrzones-maxspeed" value="0" min="0" max="100" step="1" required/>
                     </div>
-                    <div class="form-group">
-                        <label for="hrzones-looptimehr">Loop Time</label>
-                        <input type="number" data-suffix="s" placeholder="Loop Time" id="hrzones-looptimehr" value="1" min="1" max="100" step="1" required/>
-                    </div>
                     <div class="form-group">
                         <label for="treadmill-fanspeed">Fan Speed</label>
                         <input type="number" placeholder="Fan Speed" id="treadmill-fanspeed" value="0" min="0" max="100" step="1" required/>
@@ -369,18 +355,16 @@ let training_templates = {
         'object2form': function(val) {
             $('#hrzones-zonehr').val(val.zoneHR);
             $('#hrzones-maxspeed').val(val.maxSpeed);
-            $('#hrzones-looptimehr').val(val.loopTimeHR);
             $('#treadmill-fanspeed').val(val.fanspeed);
         },
         'form2object': function() {
             return {
                 zoneHR: $('#hrzones-zonehr').val(),
                 maxSpeed: $('#hrzones-maxspeed').val(),
-                loopTimeHR: $('#hrzones-looptimehr').val(),
                 fanspeed: $('#treadmill-fanspeed').val()
             };
         },
-        'columns': ['zoneHR', 'maxSpeed', 'loopTimeHR', 'fanspeed'],
+        'columns': ['zoneHR', 'maxSpeed', 'fanspeed'],
     },
 };
 